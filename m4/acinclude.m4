@@ -13,6 +13,32 @@ dnl
 dnl You should have received a copy of the GNU General Public License
 dnl along with this program.  If not, see <http://www.gnu.org/licenses/>.
 dnl ===
+dnl GCONFIG_FN_ACCEPT4
+dnl ------------------
+dnl Tests for accept4().
+dnl
+AC_DEFUN([GCONFIG_FN_ACCEPT4],
+[AC_CACHE_CHECK([for accept4],[gconfig_cv_accept4],
+[
+	AC_COMPILE_IFELSE([AC_LANG_PROGRAM(
+		[
+			[#include <sys/types.h>]
+			[#include <sys/socket.h>]
+			[int fd = 0 ;]
+		],
+		[
+			[fd = accept4( fd , 0 , 0 , SOCK_NONBLOCK | SOCK_CLOEXEC ) ;]
+		])],
+		gconfig_cv_accept4=yes ,
+		gconfig_cv_accept4=no )
+])
+	if test "$gconfig_cv_accept4" = "yes" ; then
+		AC_DEFINE(GCONFIG_HAVE_ACCEPT4,1,[Define true if have accept4() in sys/socket.h])
+	else
+		AC_DEFINE(GCONFIG_HAVE_ACCEPT4,0,[Define true if have accept4() in sys/socket.h])
+	fi
+])
+
 dnl GCONFIG_FN_ARFLAGS
 dnl ------------------
 dnl Does AC_SUBST to set ARFLAGS to "cr", depending on the output from
@@ -156,6 +182,7 @@ AC_DEFUN([GCONFIG_FN_CHECK_NET],[
 	AC_REQUIRE([GCONFIG_FN_INET_NTOP])
 	AC_REQUIRE([GCONFIG_FN_INET_PTON])
 	AC_REQUIRE([GCONFIG_FN_EPOLL])
+	AC_REQUIRE([GCONFIG_FN_ACCEPT4])
 	AC_REQUIRE([GCONFIG_FN_RTNETLINK])
 	AC_REQUIRE([GCONFIG_FN_NETROUTE])
 	AC_REQUIRE([GCONFIG_FN_IFNAMETOINDEX])
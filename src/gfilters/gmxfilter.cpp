@@ -30,6 +30,20 @@
 #include "gdatetime.h"
 #include "gstringtoken.h"
 #include "glog.h"
+#include <sstream>
+
+namespace GFilters
+{
+	namespace MxFilterImp
+	{
+		std::string cacheReport()
+		{
+			std::ostringstream ss ;
+			MxLookup::report( ss , "" , "; " ) ;
+			return G::Str::trimmed( ss.str() , "; " ) ;
+		}
+	}
+}
 
 GFilters::MxFilter::MxFilter( GNet::EventState es , GStore::FileStore & store ,
 	Filter::Type filter_type , const Filter::Config & filter_config , const std::string & spec ) :
@@ -153,6 +167,7 @@ void GFilters::MxFilter::lookupDone( GStore::MessageId message_id , std::string
 	G_LOG( "GFilters::MxFilter::start: " << prefix() << ": [" << message_id.str() << "]: "
 		<< "setting forward-to-address [" << address << "]"
 		<< (error.empty()?"":" (") << error << (error.empty()?"":")") ) ;
+	G_LOG_MORE( "GFilters::MxFilter::lookupDone: " << prefix() << ": " << MxFilterImp::cacheReport() ) ;
 
 	// update the envelope forward-to-address
 	GStore::StoredFile msg( m_store , message_id , storestate() ) ;
@@ -180,6 +195,8 @@ GFilters::MxLookup::Config GFilters::MxFilter::parseSpec( std::string_view spec
 			config.ns_timeout = G::TimeInterval( G::Str::toUInt(s.substr(4U)) ) ;
 		else if( s.find("rt=") == 0U && s.size() > 3U && G::Str::isUInt(s.substr(3U)) )
 			config.restart_timeout = G::TimeInterval( G::Str::toUInt(s.substr(3U)) ) ;
+		else if( s.find("ttl=") == 0U && s.size() > 4U && G::Str::isUInt(s.substr(4U)) )
+			config.cache_ttl = G::Str::toUInt( s.substr(4U) ) ;
 		else if( GNet::Address::validString( s ) )
 			nameservers_out.push_back( GNet::Address::parse( s ) ) ;
 		else if( GNet::Address::validStrings( s , "53" ) )
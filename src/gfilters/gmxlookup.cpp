@@ -24,9 +24,13 @@
 #include "gnameservers.h"
 #include "gstr.h"
 #include "gstringtoken.h"
+#include "glimits.h"
 #include "gassert.h"
 #include "glog.h"
+#include <algorithm>
 #include <fstream>
+#include <map>
+#include <sstream>
 #include <vector>
 #include <utility>
 
@@ -35,10 +39,36 @@ namespace GFilters
 	namespace MxLookupImp
 	{
 		enum class Result { error , fatal , mx , cname , ip } ;
-		std::pair<Result,std::string> parse( const GNet::DnsMessage & , const GNet::Address & , unsigned int ) ;
+		std::pair<Result,std::string> parse( const GNet::DnsMessage & , const GNet::Address & , unsigned int , unsigned int & ) ;
+		static constexpr unsigned int negative_ttl {60U} ; // seconds, for nxdomain
+		class Cache ;
 	}
 }
 
+class GFilters::MxLookupImp::Cache /// A shared cache of MX lookup results, with a register of lookups in progress.
+{
+public:
+	struct Entry
+	{
+		std::string result ;
+		std::string error ;
+		G::TimerTime expiry ;
+	} ;
+	static Cache & instance() ;
+	const Entry * find( const std::string & key ) ;
+	void add( const std::string & key , const std::string & result , const std::string & error , unsigned int ttl ) ;
+	MxLookup * leader( const std::string & key ) const ;
+	void setLeader( const std::string & key , MxLookup * ) ;
+	void report( std::ostream & , const std::string & , const std::string & ) const ;
+	unsigned long m_coalesced {0UL} ;
+
+private:
+	std::map<std::string,Entry> m_map ;
+	std::map<std::string,MxLookup*> m_leaders ;
+	unsigned long m_hits {0UL} ;
+	unsigned long m_misses {0UL} ;
+} ;
+
 bool GFilters::MxLookup::enabled()
 {
 	return true ;
@@ -86,8 +116,25 @@ GFilters::MxLookup::MxLookup( GNet::EventState es , Config config ,
 	}
 }
 
+GFilters::MxLookup::~MxLookup()
+{
+	try
+	{
+		detach() ;
+	}
+	catch(...) // NOLINT bugprone-empty-catch
+	{
+	}
+}
+
 void GFilters::MxLookup::start( const GStore::MessageId & message_id , const std::string & forward_to , unsigned int port )
 {
+	using Cache = MxLookupImp::Cache ;
+	detach() ;
+	m_message_id = message_id ;
+	m_finished = false ;
+	m_error.clear() ;
+	m_result.clear() ;
 	if( !m_socket4 && !m_socket6 )
 	{
 		fail( "no nameserver" ) ;
@@ -98,16 +145,53 @@ void GFilters::MxLookup::start( const GStore::MessageId & message_id , const std
 	}
 	else
 	{
-		m_message_id = message_id ;
 		m_port = port ? port : 25U ;
-		m_ns_index = 0U ;
-		m_ns_failures = 0U ;
 		m_question = forward_to ;
-		sendMxQuestion( m_ns_index , m_question ) ;
-		startTimer() ;
+
+		m_key.clear() ;
+		if( m_config.cache_ttl )
+		{
+			std::ostringstream ss ;
+			ss << G::Str::lower(forward_to) << '\0' << m_port ;
+			for( const auto & ns : m_nameservers )
+				ss << '\0' << ns.displayString() ;
+			m_key = ss.str() ;
+		}
+
+		MxLookup * leader = m_key.empty() ? nullptr : Cache::instance().leader( m_key ) ;
+		const Cache::Entry * entry = ( m_key.empty() || leader ) ? nullptr : Cache::instance().find( m_key ) ;
+		if( leader )
+		{
+			// share the results of a lookup already in progress
+			G_LOG_MORE( "GFilters::MxLookup::start: mx: waiting for lookup of [" << m_question << "]" ) ;
+			leader->m_waiters.push_back( this ) ;
+			Cache::instance().m_coalesced++ ;
+		}
+		else if( entry )
+		{
+			G_LOG_MORE( "GFilters::MxLookup::start: mx: cached: [" << m_question << "]: "
+				<< (entry->error.empty()?entry->result:entry->error) ) ;
+			deliver( entry->result , entry->error ) ;
+		}
+		else
+		{
+			m_leader = !m_key.empty() ;
+			if( m_leader )
+				Cache::instance().setLeader( m_key , this ) ;
+			startQuery() ;
+		}
 	}
 }
 
+void GFilters::MxLookup::startQuery()
+{
+	m_ns_index = 0U ;
+	m_ns_failures = 0U ;
+	m_ttl = m_config.cache_ttl ;
+	sendMxQuestion( m_ns_index , m_question ) ;
+	startTimer() ;
+}
+
 void GFilters::MxLookup::readEvent()
 {
 	G_DEBUG( "GFilters::MxLookup::readEvent" ) ;
@@ -129,10 +213,15 @@ void GFilters::MxLookup::process( const char * p , std::size_t n )
 	if( response.valid() && response.QR() && response.ID() && response.ID() < (m_nameservers.size()+1U) )
 	{
 		std::size_t ns_index = static_cast<std::size_t>(response.ID()) - 1U ;
-		auto pair = parse( response , m_nameservers.at(ns_index) , m_port ) ;
+		unsigned int ttl = 0U ;
+		auto pair = parse( response , m_nameservers.at(ns_index) , m_port , ttl ) ;
+		if( pair.first != Result::error && pair.first != Result::fatal )
+			m_ttl = std::min( m_ttl , ttl ) ;
 		if( pair.first == Result::error && (m_ns_failures+1U) < m_nameservers.size() )
 			disable( ns_index , pair.second ) ;
-		else if( pair.first == Result::error || pair.first == Result::fatal )
+		else if( pair.first == Result::fatal )
+			fail( pair.second , std::min(m_ttl,negative_ttl) ) ;
+		else if( pair.first == Result::error )
 			fail( pair.second ) ;
 		else if( pair.first == Result::mx )
 			sendHostQuestion( ns_index , pair.second ) ;
@@ -152,9 +241,10 @@ void GFilters::MxLookup::disable( std::size_t ns_index , const std::string & rea
 }
 
 std::pair<GFilters::MxLookupImp::Result,std::string> GFilters::MxLookupImp::parse( const GNet::DnsMessage & response ,
-	const GNet::Address & ns_address , unsigned int port )
+	const GNet::Address & ns_address , unsigned int port , unsigned int & ttl_out )
 {
 	G_ASSERT( port != 0U ) ;
+	ttl_out = 0U ;
 	std::string from = " from " + ns_address.hostPartString() ;
 	if( response.RCODE() == 3 && response.AA() )
 	{
@@ -208,6 +298,7 @@ std::pair<GFilters::MxLookupImp::Result,std::string> GFilters::MxLookupImp::pars
 			}
 		}
 
+		ttl_out = response.ttl() ;
 		if( !cname_result.empty() )
 			return { Result::cname , cname_result } ;
 		else if( address.port() != 0U )
@@ -245,11 +336,73 @@ void GFilters::MxLookup::sendHostQuestion( std::size_t ns_index , const std::str
 }
 
 void GFilters::MxLookup::cancel()
+{
+	detach() ;
+	stop() ;
+}
+
+void GFilters::MxLookup::stop()
 {
 	dropReadHandlers() ;
 	m_timer.cancelTimer() ;
 }
 
+void GFilters::MxLookup::detach()
+{
+	using Cache = MxLookupImp::Cache ;
+	if( m_key.empty() )
+		return ;
+	if( m_leader )
+	{
+		// hand over any waiters to the first of them
+		m_leader = false ;
+		Cache::instance().setLeader( m_key , nullptr ) ;
+		if( !m_waiters.empty() )
+		{
+			MxLookup * new_leader = m_waiters.front() ;
+			new_leader->m_waiters.assign( m_waiters.begin()+1 , m_waiters.end() ) ;
+			new_leader->m_leader = true ;
+			Cache::instance().setLeader( m_key , new_leader ) ;
+			new_leader->startQuery() ;
+		}
+		m_waiters.clear() ;
+	}
+	else if( MxLookup * leader = Cache::instance().leader( m_key ) )
+	{
+		auto & waiters = leader->m_waiters ;
+		waiters.erase( std::remove( waiters.begin() , waiters.end() , this ) , waiters.end() ) ;
+	}
+	m_key.clear() ;
+}
+
+void GFilters::MxLookup::complete( const std::string & result , const std::string & error , unsigned int ttl )
+{
+	using Cache = MxLookupImp::Cache ;
+	if( m_leader )
+	{
+		m_leader = false ;
+		Cache::instance().setLeader( m_key , nullptr ) ;
+		Cache::instance().add( m_key , result , error , ttl ) ;
+		for( auto * waiter : m_waiters )
+		{
+			waiter->m_key.clear() ;
+			waiter->deliver( result , error ) ;
+		}
+		m_waiters.clear() ;
+	}
+	m_key.clear() ;
+}
+
+void GFilters::MxLookup::deliver( const std::string & result , const std::string & error )
+{
+	// emit the result asynchronously
+	m_result = result ;
+	m_error = error.empty() ? std::string() : ( "mx: " + error ) ;
+	m_finished = true ;
+	dropReadHandlers() ;
+	m_timer.startTimer( 0U ) ;
+}
+
 void GFilters::MxLookup::dropReadHandlers()
 {
 	if( m_socket4 )
@@ -258,19 +411,19 @@ void GFilters::MxLookup::dropReadHandlers()
 		m_socket6->dropReadHandler() ;
 }
 
-void GFilters::MxLookup::fail( const std::string & error )
+void GFilters::MxLookup::fail( const std::string & error , unsigned int ttl )
 {
-	m_error = "mx: " + error ;
-	dropReadHandlers() ;
-	m_timer.startTimer( 0U ) ;
+	complete( {} , error , ttl ) ;
+	deliver( {} , error ) ;
 }
 
 void GFilters::MxLookup::onTimeout()
 {
-	if( !m_error.empty() )
+	if( m_finished )
 	{
-		cancel() ;
-		m_done_signal.emit( m_message_id , "" , m_error ) ;
+		m_finished = false ;
+		stop() ;
+		m_done_signal.emit( m_message_id , std::string(m_result) , std::string(m_error) ) ;
 	}
 	else
 	{
@@ -292,7 +445,8 @@ void GFilters::MxLookup::startTimer()
 
 void GFilters::MxLookup::succeed( const std::string & result )
 {
-	cancel() ;
+	stop() ;
+	complete( result , {} , m_ttl ) ;
 	m_done_signal.emit( m_message_id , result , "" ) ;
 }
 
@@ -306,6 +460,85 @@ G::Slot::Signal<GStore::MessageId,std::string,std::string> & GFilters::MxLookup:
 	return m_done_signal ;
 }
 
+void GFilters::MxLookup::report( std::ostream & stream , const std::string & px , const std::string & eol )
+{
+	MxLookupImp::Cache::instance().report( stream , px , eol ) ;
+}
+
 GFilters::MxLookup::Config::Config()
 = default ;
 
+// ==
+
+GFilters::MxLookupImp::Cache & GFilters::MxLookupImp::Cache::instance()
+{
+	static Cache cache ;
+	return cache ;
+}
+
+const GFilters::MxLookupImp::Cache::Entry * GFilters::MxLookupImp::Cache::find( const std::string & key )
+{
+	auto p = m_map.find( key ) ;
+	if( p != m_map.end() && G::TimerTime::now() <= p->second.expiry )
+	{
+		m_hits++ ;
+		return &(*p).second ;
+	}
+	m_misses++ ;
+	return nullptr ;
+}
+
+void GFilters::MxLookupImp::Cache::add( const std::string & key , const std::string & result ,
+	const std::string & error , unsigned int ttl )
+{
+	if( ttl == 0U )
+		return ;
+	G::TimerTime now = G::TimerTime::now() ;
+	const std::size_t limit = static_cast<std::size_t>( G::Limits<>::mx_cache ) ;
+	if( m_map.size() >= limit )
+	{
+		// remove expired entries, and then the oldest if still full
+		for( auto p = m_map.begin() ; p != m_map.end() ; )
+		{
+			if( p->second.expiry <= now )
+				p = m_map.erase( p ) ;
+			else
+				++p ;
+		}
+		while( !m_map.empty() && m_map.size() >= limit )
+		{
+			m_map.erase( std::min_element( m_map.begin() , m_map.end() ,
+				[](const std::pair<const std::string,Entry> & a , const std::pair<const std::string,Entry> & b){
+					return G::TimerTime::less( a.second.expiry , b.second.expiry ) ; } ) ) ;
+		}
+	}
+	Entry entry { result , error , now + G::TimeInterval(ttl) } ;
+	auto p = m_map.find( key ) ;
+	if( p == m_map.end() )
+		m_map.insert( {key,entry} ) ;
+	else
+		p->second = entry ;
+}
+
+GFilters::MxLookup * GFilters::MxLookupImp::Cache::leader( const std::string & key ) const
+{
+	auto p = m_leaders.find( key ) ;
+	return p == m_leaders.end() ? nullptr : p->second ;
+}
+
+void GFilters::MxLookupImp::Cache::setLeader( const std::string & key , MxLookup * lookup )
+{
+	if( lookup )
+		m_leaders[key] = lookup ;
+	else
+		m_leaders.erase( key ) ;
+}
+
+void GFilters::MxLookupImp::Cache::report( std::ostream & s , const std::string & px , const std::string & eol ) const
+{
+	s << px << "MX cache entries: " << m_map.size() << eol ;
+	s << px << "MX cache hits: " << m_hits << eol ;
+	s << px << "MX cache misses: " << m_misses << eol ;
+	s << px << "MX lookups shared: " << m_coalesced << eol ;
+}
+
@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <iostream>
 
 namespace GFilters
 {
@@ -46,6 +47,10 @@ namespace GFilters
 /// 'restart_timeout' before the sequence starts again. There is no
 /// overall timeout.
 ///
+/// Results are held in a shared cache for the lifetime of the DNS
+/// records, up to 'cache_ttl', and concurrent lookups of the same
+/// domain share one set of DNS queries.
+///
 class GFilters::MxLookup : private GNet::EventHandler
 {
 public:
@@ -54,6 +59,7 @@ public:
 		Config() ;
 		G::TimeInterval ns_timeout {1U,0} ;
 		G::TimeInterval restart_timeout {15U,0} ;
+		unsigned int cache_ttl {3600U} ; // maximum cache time in seconds, zero to disable
 	} ;
 
 	static bool enabled() ;
@@ -66,6 +72,9 @@ public:
 		///< Constructor taking a list of nameservers.
 		/// \see GNet::nameservers()
 
+	~MxLookup() override ;
+		///< Destructor.
+
 	void start( const GStore::MessageId & , const std::string & question_domain , unsigned int port ) ;
 		///< Starts the lookup.
 
@@ -78,15 +87,31 @@ public:
 	void cancel() ;
 		///< Cancels the lookup so the doneSignal() is not emitted.
 
+	static void report( std::ostream & stream ,
+		const std::string & line_prefix = {} ,
+		const std::string & eol = std::string("\n") ) ;
+			///< Reports cache statistics onto a stream.
+
 private: // overrides
 	void readEvent() override ; // GNet::EventHandler
 
+public:
+	MxLookup( const MxLookup & ) = delete ;
+	MxLookup( MxLookup && ) = delete ;
+	MxLookup & operator=( const MxLookup & ) = delete ;
+	MxLookup & operator=( MxLookup && ) = delete ;
+
 private:
+	void startQuery() ;
+	void stop() ;
+	void detach() ;
+	void complete( const std::string & result , const std::string & error , unsigned int ttl ) ;
+	void deliver( const std::string & result , const std::string & error ) ;
 	void startTimer() ;
 	void onTimeout() ;
 	void sendMxQuestion( std::size_t , const std::string & ) ;
 	void sendHostQuestion( std::size_t , const std::string & ) ;
-	void fail( const std::string & ) ;
+	void fail( const std::string & , unsigned int ttl = 0U ) ;
 	void succeed( const std::string & ) ;
 	void dropReadHandlers() ;
 	GNet::DatagramSocket & socket( std::size_t ) ;
@@ -100,6 +125,12 @@ private:
 	std::string m_question ;
 	unsigned int m_port {0U} ;
 	std::string m_error ;
+	std::string m_result ;
+	bool m_finished {false} ;
+	std::string m_key ;
+	bool m_leader {false} ;
+	std::vector<MxLookup*> m_waiters ;
+	unsigned int m_ttl {0U} ;
 	std::size_t m_ns_index ;
 	std::size_t m_ns_failures ;
 	std::vector<GNet::Address> m_nameservers ;
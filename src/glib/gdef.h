@@ -331,6 +331,13 @@
 			#define GCONFIG_HAVE_RTNETLINK 0
 		#endif
 	#endif
+	#if !defined(GCONFIG_HAVE_ACCEPT4)
+		#if defined(G_UNIX_LINUX) || defined(G_UNIX_FREEBSD) || defined(G_UNIX_NETBSD) || defined(G_UNIX_OPENBSD)
+			#define GCONFIG_HAVE_ACCEPT4 1
+		#else
+			#define GCONFIG_HAVE_ACCEPT4 0
+		#endif
+	#endif
 	#if !defined(GCONFIG_HAVE_NETROUTE)
 		#ifdef G_UNIX_BSD
 			#define GCONFIG_HAVE_NETROUTE 1
@@ -531,6 +538,13 @@
 			#define GCONFIG_HAVE_TIMERFD 0
 		#endif
 	#endif
+	#if !defined(GCONFIG_HAVE_SENDFILE)
+		#ifdef G_UNIX_LINUX
+			#define GCONFIG_HAVE_SENDFILE 1
+		#else
+			#define GCONFIG_HAVE_SENDFILE 0
+		#endif
+	#endif
 	#if !defined(GCONFIG_HAVE_PAM)
 		#ifdef G_UNIX
 			#define GCONFIG_HAVE_PAM 1
@@ -1119,6 +1133,7 @@
 		#if GCONFIG_ENABLE_STD_THREAD
 			#include <thread>
 			#include <mutex>
+			#include <condition_variable>
 			#include <cstring>
 			namespace G
 			{
@@ -1128,6 +1143,8 @@
 					using thread_type = std::thread ;
 					using mutex_type = std::mutex ;
 					using lock_type = std::lock_guard<std::mutex> ;
+					using unique_lock_type = std::unique_lock<std::mutex> ;
+					using cond_type = std::condition_variable ;
 					static bool works() ; // run-time test -- see gthread.cpp
 					static void yield() noexcept { std::this_thread::yield() ; }
 				} ;
@@ -1150,12 +1167,15 @@
 				} ;
 				class dummy_mutex {} ;
 				class dummy_lock { public: explicit dummy_lock( dummy_mutex & ) {} } ;
+				class dummy_cond { public: void wait( dummy_lock & ) {} void notify_one() noexcept {} void notify_all() noexcept {} } ;
 				struct threading
 				{
 					static constexpr bool using_std_thread = false ;
 					using thread_type = G::dummy_thread ;
 					using mutex_type = G::dummy_mutex ;
 					using lock_type = G::dummy_lock ;
+					using unique_lock_type = G::dummy_lock ;
+					using cond_type = G::dummy_cond ;
 					static bool works() ;
 					static void yield() noexcept {}
 				} ;
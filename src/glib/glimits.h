@@ -57,7 +57,17 @@ struct G::Limits<G::Scale::Normal> /// Normal specialisation of G::Limits.
 	static constexpr int file_buffer = 8192 ; // read() buffer size for file copying (BUFSIZ)
 	static constexpr int net_buffer = 20000 ; // read() buffer size for network reads (>=16k is best for TLS)
 	static constexpr int net_listen_queue = 31 ; // listen(2) backlog parameter (cf. apache 511)
+	static constexpr int net_accept_batch = 64 ; // maximum accept(2) calls per listening socket read event
 	static constexpr int net_file_limit = 200000000 ; // DoS limit reading a file from the network
+	static constexpr int net_send_queue = 1000000 ; // per-connection byte budget for queued network output
+	static constexpr int smtp_data_buffer = 65536 ; // smtp client DATA content is sent in blocks of about this size
+	static constexpr int forward_queue = 1000 ; // maximum number of spooled messages held in forwarding queues
+	static constexpr int resolver_threads = 8 ; // maximum number of getaddrinfo() worker threads
+	static constexpr int tls_threads = 4 ; // maximum number of tls handshake worker threads
+	static constexpr int resolver_cache = 1000 ; // maximum number of cached name lookups
+	static constexpr int dnsbl_cache = 5000 ; // maximum number of cached dnsbl results
+	static constexpr int mx_cache = 1000 ; // maximum number of cached mx lookups
+	static constexpr int connection_limiter_sources = 100000 ; // maximum number of source addresses tracked by a connection rate limiter
 	Limits() = delete ;
 } ;
 
@@ -70,7 +80,17 @@ struct G::Limits<G::Scale::Small> /// Small-memory specialisation of G::Limits.
 	static constexpr int file_buffer = 4096 ;
 	static constexpr int net_buffer = 4096 ;
 	static constexpr int net_listen_queue = 3 ;
+	static constexpr int net_accept_batch = 1 ;
 	static constexpr int net_file_limit = 10000000 ;
+	static constexpr int net_send_queue = 0 ;
+	static constexpr int smtp_data_buffer = 1024 ;
+	static constexpr int forward_queue = 10 ;
+	static constexpr int resolver_threads = 2 ;
+	static constexpr int tls_threads = 1 ;
+	static constexpr int resolver_cache = 10 ;
+	static constexpr int dnsbl_cache = 10 ;
+	static constexpr int mx_cache = 10 ;
+	static constexpr int connection_limiter_sources = 100 ;
 	Limits() = delete ;
 } ;
 
@@ -21,8 +21,11 @@
 #include "gdef.h"
 #include "gmsg.h"
 #include <cerrno> // EINTR etc
+#include <cstring>
+#include <vector>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h> // struct iovec
 
 ssize_t G::Msg::send( int fd , const void * buffer , std::size_t size , int flags ) noexcept
 {
@@ -36,6 +39,64 @@ ssize_t G::Msg::sendto( int fd , const void * buffer , std::size_t size , int fl
 		const_cast<sockaddr*>(address_p) , address_n ) ;
 }
 
+ssize_t G::Msg::sendto( int fd , const std::vector<std::string_view> & data , int flags ,
+	const sockaddr * address_p , socklen_t address_n )
+{
+	std::vector<::iovec> iovec_vector ;
+	iovec_vector.reserve( data.size() ) ;
+	for( std::string_view sv : data )
+	{
+		if( !sv.empty() )
+		{
+			::iovec i ;
+			i.iov_base = const_cast<char*>(sv.data()) ;
+			i.iov_len = sv.size() ;
+			iovec_vector.push_back( i ) ;
+		}
+	}
+	if( iovec_vector.empty() )
+		return 0 ;
+
+	struct ::msghdr msg {} ;
+	msg.msg_name = const_cast<sockaddr*>(address_p) ;
+	msg.msg_namelen = address_n ;
+	msg.msg_iov = iovec_vector.data() ;
+	msg.msg_iovlen = static_cast<int>( iovec_vector.size() ) ;
+	return ::sendmsg( fd , &msg , flags|MSG_NOSIGNAL ) ; // NOLINT
+}
+
+ssize_t G::Msg::sendto( int fd , const void * buffer , std::size_t size , int flags ,
+	const sockaddr * address_p , socklen_t address_n , int fd_to_send )
+{
+	if( fd_to_send == -1 )
+		return sendto( fd , buffer , size , flags , address_p , address_n ) ;
+
+	struct ::iovec io {} ;
+	io.iov_base = const_cast<void*>(buffer) ;
+	io.iov_len = size ;
+
+	struct ::msghdr msg {} ;
+	msg.msg_name = const_cast<sockaddr*>(address_p) ;
+	msg.msg_namelen = address_n ;
+	msg.msg_iov = &io ;
+	msg.msg_iovlen = 1 ;
+
+	// CMSG_SPACE() is not a compile-time constant on OSX
+	std::vector<char> control_buffer( CMSG_SPACE(sizeof(int)) ) ;
+	msg.msg_control = control_buffer.data() ;
+	msg.msg_controllen = static_cast<socklen_t>( control_buffer.size() ) ;
+
+	struct ::cmsghdr * cmsg = CMSG_FIRSTHDR( &msg ) ; /// NOLINT
+	if( cmsg != nullptr )
+	{
+		cmsg->cmsg_len = CMSG_LEN( sizeof(int) ) ;
+		cmsg->cmsg_level = SOL_SOCKET ;
+		cmsg->cmsg_type = SCM_RIGHTS ;
+		std::memcpy( CMSG_DATA(cmsg) , &fd_to_send , sizeof(int) ) ;
+	}
+	return ::sendmsg( fd , &msg , flags|MSG_NOSIGNAL ) ; // NOLINT
+}
+
 ssize_t G::Msg::recv( int fd , void * buffer , std::size_t size , int flags ) noexcept
 {
 	return ::recv( fd , buffer , size , flags ) ;
@@ -47,6 +108,40 @@ ssize_t G::Msg::recvfrom( int fd , void * buffer , std::size_t size , int flags
 	return ::recvfrom( fd , buffer , size , flags , address_p , address_np ) ;
 }
 
+ssize_t G::Msg::recvfrom( int fd , void * buffer , std::size_t size , int flags ,
+	sockaddr * address_p , socklen_t * address_np , int * fd_received_p )
+{
+	if( fd_received_p == nullptr )
+		return recvfrom( fd , buffer , size , flags , address_p , address_np ) ;
+
+	struct ::iovec io {} ;
+	io.iov_base = buffer ;
+	io.iov_len = size ;
+
+	struct ::msghdr msg {} ;
+	msg.msg_name = address_p ;
+	msg.msg_namelen = address_np == nullptr ? socklen_t(0) : *address_np ;
+	msg.msg_iov = &io ;
+	msg.msg_iovlen = 1 ;
+
+	std::vector<char> control_buffer( CMSG_SPACE(sizeof(int)) ) ;
+	msg.msg_control = control_buffer.data() ;
+	msg.msg_controllen = static_cast<socklen_t>( control_buffer.size() ) ;
+
+	ssize_t rc = ::recvmsg( fd , &msg , flags ) ;
+	int e = errno ;
+	if( rc >= 0 && msg.msg_controllen > 0U )
+	{
+		struct ::cmsghdr * cmsg = CMSG_FIRSTHDR( &msg ) ; /// NOLINT
+		if( cmsg != nullptr && cmsg->cmsg_type == SCM_RIGHTS )
+			std::memcpy( fd_received_p , CMSG_DATA(cmsg) , sizeof(int) ) ;
+	}
+	if( rc >= 0 && address_np != nullptr )
+		*address_np = msg.msg_namelen ;
+	errno = e ;
+	return rc ; // with errno
+}
+
 bool G::Msg::fatal( int error ) noexcept
 {
 	return !(
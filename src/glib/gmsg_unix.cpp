@@ -36,7 +36,7 @@ namespace G
 	namespace MsgImp
 	{
 		template <typename Tin, typename Tout, typename Fn1, typename Fn2>
-		std::size_t copy( Tin in , Tout out , Fn1 fn_convert , Fn2 fn_empty )
+		std::size_t copy( const Tin & in , Tout & out , Fn1 fn_convert , Fn2 fn_empty )
 		{
 			return std::distance( out.begin() ,
 				std::remove_if( out.begin() , std::transform( in.begin() , in.end() , out.begin() , fn_convert ) , fn_empty ) ) ;
@@ -88,7 +88,6 @@ ssize_t G::Msg::sendto( int fd , const std::vector<std::string_view> & data , in
 	}
 }
 
-#ifndef G_LIB_SMALL
 ssize_t G::Msg::sendto( int fd , const void * buffer , std::size_t size , int flags ,
 	const sockaddr * address_p , socklen_t address_n , int fd_to_send )
 {
@@ -104,7 +103,6 @@ ssize_t G::Msg::sendto( int fd , const void * buffer , std::size_t size , int fl
 		return MsgImp::sendmsg( fd , &io , 1U , flags , address_p , address_n , fd_to_send ) ;
 	}
 }
-#endif
 
 ssize_t G::MsgImp::sendmsg( int fd , const ::iovec * iovec_p , std::size_t iovec_n , int flags ,
 	const sockaddr * address_p , socklen_t address_n , int fd_to_send ) noexcept
@@ -121,18 +119,21 @@ ssize_t G::MsgImp::sendmsg( int fd , const ::iovec * iovec_p , std::size_t iovec
 	constexpr std::size_t space = CMSG_SPACE( sizeof(int) ) ;
 	static_assert( space != 0U , "" ) ;
 	std::array<char,space> control_buffer {} ;
-	std::memset( control_buffer.data() , 0 , control_buffer.size() ) ;
-	msg.msg_control = control_buffer.data() ;
-	msg.msg_controllen = control_buffer.size() ;
-
-	struct ::cmsghdr * cmsg = CMSG_FIRSTHDR( &msg ) ; /// NOLINT
-	G_ASSERT( cmsg != nullptr ) ;
-	if( cmsg != nullptr )
+	if( fd_to_send != -1 )
 	{
-		cmsg->cmsg_len = CMSG_LEN( sizeof(int) ) ;
-		cmsg->cmsg_level = SOL_SOCKET ;
-		cmsg->cmsg_type = SCM_RIGHTS ;
-		std::memcpy( CMSG_DATA(cmsg) , &fd_to_send , sizeof(int) ) ;
+		std::memset( control_buffer.data() , 0 , control_buffer.size() ) ;
+		msg.msg_control = control_buffer.data() ;
+		msg.msg_controllen = control_buffer.size() ;
+
+		struct ::cmsghdr * cmsg = CMSG_FIRSTHDR( &msg ) ; /// NOLINT
+		G_ASSERT( cmsg != nullptr ) ;
+		if( cmsg != nullptr )
+		{
+			cmsg->cmsg_len = CMSG_LEN( sizeof(int) ) ;
+			cmsg->cmsg_level = SOL_SOCKET ;
+			cmsg->cmsg_type = SCM_RIGHTS ;
+			std::memcpy( CMSG_DATA(cmsg) , &fd_to_send , sizeof(int) ) ;
+		}
 	}
 
 	return ::sendmsg( fd , &msg , flags | MSG_NOSIGNAL ) ; // NOLINT
@@ -149,7 +150,6 @@ ssize_t G::Msg::recvfrom( int fd , void * buffer , std::size_t size , int flags
 	return ::recvfrom( fd , buffer , size , flags , address_p , address_np ) ;
 }
 
-#ifndef G_LIB_SMALL
 ssize_t G::Msg::recvfrom( int fd , void * buffer , std::size_t size , int flags ,
 	sockaddr * address_p , socklen_t * address_np , int * fd_received_p )
 {
@@ -188,7 +188,6 @@ ssize_t G::Msg::recvfrom( int fd , void * buffer , std::size_t size , int flags
 	Process::errno_( SignalSafe() , e ) ;
 	return rc ; // with errno
 }
-#endif
 
 #ifndef G_LIB_SMALL
 bool G::Msg::fatal( int error ) noexcept
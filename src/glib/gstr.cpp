@@ -631,7 +631,6 @@ unsigned int G::Str::toUInt( std::string_view s , unsigned int default_ ) noexce
 	return !s.empty() && isUInt(s) ? StrImp::toUInt(s,overflow,invalid) : default_ ;
 }
 
-#ifndef G_LIB_SMALL
 unsigned int G::Str::toUInt( std::string_view s , Limited )
 {
 	bool overflow = false ;
@@ -643,7 +642,6 @@ unsigned int G::Str::toUInt( std::string_view s , Limited )
 		result = std::numeric_limits<unsigned int>::max() ;
 	return result ;
 }
-#endif
 
 unsigned int G::Str::toUInt( std::string_view s )
 {
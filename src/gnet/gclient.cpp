@@ -31,9 +31,53 @@
 #include "gtest.h"
 #include "glog.h"
 #include <numeric>
+#include <algorithm>
 #include <sstream>
 #include <cstdlib>
 
+//| \class GNet::ClientAttempt
+/// A private implementation class used by GNet::Client for each of the
+/// later connection attempts when racing connections to several
+/// addresses. The socket's write and other events are passed back
+/// to the Client.
+///
+class GNet::ClientAttempt : private EventHandler
+{
+public:
+	ClientAttempt( Client & , EventState , const Address & , const Client::Config & ) ;
+		// Constructor. Starts connecting.
+
+	bool failed() const ;
+		// Returns true if the connect failed immediately.
+
+	std::string reason() const ;
+		// Returns the reason for an immediate failure.
+
+	Address address() const ;
+		// Returns the remote address.
+
+	std::unique_ptr<StreamSocket> release() ;
+		// Drops the event handlers and releases the socket.
+
+private: // overrides
+	void writeEvent() override ; // GNet::EventHandler
+	void otherEvent( EventHandler::Reason ) override ; // GNet::EventHandler
+
+public:
+	ClientAttempt( const ClientAttempt & ) = delete ;
+	ClientAttempt( ClientAttempt && ) = delete ;
+	ClientAttempt & operator=( const ClientAttempt & ) = delete ;
+	ClientAttempt & operator=( ClientAttempt && ) = delete ;
+
+private:
+	Client & m_client ;
+	Address m_address ;
+	std::unique_ptr<StreamSocket> m_socket ;
+	bool m_failed {false} ;
+} ;
+
+// ==
+
 GNet::Client::Client( EventState es , const Location & remote , const Config & config ) :
 	m_es(es) ,
 	m_config(config) ,
@@ -41,6 +85,7 @@ GNet::Client::Client( EventState es , const Location & remote , const Config & c
 	m_remote_location(remote) ,
 	m_start_timer(*this,&GNet::Client::onStartTimeout,es) ,
 	m_connect_timer(*this,&GNet::Client::onConnectTimeout,es) ,
+	m_race_timer(*this,&GNet::Client::onRaceTimeout,es) ,
 	m_connected_timer(*this,&GNet::Client::onConnectedTimeout,es) ,
 	m_response_timer(*this,&GNet::Client::onResponseTimeout,es) ,
 	m_idle_timer(*this,&GNet::Client::onIdleTimeout,es)
@@ -63,6 +108,7 @@ void GNet::Client::disconnect()
 
 	m_start_timer.cancelTimer() ;
 	m_connect_timer.cancelTimer() ;
+	m_race_timer.cancelTimer() ;
 	m_connected_timer.cancelTimer() ;
 	m_response_timer.cancelTimer() ;
 	m_idle_timer.cancelTimer() ;
@@ -70,6 +116,7 @@ void GNet::Client::disconnect()
 	m_state = State::Disconnected ;
 	m_finished = true ;
 
+	m_attempts.clear() ;
 	m_sp.reset() ;
 	m_socket.reset() ;
 	m_resolver.reset() ;
@@ -129,7 +176,8 @@ void GNet::Client::connect()
 		setState( State::Connecting ) ;
 		startConnecting() ;
 	}
-	else if( m_config.sync_dns || !Resolver::async() )
+	else if( m_config.sync_dns || ( !Resolver::async() &&
+		!Resolver::native(m_remote_location,Resolver::Config().set_native(m_config.native_dns)) ) )
 	{
 		std::string error = Resolver::resolve( m_remote_location ) ;
 		if( !error.empty() )
@@ -146,7 +194,7 @@ void GNet::Client::connect()
 			Resolver::Callback & resolver_callback = *this ;
 			m_resolver = std::make_unique<Resolver>( resolver_callback , m_es ) ;
 		}
-		m_resolver->start( m_remote_location ) ;
+		m_resolver->start( m_remote_location , Resolver::Config().set_native(m_config.native_dns) ) ;
 		emit( "resolving" ) ;
 	}
 }
@@ -157,7 +205,7 @@ void GNet::Client::onResolved( std::string error , Location location )
 		throw DnsError( error ) ;
 
 	G_DEBUG( "GNet::Client::onResolved: " << location.displayString() ) ;
-	m_remote_location.update( location.address() ) ;
+	m_remote_location.update( location.address() , location.addresses() ) ;
 	setState( State::Connecting ) ;
 	startConnecting() ;
 }
@@ -169,6 +217,14 @@ void GNet::Client::startConnecting()
 	if( G::Test::enabled("client-slow-connect") )
 		setState( State::Testing ) ;
 
+	// get ready to race connections to any other addresses
+	//
+	m_attempts.clear() ;
+	m_race_list = raceList() ;
+	m_connect_error.clear() ;
+	if( !m_race_list.empty() )
+		m_race_timer.startTimer( m_config.connection_race_delay_ms/1000U , (m_config.connection_race_delay_ms%1000U)*1000U ) ;
+
 	// create and open a socket
 	//
 	m_sp.reset() ;
@@ -191,7 +247,10 @@ void GNet::Client::startConnecting()
 	//
 	bool immediate = false ;
 	if( !socket().connect( m_remote_location.address() , &immediate ) )
-		throw ConnectError( "cannot connect to " + m_remote_location.address().displayString() + ": " + socket().reason() ) ;
+	{
+		onConnectFailure( "cannot connect to " + m_remote_location.address().displayString() + ": " + socket().reason() ) ;
+		return ;
+	}
 
 	// deal with immediate connection (typically if connecting locally)
 	//
@@ -244,6 +303,8 @@ void GNet::Client::onConnectTimeout()
 {
 	std::ostringstream ss ;
 	ss << "cannot connect to " << m_remote_location << ": timed out out after " << m_config.connection_timeout << "s" ;
+	if( !m_connect_error.empty() )
+		ss << " (" << m_connect_error << ")" ;
 	G_DEBUG( "GNet::Client::onConnectTimeout: " << ss.str() ) ;
 	throw ConnectError( ss.str() ) ;
 }
@@ -263,6 +324,134 @@ void GNet::Client::onIdleTimeout()
 	throw IdleTimeout( ss.str() ) ;
 }
 
+std::vector<GNet::Address> GNet::Client::raceList() const
+{
+	// returns the other addresses in the order that connections
+	// should be attempted, alternating between address families
+	// -- see RFC 8305 section 4
+	std::vector<Address> result ;
+	if( m_config.connection_race_delay_ms == 0U || m_state != State::Connecting )
+		return result ;
+
+	Address first = m_remote_location.address() ;
+	std::vector<Address> same ;
+	std::vector<Address> other ;
+	for( const auto & address : m_remote_location.addresses() )
+	{
+		if( address == first )
+			continue ;
+		if( m_config.bind_local_address && address.family() != m_config.local_address.family() )
+			continue ;
+		( address.family() == first.family() ? same : other ).push_back( address ) ;
+	}
+	for( std::size_t i = 0U ; i < std::max(same.size(),other.size()) ; i++ )
+	{
+		if( i < other.size() ) result.push_back( other[i] ) ;
+		if( i < same.size() ) result.push_back( same[i] ) ;
+	}
+	return result ;
+}
+
+bool GNet::Client::racing() const
+{
+	return !m_race_list.empty() || !m_attempts.empty() ;
+}
+
+void GNet::Client::stopRacing()
+{
+	m_race_timer.cancelTimer() ;
+	m_race_list.clear() ;
+	m_attempts.clear() ;
+}
+
+void GNet::Client::onRaceTimeout()
+{
+	// start the next connection attempt, or more than one if they fail immediately
+	while( !m_race_list.empty() )
+	{
+		Address address = m_race_list.front() ;
+		m_race_list.erase( m_race_list.begin() ) ;
+		G_DEBUG( "GNet::Client::onRaceTimeout: also connecting to " << address.displayString() ) ;
+		try
+		{
+			m_attempts.push_back( std::make_unique<ClientAttempt>( *this , m_es , address , m_config ) ) ;
+			if( !m_attempts.back()->failed() )
+				break ;
+			addConnectError( "cannot connect to " + address.displayString() , m_attempts.back()->reason() ) ;
+			m_attempts.pop_back() ;
+		}
+		catch( std::exception & e )
+		{
+			addConnectError( "cannot connect to " + address.displayString() , e.what() ) ;
+		}
+	}
+
+	if( !m_race_list.empty() )
+		m_race_timer.startTimer( m_config.connection_race_delay_ms/1000U , (m_config.connection_race_delay_ms%1000U)*1000U ) ;
+	else if( m_attempts.empty() && m_socket == nullptr )
+		throw ConnectError( m_connect_error ) ;
+}
+
+void GNet::Client::addConnectError( const std::string & error , const std::string & reason )
+{
+	// accumulate the errors from all the racing connection attempts
+	if( !m_connect_error.empty() )
+		m_connect_error.append( "; " ) ;
+	m_connect_error.append( error ) ;
+	if( !reason.empty() )
+		m_connect_error.append(": ").append( reason ) ;
+}
+
+void GNet::Client::onConnectFailure( const std::string & reason )
+{
+	addConnectError( reason ) ;
+	if( !racing() )
+		throw ConnectError( m_connect_error ) ;
+
+	// abandon this socket but keep racing
+	G_DEBUG( "GNet::Client::onConnectFailure: " << reason ) ;
+	m_sp.reset() ;
+	m_socket.reset() ;
+	if( !m_race_list.empty() )
+		m_race_timer.startTimer( 0U ) ;
+}
+
+void GNet::Client::onAttempt( ClientAttempt * attempt , bool connected )
+{
+	auto p = std::find_if( m_attempts.begin() , m_attempts.end() ,
+		[attempt](const std::unique_ptr<ClientAttempt> & ptr){ return ptr.get() == attempt ; } ) ;
+	G_ASSERT( p != m_attempts.end() ) ;
+	if( p == m_attempts.end() )
+		return ;
+
+	if( connected )
+	{
+		// the race is won, so take over the socket and carry on as if
+		// it was an immediate connection
+		Address address = attempt->address() ;
+		G_DEBUG( "GNet::Client::onAttempt: connected to " << address.displayString() ) ;
+		std::unique_ptr<StreamSocket> new_socket = attempt->release() ;
+		stopRacing() ; // deletes the attempt
+		m_sp.reset() ;
+		m_socket = std::move( new_socket ) ;
+		m_remote_location.select( address ) ;
+		socket().addOtherHandler( *this , m_es ) ;
+		EventHandler & eh = *this ;
+		SocketProtocolSink & sp_sink = *this ;
+		m_sp = std::make_unique<SocketProtocol>( eh , m_es , sp_sink , *m_socket , m_config.socket_protocol_config ) ;
+		m_connected_timer.startTimer( 0U ) ; // -> onConnectedTimeout()
+	}
+	else
+	{
+		addConnectError( "cannot connect to " + attempt->address().displayString() ) ;
+		m_attempts.erase( p ) ; // deletes the attempt
+		if( !m_race_list.empty() )
+			m_race_timer.startTimer( 0U ) ;
+		else if( m_attempts.empty() && m_socket == nullptr )
+			throw ConnectError( m_connect_error ) ;
+	}
+}
+
 void GNet::Client::onConnectedTimeout()
 {
 	G_DEBUG( "GNet::Client::onConnectedTimeout: immediate connection" ) ;
@@ -291,6 +480,7 @@ void GNet::Client::onWriteable()
 	}
 	else if( m_state == State::Connecting && has_peer && m_remote_location.socks() )
 	{
+		stopRacing() ;
 		setState( State::Socksing ) ;
 		m_socks = std::make_unique<Socks>( m_remote_location ) ;
 		if( m_socks->send( socket() ) )
@@ -306,6 +496,7 @@ void GNet::Client::onWriteable()
 	}
 	else if( m_state == State::Connecting && has_peer )
 	{
+		stopRacing() ;
 		socket().dropWriteHandler() ;
 		socket().addReadHandler( *this , m_es ) ;
 
@@ -315,7 +506,7 @@ void GNet::Client::onWriteable()
 	else if( m_state == State::Connecting )
 	{
 		socket().dropWriteHandler() ;
-		throw ConnectError( "cannot connect to " + m_remote_location.address().displayString() ) ;
+		onConnectFailure( "cannot connect to " + m_remote_location.address().displayString() ) ;
 	}
 	else if( m_state == State::Socksing )
 	{
@@ -347,6 +538,8 @@ void GNet::Client::otherEvent( EventHandler::Reason reason )
 {
 	if( m_state == State::Socksing || m_sp == nullptr )
 		EventHandler::otherEvent( reason ) ; // default implementation throws
+	else if( m_state == State::Connecting && racing() )
+		onConnectFailure( "cannot connect to " + m_remote_location.address().displayString() ) ;
 	else
 		m_sp->otherEvent( reason , m_config.no_throw_on_peer_disconnect ) ;
 }
@@ -371,6 +564,11 @@ void GNet::Client::readEvent()
 	}
 }
 
+const char * GNet::Client::statsName() const noexcept
+{
+	return "GNet::Client" ;
+}
+
 void GNet::Client::onData( const char * data , std::size_t size )
 {
 	if( m_config.response_timeout && m_line_buffer.transparent() ) // anything will do if transparent
@@ -477,7 +675,13 @@ void GNet::Client::secureConnect()
 {
 	if( m_sp == nullptr )
 		throw NotConnected( "for secure-connect" ) ;
-	m_sp->secureConnect() ;
+
+	// key any saved tls session by the next-hop server, which is
+	// the far server when using socks
+	std::string session_key = m_remote_location.socks() ?
+		m_remote_location.socksFarHost().append(1U,':').append(std::to_string(m_remote_location.socksFarPort())) :
+		m_remote_location.address().displayString() ;
+	m_sp->secureConnect( session_key ) ;
 }
 
 bool GNet::Client::send( const std::string & data )
@@ -494,6 +698,18 @@ bool GNet::Client::send( std::string_view data )
 	return m_sp->send( data ) ;
 }
 
+bool GNet::Client::sendFile( std::string_view head , int fd , std::size_t offset , std::size_t size )
+{
+	if( m_config.response_timeout )
+		m_response_timer.startTimer( m_config.response_timeout ) ;
+	return m_sp->sendFile( head , fd , offset , size ) ;
+}
+
+bool GNet::Client::sendFileZeroCopy() const
+{
+	return m_sp && m_sp->sendFileZeroCopy() ;
+}
+
 #ifndef G_LIB_SMALL
 bool GNet::Client::send( const std::vector<std::string_view> & data , std::size_t offset )
 {
@@ -529,3 +745,58 @@ GNet::Client::Config & GNet::Client::Config::set_all_timeouts( unsigned int all_
 }
 #endif
 
+// ==
+
+GNet::ClientAttempt::ClientAttempt( Client & client , EventState es , const Address & address ,
+	const Client::Config & config ) :
+		m_client(client) ,
+		m_address(address) ,
+		m_socket(std::make_unique<StreamSocket>(address.family(),config.stream_socket_config))
+{
+	if( config.bind_local_address )
+	{
+		G::Root claim_root ;
+		m_socket->bind( config.local_address ) ;
+	}
+	m_failed = !m_socket->connect( address ) ;
+	if( !m_failed )
+	{
+		m_socket->addWriteHandler( *this , es ) ;
+		m_socket->addOtherHandler( *this , es ) ;
+	}
+}
+
+bool GNet::ClientAttempt::failed() const
+{
+	return m_failed ;
+}
+
+std::string GNet::ClientAttempt::reason() const
+{
+	return m_failed ? m_socket->reason() : std::string() ;
+}
+
+GNet::Address GNet::ClientAttempt::address() const
+{
+	return m_address ;
+}
+
+std::unique_ptr<GNet::StreamSocket> GNet::ClientAttempt::release()
+{
+	m_socket->dropWriteHandler() ;
+	m_socket->dropOtherHandler() ;
+	return std::move( m_socket ) ;
+}
+
+void GNet::ClientAttempt::writeEvent()
+{
+	m_socket->dropWriteHandler() ;
+	m_client.onAttempt( this , m_socket->getPeerAddress().first ) ; // last -- may delete this
+}
+
+void GNet::ClientAttempt::otherEvent( EventHandler::Reason )
+{
+	m_socket->dropOtherHandler() ;
+	m_client.onAttempt( this , false ) ; // last -- may delete this
+}
+
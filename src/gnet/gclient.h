@@ -42,10 +42,12 @@
 #include "gstr.h"
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace GNet
 {
 	class Client ;
+	class ClientAttempt ;
 }
 
 //| \class GNet::Client
@@ -63,6 +65,13 @@ namespace GNet
 /// method and possibly fed back to the next Client that connects to the
 /// same host/service in order to implement name lookup cacheing.
 ///
+/// If name lookup gives more than one address then connections are
+/// raced, as in RFC 8305 ("Happy Eyeballs"). The first address is
+/// tried immediately, and the others, alternating between address
+/// families, follow at short intervals or as soon as an earlier
+/// attempt fails. The first connection to succeed is used and the
+/// others are abandoned.
+///
 /// Received data is delivered through a virtual method onReceive(), with
 /// optional line-buffering.
 ///
@@ -90,9 +99,11 @@ public:
 		SocketProtocol::Config socket_protocol_config ; // inc. secure_connection_timeout
 		Address local_address {Address::defaultAddress()} ;
 		bool sync_dns {false} ;
+		bool native_dns {false} ; // see GNet::Resolver::Config::native
 		bool auto_start {true} ;
 		bool bind_local_address {false} ;
 		unsigned int connection_timeout {0U} ;
+		unsigned int connection_race_delay_ms {250U} ; // zero to connect to one address only
 		unsigned int response_timeout {0U} ;
 		unsigned int idle_timeout {0U} ;
 		bool no_throw_on_peer_disconnect {false} ; // call SocketProtocolSink::onPeerDisconnect() instead
@@ -101,10 +112,12 @@ public:
 		Config & set_line_buffer_config( const LineBuffer::Config & ) ;
 		Config & set_socket_protocol_config( const SocketProtocol::Config & ) ;
 		Config & set_sync_dns( bool = true ) noexcept ;
+		Config & set_native_dns( bool = true ) noexcept ;
 		Config & set_auto_start( bool = true ) noexcept ;
 		Config & set_bind_local_address( bool = true ) noexcept ;
 		Config & set_local_address( const Address & ) ;
 		Config & set_connection_timeout( unsigned int ) noexcept ;
+		Config & set_connection_race_delay_ms( unsigned int ) noexcept ;
 		Config & set_response_timeout( unsigned int ) noexcept ;
 		Config & set_idle_timeout( unsigned int ) noexcept ;
 		Config & set_all_timeouts( unsigned int ) noexcept ;
@@ -175,6 +188,18 @@ public:
 	bool send( const std::vector<std::string_view> & data , std::size_t offset = 0 ) ;
 		///< Overload for scatter/gather segments.
 
+	bool sendFile( std::string_view head , int fd , std::size_t offset , std::size_t size ) ;
+		///< Sends the head data followed by part of an open file,
+		///< if possible without copying the file data through user
+		///< space. The file descriptor must stay open until
+		///< onSendComplete().
+		///< \see GNet::SocketProtocol::sendFile()
+
+	bool sendFileZeroCopy() const ;
+		///< Returns true if sendFile() would not copy the file data
+		///< through user space.
+		///< \see GNet::SocketProtocol::sendFileZeroCopy()
+
 	G::Slot::Signal<const std::string&,const std::string&,const std::string&> & eventSignal() noexcept ;
 		///< Returns a signal that indicates that something interesting
 		///< has happened. The first signal parameter is one of
@@ -253,10 +278,13 @@ protected:
 		///< Starts TLS/SSL client-side negotiation. Uses a profile
 		///< called "client" by default; see GSsl::Library::addProfile().
 		///< The callback GNet::SocketProtocolSink::onSecure() is
-		///< triggered when the secure session is established.
+		///< triggered when the secure session is established. A TLS
+		///< session from an earlier connection to the same server is
+		///< offered for resumption if the profile has a session cache.
 
 private: // overrides
 	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
 	void writeEvent() override ; // GNet::EventHandler
 	void otherEvent( EventHandler::Reason ) override ; // GNet::EventHandler
 	void onResolved( std::string , Location ) override ; // GNet::Resolver
@@ -295,6 +323,14 @@ private:
 	void onIdleTimeout() ;
 	void onWriteable() ;
 	void doOnConnect() ;
+	friend class GNet::ClientAttempt ;
+	std::vector<Address> raceList() const ;
+	bool racing() const ;
+	void stopRacing() ;
+	void onRaceTimeout() ;
+	void onConnectFailure( const std::string & ) ;
+	void addConnectError( const std::string & , const std::string & = {} ) ;
+	void onAttempt( ClientAttempt * , bool ) ;
 
 private:
 	EventState m_es ;
@@ -303,6 +339,9 @@ private:
 	std::unique_ptr<StreamSocket> m_socket ;
 	std::unique_ptr<SocketProtocol> m_sp ;
 	std::unique_ptr<Socks> m_socks ;
+	std::vector<Address> m_race_list ;
+	std::vector<std::unique_ptr<ClientAttempt>> m_attempts ;
+	std::string m_connect_error ;
 	LineBuffer m_line_buffer ;
 	std::unique_ptr<Resolver> m_resolver ;
 	Location m_remote_location ;
@@ -311,6 +350,7 @@ private:
 	bool m_has_connected {false} ;
 	Timer<Client> m_start_timer ;
 	Timer<Client> m_connect_timer ;
+	Timer<Client> m_race_timer ;
 	Timer<Client> m_connected_timer ;
 	Timer<Client> m_response_timer ;
 	Timer<Client> m_idle_timer ;
@@ -322,10 +362,12 @@ inline GNet::Client::Config & GNet::Client::Config::set_stream_socket_config( co
 inline GNet::Client::Config & GNet::Client::Config::set_line_buffer_config( const LineBuffer::Config & cfg ) { line_buffer_config = cfg ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_socket_protocol_config( const SocketProtocol::Config & cfg ) { socket_protocol_config = cfg ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_sync_dns( bool b ) noexcept { sync_dns = b ; return *this ; }
+inline GNet::Client::Config & GNet::Client::Config::set_native_dns( bool b ) noexcept { native_dns = b ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_auto_start( bool b ) noexcept { auto_start = b ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_bind_local_address( bool b ) noexcept { bind_local_address = b ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_local_address( const Address & a ) { local_address = a ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_connection_timeout( unsigned int t ) noexcept { connection_timeout = t ; return *this ; }
+inline GNet::Client::Config & GNet::Client::Config::set_connection_race_delay_ms( unsigned int t ) noexcept { connection_race_delay_ms = t ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_response_timeout( unsigned int t ) noexcept { response_timeout = t ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_idle_timeout( unsigned int t ) noexcept { idle_timeout = t ; return *this ; }
 inline GNet::Client::Config & GNet::Client::Config::set_no_throw_on_peer_disconnect( bool b ) noexcept { no_throw_on_peer_disconnect = b ; return *this ; }
@@ -0,0 +1,251 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gconnectionlimiter.cpp
+///
+
+#include "gdef.h"
+#include "gconnectionlimiter.h"
+#include "glimits.h"
+#include "gmetrics.h"
+#include "glog.h"
+#include <algorithm>
+#include <cstring>
+
+namespace GNet
+{
+	namespace ConnectionLimiterImp
+	{
+		struct Stats
+		{
+			unsigned long admitted {0UL} ;
+			unsigned long refused {0UL} ;
+			unsigned long evicted {0UL} ;
+			unsigned long tracked {0UL} ; // current table size, summed over limiters
+			unsigned int limiters {0U} ;
+			Metrics::Counter metric_refused {"emailrelay_connections_refused_total","Incoming connections refused by the connection rate limiter"} ;
+		} ;
+		Stats & stats()
+		{
+			static Stats s ;
+			return s ;
+		}
+		void mask( unsigned char * p , std::size_t n , unsigned int bits )
+		{
+			for( std::size_t i = 0U ; i < n ; i++ , bits = bits > 8U ? (bits-8U) : 0U )
+			{
+				if( bits < 8U )
+					p[i] &= static_cast<unsigned char>( 0xffU << (8U-bits) ) ;
+			}
+		}
+		constexpr unsigned int max_sweep_interval = 60U ; // seconds
+	}
+}
+
+GNet::ConnectionLimiter::ConnectionLimiter( EventState es , const Config & config ) :
+	m_config(config) ,
+	m_rate(0.0) ,
+	m_timer(*this,&ConnectionLimiter::onTimeout,es)
+{
+	if( enabled() )
+	{
+		m_config.interval = std::max( 1U , m_config.interval ) ;
+		m_config.ipv4_bits = std::min( 32U , m_config.ipv4_bits ) ;
+		m_config.ipv6_bits = std::min( 128U , m_config.ipv6_bits ) ;
+		m_rate = static_cast<double>(m_config.count) / static_cast<double>(m_config.interval) ;
+		ConnectionLimiterImp::stats().limiters++ ;
+		m_timer.startTimer( std::min(m_config.interval,ConnectionLimiterImp::max_sweep_interval) ) ;
+	}
+}
+
+GNet::ConnectionLimiter::~ConnectionLimiter()
+{
+	if( enabled() )
+	{
+		ConnectionLimiterImp::Stats & stats = ConnectionLimiterImp::stats() ;
+		stats.limiters-- ;
+		stats.tracked -= std::min( stats.tracked , static_cast<unsigned long>(m_map.size()) ) ;
+	}
+}
+
+bool GNet::ConnectionLimiter::enabled() const noexcept
+{
+	return m_config.count != 0U ;
+}
+
+const std::string & GNet::ConnectionLimiter::response() const noexcept
+{
+	return m_config.response ;
+}
+
+bool GNet::ConnectionLimiter::admit( const Address & address )
+{
+	namespace imp = ConnectionLimiterImp ;
+	Key k {} ;
+	if( !enabled() || !key(address,k) )
+		return true ;
+
+	imp::Stats & stats = imp::stats() ;
+	G::TimerTime now = G::TimerTime::now() ;
+	auto p = m_map.find( k ) ;
+	if( p == m_map.end() )
+	{
+		if( m_map.size() >= static_cast<std::size_t>(G::Limits<>::connection_limiter_sources) )
+		{
+			// evict the least-recently-used source to make room
+			m_map.erase( m_lru.back() ) ;
+			m_lru.pop_back() ;
+			stats.evicted++ ;
+			stats.tracked-- ;
+		}
+		m_lru.push_front( k ) ;
+		p = m_map.insert( {k,Bucket{static_cast<double>(m_config.count),now,m_lru.begin()}} ).first ;
+		stats.tracked++ ;
+	}
+	else
+	{
+		refill( p->second , now ) ;
+		m_lru.splice( m_lru.begin() , m_lru , p->second.lru ) ;
+	}
+
+	if( p->second.tokens < 1.0 )
+	{
+		stats.refused++ ;
+		stats.metric_refused.add() ;
+		logRefusal( address ) ;
+		return false ;
+	}
+	p->second.tokens -= 1.0 ;
+	stats.admitted++ ;
+	return true ;
+}
+
+bool GNet::ConnectionLimiter::key( const Address & address , Key & k ) const
+{
+	// keyed on the masked address bytes, treating ipv4-mapped
+	// ipv6 addresses as ipv4
+	if( address.is4() )
+	{
+		sockaddr_in sa {} ;
+		std::memcpy( &sa , address.address() , std::min(sizeof(sa),static_cast<std::size_t>(address.length())) ) ;
+		k[0] = 4U ;
+		std::memcpy( &k[1] , &sa.sin_addr , 4U ) ;
+		ConnectionLimiterImp::mask( &k[1] , 4U , m_config.ipv4_bits ) ;
+		return true ;
+	}
+	else if( address.is6() )
+	{
+		sockaddr_in6 sa {} ;
+		std::memcpy( &sa , address.address() , std::min(sizeof(sa),static_cast<std::size_t>(address.length())) ) ;
+		const unsigned char * a = reinterpret_cast<const unsigned char*>( &sa.sin6_addr ) ;
+		static constexpr unsigned char mapped[] = { 0,0,0,0,0,0,0,0,0,0,0xff,0xff } ;
+		if( std::memcmp( a , mapped , sizeof(mapped) ) == 0 )
+		{
+			k[0] = 4U ;
+			std::memcpy( &k[1] , a+12 , 4U ) ;
+			ConnectionLimiterImp::mask( &k[1] , 4U , m_config.ipv4_bits ) ;
+		}
+		else
+		{
+			k[0] = 6U ;
+			std::memcpy( &k[1] , a , 16U ) ;
+			ConnectionLimiterImp::mask( &k[1] , 16U , m_config.ipv6_bits ) ;
+		}
+		return true ;
+	}
+	else
+	{
+		return false ;
+	}
+}
+
+std::size_t GNet::ConnectionLimiter::KeyHash::operator()( const Key & k ) const noexcept
+{
+	// fnv-1a
+	std::size_t h = 2166136261U ;
+	for( unsigned char c : k )
+	{
+		h ^= c ;
+		h *= 16777619U ;
+	}
+	return h ;
+}
+
+void GNet::ConnectionLimiter::refill( Bucket & bucket , const G::TimerTime & now ) const
+{
+	G::TimeInterval elapsed = bucket.time.interval( now ) ;
+	double dt = static_cast<double>(elapsed.s()) + static_cast<double>(elapsed.us()) / 1000000.0 ;
+	bucket.tokens = std::min( static_cast<double>(m_config.count) , bucket.tokens + dt * m_rate ) ;
+	bucket.time = now ;
+}
+
+void GNet::ConnectionLimiter::onTimeout()
+{
+	// discard buckets that have refilled completely since they
+	// are indistinguishable from new ones
+	G::TimerTime now = G::TimerTime::now() ;
+	std::size_t old_size = m_map.size() ;
+	for( auto p = m_map.begin() ; p != m_map.end() ; )
+	{
+		refill( p->second , now ) ;
+		if( p->second.tokens >= static_cast<double>(m_config.count) )
+		{
+			m_lru.erase( p->second.lru ) ;
+			p = m_map.erase( p ) ;
+		}
+		else
+		{
+			++p ;
+		}
+	}
+	ConnectionLimiterImp::stats().tracked -= static_cast<unsigned long>( old_size - m_map.size() ) ;
+	if( old_size != m_map.size() )
+	{
+		G_DEBUG( "GNet::ConnectionLimiter::onTimeout: tracking " << m_map.size() << " source(s)" ) ;
+	}
+	if( m_refused_unlogged > 1UL )
+	{
+		G_LOG( "GNet::ConnectionLimiter::onTimeout: connection rate limit exceeded: refused "
+			<< (m_refused_unlogged-1UL) << " more connection(s)" ) ;
+	}
+	m_refused_unlogged = 0UL ;
+	m_timer.startTimer( std::min(m_config.interval,ConnectionLimiterImp::max_sweep_interval) ) ;
+}
+
+void GNet::ConnectionLimiter::logRefusal( const Address & address )
+{
+	// log the first refusal since the last timer tick and
+	// summarise the rest in onTimeout()
+	if( m_refused_unlogged++ == 0UL )
+	{
+		G_LOG( "GNet::ConnectionLimiter::admit: connection rate limit exceeded: refusing connection from "
+			<< address.hostPartString() ) ;
+	}
+}
+
+void GNet::ConnectionLimiter::report( std::ostream & s , const std::string & px , const std::string & eol )
+{
+	using G::txt ;
+	const ConnectionLimiterImp::Stats & stats = ConnectionLimiterImp::stats() ;
+	if( stats.limiters == 0U && (stats.admitted+stats.refused) == 0UL )
+		return ;
+	s << px << txt("Connection limiter admitted: ") << stats.admitted << eol ;
+	s << px << txt("Connection limiter refused: ") << stats.refused << eol ;
+	s << px << txt("Connection limiter sources: ") << stats.tracked << eol ;
+	if( stats.evicted )
+		s << px << txt("Connection limiter evicted: ") << stats.evicted << eol ;
+}
@@ -0,0 +1,143 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gconnectionlimiter.h
+///
+
+#ifndef G_NET_CONNECTION_LIMITER_H
+#define G_NET_CONNECTION_LIMITER_H
+
+#include "gdef.h"
+#include "gaddress.h"
+#include "gdatetime.h"
+#include "geventstate.h"
+#include "gtimer.h"
+#include <array>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <iostream>
+
+namespace GNet
+{
+	class ConnectionLimiter ;
+}
+
+//| \class GNet::ConnectionLimiter
+/// A token-bucket rate limiter for incoming connections, keyed
+/// by source address prefix. Each source prefix has a bucket
+/// holding up to 'count' tokens that refills at 'count' tokens
+/// per 'interval'. Each admitted connection takes a token and
+/// connections are refused when the bucket is empty.
+///
+/// Buckets are refilled lazily when a connection arrives and a
+/// periodic timer discards buckets that have become full again,
+/// so the table only holds recently-active sources. The table
+/// size is bounded by G::Limits::connection_limiter_sources;
+/// once it is full the least-recently-used bucket is evicted
+/// to make room for a new source.
+///
+/// Refusals are logged when the first one occurs and then as
+/// a count on each timer tick, so a connection flood does not
+/// flood the log.
+///
+/// Unix-domain connections are always admitted.
+///
+/// \see GNet::Server
+///
+class GNet::ConnectionLimiter
+{
+public:
+	struct Config /// A configuration structure for GNet::ConnectionLimiter.
+	{
+		unsigned int count {0U} ; // connections per interval, zero to disable
+		unsigned int interval {60U} ; // seconds
+		unsigned int ipv4_bits {32U} ; // ipv4 prefix length
+		unsigned int ipv6_bits {128U} ; // ipv6 prefix length
+		std::string response ; // sent on refusal, eg. "421 too many connections\r\n"
+		Config & set_count( unsigned int ) noexcept ;
+		Config & set_interval( unsigned int ) noexcept ;
+		Config & set_ipv4_bits( unsigned int ) noexcept ;
+		Config & set_ipv6_bits( unsigned int ) noexcept ;
+		Config & set_response( const std::string & ) ;
+	} ;
+
+	ConnectionLimiter( EventState , const Config & ) ;
+		///< Constructor.
+
+	bool enabled() const noexcept ;
+		///< Returns true if the configured count is non-zero.
+
+	bool admit( const Address & ) ;
+		///< Takes a token from the given address's bucket, returning
+		///< false if the bucket is empty. Returns true if not
+		///< enabled(). Refusals are logged, subject to rate
+		///< limiting.
+
+	const std::string & response() const noexcept ;
+		///< Returns the configured refusal response.
+
+	static void report( std::ostream & stream ,
+		const std::string & line_prefix = {} ,
+		const std::string & eol = std::string("\n") ) ;
+			///< Reports admission statistics onto a stream, if any
+			///< limiter has been used.
+
+	~ConnectionLimiter() ;
+		///< Destructor.
+
+public:
+	ConnectionLimiter( const ConnectionLimiter & ) = delete ;
+	ConnectionLimiter( ConnectionLimiter && ) = delete ;
+	ConnectionLimiter & operator=( const ConnectionLimiter & ) = delete ;
+	ConnectionLimiter & operator=( ConnectionLimiter && ) = delete ;
+
+private:
+	using Key = std::array<unsigned char,17U> ; // family byte and address bytes
+	struct KeyHash
+	{
+		std::size_t operator()( const Key & ) const noexcept ;
+	} ;
+	using Lru = std::list<Key> ; // most recently used first
+	struct Bucket
+	{
+		double tokens ;
+		G::TimerTime time ;
+		Lru::iterator lru ;
+	} ;
+	using Map = std::unordered_map<Key,Bucket,KeyHash> ;
+	bool key( const Address & , Key & ) const ;
+	void refill( Bucket & , const G::TimerTime & ) const ;
+	void onTimeout() ;
+	void logRefusal( const Address & ) ;
+
+private:
+	Config m_config ;
+	double m_rate ; // tokens per second
+	Map m_map ;
+	Lru m_lru ;
+	unsigned long m_refused_unlogged {0UL} ;
+	Timer<ConnectionLimiter> m_timer ;
+} ;
+
+inline GNet::ConnectionLimiter::Config & GNet::ConnectionLimiter::Config::set_count( unsigned int n ) noexcept { count = n ; return *this ; }
+inline GNet::ConnectionLimiter::Config & GNet::ConnectionLimiter::Config::set_interval( unsigned int s ) noexcept { interval = s ; return *this ; }
+inline GNet::ConnectionLimiter::Config & GNet::ConnectionLimiter::Config::set_ipv4_bits( unsigned int n ) noexcept { ipv4_bits = n ; return *this ; }
+inline GNet::ConnectionLimiter::Config & GNet::ConnectionLimiter::Config::set_ipv6_bits( unsigned int n ) noexcept { ipv6_bits = n ; return *this ; }
+inline GNet::ConnectionLimiter::Config & GNet::ConnectionLimiter::Config::set_response( const std::string & s ) { response = s ; return *this ; }
+
+#endif
@@ -27,6 +27,7 @@
 #include "gstringview.h"
 #include <functional>
 #include <memory>
+#include <iostream>
 
 namespace GNet
 {
@@ -56,6 +57,9 @@ public:
 	static void checkConfig( const std::string & ) ;
 		///< See DnsBlock::checkConfig().
 
+	static void report( std::ostream & , const std::string & line_prefix , const std::string & eol ) ;
+		///< See DnsBlock::report().
+
 public:
 	Dnsbl( const Dnsbl & ) = delete ;
 	Dnsbl( Dnsbl && ) = delete ;
@@ -49,3 +49,7 @@ void GNet::Dnsbl::checkConfig( const std::string & config )
 	if( !config.empty() )
 		throw G::Exception( "dnsbl has been disabled in this build" ) ;
 }
+
+void GNet::Dnsbl::report( std::ostream & , const std::string & , const std::string & )
+{
+}
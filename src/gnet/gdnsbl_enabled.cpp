@@ -64,3 +64,8 @@ void GNet::Dnsbl::checkConfig( const std::string & config )
 	DnsBlock::checkConfig( config ) ;
 }
 
+void GNet::Dnsbl::report( std::ostream & stream , const std::string & px , const std::string & eol )
+{
+	DnsBlock::report( stream , px , eol ) ;
+}
+
@@ -26,11 +26,14 @@
 #include "glocal.h"
 #include "gstr.h"
 #include "gtest.h"
+#include "glimits.h"
 #include "gassert.h"
 #include "glog.h"
 #include <sstream>
 #include <algorithm>
 #include <cstdlib>
+#include <list>
+#include <map>
 
 namespace GNet
 {
@@ -38,6 +41,30 @@ namespace GNet
 	{
 		static constexpr std::string_view default_timeout_ms {"5000",4U} ;
 		static constexpr unsigned int default_threshold {1U} ;
+		static constexpr unsigned int negative_ttl {300U} ; // seconds, for "not listed" answers
+		static constexpr unsigned int max_ttl {3600U} ; // seconds
+
+		class Cache /// A bounded LRU cache of DnsBlockResult objects.
+		{
+		public:
+			static Cache & instance() ;
+			const DnsBlockResult * find( const std::string & key ) ;
+			void add( const std::string & key , const DnsBlockResult & , unsigned int ttl ) ;
+			void report( std::ostream & , const std::string & , const std::string & ) const ;
+
+		private:
+			struct Entry
+			{
+				std::string key ;
+				DnsBlockResult result ;
+				G::TimerTime expiry ;
+			} ;
+			using List = std::list<Entry> ; // most recently used first
+			List m_list ;
+			std::map<std::string,List::iterator> m_map ;
+			unsigned long m_hits {0UL} ;
+			unsigned long m_misses {0UL} ;
+		} ;
 
 		struct HostList /// A streamable adaptor for a list of addresses.
 		{
@@ -66,6 +93,62 @@ namespace GNet
 	}
 }
 
+GNet::DnsBlockImp::Cache & GNet::DnsBlockImp::Cache::instance()
+{
+	static Cache cache ;
+	return cache ;
+}
+
+const GNet::DnsBlockResult * GNet::DnsBlockImp::Cache::find( const std::string & key )
+{
+	auto p = m_map.find( key ) ;
+	if( p != m_map.end() && G::TimerTime::now() <= p->second->expiry )
+	{
+		m_list.splice( m_list.begin() , m_list , p->second ) ;
+		m_hits++ ;
+		return &m_list.front().result ;
+	}
+	else if( p != m_map.end() )
+	{
+		m_list.erase( p->second ) ;
+		m_map.erase( p ) ;
+	}
+	m_misses++ ;
+	return nullptr ;
+}
+
+void GNet::DnsBlockImp::Cache::add( const std::string & key , const DnsBlockResult & result , unsigned int ttl )
+{
+	if( ttl == 0U )
+		return ;
+	auto p = m_map.find( key ) ;
+	if( p != m_map.end() )
+	{
+		m_list.erase( p->second ) ;
+		m_map.erase( p ) ;
+	}
+	const std::size_t limit = static_cast<std::size_t>( G::Limits<>::dnsbl_cache ) ;
+	while( !m_list.empty() && m_list.size() >= limit )
+	{
+		m_map.erase( m_list.back().key ) ;
+		m_list.pop_back() ;
+	}
+	m_list.push_front( Entry{ key , result , G::TimerTime::now() + G::TimeInterval(ttl) } ) ;
+	m_map.insert( {key,m_list.begin()} ) ;
+}
+
+void GNet::DnsBlockImp::Cache::report( std::ostream & s , const std::string & px , const std::string & eol ) const
+{
+	using G::txt ;
+	unsigned long total = m_hits + m_misses ;
+	if( total == 0UL )
+		return ;
+	s << px << txt("DNSBL cache entries: ") << m_list.size() << eol ;
+	s << px << txt("DNSBL cache hits: ") << m_hits << eol ;
+	s << px << txt("DNSBL cache misses: ") << m_misses << eol ;
+	s << px << txt("DNSBL cache hit rate: ") << (m_hits*100UL/total) << "%" << eol ;
+}
+
 GNet::DnsBlock::DnsBlock( DnsBlockCallback & callback , EventState es , std::string_view config ) :
 	m_callback(callback) ,
 	m_es(es) ,
@@ -193,7 +276,10 @@ void GNet::DnsBlock::start( const Address & address )
 		<< "address=" << address.hostPartString() << " "
 		<< "servers=[" << G::Str::join(",",m_servers) << "]" ) ;
 
+	m_result = DnsBlockResult() ;
 	m_result.reset( m_threshold , address ) ;
+	m_cached = false ;
+	m_ttl = DnsBlockImp::max_ttl ;
 
 	// dont block connections from local addresses
 	bool is_local = address.isLoopback() || address.isUniqueLocal() || address.isLinkLocal() ;
@@ -204,6 +290,18 @@ void GNet::DnsBlock::start( const Address & address )
 		return ;
 	}
 
+	// deliver a cached result asynchronously
+	m_cache_key = cacheKey( address ) ;
+	const DnsBlockResult * cached = DnsBlockImp::Cache::instance().find( m_cache_key ) ;
+	if( cached )
+	{
+		G_DEBUG( "GNet::DnsBlock::start: using cached result for " << address.hostPartString() ) ;
+		m_result = *cached ;
+		m_cached = true ;
+		m_timer.startTimer( 0 ) ;
+		return ;
+	}
+
 	// re-base the sequence number if necessary
 	static unsigned int id_generator = 10 ;
 	if( (id_generator+m_servers.size()) > 65535U )
@@ -261,6 +359,7 @@ void GNet::DnsBlock::readEvent()
 	}
 
 	m_result.at(message.ID()-m_id_base).set( message.addresses() ) ;
+	m_ttl = std::min( m_ttl , message.ANCOUNT() ? message.ttl() : DnsBlockImp::negative_ttl ) ;
 
 	std::size_t server_count = m_result.list().size() ;
 	std::size_t responder_count = countResponders( m_result.list() ) ;
@@ -285,12 +384,24 @@ void GNet::DnsBlock::readEvent()
 		m_result.type() = ( m_threshold && deny_count >= m_threshold ) ?
 			DnsBlockResult::Type::Deny :
 			DnsBlockResult::Type::Allow ;
+		DnsBlockImp::Cache::instance().add( m_cache_key , m_result , m_ttl ) ;
 		m_callback.onDnsBlockResult( m_result ) ;
 	}
 }
 
+const char * GNet::DnsBlock::statsName() const noexcept
+{
+	return "GNet::DnsBlock" ;
+}
+
 void GNet::DnsBlock::onTimeout()
 {
+	if( m_cached )
+	{
+		m_cached = false ;
+		m_callback.onDnsBlockResult( m_result ) ;
+		return ;
+	}
 	m_socket_ptr.reset() ;
 	m_result.type() = m_result.list().empty() ?
 		( m_servers.empty() ? DnsBlockResult::Type::Inactive : DnsBlockResult::Type::Local ) :
@@ -303,6 +414,20 @@ std::string GNet::DnsBlock::queryString( const Address & address )
 	return address.queryString() ;
 }
 
+std::string GNet::DnsBlock::cacheKey( const Address & address ) const
+{
+	// the result depends on the configuration as well as the address
+	std::ostringstream ss ;
+	ss << address.hostPartString() << '\0' << m_threshold << '\0' << m_allow_on_timeout
+		<< '\0' << m_dns_server.displayString() << '\0' << G::Str::join(",",m_servers) ;
+	return ss.str() ;
+}
+
+void GNet::DnsBlock::report( std::ostream & stream , const std::string & px , const std::string & eol )
+{
+	DnsBlockImp::Cache::instance().report( stream , px , eol ) ;
+}
+
 void GNet::DnsBlockResult::log() const
 {
 	using namespace DnsBlockImp ;
@@ -33,6 +33,7 @@
 #include "gstringview.h"
 #include <memory>
 #include <vector>
+#include <iostream>
 
 namespace GNet
 {
@@ -142,6 +143,12 @@ private:
 /// server and are cached or routed in the normal way, so the
 /// block-list servers are not contacted directly.
 ///
+/// Results are kept in a bounded LRU cache keyed by the tested
+/// address, so that clients that reconnect repeatedly do not
+/// cause repeated queries. Cache entries expire according to
+/// the TTLs of the DNS answers, or after a fixed time for
+/// negative answers. Timeouts are not cached.
+///
 class GNet::DnsBlock : private EventHandler
 {
 public:
@@ -175,6 +182,12 @@ public:
 	bool busy() const ;
 		///< Returns true after start() and before the completion callback.
 
+	static void report( std::ostream & stream ,
+		const std::string & line_prefix = {} ,
+		const std::string & eol = std::string("\n") ) ;
+			///< Reports cache statistics onto a stream, if
+			///< any checks have been made.
+
 public:
 	~DnsBlock() override = default ;
 	DnsBlock( const DnsBlock & ) = delete ;
@@ -184,6 +197,7 @@ public:
 
 private: // overrides
 	void readEvent() override ; // Override from GNet::EventHandler.
+	const char * statsName() const noexcept override ; // Override from GNet::EventHandler.
 
 private:
 	static void configureImp( std::string_view , DnsBlock * ) ;
@@ -196,6 +210,7 @@ private:
 	static bool isDomain( std::string_view ) noexcept ;
 	static bool isPositive( std::string_view ) noexcept ;
 	static unsigned int ms( std::string_view ) ;
+	std::string cacheKey( const Address & ) const ;
 
 private:
 	DnsBlockCallback & m_callback ;
@@ -209,6 +224,9 @@ private:
 	DnsBlockResult m_result ;
 	unsigned int m_id_base {0U} ;
 	std::unique_ptr<DatagramSocket> m_socket_ptr ;
+	std::string m_cache_key ;
+	unsigned int m_ttl {0U} ;
+	bool m_cached {false} ;
 } ;
 
 //| \class GNet::DnsBlockCallback
@@ -24,6 +24,7 @@
 #include "gstr.h"
 #include "gstringview.h"
 #include "gstringfield.h"
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <iomanip>
@@ -140,6 +141,17 @@ std::vector<GNet::Address> GNet::DnsMessage::addresses() const
 	return list ;
 }
 
+unsigned int GNet::DnsMessage::ttl() const
+{
+	unsigned int result = 0U ;
+	for( unsigned int i = QDCOUNT() ; i < (QDCOUNT()+ANCOUNT()) ; i++ )
+	{
+		unsigned int rr_ttl = rr(i).ttl() ;
+		result = i == QDCOUNT() ? rr_ttl : std::min( result , rr_ttl ) ;
+	}
+	return result ;
+}
+
 unsigned int GNet::DnsMessage::byte( unsigned int i ) const
 {
 	if( i > m_buffer.size() )
@@ -407,7 +419,8 @@ GNet::DnsMessageRR::DnsMessageRR( const DnsMessage & msg , unsigned int offset )
 
 	m_type = msg.word( offset ) ; offset += 2U ; // TYPE // NOLINT
 	m_class = msg.word( offset ) ; offset += 2U ; // CLASS // NOLINT
-	offset += 4U ; // TTL
+	m_ttl = msg.word( offset ) * 65536UL + msg.word( offset + 2U ) ; offset += 4U ; // TTL // NOLINT
+	if( m_ttl > 0x7fffffffUL ) m_ttl = 0U ; // RFC-2181 8
 	m_rdata_size = msg.word( offset ) ; offset += 2U ; // RDLENGTH // NOLINT
 
 	m_rdata_offset = offset ; // NOLINT
@@ -424,6 +437,11 @@ unsigned int GNet::DnsMessageRR::type() const
 }
 #endif
 
+unsigned int GNet::DnsMessageRR::ttl() const
+{
+	return static_cast<unsigned int>( m_ttl ) ;
+}
+
 #ifndef G_LIB_SMALL
 unsigned int GNet::DnsMessageRR::class_() const
 {
@@ -72,6 +72,10 @@ public:
 	std::vector<Address> addresses() const ;
 		///< Returns the Answer addresses.
 
+	unsigned int ttl() const ;
+		///< Returns the smallest TTL of the Answer records, or
+		///< zero if there are none.
+
 	unsigned int ID() const ;
 		///< Returns the header ID.
 
@@ -257,6 +261,9 @@ public:
 	unsigned int class_() const ;
 		///< Returns the RR CLASS value().
 
+	unsigned int ttl() const ;
+		///< Returns the RR TTL value in seconds.
+
 	unsigned int size() const ;
 		///< Returns the size of the RR.
 
@@ -300,6 +307,7 @@ private:
 	unsigned int m_size {0U} ;
 	unsigned int m_type {0U} ;
 	unsigned int m_class {0U} ;
+	unsigned long m_ttl {0UL} ;
 	unsigned int m_rdata_offset {0U} ;
 	unsigned int m_rdata_size {0U} ;
 	std::string m_name ;
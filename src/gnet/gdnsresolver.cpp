@@ -0,0 +1,521 @@
+// 
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gdnsresolver.cpp
+///
+
+#include "gdef.h"
+#include "gdnsresolver.h"
+#include "gdnsmessage.h"
+#include "gnameservers.h"
+#include "grandom.h"
+#include "gstr.h"
+#include "gstringtoken.h"
+#include "gassert.h"
+#include "glog.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+namespace GNet
+{
+	namespace DnsResolverImp
+	{
+		struct Stats /// Lookup statistics for GNet::DnsResolver::report().
+		{
+			unsigned long lookups {0UL} ;
+			unsigned long failures {0UL} ;
+			unsigned long tcp {0UL} ;
+			unsigned long total_ms {0UL} ;
+			unsigned long max_ms {0UL} ;
+		} ;
+		Stats & stats()
+		{
+			static Stats s ;
+			return s ;
+		}
+	}
+}
+
+GNet::DnsResolver::DnsResolver( EventState es , const Config & config ) :
+	DnsResolver(es,config,GNet::nameservers(53U),GNet::dnsSearch())
+{
+}
+
+GNet::DnsResolver::DnsResolver( EventState es , const Config & config ,
+	const std::vector<Address> & nameservers , const DnsSearch & search ) :
+		m_es(es) ,
+		m_config(config) ,
+		m_nameservers(nameservers) ,
+		m_search(search) ,
+		m_start_time(G::TimerTime::zero()) ,
+		m_timer(*this,&DnsResolver::onTimeout,es) ,
+		m_done_timer(*this,&DnsResolver::onDoneTimeout,es)
+{
+	if( m_nameservers.empty() )
+	{
+		m_nameservers.push_back( Address::loopback( Address::Family::ipv4 , 53U ) ) ;
+		m_nameservers.push_back( Address::loopback( Address::Family::ipv6 , 53U ) ) ;
+	}
+	if( m_config.attempts == 0U )
+		m_config.attempts = 1U ;
+}
+
+GNet::DnsResolver::~DnsResolver()
+= default;
+
+void GNet::DnsResolver::start( const std::string & host , unsigned int port , int family )
+{
+	G_ASSERT( !busy() ) ;
+	G_DEBUG( "GNet::DnsResolver::start: [" << host << "] port " << port << " family " << family ) ;
+	m_busy = true ;
+	m_host = host ;
+	m_port = port ;
+	m_start_time = G::TimerTime::now() ;
+	m_error.clear() ;
+	m_result.clear() ;
+	m_ttl = std::numeric_limits<unsigned int>::max() ;
+	m_family = family ;
+	dropQueries() ;
+
+	if( m_config.hosts && hostsFile( m_config.hosts_file , host , port , family , m_result ) )
+	{
+		G_LOG_MORE( "GNet::DnsResolver::start: dns: [" << host << "] found in hosts file" ) ;
+		m_done_timer.startTimer( 0U ) ;
+		return ;
+	}
+
+	m_names = candidates( host ) ;
+	m_name_index = 0U ;
+	startQueries() ;
+}
+
+G::StringArray GNet::DnsResolver::candidates( const std::string & host ) const
+{
+	// as per res_search(), names with a trailing dot are not searched,
+	// and names with fewer than 'ndots' dots are searched before
+	// being tried as-is
+	std::string name = host ;
+	bool absolute = !name.empty() && name.back() == '.' ;
+	G::Str::trimRight( name , "." ) ;
+	if( absolute || m_search.domains.empty() || name.empty() )
+		return { name } ;
+
+	G::StringArray result ;
+	bool as_is_first = static_cast<std::size_t>( std::count( name.begin() , name.end() , '.' ) ) >= m_search.ndots ;
+	if( as_is_first )
+		result.push_back( name ) ;
+	for( const auto & domain : m_search.domains )
+		result.push_back( std::string(name).append(1U,'.').append(domain) ) ;
+	if( !as_is_first )
+		result.push_back( name ) ;
+	return result ;
+}
+
+void GNet::DnsResolver::startQueries()
+{
+	dropQueries() ;
+	for( const char * type : {"A","AAAA"} )
+	{
+		bool is4 = type[1] == '\0' ;
+		if( m_family == AF_UNSPEC || m_family == (is4?AF_INET:AF_INET6) )
+		{
+			Query query ;
+			query.type = type ;
+			query.id = G::Random::rand( 1U , 65535U ) ;
+			m_queries.push_back( std::move(query) ) ;
+		}
+	}
+
+	m_ns_index = 0U ;
+	m_round = 0U ;
+	send( m_ns_index ) ;
+	m_timer.startTimer( m_config.timeout ) ;
+}
+
+void GNet::DnsResolver::dropQueries()
+{
+	// (the sockets' destructors drop their event handlers)
+	m_queries.clear() ;
+	dropTcp() ;
+}
+
+bool GNet::DnsResolver::busy() const
+{
+	return m_busy ;
+}
+
+void GNet::DnsResolver::cancel()
+{
+	m_busy = false ;
+	m_timer.cancelTimer() ;
+	m_done_timer.cancelTimer() ;
+	dropQueries() ;
+}
+
+GNet::DatagramSocket & GNet::DnsResolver::socket( Query & query , const Address & ns )
+{
+	// a new socket for each query so that the source port is
+	// chosen afresh by the kernel's ephemeral port randomisation
+	std::unique_ptr<DatagramSocket> & socket_ptr = ns.is4() ? query.socket4 : query.socket6 ;
+	if( !socket_ptr )
+	{
+		socket_ptr = std::make_unique<DatagramSocket>( ns.family() , 0 , DatagramSocket::Config() ) ;
+		socket_ptr->addReadHandler( *this , m_es ) ;
+	}
+	return *socket_ptr ;
+}
+
+void GNet::DnsResolver::send( std::size_t ns_index )
+{
+	const Address & ns = m_nameservers.at( ns_index ) ;
+	const std::string & name = m_names.at( m_name_index ) ;
+	for( std::size_t i = 0U ; i < m_queries.size() ; i++ )
+	{
+		Query & query = m_queries[i] ;
+		if( query.done || ( m_tcp_socket && m_tcp_query == i ) )
+			continue ;
+
+		G_LOG_MORE( "GNet::DnsResolver::send: dns: question: " << query.type << " [" << name << "] "
+			<< "to " << ns.displayString() << " (id " << query.id << ")" ) ;
+		DnsMessageRequest request( query.type , name , query.id ) ;
+		DatagramSocket & s = socket( query , ns ) ;
+		ssize_t rc = s.writeto( request.p() , request.n() , ns ) ;
+		if( rc < 0 || static_cast<std::size_t>(rc) != request.n() )
+		{
+			G_DEBUG( "GNet::DnsResolver::send: send failed: " << s.reason() ) ;
+		}
+	}
+}
+
+void GNet::DnsResolver::readEvent()
+{
+	// (process() can start new queries, so index rather than iterate)
+	std::vector<char> buffer( 4096U ) ; // 512 in RFC-1035 4.2.1
+	for( std::size_t i = 0U ; i < m_queries.size() && m_busy && !m_done_timer.active() ; i++ )
+	{
+		for( bool is4 : {true,false} )
+		{
+			if( i >= m_queries.size() || !m_busy || m_done_timer.active() )
+				break ;
+			DatagramSocket * s = is4 ? m_queries[i].socket4.get() : m_queries[i].socket6.get() ;
+			if( s == nullptr )
+				continue ;
+			Address from = Address::defaultAddress() ;
+			ssize_t nread = s->readfrom( buffer.data() , buffer.size() , from ) ;
+			if( nread > 0 )
+				process( buffer.data() , static_cast<std::size_t>(nread) , from , false ) ;
+		}
+	}
+	if( m_tcp_socket && m_busy && !m_done_timer.active() )
+		readTcp() ;
+}
+
+const char * GNet::DnsResolver::statsName() const noexcept
+{
+	return "GNet::DnsResolver" ;
+}
+
+bool GNet::DnsResolver::matches( const Query & query , const DnsMessage & response ) const
+{
+	// the response must echo the question (RFC-5452 9.1)
+	try
+	{
+		if( !response.QR() || response.ID() != query.id || response.QDCOUNT() != 1U )
+			return false ;
+		DnsMessage::Question question = response.question( 0U ) ;
+		std::string qname = question.qname() ;
+		G::Str::trimRight( qname , "." ) ;
+		return
+			question.qtype() == DnsMessageRecordType::value( query.type , std::nothrow ) &&
+			G::Str::imatch( qname , m_names.at(m_name_index) ) ;
+	}
+	catch( G::Exception & )
+	{
+		return false ;
+	}
+}
+
+void GNet::DnsResolver::process( const char * p , std::size_t n , const Address & from , bool tcp )
+{
+	if( n < 12U )
+		return ;
+
+	DnsMessage response( p , n ) ;
+	auto query_p = std::find_if( m_queries.begin() , m_queries.end() ,
+		[this,&response](const Query & q_){ return !q_.done && matches(q_,response) ; } ) ;
+	bool from_ns = tcp || std::find( m_nameservers.begin() , m_nameservers.end() , from ) != m_nameservers.end() ;
+	if( query_p == m_queries.end() || !from_ns )
+	{
+		G_DEBUG( "GNet::DnsResolver::process: ignoring dns response from " << from.displayString() ) ;
+		return ;
+	}
+	Query & query = *query_p ;
+
+	if( response.TC() )
+	{
+		G_LOG_MORE( "GNet::DnsResolver::process: dns: truncated " << query.type << " response from " << from.displayString() ) ;
+		if( m_config.tcp && !tcp && !m_tcp_socket )
+			startTcp( static_cast<std::size_t>(query_p-m_queries.begin()) , from ) ;
+		return ;
+	}
+
+	const std::string & name = m_names.at( m_name_index ) ;
+	if( response.RCODE() == 3U ) // nxdomain
+	{
+		G_LOG_MORE( "GNet::DnsResolver::process: dns: answer: " << query.type << " [" << name << "] nxdomain" ) ;
+		for( auto & q : m_queries )
+		{
+			q.done = true ;
+			q.nxdomain = true ;
+		}
+	}
+	else if( response.RCODE() != 0U )
+	{
+		// try the next nameserver after the timeout
+		G_LOG_MORE( "GNet::DnsResolver::process: dns: answer: " << query.type << " [" << name << "] "
+			<< "rcode " << response.RCODE() << " from " << from.displayString() ) ;
+		return ;
+	}
+	else
+	{
+		try
+		{
+			query.ttl = std::numeric_limits<unsigned int>::max() ;
+			unsigned int offset = response.QDCOUNT() ;
+			for( unsigned int i = 0U ; i < response.ANCOUNT() ; i++ )
+			{
+				auto rr = response.rr( i + offset ) ;
+				query.ttl = std::min( query.ttl , rr.ttl() ) ;
+				if( rr.isa(query.type) )
+				{
+					query.list.push_back( rr.address( m_port ) ) ;
+					G_LOG_MORE( "GNet::DnsResolver::process: dns: answer: " << query.type << " [" << name << "] "
+						<< query.list.back().hostPartString() << " (ttl " << rr.ttl() << ")" ) ;
+				}
+			}
+		}
+		catch( G::Exception & e )
+		{
+			G_WARNING( "GNet::DnsResolver::process: invalid dns response from " << from.displayString() << ": " << e.what() ) ;
+			query.list.clear() ;
+			return ;
+		}
+		query.done = true ;
+	}
+
+	if( finished() )
+		finish() ;
+}
+
+bool GNet::DnsResolver::finished() const
+{
+	return std::all_of( m_queries.begin() , m_queries.end() , [](const Query & q_){ return q_.done ; } ) ;
+}
+
+void GNet::DnsResolver::finish()
+{
+	bool nxdomain = false ;
+	for( const auto & query : m_queries )
+	{
+		m_result.insert( m_result.end() , query.list.begin() , query.list.end() ) ;
+		if( !query.list.empty() )
+			m_ttl = std::min( m_ttl , query.ttl ) ;
+		nxdomain = nxdomain || query.nxdomain ;
+	}
+	if( m_result.empty() && (m_name_index+1U) < m_names.size() )
+	{
+		// try the next name from the search list
+		m_timer.cancelTimer() ;
+		m_name_index++ ;
+		startQueries() ;
+	}
+	else if( m_result.empty() )
+		fail( nxdomain ? "no such host" : "no address records" ) ;
+	else
+		m_done_timer.startTimer( 0U ) ;
+}
+
+void GNet::DnsResolver::fail( const std::string & reason )
+{
+	m_error = "no such host: \"" + m_host + "\" (" + reason + ")" ;
+	m_result.clear() ;
+	m_done_timer.startTimer( 0U ) ;
+}
+
+void GNet::DnsResolver::onTimeout()
+{
+	dropTcp() ;
+	m_ns_index++ ;
+	if( m_ns_index == m_nameservers.size() )
+	{
+		m_ns_index = 0U ;
+		m_round++ ;
+	}
+	if( m_round == m_config.attempts )
+	{
+		fail( "dns timeout" ) ;
+	}
+	else
+	{
+		send( m_ns_index ) ;
+		m_timer.startTimer( m_config.timeout ) ;
+	}
+}
+
+void GNet::DnsResolver::onDoneTimeout()
+{
+	m_timer.cancelTimer() ;
+	dropQueries() ;
+	m_busy = false ;
+
+	G::TimeInterval elapsed( m_start_time , G::TimerTime::now() ) ;
+	auto ms = static_cast<unsigned long>( elapsed.s() * 1000U + elapsed.us() / 1000U ) ;
+	DnsResolverImp::Stats & stats = DnsResolverImp::stats() ;
+	stats.lookups++ ;
+	stats.failures += ( m_error.empty() ? 0UL : 1UL ) ;
+	stats.total_ms += ms ;
+	stats.max_ms = std::max( stats.max_ms , ms ) ;
+	G_LOG_MORE( "GNet::DnsResolver::onDoneTimeout: dns: [" << m_host << "] "
+		<< (m_error.empty()?"resolved":"failed") << " in " << ms << "ms" ) ;
+
+	m_done_signal.emit( std::string(m_error) , AddressList(m_result) , m_ttl ) ;
+}
+
+void GNet::DnsResolver::startTcp( std::size_t query_index , const Address & ns )
+{
+	G_LOG_MORE( "GNet::DnsResolver::startTcp: dns: retrying " << m_queries.at(query_index).type
+		<< " [" << m_names.at(m_name_index) << "] over tcp to " << ns.displayString() ) ;
+	DnsResolverImp::stats().tcp++ ;
+	m_tcp_query = query_index ;
+	m_tcp_buffer.clear() ;
+	m_tcp_socket = std::make_unique<StreamSocket>( ns.family() , StreamSocket::Config() ) ;
+	if( m_tcp_socket->connect( ns ) )
+	{
+		m_tcp_socket->addWriteHandler( *this , m_es ) ;
+		m_tcp_socket->addOtherHandler( *this , m_es ) ;
+		m_timer.startTimer( m_config.timeout ) ;
+	}
+	else
+	{
+		dropTcp() ;
+	}
+}
+
+void GNet::DnsResolver::writeEvent()
+{
+	// tcp connection established -- send the length-prefixed query
+	if( !m_tcp_socket ) return ;
+	m_tcp_socket->dropWriteHandler() ;
+	const Query & query = m_queries.at( m_tcp_query ) ;
+	DnsMessageRequest request( query.type , m_names.at(m_name_index) , query.id ) ;
+	std::string data ;
+	data.append( 1U , static_cast<char>((request.n()>>8U)&0xffU) ) ;
+	data.append( 1U , static_cast<char>(request.n()&0xffU) ) ;
+	data.append( request.p() , request.n() ) ;
+	ssize_t rc = m_tcp_socket->write( data.data() , data.size() ) ;
+	if( rc < 0 || static_cast<std::size_t>(rc) != data.size() )
+		dropTcp() ;
+	else
+		m_tcp_socket->addReadHandler( *this , m_es ) ;
+}
+
+void GNet::DnsResolver::readTcp()
+{
+	std::vector<char> buffer( 4096U ) ;
+	ssize_t nread = m_tcp_socket->read( buffer.data() , buffer.size() ) ;
+	if( nread < 0 && m_tcp_socket->eWouldBlock() )
+		return ;
+	if( nread <= 0 )
+	{
+		dropTcp() ;
+		return ;
+	}
+	m_tcp_buffer.append( buffer.data() , static_cast<std::size_t>(nread) ) ;
+	if( m_tcp_buffer.size() >= 2U )
+	{
+		std::size_t n = static_cast<unsigned char>(m_tcp_buffer[0]) * 256U + static_cast<unsigned char>(m_tcp_buffer[1]) ;
+		if( m_tcp_buffer.size() >= (n+2U) )
+		{
+			std::string message = m_tcp_buffer.substr( 2U , n ) ;
+			Address from = m_nameservers.at( m_ns_index ) ;
+			dropTcp() ;
+			process( message.data() , message.size() , from , true ) ;
+		}
+	}
+}
+
+void GNet::DnsResolver::otherEvent( EventHandler::Reason )
+{
+	dropTcp() ;
+}
+
+void GNet::DnsResolver::dropTcp()
+{
+	m_tcp_socket.reset() ;
+	m_tcp_buffer.clear() ;
+}
+
+bool GNet::DnsResolver::hostsFile( const std::string & path , const std::string & host ,
+	unsigned int port , int family , AddressList & list )
+{
+	if( G::is_windows() || path.empty() ) return false ;
+	std::ifstream f( path.c_str() ) ;
+	std::string line ;
+	while( G::Str::readLine( f , line ) )
+	{
+		G::StringArray words = G::Str::splitIntoTokens( G::Str::head(line,"#",false) , " \t" ) ;
+		if( words.size() < 2U || !Address::validStrings(words[0],"0") )
+			continue ;
+		for( std::size_t i = 1U ; i < words.size() ; i++ )
+		{
+			if( G::Str::imatch( words[i] , host ) )
+			{
+				Address a = Address::parse( words[0] , port ) ;
+				if( family == AF_UNSPEC || a.af() == family )
+					list.push_back( a ) ;
+				break ;
+			}
+		}
+	}
+	std::stable_sort( list.begin() , list.end() ,
+		[](const Address & a , const Address & b){ return a.is4() && !b.is4() ; } ) ;
+	return !list.empty() ;
+}
+
+G::Slot::Signal<const std::string&,const GNet::DnsResolver::AddressList&,unsigned int> & GNet::DnsResolver::doneSignal() noexcept
+{
+	return m_done_signal ;
+}
+
+void GNet::DnsResolver::report( std::ostream & s , const std::string & px , const std::string & eol )
+{
+	using G::txt ;
+	const DnsResolverImp::Stats & stats = DnsResolverImp::stats() ;
+	if( stats.lookups )
+	{
+		s << px << txt("DNS native lookups: ") << stats.lookups << eol ;
+		s << px << txt("DNS native failures: ") << stats.failures << eol ;
+		s << px << txt("DNS native tcp retries: ") << stats.tcp << eol ;
+		s << px << txt("DNS native average time: ") << (stats.total_ms/stats.lookups) << "ms" << eol ;
+		s << px << txt("DNS native maximum time: ") << stats.max_ms << "ms" << eol ;
+	}
+}
+
+GNet::DnsResolver::Config::Config()
+= default ;
+
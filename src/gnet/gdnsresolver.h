@@ -0,0 +1,193 @@
+// 
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gdnsresolver.h
+///
+
+#ifndef G_NET_DNS_RESOLVER_H
+#define G_NET_DNS_RESOLVER_H
+
+#include "gdef.h"
+#include "gaddress.h"
+#include "gsocket.h"
+#include "gnameservers.h"
+#include "geventhandler.h"
+#include "geventstate.h"
+#include "gdatetime.h"
+#include "gtimer.h"
+#include "gslot.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+
+namespace GNet
+{
+	class DnsResolver ;
+	class DnsMessage ;
+}
+
+//| \class GNet::DnsResolver
+/// An asynchronous A/AAAA lookup client that runs entirely on the event
+/// loop, sending DNS queries to the system's nameservers (see
+/// GNet::nameservers()) and parsing the responses with GNet::DnsMessage.
+///
+/// Each nameserver is queried in turn with a 'timeout' interval, going
+/// round the list of nameservers 'attempts' times before giving up.
+/// Truncated UDP responses are retried over TCP. Names that are in the
+/// hosts file (normally "/etc/hosts") are resolved without any DNS
+/// queries.
+///
+/// Unqualified names are tried with each domain in the system's search
+/// list (see GNet::dnsSearch()), honouring 'ndots', in the same way as
+/// the system resolver.
+///
+/// Each query uses its own UDP socket so that it has its own ephemeral
+/// source port, and responses are only accepted if they come from one
+/// of the nameservers and match the query's id, name and type.
+///
+/// \see GNet::Resolver
+///
+class GNet::DnsResolver : private EventHandler
+{
+public:
+	using AddressList = std::vector<Address> ;
+	struct Config /// A configuration structure for GNet::DnsResolver.
+	{
+		Config() ;
+		G::TimeInterval timeout {2U,0} ; // per nameserver
+		unsigned int attempts {2U} ; // times round the list of nameservers
+		bool tcp {true} ; // retry truncated responses over tcp
+		bool hosts {true} ; // check the hosts file first
+		std::string hosts_file {"/etc/hosts"} ;
+		Config & set_timeout( G::TimeInterval ) noexcept ;
+		Config & set_attempts( unsigned int ) noexcept ;
+		Config & set_tcp( bool = true ) noexcept ;
+		Config & set_hosts( bool = true ) noexcept ;
+		Config & set_hosts_file( const std::string & ) ;
+	} ;
+
+	DnsResolver( EventState , const Config & ) ;
+		///< Constructor using the system's nameservers and search list.
+
+	DnsResolver( EventState , const Config & , const std::vector<Address> & nameservers ,
+		const DnsSearch & = {} ) ;
+			///< Constructor taking a list of nameservers and an
+			///< optional search list.
+
+	~DnsResolver() override ;
+		///< Destructor.
+
+	void start( const std::string & host , unsigned int port , int family = AF_UNSPEC ) ;
+		///< Starts resolving the given host name. The address family
+		///< can be AF_UNSPEC, AF_INET or AF_INET6. The resulting
+		///< addresses have the given port number. IPv4 addresses
+		///< come before IPv6 addresses in the result list.
+		///< Precondition: !busy()
+
+	bool busy() const ;
+		///< Returns true after start() and before the done signal.
+
+	void cancel() ;
+		///< Cancels the lookup so the doneSignal() is not emitted.
+
+	G::Slot::Signal<const std::string&,const AddressList&,unsigned int> & doneSignal() noexcept ;
+		///< Returns a reference to the completion signal. The signal
+		///< parameters are (1) the error reason, empty on success,
+		///< (2) the list of addresses, and (3) the smallest answer
+		///< TTL in seconds, or the maximum unsigned value if the
+		///< result did not come from DNS.
+
+	static void report( std::ostream & stream ,
+		const std::string & line_prefix = {} ,
+		const std::string & eol = std::string("\n") ) ;
+			///< Reports lookup counts and timings onto a stream.
+
+private: // overrides
+	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
+	void writeEvent() override ; // GNet::EventHandler
+	void otherEvent( EventHandler::Reason ) override ; // GNet::EventHandler
+
+public:
+	DnsResolver( const DnsResolver & ) = delete ;
+	DnsResolver( DnsResolver && ) = delete ;
+	DnsResolver & operator=( const DnsResolver & ) = delete ;
+	DnsResolver & operator=( DnsResolver && ) = delete ;
+
+private:
+	struct Query
+	{
+		std::string type ; // "A" or "AAAA"
+		unsigned int id {0U} ;
+		bool done {false} ;
+		bool nxdomain {false} ;
+		AddressList list ;
+		unsigned int ttl {0U} ;
+		std::unique_ptr<DatagramSocket> socket4 ;
+		std::unique_ptr<DatagramSocket> socket6 ;
+	} ;
+	void startQueries() ;
+	void dropQueries() ;
+	void send( std::size_t ns_index ) ;
+	void process( const char * , std::size_t , const Address & from , bool tcp ) ;
+	void startTcp( std::size_t query_index , const Address & ) ;
+	void readTcp() ;
+	void dropTcp() ;
+	bool finished() const ;
+	void finish() ;
+	void fail( const std::string & ) ;
+	void onTimeout() ;
+	void onDoneTimeout() ;
+	DatagramSocket & socket( Query & , const Address & ) ;
+	bool matches( const Query & , const DnsMessage & ) const ;
+	G::StringArray candidates( const std::string & ) const ;
+	static bool hostsFile( const std::string & path , const std::string & , unsigned int , int , AddressList & ) ;
+
+private:
+	EventState m_es ;
+	Config m_config ;
+	std::vector<Address> m_nameservers ;
+	DnsSearch m_search ;
+	std::string m_host ;
+	G::StringArray m_names ; // m_host with search domains
+	std::size_t m_name_index {0U} ;
+	int m_family {AF_UNSPEC} ;
+	unsigned int m_port {0U} ;
+	std::vector<Query> m_queries ;
+	std::size_t m_ns_index {0U} ;
+	unsigned int m_round {0U} ;
+	G::TimerTime m_start_time ;
+	std::unique_ptr<StreamSocket> m_tcp_socket ;
+	std::size_t m_tcp_query {0U} ;
+	std::string m_tcp_buffer ;
+	Timer<DnsResolver> m_timer ;
+	Timer<DnsResolver> m_done_timer ;
+	bool m_busy {false} ;
+	std::string m_error ;
+	AddressList m_result ;
+	unsigned int m_ttl {0U} ;
+	G::Slot::Signal<const std::string&,const AddressList&,unsigned int> m_done_signal ;
+} ;
+
+inline GNet::DnsResolver::Config & GNet::DnsResolver::Config::set_timeout( G::TimeInterval t ) noexcept { timeout = t ; return *this ; }
+inline GNet::DnsResolver::Config & GNet::DnsResolver::Config::set_attempts( unsigned int n ) noexcept { attempts = n ; return *this ; }
+inline GNet::DnsResolver::Config & GNet::DnsResolver::Config::set_tcp( bool b ) noexcept { tcp = b ; return *this ; }
+inline GNet::DnsResolver::Config & GNet::DnsResolver::Config::set_hosts( bool b ) noexcept { hosts = b ; return *this ; }
+inline GNet::DnsResolver::Config & GNet::DnsResolver::Config::set_hosts_file( const std::string & s ) { hosts_file = s ; return *this ; }
+
+#endif
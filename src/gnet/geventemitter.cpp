@@ -22,6 +22,7 @@
 #include "geventemitter.h"
 #include "gnetdone.h"
 #include "geventloggingcontext.h"
+#include "geventloopstats.h"
 #include "glog.h"
 #include "gassert.h"
 #include <functional>
@@ -85,20 +86,29 @@ void GNet::EventEmitter::raiseReadEvent( EventHandler * handler , EventState & e
 {
 	namespace imp = EventEmitterImp ;
 	if( handler )
+	{
+		EventLoopStats::Dispatch stats( EventLoopStats::Type::read , handler->statsName() ) ;
 		imp::raiseEvent( imp::bind(&EventHandler::readEvent,handler) , es ) ;
+	}
 }
 
 void GNet::EventEmitter::raiseWriteEvent( EventHandler * handler , EventState & es )
 {
 	namespace imp = EventEmitterImp ;
 	if( handler )
+	{
+		EventLoopStats::Dispatch stats( EventLoopStats::Type::write , handler->statsName() ) ;
 		imp::raiseEvent( imp::bind(&EventHandler::writeEvent,handler) , es ) ;
+	}
 }
 
 void GNet::EventEmitter::raiseOtherEvent( EventHandler * handler , EventState & es , EventHandler::Reason reason )
 {
 	namespace imp = EventEmitterImp ;
 	if( handler )
+	{
+		EventLoopStats::Dispatch stats( EventLoopStats::Type::other , handler->statsName() ) ;
 		imp::raiseEvent( imp::bind(&EventHandler::otherEvent,handler,reason) , es ) ;
+	}
 }
 
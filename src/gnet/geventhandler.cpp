@@ -51,6 +51,11 @@ void GNet::EventHandler::otherEvent( EventHandler::Reason reason )
 	throw G::Exception( "socket disconnect event" , str(reason) ) ;
 }
 
+const char * GNet::EventHandler::statsName() const noexcept
+{
+	return "GNet::EventHandler" ;
+}
+
 std::string GNet::EventHandler::str( EventHandler::Reason reason )
 {
 	if( reason == EventHandler::Reason::failed ) return "connection failed" ;
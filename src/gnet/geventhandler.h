@@ -77,6 +77,12 @@ public:
 		///< event on windows. Overridable. The default
 		///< implementation throws an exception.
 
+	virtual const char * statsName() const noexcept ;
+		///< Returns a static name for the type of handler, used to
+		///< break down the event loop statistics (see
+		///< GNet::EventLoopStats). Overridable. The default
+		///< implementation returns "GNet::EventHandler".
+
 	static std::string str( Reason ) ;
 		///< Returns a printable description of the other-event
 		///< reason.
@@ -23,6 +23,7 @@
 #include "gscope.h"
 #include "gexception.h"
 #include "gtimerlist.h"
+#include "geventloopstats.h"
 #include "gprocess.h"
 #include "glog.h"
 #include "gassert.h"
@@ -153,7 +154,9 @@ void GNet::EventLoopImp::runOnce()
 
 	// extract the pending events
 	int timeout_ms = ms() ;
+	EventLoopStats::waitStart() ;
 	m_wait_rc = epoll_wait( m_epoll_fd , m_wait_events.data() , m_wait_events.size() , timeout_ms ) ; // NOLINT narrowing
+	EventLoopStats::waitEnd( m_wait_rc ) ;
 	if( m_wait_rc < 0 )
 	{
 		int e = G::Process::errno_() ;
@@ -27,6 +27,7 @@
 #include "gstr.h"
 #include "gtimer.h"
 #include "gtimerlist.h"
+#include "geventloopstats.h"
 #include "gtest.h"
 #include "glog.h"
 #include "gassert.h"
@@ -198,7 +199,9 @@ void GNet::EventLoopImp::runOnce()
 	m_read_set_copy = m_read_set ;
 	m_write_set_copy = m_write_set ;
 	m_other_set_copy = m_other_set ;
+	EventLoopStats::waitStart() ;
 	int rc = ::select( nfds , &m_read_set_copy , &m_write_set_copy , &m_other_set_copy , timeout_p ) ;
+	EventLoopStats::waitEnd( rc ) ;
 	if( rc < 0 )
 	{
 		int e = G::Process::errno_() ;
@@ -26,6 +26,7 @@
 #include "gexception.h"
 #include "gtimer.h"
 #include "gtimerlist.h"
+#include "geventloopstats.h"
 #include "gscope.h"
 #include "gstr.h"
 #include "gtest.h"
@@ -205,7 +206,9 @@ void GNet::EventLoopImp::runOnce()
 
 	EventLoopHandles & handles = *m_handles ;
 
+	EventLoopStats::waitStart() ;
 	auto rc = handles.wait( ms() ) ;
+	EventLoopStats::waitEnd( rc == RcType::event ? 1 : 0 ) ;
 	if( rc == RcType::overflow )
 	{
 		throw Overflow() ;
@@ -0,0 +1,209 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file geventloopstats.cpp
+///
+
+#include "gdef.h"
+#include "geventloopstats.h"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace GNet
+{
+	namespace EventLoopStatsImp
+	{
+		constexpr std::size_t buckets = 7U ;
+		constexpr std::array<unsigned long,buckets-1U> bucket_limits {{ 10UL , 100UL , 1000UL , 10000UL , 100000UL , 1000000UL }} ; // us
+		constexpr std::array<const char*,buckets> bucket_names {{ "<10us" , "<100us" , "<1ms" , "<10ms" , "<100ms" , "<1s" , ">=1s" }} ;
+
+		struct HandlerStats
+		{
+			unsigned long count {0UL} ;
+			unsigned long long total_us {0ULL} ;
+			unsigned long max_us {0UL} ;
+			std::array<unsigned long,buckets> histogram {{}} ;
+		} ;
+
+		struct Stats
+		{
+			bool enabled {false} ;
+			bool waiting {false} ;
+			G::TimerTime wait_start {G::TimerTime::zero()} ;
+			G::TimerTime wait_end {G::TimerTime::zero()} ;
+			unsigned long wakeups {0UL} ;
+			unsigned long events {0UL} ;
+			unsigned long max_events {0UL} ;
+			unsigned long long idle_us {0ULL} ;
+			unsigned long long busy_us {0ULL} ;
+			std::map<std::pair<int,const char*>,HandlerStats> handlers ; // keyed by static name pointer
+		} ;
+
+		Stats & stats()
+		{
+			static Stats s ;
+			return s ;
+		}
+
+		unsigned long long us( G::TimerTime start , G::TimerTime end )
+		{
+			G::TimeInterval interval( start , end ) ;
+			return static_cast<unsigned long long>(interval.s()) * 1000000ULL + interval.us() ;
+		}
+
+		const char * str( int type )
+		{
+			using Type = EventLoopStats::Type ;
+			if( type == static_cast<int>(Type::read) ) return "read" ;
+			if( type == static_cast<int>(Type::write) ) return "write" ;
+			if( type == static_cast<int>(Type::other) ) return "other" ;
+			return "timer" ;
+		}
+	}
+}
+
+GNet::EventLoopStats::Dispatch::Dispatch( Type type , const char * name ) noexcept :
+	m_enabled(EventLoopStatsImp::stats().enabled) ,
+	m_type(type) ,
+	m_name(name) ,
+	m_start(m_enabled?G::TimerTime::now():G::TimerTime::zero())
+{
+}
+
+GNet::EventLoopStats::Dispatch::~Dispatch()
+{
+	namespace imp = EventLoopStatsImp ;
+	if( m_enabled && imp::stats().enabled )
+	{
+		try
+		{
+			auto elapsed = static_cast<unsigned long>( std::min( imp::us(m_start,G::TimerTime::now()) , 0xffffffffULL ) ) ;
+			auto & h = imp::stats().handlers[{static_cast<int>(m_type),m_name}] ;
+			h.count++ ;
+			h.total_us += elapsed ;
+			h.max_us = std::max( h.max_us , elapsed ) ;
+			std::size_t bucket = static_cast<std::size_t>( std::upper_bound( imp::bucket_limits.begin() ,
+				imp::bucket_limits.end() , elapsed ) - imp::bucket_limits.begin() ) ;
+			h.histogram[bucket]++ ;
+		}
+		catch(...) // NOLINT bugprone-empty-catch
+		{
+		}
+	}
+}
+
+void GNet::EventLoopStats::enable( bool b ) noexcept
+{
+	EventLoopStatsImp::stats().enabled = b ;
+}
+
+bool GNet::EventLoopStats::enabled() noexcept
+{
+	return EventLoopStatsImp::stats().enabled ;
+}
+
+void GNet::EventLoopStats::waitStart() noexcept
+{
+	namespace imp = EventLoopStatsImp ;
+	imp::Stats & s = imp::stats() ;
+	if( s.enabled )
+	{
+		s.wait_start = G::TimerTime::now() ;
+		if( s.wakeups )
+			s.busy_us += imp::us( s.wait_end , s.wait_start ) ;
+		s.waiting = true ;
+	}
+}
+
+void GNet::EventLoopStats::waitEnd( int events ) noexcept
+{
+	namespace imp = EventLoopStatsImp ;
+	imp::Stats & s = imp::stats() ;
+	if( s.enabled && s.waiting )
+	{
+		s.wait_end = G::TimerTime::now() ;
+		s.idle_us += imp::us( s.wait_start , s.wait_end ) ;
+		s.waiting = false ;
+		s.wakeups++ ;
+		unsigned long n = events > 0 ? static_cast<unsigned long>(events) : 0UL ;
+		s.events += n ;
+		s.max_events = std::max( s.max_events , n ) ;
+	}
+}
+
+void GNet::EventLoopStats::reset()
+{
+	namespace imp = EventLoopStatsImp ;
+	bool enabled = imp::stats().enabled ;
+	imp::stats() = imp::Stats() ;
+	imp::stats().enabled = enabled ;
+}
+
+void GNet::EventLoopStats::report( std::ostream & s , const std::string & px , const std::string & eol )
+{
+	namespace imp = EventLoopStatsImp ;
+	const imp::Stats & stats = imp::stats() ;
+	if( !stats.enabled )
+		return ;
+
+	unsigned long long total_us = stats.idle_us + stats.busy_us ;
+	s << px << "Event loop wakeups: " << stats.wakeups << eol ;
+	s << px << "Event loop events per wakeup: "
+		<< (stats.wakeups?(stats.events/stats.wakeups):0UL) << " average, "
+		<< stats.max_events << " maximum" << eol ;
+	s << px << "Event loop idle time: " << (stats.idle_us/1000ULL) << "ms"
+		<< " (" << (total_us?(stats.idle_us*100ULL/total_us):0ULL) << "%)" << eol ;
+	s << px << "Event loop busy time: " << (stats.busy_us/1000ULL) << "ms"
+		<< " (" << (total_us?(stats.busy_us*100ULL/total_us):0ULL) << "%)" << eol ;
+
+	// handlers merged by name, most expensive first
+	std::map<std::pair<int,std::string>,imp::HandlerStats> merged ;
+	for( const auto & handler : stats.handlers )
+	{
+		imp::HandlerStats & m = merged[{handler.first.first,std::string(handler.first.second)}] ;
+		m.count += handler.second.count ;
+		m.total_us += handler.second.total_us ;
+		m.max_us = std::max( m.max_us , handler.second.max_us ) ;
+		for( std::size_t i = 0U ; i < imp::buckets ; i++ )
+			m.histogram[i] += handler.second.histogram[i] ;
+	}
+	using Item = std::pair<std::pair<int,std::string>,imp::HandlerStats> ;
+	std::vector<Item> items( merged.begin() , merged.end() ) ;
+	std::sort( items.begin() , items.end() ,
+		[](const Item & a , const Item & b){ return a.second.total_us > b.second.total_us ; } ) ;
+	for( const auto & item : items )
+	{
+		const imp::HandlerStats & h = item.second ;
+		s << px << "Event handler: " << imp::str(item.first.first) << " " << item.first.second
+			<< ": " << h.count << " calls, "
+			<< (h.total_us/h.count) << "us average, "
+			<< h.max_us << "us maximum, " ;
+		const char * sep = "" ;
+		for( std::size_t i = 0U ; i < imp::buckets ; i++ )
+		{
+			if( h.histogram[i] )
+			{
+				s << sep << imp::bucket_names[i] << ":" << h.histogram[i] ;
+				sep = " " ;
+			}
+		}
+		s << eol ;
+	}
+}
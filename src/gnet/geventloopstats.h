@@ -0,0 +1,107 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file geventloopstats.h
+///
+
+#ifndef G_NET_EVENT_LOOP_STATS_H
+#define G_NET_EVENT_LOOP_STATS_H
+
+#include "gdef.h"
+#include "gdatetime.h"
+#include <string>
+#include <iostream>
+
+namespace GNet
+{
+	class EventLoopStats ;
+}
+
+//| \class GNet::EventLoopStats
+/// Optional event loop instrumentation, recording the time spent
+/// waiting for events against the time spent handling them, the
+/// number of events per wakeup, and a histogram of dispatch times
+/// for each type of event handler.
+///
+/// The event loop implementations call waitStart() and waitEnd()
+/// around their wait, and EventEmitter and TimerList wrap each
+/// callback in a Dispatch object. Handlers are told apart by the
+/// name from EventHandler::statsName() or TimerBase::statsName(),
+/// so no RTTI is needed. Nothing is recorded unless enable()d.
+///
+/// \see GNet::Monitor
+///
+class GNet::EventLoopStats
+{
+public:
+	enum class Type
+	{
+		read ,
+		write ,
+		other ,
+		timer
+	} ;
+
+	class Dispatch /// A RAII class to time one event handler callback.
+	{
+	public:
+		Dispatch( Type , const char * name ) noexcept ;
+			///< Constructor. Notes the start time if enabled().
+			///< The name must be a static string.
+
+		~Dispatch() ;
+			///< Destructor. Records the elapsed time.
+
+	public:
+		Dispatch( const Dispatch & ) = delete ;
+		Dispatch( Dispatch && ) = delete ;
+		Dispatch & operator=( const Dispatch & ) = delete ;
+		Dispatch & operator=( Dispatch && ) = delete ;
+
+	private:
+		bool m_enabled ;
+		Type m_type ;
+		const char * m_name ;
+		G::TimerTime m_start ;
+	} ;
+
+	static void enable( bool = true ) noexcept ;
+		///< Enables or disables statistics collection.
+
+	static bool enabled() noexcept ;
+		///< Returns true if enable()d.
+
+	static void waitStart() noexcept ;
+		///< Called by the event loop just before waiting for events.
+
+	static void waitEnd( int events ) noexcept ;
+		///< Called by the event loop after waiting, with the number
+		///< of events returned.
+
+	static void reset() ;
+		///< Clears the statistics.
+
+	static void report( std::ostream & stream ,
+		const std::string & line_prefix = {} ,
+		const std::string & eol = std::string("\n") ) ;
+			///< Reports the statistics onto a stream.
+
+public:
+	EventLoopStats() = delete ;
+} ;
+
+#endif
@@ -57,6 +57,7 @@ public:
 
 private: // overrides
 	void readEvent() override ; // Override from GNet::EventHandler.
+	const char * statsName() const noexcept override ; // Override from GNet::EventHandler.
 
 private:
 	static int init( int ) ;
@@ -145,6 +146,11 @@ void GNet::FutureEventImp::readEvent()
 	}
 }
 
+const char * GNet::FutureEventImp::statsName() const noexcept
+{
+	return "GNet::FutureEvent" ;
+}
+
 // ==
 
 GNet::FutureEvent::FutureEvent( FutureEventHandler & handler , EventState es ) :
@@ -54,6 +54,7 @@ public:
 
 private: // overrides
 	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
 
 public:
 	FutureEventImp( const FutureEventImp & ) = delete ;
@@ -143,6 +144,11 @@ void GNet::FutureEventImp::readEvent()
 	m_handler.onFutureEvent() ;
 }
 
+const char * GNet::FutureEventImp::statsName() const noexcept
+{
+	return "GNet::FutureEvent" ;
+}
+
 // ==
 
 GNet::FutureEvent::FutureEvent( FutureEventHandler & handler , EventState es ) :
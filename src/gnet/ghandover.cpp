@@ -0,0 +1,100 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file ghandover.cpp
+///
+
+#include "gdef.h"
+#include "ghandover.h"
+#include "gmultiserver.h"
+#include "glog.h"
+#include <algorithm>
+
+namespace GNet
+{
+	namespace HandoverImp
+	{
+		std::vector<MultiServer*> & servers()
+		{
+			static std::vector<MultiServer*> list ;
+			return list ;
+		}
+		std::vector<Handover::Item> & adopted()
+		{
+			static std::vector<Handover::Item> list ;
+			return list ;
+		}
+	}
+}
+
+void GNet::Handover::add( MultiServer & server )
+{
+	HandoverImp::servers().push_back( &server ) ;
+}
+
+void GNet::Handover::remove( MultiServer & server ) noexcept
+{
+	auto & list = HandoverImp::servers() ;
+	list.erase( std::remove( list.begin() , list.end() , &server ) , list.end() ) ;
+}
+
+std::vector<GNet::Handover::Item> GNet::Handover::items()
+{
+	std::vector<Item> result ;
+	for( MultiServer * server : HandoverImp::servers() )
+		server->handoverItems( result ) ;
+	return result ;
+}
+
+void GNet::Handover::stop()
+{
+	for( MultiServer * server : HandoverImp::servers() )
+		server->stopListening() ;
+}
+
+bool GNet::Handover::busy( const G::StringArray & types )
+{
+	const auto & list = HandoverImp::servers() ;
+	return std::any_of( list.begin() , list.end() , [&types](const MultiServer * server){
+		return server->hasPeers() && std::find(types.begin(),types.end(),server->type()) != types.end() ; } ) ;
+}
+
+void GNet::Handover::adopt( const Item & item )
+{
+	G_DEBUG( "GNet::Handover::adopt: " << item.type << " " << item.address << " fd " << item.fd.fd() ) ;
+	HandoverImp::adopted().push_back( item ) ;
+}
+
+GNet::Descriptor GNet::Handover::take( const std::string & type , const Address & address )
+{
+	auto & list = HandoverImp::adopted() ;
+	std::string address_string = address.displayString() ;
+	auto p = std::find_if( list.begin() , list.end() , [&](const Item & item){
+		return item.type == type && item.address == address_string ; } ) ;
+	if( p == list.end() )
+		return Descriptor::invalid() ;
+	Descriptor fd = (*p).fd ;
+	list.erase( p ) ;
+	return fd ;
+}
+
+std::vector<GNet::Handover::Item> GNet::Handover::untaken()
+{
+	std::vector<Item> result ;
+	result.swap( HandoverImp::adopted() ) ;
+	return result ;
+}
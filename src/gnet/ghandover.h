@@ -0,0 +1,101 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file ghandover.h
+///
+
+#ifndef G_NET_HANDOVER_H
+#define G_NET_HANDOVER_H
+
+#include "gdef.h"
+#include "gaddress.h"
+#include "gdescriptor.h"
+#include "gstringarray.h"
+#include <string>
+#include <vector>
+
+namespace GNet
+{
+	class Handover ;
+	class MultiServer ;
+}
+
+//| \class GNet::Handover
+/// Supports a graceful restart where listening sockets are handed
+/// over from a running process to its replacement.
+///
+/// In the running process all GNet::MultiServer objects register
+/// themselves so that their listening sockets can be enumerated
+/// with items() and then passed to the new process. Once the new
+/// process is up and running the old process calls stop() so that
+/// it stops accepting connections, and it can then wait until
+/// busy() is false before terminating.
+///
+/// In the new process the received sockets are adopt()ed before
+/// any servers are created, and each MultiServer take()s a matching
+/// socket in preference to binding a new one. Any connections left
+/// in the listen queue are therefore not lost.
+///
+/// The mechanism for passing the sockets between processes is
+/// outside the scope of this class.
+///
+class GNet::Handover
+{
+public:
+	struct Item /// A description of a listening socket used by GNet::Handover.
+	{
+		std::string type ; ///< The server type, eg. "smtp".
+		std::string address ; ///< The listening address display string.
+		Descriptor fd ; ///< The listening socket.
+		bool inherited {false} ; ///< True if originally inherited as "fd#<n>".
+	} ;
+
+	static void add( MultiServer & ) ;
+		///< Registers a server. Used by GNet::MultiServer.
+
+	static void remove( MultiServer & ) noexcept ;
+		///< Unregisters a server. Used by GNet::MultiServer.
+
+	static std::vector<Item> items() ;
+		///< Returns the listening sockets of all registered servers.
+
+	static void stop() ;
+		///< Stops all registered servers from accepting new
+		///< connections, without closing their listening sockets.
+
+	static bool busy( const G::StringArray & types ) ;
+		///< Returns true if any registered server of the given
+		///< types has a connected peer.
+
+	static void adopt( const Item & ) ;
+		///< Adds a listening socket received from a previous
+		///< instance of the program.
+
+	static Descriptor take( const std::string & type , const Address & ) ;
+		///< Returns and removes an adopted socket that matches
+		///< the given server type and listening address. Returns
+		///< Descriptor::invalid() if none.
+
+	static std::vector<Item> untaken() ;
+		///< Removes and returns any adopted sockets that have
+		///< not been taken so that the caller can close them.
+
+public:
+	Handover() = delete ;
+} ;
+
+#endif
@@ -109,6 +109,7 @@ public:
 
 private: // overrides
 	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
 	void onFutureEvent() override ; // GNet::FutureEventHandler
 
 public:
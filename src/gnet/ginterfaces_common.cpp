@@ -128,6 +128,11 @@ void GNet::Interfaces::readEvent()
 	}
 }
 
+const char * GNet::Interfaces::statsName() const noexcept
+{
+	return "GNet::Interfaces" ;
+}
+
 void GNet::Interfaces::onFutureEvent()
 {
 	if( m_notifier )
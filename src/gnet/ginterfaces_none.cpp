@@ -84,6 +84,11 @@ void GNet::Interfaces::readEvent()
 {
 }
 
+const char * GNet::Interfaces::statsName() const noexcept
+{
+	return "GNet::Interfaces" ;
+}
+
 void GNet::Interfaces::onFutureEvent()
 {
 }
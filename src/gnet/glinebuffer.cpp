@@ -263,10 +263,8 @@ GNet::LineBuffer::Config GNet::LineBuffer::Config::pop()
 	return crlf() ;
 }
 
-#ifndef G_LIB_SMALL
 GNet::LineBuffer::Config GNet::LineBuffer::Config::http()
 {
 	return crlf() ;
 }
-#endif
 
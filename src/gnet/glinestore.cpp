@@ -23,8 +23,16 @@
 #include "gexception.h"
 #include "gstr.h"
 #include "gassert.h"
+#include <algorithm>
 #include <iterator>
 #include <cstddef>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define G_LINESTORE_SSE2 1
+#endif
 
 namespace GNet
 {
@@ -169,6 +177,61 @@ namespace GNet
 			}
 			return p1 == end1 && p2 == end2 ;
 		}
+		#if defined(__AVX2__) || defined(G_LINESTORE_SSE2)
+		inline std::size_t lowestBit( unsigned int mask ) noexcept
+		{
+			#if defined(__GNUC__)
+				return static_cast<std::size_t>( __builtin_ctz( mask ) ) ;
+			#else
+				std::size_t n = 0U ;
+				for( ; (mask & 1U) == 0U ; mask >>= 1 )
+					n++ ;
+				return n ;
+			#endif
+		}
+		#endif
+		std::size_t findPair( const char * data , std::size_t size , std::size_t pos , char c0 , char c1 ) noexcept
+		{
+			// returns the offset of the first c0 that is followed by c1 -- each
+			// vector step compares a block against c0 and the same block shifted
+			// by one against c1, so a lone c0 (eg. a bare CR) costs nothing
+			#if defined(__AVX2__)
+			{
+				const __m256i v0 = _mm256_set1_epi8( c0 ) ;
+				const __m256i v1 = _mm256_set1_epi8( c1 ) ;
+				for( ; (pos+32U) < size ; pos += 32U )
+				{
+					const __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(data+pos) ) ;
+					const __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(data+pos+1U) ) ;
+					const __m256i m = _mm256_and_si256( _mm256_cmpeq_epi8(a,v0) , _mm256_cmpeq_epi8(b,v1) ) ;
+					const unsigned int mask = static_cast<unsigned int>( _mm256_movemask_epi8(m) ) ;
+					if( mask )
+						return pos + lowestBit( mask ) ;
+				}
+			}
+			#endif
+			#if defined(G_LINESTORE_SSE2)
+			{
+				const __m128i v0 = _mm_set1_epi8( c0 ) ;
+				const __m128i v1 = _mm_set1_epi8( c1 ) ;
+				for( ; (pos+16U) < size ; pos += 16U )
+				{
+					const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>(data+pos) ) ;
+					const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>(data+pos+1U) ) ;
+					const __m128i m = _mm_and_si128( _mm_cmpeq_epi8(a,v0) , _mm_cmpeq_epi8(b,v1) ) ;
+					const unsigned int mask = static_cast<unsigned int>( _mm_movemask_epi8(m) ) ;
+					if( mask )
+						return pos + lowestBit( mask ) ;
+				}
+			}
+			#endif
+			for( ; (pos+1U) < size ; pos++ )
+			{
+				if( data[pos] == c0 && data[pos+1U] == c1 )
+					return pos ;
+			}
+			return std::string::npos ;
+		}
 	}
 }
 
@@ -281,16 +344,14 @@ std::size_t GNet::LineStore::find( const std::string & s , std::size_t startpos
 {
 	const std::size_t npos = std::string::npos ;
 	std::size_t result = npos ;
-	if( s.size() == 2U )
+	if( s.size() >= 2U )
 	{
+		// find the leading pair (eg. CR-LF) and then check the rest
 		const char c0 = s[0] ;
 		const char c1 = s[1] ;
-		const std::size_t end = size() ;
-		for( std::size_t pos = startpos ; pos != npos ; ++pos )
+		for( std::size_t pos = findPair(c0,c1,startpos) ; pos != npos ; pos = findPair(c0,c1,pos+1U) )
 		{
-			pos = find( c0 , pos ) ;
-			if( pos == npos ) break ;
-			if( (pos+1U) != end && at(pos+1U) == c1 )
+			if( s.size() == 2U || match(s,pos) )
 			{
 				result = pos ;
 				break ;
@@ -305,11 +366,46 @@ std::size_t GNet::LineStore::find( const std::string & s , std::size_t startpos
 	}
 	else
 	{
-        result = search( s.begin() , s.end() , startpos ) ;
+		result = search( s.begin() , s.end() , startpos ) ;
 	}
 	return result ;
 }
 
+std::size_t GNet::LineStore::findPair( char c0 , char c1 , std::size_t pos ) const
+{
+	namespace imp = LineStoreImp ;
+	const std::size_t npos = std::string::npos ;
+	const std::size_t store_size = m_store.size() ;
+	if( pos < store_size )
+	{
+		std::size_t result = imp::findPair( m_store.data() , store_size , pos , c0 , c1 ) ;
+		if( result != npos )
+			return result ;
+		if( m_extra_size && m_store[store_size-1U] == c0 && m_extra_data[0] == c1 ) // straddling
+			return store_size - 1U ;
+		pos = store_size ;
+	}
+	if( m_extra_size && pos < size() )
+	{
+		std::size_t result = imp::findPair( m_extra_data , m_extra_size , pos-store_size , c0 , c1 ) ;
+		if( result != npos )
+			return store_size + result ;
+	}
+	return npos ;
+}
+
+bool GNet::LineStore::match( const std::string & s , std::size_t pos ) const
+{
+	if( (size()-pos) < s.size() )
+		return false ;
+	for( std::size_t i = 0U ; i < s.size() ; i++ )
+	{
+		if( at(pos+i) != s[i] )
+			return false ;
+	}
+	return true ;
+}
+
 std::size_t GNet::LineStore::search( std::string::const_iterator begin , std::string::const_iterator end ,
 	std::size_t startpos ) const
 {
@@ -79,7 +79,10 @@ public:
 
 	std::size_t find( const std::string & s , std::size_t startpos = 0U ) const ;
 		///< Finds the given string. Returns npos if not
-		///< found.
+		///< found. Strings of two or more characters (eg.
+		///< CR-LF) are found by a scan for the leading pair
+		///< that is vectorised (SSE2 or AVX2) where the
+		///< compiler allows.
 
 	std::size_t findSubStringAtEnd( const std::string & s , std::size_t startpos = 0U ) const ;
 		///< Tries to find some leading sub-string of 's' that
@@ -113,6 +116,8 @@ public:
 private:
 	const char * dataimp( std::size_t pos , std::size_t size ) ;
 	std::size_t search( std::string::const_iterator , std::string::const_iterator , std::size_t ) const ;
+	std::size_t findPair( char , char , std::size_t ) const ;
+	bool match( const std::string & , std::size_t ) const ;
 
 private:
 	std::string m_store ;
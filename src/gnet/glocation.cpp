@@ -24,6 +24,7 @@
 #include "gresolver.h"
 #include "gassert.h"
 #include "glog.h"
+#include <algorithm>
 
 GNet::Location::Location( const std::string & spec , int family ) :
 	m_host(head(sockless(spec))) ,
@@ -172,6 +173,7 @@ bool GNet::Location::update( const Address & address , std::nothrow_t )
 		return false ;
 
 	m_address = address ;
+	m_address_list.clear() ;
 	m_family = address.af() ; // not enum
 	m_address_valid = true ;
 	m_update_time = G::SystemTime::now() ;
@@ -179,6 +181,32 @@ bool GNet::Location::update( const Address & address , std::nothrow_t )
 	return true ;
 }
 
+void GNet::Location::update( const Address & address , const std::vector<Address> & address_list )
+{
+	update( address ) ;
+	for( const auto & a : address_list )
+	{
+		if( a.family() == Address::Family::ipv4 || a.family() == Address::Family::ipv6 )
+			m_address_list.push_back( a ) ;
+	}
+}
+
+std::vector<GNet::Address> GNet::Location::addresses() const
+{
+	if( m_address_list.empty() && m_address_valid )
+		return { m_address } ;
+	return m_address_list ;
+}
+
+void GNet::Location::select( const Address & address )
+{
+	if( std::find( m_address_list.begin() , m_address_list.end() , address ) == m_address_list.end() )
+		throw InvalidAddress( address.displayString() ) ;
+	m_address = address ;
+	m_family = address.af() ;
+	G_DEBUG( "GNet::Location::select: selected address [" << displayString() << "]" ) ;
+}
+
 std::string GNet::Location::displayString() const
 {
 	if( resolved() )
@@ -26,6 +26,7 @@
 #include "gdatetime.h"
 #include "gexception.h"
 #include <new>
+#include <vector>
 
 namespace GNet
 {
@@ -71,6 +72,7 @@ class GNet::Location
 public:
 	G_EXCEPTION( InvalidFormat , tx("invalid host:service format") )
 	G_EXCEPTION( InvalidFamily , tx("invalid address family") )
+	G_EXCEPTION( InvalidAddress , tx("invalid address") )
 
 	explicit Location( const std::string & spec , int family = AF_UNSPEC ) ;
 		///< Constructor taking a formatted "host:service" string.
@@ -117,6 +119,20 @@ public:
 		///< host() and service(). Returns false if an invalid address
 		///< family.
 
+	void update( const Address & address , const std::vector<Address> & address_list ) ;
+		///< Updates the address and also keeps the complete list of
+		///< addresses from the name lookup. Throws if an invalid address
+		///< family.
+
+	std::vector<Address> addresses() const ;
+		///< Returns the complete list of addresses from the last
+		///< update(), or just address() if no list was given.
+
+	void select( const Address & address ) ;
+		///< Changes the address to one of the other addresses(),
+		///< typically after racing connections to all of them.
+		///< Throws if not one of addresses().
+
 	bool resolved() const ;
 		///< Returns true after update() has been called or resolveTrivially()
 		///< succeeded.
@@ -151,6 +167,7 @@ private:
 	std::string m_service ;
 	bool m_address_valid ;
 	Address m_address ;
+	std::vector<Address> m_address_list ;
 	int m_family ;
 	G::SystemTime m_update_time ;
 	bool m_using_socks ;
@@ -0,0 +1,222 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gmetrics.cpp
+///
+
+#include "gdef.h"
+#include "gmetrics.h"
+#include "gassert.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+
+namespace GNet
+{
+	namespace MetricsImp
+	{
+		std::vector<Metrics::Metric*> & registry()
+		{
+			static std::vector<Metrics::Metric*> list ;
+			return list ;
+		}
+		void number( std::ostream & stream , double d )
+		{
+			// integral values without an exponent
+			if( d >= 0.0 && d < 1.0e15 && d == static_cast<double>(static_cast<unsigned long long>(d)) )
+				stream << static_cast<unsigned long long>(d) ;
+			else
+				stream << std::setprecision(10) << d ;
+		}
+	}
+}
+
+GNet::Metrics::Metric::Metric( const char * name , const char * help , const char * type , const std::string & labels ) :
+	m_name(name) ,
+	m_help(help) ,
+	m_type(type) ,
+	m_labels(labels)
+{
+	MetricsImp::registry().push_back( this ) ;
+}
+
+GNet::Metrics::Metric::~Metric()
+{
+	auto & list = MetricsImp::registry() ;
+	list.erase( std::remove( list.begin() , list.end() , this ) , list.end() ) ;
+}
+
+const char * GNet::Metrics::Metric::name() const noexcept
+{
+	return m_name ;
+}
+
+void GNet::Metrics::Metric::sample( std::ostream & stream , const char * suffix ,
+	const std::string & extra_label , double value ) const
+{
+	stream << m_name << suffix ;
+	if( !m_labels.empty() || !extra_label.empty() )
+	{
+		stream << "{" << m_labels
+			<< ( m_labels.empty() || extra_label.empty() ? "" : "," )
+			<< extra_label << "}" ;
+	}
+	stream << " " ;
+	MetricsImp::number( stream , value ) ;
+	stream << "\n" ;
+}
+
+// ==
+
+GNet::Metrics::Counter::Counter( const char * name , const char * help , const std::string & labels ) :
+	Metric(name,help,"counter",labels)
+{
+}
+
+void GNet::Metrics::Counter::add( unsigned long n ) noexcept
+{
+	m_value.fetch_add( n , std::memory_order_relaxed ) ;
+}
+
+unsigned long GNet::Metrics::Counter::value() const noexcept
+{
+	return m_value.load( std::memory_order_relaxed ) ;
+}
+
+void GNet::Metrics::Counter::output( std::ostream & stream ) const
+{
+	sample( stream , "" , {} , static_cast<double>(value()) ) ;
+}
+
+// ==
+
+GNet::Metrics::Gauge::Gauge( const char * name , const char * help , const std::string & labels ) :
+	Metric(name,help,"gauge",labels)
+{
+}
+
+GNet::Metrics::Gauge::Gauge( const char * name , const char * help , const std::string & labels ,
+	std::function<double()> fn ) :
+		Metric(name,help,"gauge",labels) ,
+		m_fn(fn)
+{
+}
+
+void GNet::Metrics::Gauge::add( long n ) noexcept
+{
+	m_value.fetch_add( n , std::memory_order_relaxed ) ;
+}
+
+void GNet::Metrics::Gauge::sub( long n ) noexcept
+{
+	m_value.fetch_sub( n , std::memory_order_relaxed ) ;
+}
+
+void GNet::Metrics::Gauge::output( std::ostream & stream ) const
+{
+	sample( stream , "" , {} , m_fn ? m_fn() : static_cast<double>(m_value.load(std::memory_order_relaxed)) ) ;
+}
+
+// ==
+
+GNet::Metrics::Histogram::Histogram( const char * name , const char * help , const std::string & labels ,
+	const std::vector<double> & bounds ) :
+		Metric(name,help,"histogram",labels) ,
+		m_bounds(bounds) ,
+		m_counts(bounds.size()+1U,0UL)
+{
+	G_ASSERT( std::is_sorted( m_bounds.begin() , m_bounds.end() ) ) ;
+}
+
+std::vector<double> GNet::Metrics::Histogram::durations()
+{
+	return { 0.005 , 0.01 , 0.025 , 0.05 , 0.1 , 0.25 , 0.5 , 1.0 , 2.5 , 5.0 , 10.0 , 30.0 , 60.0 } ;
+}
+
+void GNet::Metrics::Histogram::observe( double value )
+{
+	auto p = std::lower_bound( m_bounds.begin() , m_bounds.end() , value ) ; // first bound >= value
+	m_counts[static_cast<std::size_t>(std::distance(m_bounds.begin(),p))]++ ;
+	m_sum += value ;
+	m_count++ ;
+}
+
+void GNet::Metrics::Histogram::observe( const G::TimerTime & start )
+{
+	G::TimeInterval interval = start.interval( G::TimerTime::now() ) ;
+	observe( static_cast<double>(interval.s()) + static_cast<double>(interval.us()) / 1000000.0 ) ;
+}
+
+void GNet::Metrics::Histogram::output( std::ostream & stream ) const
+{
+	unsigned long cumulative = 0UL ;
+	for( std::size_t i = 0U ; i < m_bounds.size() ; i++ )
+	{
+		cumulative += m_counts[i] ;
+		std::ostringstream ss ;
+		ss << "le=\"" ;
+		MetricsImp::number( ss , m_bounds[i] ) ;
+		ss << "\"" ;
+		sample( stream , "_bucket" , ss.str() , static_cast<double>(cumulative) ) ;
+	}
+	sample( stream , "_bucket" , "le=\"+Inf\"" , static_cast<double>(m_count) ) ;
+	sample( stream , "_sum" , {} , m_sum ) ;
+	sample( stream , "_count" , {} , static_cast<double>(m_count) ) ;
+}
+
+// ==
+
+std::string GNet::Metrics::label( const std::string & key , const std::string & value )
+{
+	std::string result = key ;
+	result.append( "=\"" ) ;
+	for( char c : value )
+	{
+		if( c == '\\' ) result.append( "\\\\" ) ;
+		else if( c == '"' ) result.append( "\\\"" ) ;
+		else if( c == '\n' ) result.append( "\\n" ) ;
+		else result.append( 1U , c ) ;
+	}
+	result.append( 1U , '"' ) ;
+	return result ;
+}
+
+void GNet::Metrics::output( std::ostream & stream )
+{
+	// group by name, keeping registration order within each group
+	std::vector<Metric*> list = MetricsImp::registry() ;
+	std::stable_sort( list.begin() , list.end() ,
+		[](const Metric * a , const Metric * b){ return std::strcmp(a->m_name,b->m_name) < 0 ; } ) ;
+
+	const char * previous = "" ;
+	for( const Metric * metric : list )
+	{
+		if( std::strcmp( metric->m_name , previous ) != 0 )
+		{
+			stream << "# HELP " << metric->m_name << " " << metric->m_help << "\n" ;
+			stream << "# TYPE " << metric->m_name << " " << metric->m_type << "\n" ;
+			previous = metric->m_name ;
+		}
+		metric->output( stream ) ;
+	}
+}
+
+std::string GNet::Metrics::contentType()
+{
+	return "text/plain; version=0.0.4; charset=utf-8" ;
+}
@@ -0,0 +1,181 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gmetrics.h
+///
+
+#ifndef G_NET_METRICS_H
+#define G_NET_METRICS_H
+
+#include "gdef.h"
+#include "gdatetime.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace GNet
+{
+	class Metrics ;
+}
+
+//| \class GNet::Metrics
+/// A process-wide registry of counters, gauges and histograms that
+/// can be output in the Prometheus text exposition format.
+///
+/// Metric objects are typically file-scope statics in the module
+/// that updates them, so updates are cheap and need no lookup.
+/// Each metric has a name, help text and an optional label string,
+/// and metrics that share a name are output together.
+///
+/// Counters and gauges are atomic so that they can be updated from
+/// any thread. Histograms are updated only from the main thread.
+///
+/// \code
+/// static GNet::Metrics::Counter widgets( "widgets_total" , "Widgets made" ) ;
+/// void makeWidget() { ... ; widgets.add() ; }
+/// \endcode
+///
+/// \see GSmtp::MetricsServer
+///
+class GNet::Metrics
+{
+public:
+	class Metric /// A base class for GNet::Metrics counters, gauges and histograms.
+	{
+	public:
+		Metric( const char * name , const char * help , const char * type , const std::string & labels ) ;
+			///< Constructor. Registers itself with the Metrics
+			///< registry.
+
+		virtual ~Metric() ;
+			///< Destructor. Unregisters itself.
+
+		const char * name() const noexcept ;
+			///< Returns the metric name.
+
+		virtual void output( std::ostream & ) const = 0 ;
+			///< Outputs the sample lines.
+
+	protected:
+		void sample( std::ostream & , const char * suffix , const std::string & extra_label , double value ) const ;
+			///< Outputs one sample line.
+
+	private:
+		friend class Metrics ;
+		const char * m_name ;
+		const char * m_help ;
+		const char * m_type ;
+		std::string m_labels ;
+
+	public:
+		Metric( const Metric & ) = delete ;
+		Metric( Metric && ) = delete ;
+		Metric & operator=( const Metric & ) = delete ;
+		Metric & operator=( Metric && ) = delete ;
+	} ;
+
+	class Counter : public Metric /// A monotonic counter.
+	{
+	public:
+		Counter( const char * name , const char * help , const std::string & labels = {} ) ;
+			///< Constructor. The name should have a "_total" suffix.
+
+		void add( unsigned long n = 1UL ) noexcept ;
+			///< Increments the counter.
+
+		unsigned long value() const noexcept ;
+			///< Returns the counter value.
+
+	private:
+		void output( std::ostream & ) const override ;
+
+	private:
+		std::atomic<unsigned long> m_value {0UL} ;
+	} ;
+
+	class Gauge : public Metric /// A gauge that can go up and down, or one that is sampled from a callback function.
+	{
+	public:
+		Gauge( const char * name , const char * help , const std::string & labels = {} ) ;
+			///< Constructor.
+
+		Gauge( const char * name , const char * help , const std::string & labels , std::function<double()> ) ;
+			///< Constructor for a gauge whose value comes from the
+			///< given function each time it is output.
+
+		void add( long n = 1L ) noexcept ;
+			///< Increments the gauge.
+
+		void sub( long n = 1L ) noexcept ;
+			///< Decrements the gauge.
+
+	private:
+		void output( std::ostream & ) const override ;
+
+	private:
+		std::atomic<long> m_value {0L} ;
+		std::function<double()> m_fn ;
+	} ;
+
+	class Histogram : public Metric /// A histogram of observed values, typically durations in seconds.
+	{
+	public:
+		Histogram( const char * name , const char * help , const std::string & labels ,
+			const std::vector<double> & bounds = durations() ) ;
+				///< Constructor. The bounds are the upper bucket
+				///< boundaries, in increasing order.
+
+		void observe( double ) ;
+			///< Adds an observation.
+
+		void observe( const G::TimerTime & start ) ;
+			///< Adds an observation of the time elapsed since the
+			///< given start time, in seconds.
+
+		static std::vector<double> durations() ;
+			///< Returns a default set of bucket boundaries for
+			///< durations in seconds.
+
+	private:
+		void output( std::ostream & ) const override ;
+
+	private:
+		std::vector<double> m_bounds ;
+		std::vector<unsigned long> m_counts ; // non-cumulative, plus +Inf
+		double m_sum {0.0} ;
+		unsigned long m_count {0UL} ;
+	} ;
+
+	static std::string label( const std::string & key , const std::string & value ) ;
+		///< Returns a formatted label string, with escaping as
+		///< necessary, for passing to a metric constructor. Labels
+		///< can be comma-separated.
+
+	static void output( std::ostream & ) ;
+		///< Outputs all registered metrics in the Prometheus
+		///< text exposition format.
+
+	static std::string contentType() ;
+		///< Returns the HTTP content type for the output().
+
+public:
+	Metrics() = delete ;
+} ;
+
+#endif
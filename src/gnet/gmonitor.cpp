@@ -20,6 +20,8 @@
 
 #include "gdef.h"
 #include "gmonitor.h"
+#include "geventloopstats.h"
+#include "gmetrics.h"
 #include "ggettext.h"
 #include "gstr.h"
 #include "gassert.h"
@@ -71,6 +73,10 @@ private:
 	unsigned long m_client_removes {0UL} ;
 	unsigned long m_server_peer_adds {0UL} ;
 	unsigned long m_server_peer_removes {0UL} ;
+	Metrics::Counter m_metric_accepted ;
+	Metrics::Counter m_metric_connected ;
+	Metrics::Gauge m_metric_active_in ;
+	Metrics::Gauge m_metric_active_out ;
 } ;
 
 GNet::Monitor * & GNet::Monitor::pthis() noexcept
@@ -159,6 +165,7 @@ void GNet::Monitor::removeServer( const Listener & server ) noexcept
 void GNet::Monitor::report( std::ostream & s , const std::string & px , const std::string & eol ) const
 {
 	m_imp->report( s , px , eol ) ;
+	EventLoopStats::report( s , px , eol ) ;
 }
 
 #ifndef G_LIB_SMALL
@@ -170,7 +177,11 @@ void GNet::Monitor::report( G::StringArray & out ) const
 
 // ==
 
-GNet::MonitorImp::MonitorImp( Monitor & )
+GNet::MonitorImp::MonitorImp( Monitor & ) :
+	m_metric_accepted("emailrelay_connections_accepted_total","Incoming connections accepted") ,
+	m_metric_connected("emailrelay_connections_made_total","Outgoing connections made") ,
+	m_metric_active_in("emailrelay_connections_active","Current connections",Metrics::label("direction","in")) ,
+	m_metric_active_out("emailrelay_connections_active","Current connections",Metrics::label("direction","out"))
 {
 }
 
@@ -180,9 +191,17 @@ void GNet::MonitorImp::add( const Connection & connection , bool is_client )
 	if( inserted )
 	{
 		if( is_client )
+		{
 			m_client_adds++ ;
+			m_metric_connected.add() ;
+			m_metric_active_out.add() ;
+		}
 		else
+		{
 			m_server_peer_adds++ ;
+			m_metric_accepted.add() ;
+			m_metric_active_in.add() ;
+		}
 	}
 }
 
@@ -208,9 +227,15 @@ void GNet::MonitorImp::remove( const Connection & connection , bool is_client )
 	if( removed )
 	{
 		if( is_client )
+		{
 			m_client_removes++ ;
+			m_metric_active_out.sub() ;
+		}
 		else
+		{
 			m_server_peer_removes++ ;
+			m_metric_active_in.sub() ;
+		}
 	}
 }
 
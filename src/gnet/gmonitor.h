@@ -73,7 +73,8 @@ public:
 	void report( std::ostream & stream ,
 		const std::string & line_prefix = {} ,
 		const std::string & eol = std::string("\n") ) const ;
-			///< Reports itself onto a stream.
+			///< Reports itself onto a stream, including any event
+			///< loop statistics (see GNet::EventLoopStats).
 
 	void report( G::StringArray & out ) const ;
 		///< Reports itself into a three-column table (ordered
@@ -78,23 +78,39 @@ GNet::MultiServer::MultiServer( EventState es , const G::StringArray & listener_
 		createServer( a , true ) ;
 	for( const auto & a : listeners.dynamic() )
 		createServer( a , false ) ;
+
+	Handover::add( *this ) ; // last, in case of exceptions
 }
 
 GNet::MultiServer::~MultiServer()
 {
+	Handover::remove( *this ) ;
 	serverCleanup() ;
 }
 
 void GNet::MultiServer::createServer( Descriptor fd )
 {
 	m_server_list.emplace_back( std::make_unique<MultiServerImp>( *this , m_es ,
-		fd , m_server_peer_config , m_server_config ) ) ;
+		true , true , fd , m_server_peer_config , m_server_config ) ) ;
 }
 
 void GNet::MultiServer::createServer( const Address & address , bool fixed )
 {
-	m_server_list.emplace_back( std::make_unique<MultiServerImp>( *this , m_es ,
-		fixed , address , m_server_peer_config , m_server_config ) ) ;
+	// use a listening socket handed over from a previous instance if
+	// there is one, rather than binding a new one
+	Descriptor fd = Handover::take( m_server_type , address ) ;
+	if( fd.validfd() )
+	{
+		G_LOG( "GNet::MultiServer::createServer: using handed-over listening socket for "
+			<< m_server_type << " server on " << displayString(address) ) ;
+		m_server_list.emplace_back( std::make_unique<MultiServerImp>( *this , m_es ,
+			fixed , false , fd , m_server_peer_config , m_server_config ) ) ;
+	}
+	else
+	{
+		m_server_list.emplace_back( std::make_unique<MultiServerImp>( *this , m_es ,
+			fixed , address , m_server_peer_config , m_server_config ) ) ;
+	}
 }
 
 void GNet::MultiServer::createServer( const Address & address , bool fixed , std::nothrow_t )
@@ -132,6 +148,9 @@ void GNet::MultiServer::onInterfaceEvent( const std::string & /*description*/ )
 
 void GNet::MultiServer::onInterfaceEventTimeout()
 {
+	if( m_stopped )
+		return ;
+
 	// get a fresh address list
 	Listeners listeners( m_if , m_listener_list , m_port ) ;
 
@@ -199,6 +218,38 @@ void GNet::MultiServer::serverReport( const std::string & group ) const
 	}
 }
 
+std::string GNet::MultiServer::type() const
+{
+	return m_server_type ;
+}
+
+void GNet::MultiServer::handoverItems( std::vector<Handover::Item> & items ) const
+{
+	for( const auto & server : m_server_list )
+	{
+		G_ASSERT( server.get() != nullptr ) ;
+		if( !server ) continue ;
+		Handover::Item item ;
+		item.type = m_server_type ;
+		item.address = server->address().displayString() ;
+		item.fd = server->listeningFd() ;
+		item.inherited = server->inherited() ;
+		items.push_back( item ) ;
+	}
+}
+
+void GNet::MultiServer::stopListening()
+{
+	m_stopped = true ;
+	m_interface_event_timer.cancelTimer() ;
+	for( auto & server : m_server_list )
+	{
+		G_ASSERT( server.get() != nullptr ) ;
+		if( !server ) continue ;
+		server->stopListening() ;
+	}
+}
+
 std::unique_ptr<GNet::ServerPeer> GNet::MultiServer::doNewPeer( EventStateUnbound esu ,
 	ServerPeerInfo && pi , const ServerInfo & si )
 {
@@ -241,11 +292,12 @@ GNet::MultiServerImp::MultiServerImp( MultiServer & ms , EventState es , bool fi
 {
 }
 
-GNet::MultiServerImp::MultiServerImp( MultiServer & ms , EventState es , Descriptor fd ,
-	ServerPeer::Config server_peer_config , Server::Config server_config ) :
+GNet::MultiServerImp::MultiServerImp( MultiServer & ms , EventState es , bool fixed , bool inherited ,
+	Descriptor fd , ServerPeer::Config server_peer_config , Server::Config server_config ) :
 		GNet::Server(es,fd,server_peer_config,server_config) ,
 		m_ms(ms) ,
-		m_fixed(true)
+		m_fixed(fixed) ,
+		m_inherited(inherited)
 {
 }
 
@@ -257,6 +309,11 @@ bool GNet::MultiServerImp::dynamic() const
 	return !m_fixed ;
 }
 
+bool GNet::MultiServerImp::inherited() const
+{
+	return m_inherited ;
+}
+
 void GNet::MultiServerImp::cleanup()
 {
 	serverCleanup() ;
@@ -24,6 +24,7 @@
 #include "gdef.h"
 #include "gevent.h"
 #include "gserver.h"
+#include "ghandover.h"
 #include "gtimer.h"
 #include "ginterfaces.h"
 #include "gexception.h"
@@ -81,6 +82,18 @@ public:
 		///< The returned ServerPeer objects must not outlive
 		///< this MultiServer.
 
+	std::string type() const ;
+		///< Returns the server type, as passed to the constructor.
+
+	void handoverItems( std::vector<Handover::Item> & ) const ;
+		///< Appends a description of each listening socket.
+		///< Used by GNet::Handover.
+
+	void stopListening() ;
+		///< Stops accepting new connections on all addresses
+		///< and stops responding to interface changes.
+		///< Used by GNet::Handover.
+
 	std::unique_ptr<ServerPeer> doNewPeer( EventStateUnbound , ServerPeerInfo && , const ServerInfo & ) ;
 		///< Pseudo-private method used by the pimple class.
 
@@ -130,6 +143,7 @@ private:
 	Interfaces m_if ;
 	ServerList m_server_list ;
 	Timer<MultiServer> m_interface_event_timer ;
+	bool m_stopped {false} ;
 } ;
 
 //| \class GNet::MultiServerImp
@@ -141,8 +155,10 @@ public:
 	MultiServerImp( MultiServer & , EventState , bool fixed , const Address & , ServerPeer::Config , Server::Config ) ;
 		///< Constructor.
 
-	MultiServerImp( MultiServer & , EventState , Descriptor , ServerPeer::Config , Server::Config ) ;
-		///< Constructor.
+	MultiServerImp( MultiServer & , EventState , bool fixed , bool inherited , Descriptor ,
+		ServerPeer::Config , Server::Config ) ;
+			///< Constructor taking an inherited or handed-over
+			///< listening socket.
 
 	~MultiServerImp() override ;
 		///< Destructor.
@@ -156,6 +172,10 @@ public:
 	bool dynamic() const ;
 		///< Returns true if not a fixed address, as passed in to ctor.
 
+	bool inherited() const ;
+		///< Returns true if the listening socket was inherited
+		///< as a "fd#<n>" listener.
+
 public:
 	MultiServerImp( const MultiServerImp & ) = delete ;
 	MultiServerImp( MultiServerImp && ) = delete ;
@@ -165,6 +185,7 @@ public:
 private:
 	MultiServer & m_ms ;
 	bool m_fixed ;
+	bool m_inherited {false} ;
 } ;
 
 #endif
@@ -23,12 +23,23 @@
 
 #include "gdef.h"
 #include "gaddress.h"
+#include "gstringarray.h"
 #include <vector>
 #include <string>
 
 namespace GNet
 {
+	struct DnsSearch /// The host-name search list from the system's resolver configuration.
+	{
+		G::StringArray domains ; // eg. from "search" or "domain" in resolv.conf
+		unsigned int ndots {1U} ; // names with fewer dots are searched before being tried as-is
+	} ;
+
 	std::vector<Address> nameservers( unsigned int port = 53U ) ;
+		///< Returns the system's nameserver addresses.
+
+	DnsSearch dnsSearch() ;
+		///< Returns the system's host-name search list.
 }
 
 #endif
@@ -24,6 +24,7 @@
 #include "gstringview.h"
 #include "gstringtoken.h"
 #include <fstream>
+#include <algorithm>
 
 std::vector<GNet::Address> GNet::nameservers( unsigned int port )
 {
@@ -44,3 +45,33 @@ std::vector<GNet::Address> GNet::nameservers( unsigned int port )
 	return result ;
 }
 
+
+GNet::DnsSearch GNet::dnsSearch()
+{
+	// the last "search" or "domain" line wins, as for res_init()
+	DnsSearch result ;
+	std::string line ;
+	std::ifstream f( "/etc/resolv.conf" ) ;
+	while( G::Str::readLine( f , line ) )
+	{
+		G::StringArray words = G::Str::splitIntoTokens( G::Str::head(line,"#",false) , " \t" ) ;
+		if( words.size() >= 2U && ( G::Str::imatch(words[0],"search") || G::Str::imatch(words[0],"domain") ) )
+		{
+			result.domains.assign( words.begin()+1 , words.end() ) ;
+			if( G::Str::imatch(words[0],"domain") )
+				result.domains.resize( 1U ) ;
+		}
+		else if( words.size() >= 2U && G::Str::imatch(words[0],"options") )
+		{
+			for( std::size_t i = 1U ; i < words.size() ; i++ )
+			{
+				if( G::Str::headMatch(words[i],"ndots:") && G::Str::isUInt(words[i].substr(6U)) )
+					result.ndots = std::min( 15U , G::Str::toUInt(words[i].substr(6U),G::Str::Limited()) ) ;
+			}
+		}
+	}
+	for( auto & domain : result.domains )
+		G::Str::trimRight( domain , "." ) ;
+	result.domains.erase( std::remove( result.domains.begin() , result.domains.end() , std::string() ) , result.domains.end() ) ;
+	return result ;
+}
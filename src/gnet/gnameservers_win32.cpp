@@ -61,3 +61,21 @@ std::vector<GNet::Address> GNet::nameservers( unsigned int port )
 	return result ;
 }
 
+
+GNet::DnsSearch GNet::dnsSearch()
+{
+	DnsSearch result ;
+	G::Buffer<char> info_buffer( sizeof(FIXED_INFO) ) ;
+	FIXED_INFO * info = G::buffer_cast<FIXED_INFO*>( info_buffer ) ;
+	ULONG size = sizeof(FIXED_INFO) ;
+	auto rc = GetNetworkParams( info , &size ) ;
+	if( rc == ERROR_BUFFER_OVERFLOW )
+	{
+		info_buffer.resize( size == ULONG(0) ? std::size_t(1U) : static_cast<std::size_t>(size) ) ;
+		info = G::buffer_cast<FIXED_INFO*>( info_buffer ) ;
+		rc = GetNetworkParams( info , &size ) ;
+	}
+	if( rc == NO_ERROR && info->DomainName[0] != '\0' )
+		result.domains.emplace_back( info->DomainName ) ;
+	return result ;
+}
@@ -21,48 +21,64 @@
 #include "gdef.h"
 #include "gresolver.h"
 #include "gresolverfuture.h"
+#include "gdnsresolver.h"
 #include "geventloop.h"
 #include "gtimer.h"
 #include "gfutureevent.h"
-#include "gcleanup.h"
+#include "gworkerpool.h"
+#include "gmetrics.h"
+#include "glimits.h"
 #include "gtest.h"
 #include "gstr.h"
 #include "glog.h"
 #include "gassert.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <sstream>
+
+namespace GNet
+{
+	class ResolverCache ;
+}
 
 //| \class GNet::ResolverImp
 /// A private "pimple" implementation class used by GNet::Resolver to do
-/// asynchronous name resolution. The ResolverImp object contains a worker
-/// thread that runs ResolverFuture::run(). The ResolverImp object's
-/// lifetime is dependent on the worker thread, so the best the
-/// GNet::Resolver class can do to cancel a resolve request is to
-/// ask the ResolverImp to delete itself and then forget about it.
+/// asynchronous name resolution. The ResolverImp object is queued onto
+/// a GNet::WorkerPool where a worker thread runs ResolverFuture::run().
+/// The pool is a never-deleted singleton with up to
+/// G::Limits::resolver_threads threads since getaddrinfo() can block
+/// indefinitely.
+/// The ResolverImp object's lifetime is dependent on the worker thread,
+/// so the best the GNet::Resolver class can do to cancel a resolve request
+/// that has already started is to ask the ResolverImp to delete itself
+/// and then forget about it.
 ///
-class GNet::ResolverImp : private FutureEventHandler
+class GNet::ResolverImp : private FutureEventHandler , private WorkerPoolJob
 {
 public:
 	ResolverImp( Resolver & , EventState , const Location & , const Resolver::Config & ) ;
-		// Constructor.
+		// Constructor. Queues the request onto the worker thread pool.
 
 	~ResolverImp() override ;
-		// Destructor. The destructor will block if the worker thread is
-		// still busy.
+		// Destructor.
 
 	bool zombify() ;
-		// Disarms the callback and schedules a 'delete this' for when
-		// the workder thread has finished.
-
-	static void start( ResolverImp * , HANDLE ) noexcept ;
-		// Static worker-thread function to do name resolution. Calls
-		// ResolverFuture::run() to do the work and then FutureEvent::send()
-		// to signal the main thread. The event plumbing then results in a
-		// call to Resolver::done() on the main thread.
+		// Disarms the callback. Returns false if the request was still
+		// queued, in which case it is cancelled and the object can be
+		// deleted straight away. Otherwise returns true and schedules
+		// a 'delete this' for when the worker thread has finished.
 
 	static std::size_t zcount() noexcept ;
 		// Returns the number of zombify()d objects.
 
+	static WorkerPool & pool() ;
+		// Returns a reference to the worker pool singleton.
+
 private: // overrides
 	void onFutureEvent() override ; // GNet::FutureEventHandler
+	void workerRun() noexcept override ; // GNet::WorkerPoolJob
+	void workerDone() noexcept override ; // GNet::WorkerPoolJob
 
 public:
 	ResolverImp( const ResolverImp & ) = delete ;
@@ -76,116 +92,244 @@ private:
 private:
 	Resolver * m_resolver ;
 	std::unique_ptr<FutureEvent> m_future_event ;
+	HANDLE m_handle ;
 	Timer<ResolverImp> m_timer ;
 	Location m_location ;
+	Resolver::Config m_config ;
 	ResolverFuture m_future ;
-	G::threading::thread_type m_thread ;
 	static std::size_t m_zcount ;
 } ;
 
+//| \class GNet::ResolverCache
+/// A private singleton class used by GNet::Resolver that caches the results
+/// of getaddrinfo() calls for a short time. The cache is only used by the
+/// main thread. The number of entries is limited by G::Limits::resolver_cache,
+/// with an expiry-ordered index so that trimming does not scan every entry.
+///
+class GNet::ResolverCache
+{
+public:
+	struct ExpiryLess /// A comparison functor for G::TimerTime.
+	{
+		bool operator()( const G::TimerTime & a , const G::TimerTime & b ) const noexcept
+		{
+			return G::TimerTime::less( a , b ) ;
+		}
+	} ;
+	using Index = std::multimap<G::TimerTime,std::string,ExpiryLess> ;
+	struct Entry /// A GNet::ResolverCache entry.
+	{
+		std::string reason ; // error
+		Resolver::AddressList list ;
+		std::string canonical_name ;
+		G::TimerTime expiry ;
+		Index::iterator index_pos ;
+	} ;
+
+	static ResolverCache & instance() ;
+		// Returns a reference to the singleton.
+
+	static std::string key( const std::string & host , const std::string & service ,
+		int family , const Resolver::Config & , bool sync = false ) ;
+			// Returns a cache key, or the empty string if not cacheable.
+
+	const Entry * find( const std::string & key ) ;
+		// Returns an unexpired cache entry or nullptr.
+
+	void add( const std::string & key , const std::string & reason ,
+		const Resolver::AddressList & , const std::string & canonical_name ,
+		const Resolver::Config & , unsigned int ttl_limit = UINT_MAX ) ;
+			// Adds a cache entry.
+
+	void report( std::ostream & , const std::string & , const std::string & ) const ;
+		// Reports statistics.
+
+private:
+	void trim( G::TimerTime now ) ;
+
+private:
+	std::map<std::string,Entry> m_map ;
+	Index m_index ; // expiry -> key
+	unsigned long m_hits {0UL} ;
+	unsigned long m_misses {0UL} ;
+	Metrics::Counter m_metric_hits {"emailrelay_dns_cache_hits_total","Address lookups answered from the cache"} ;
+	Metrics::Counter m_metric_misses {"emailrelay_dns_cache_misses_total","Address lookups not answered from the cache"} ;
+} ;
+
+// ==
+
 std::size_t GNet::ResolverImp::m_zcount = 0U ;
 
 GNet::ResolverImp::ResolverImp( Resolver & resolver , EventState es , const Location & location , const Resolver::Config & config ) :
 	m_resolver(&resolver) ,
 	m_future_event(std::make_unique<FutureEvent>(static_cast<FutureEventHandler&>(*this),es)) ,
+	m_handle(m_future_event->handle()) ,
 	m_timer(*this,&ResolverImp::onTimeout,es) ,
 	m_location(location) ,
+	m_config(config) ,
 	m_future(location.host(),location.service(),location.family(),config)
 {
 	G_ASSERT( G::threading::works() ) ; // see Resolver::start()
-	G::Cleanup::Block block_signals ;
-	m_thread = G::threading::thread_type( ResolverImp::start , this , m_future_event->handle() ) ;
+	pool().submit( this ) ;
 }
 
 GNet::ResolverImp::~ResolverImp()
-{
-	try
-	{
-		// (should be already join()ed)
-		if( m_thread.joinable() )
-			m_thread.join() ;
-	}
-	catch(...)
-	{
-	}
-}
+= default;
 
 std::size_t GNet::ResolverImp::zcount() noexcept
 {
 	return m_zcount ;
 }
 
-void GNet::ResolverImp::start( ResolverImp * This , HANDLE handle ) noexcept
+GNet::WorkerPool & GNet::ResolverImp::pool()
 {
-	// thread function, spawned from ctor and join()ed from dtor
-	try
-	{
-		This->m_future.run() ;
-		FutureEvent::send( handle ) ;
-	}
-	catch(...) // worker thread outer function
-	{
-		// never gets here -- run and send are noexcept
-		FutureEvent::send( handle ) ;
-	}
+	static WorkerPool * pool = new WorkerPool( G::Limits<>::resolver_threads ) ; // NOLINT never deleted
+	return *pool ;
+}
+
+void GNet::ResolverImp::workerRun() noexcept
+{
+	// worker thread
+	m_future.run() ;
+}
+
+void GNet::ResolverImp::workerDone() noexcept
+{
+	// worker thread
+	FutureEvent::send( m_handle ) ;
 }
 
 void GNet::ResolverImp::onFutureEvent()
 {
 	G_DEBUG( "GNet::ResolverImp::onFutureEvent: future event: ptr=" << m_resolver ) ;
 
+	pool().sync() ;
 	ResolverFuture::Result result = m_future.get() ;
+	Resolver::AddressList list ;
+	m_future.get( list ) ;
 	if( !m_future.error() )
-		m_location.update( result.address ) ;
+		m_location.update( result.address , list ) ;
 
-	if( m_thread.joinable() )
-		m_thread.join() ; // worker thread is finishing, so no delay here
+	ResolverCache::instance().add( ResolverCache::key(m_location.host(),m_location.service(),m_location.family(),m_config) ,
+		m_future.reason() , list , result.canonicalName , m_config ) ;
 
 	Resolver * resolver = m_resolver ;
 	m_resolver = nullptr ;
 	if( resolver )
 		resolver->done( std::string(m_future.reason()) , Location(m_location) ) ; // must take copies
+	else
+		m_timer.startTimer( 0U ) ;
 }
 
 bool GNet::ResolverImp::zombify()
 {
 	m_resolver = nullptr ;
-	m_timer.startTimer( 0U ) ;
+	if( pool().cancel( this ) )
+		return false ;
 	m_zcount++ ;
 	return true ;
 }
 
 void GNet::ResolverImp::onTimeout()
 {
-	if( m_thread.joinable() )
+	delete this ; // (previously unique_ptr<>::release()d)
+	m_zcount-- ;
+}
+
+// ==
+
+GNet::ResolverCache & GNet::ResolverCache::instance()
+{
+	static ResolverCache cache ;
+	return cache ;
+}
+
+std::string GNet::ResolverCache::key( const std::string & host , const std::string & service ,
+	int family , const Resolver::Config & config , bool sync )
+{
+	if( config.cache_ttl == 0U || config.test_slow || ( sync && !config.sync_cache ) )
+		return {} ;
+	std::ostringstream ss ;
+	ss << host << '\0' << service << '\0' << family << '\0'
+		<< config.with_canonical_name << config.raw << config.datagram << config.idn_flag ;
+	return ss.str() ;
+}
+
+const GNet::ResolverCache::Entry * GNet::ResolverCache::find( const std::string & key )
+{
+	if( key.empty() )
+		return nullptr ;
+	auto p = m_map.find( key ) ;
+	if( p != m_map.end() && G::TimerTime::now() <= p->second.expiry )
 	{
-		m_timer.startTimer( 1U ) ;
+		m_hits++ ;
+		m_metric_hits.add() ;
+		return &(*p).second ;
 	}
-	else
+	m_misses++ ;
+	m_metric_misses.add() ;
+	return nullptr ;
+}
+
+void GNet::ResolverCache::add( const std::string & key , const std::string & reason ,
+	const Resolver::AddressList & list , const std::string & canonical_name ,
+	const Resolver::Config & config , unsigned int ttl_limit )
+{
+	unsigned int ttl = std::min( ttl_limit , reason.empty() ? config.cache_ttl : config.cache_negative_ttl ) ;
+	if( key.empty() || ttl == 0U )
+		return ;
+	G::TimerTime now = G::TimerTime::now() ;
+	auto p = m_map.find( key ) ;
+	if( p != m_map.end() )
 	{
-		delete this ; // (previously unique_ptr<>::release()d)
-		m_zcount-- ;
+		m_index.erase( p->second.index_pos ) ;
+		m_map.erase( p ) ;
 	}
+	trim( now ) ;
+	G::TimerTime expiry = now + G::TimeInterval(ttl) ;
+	m_map.insert( {key,Entry{reason,list,canonical_name,expiry,m_index.insert({expiry,key})}} ) ;
+}
+
+void GNet::ResolverCache::trim( G::TimerTime now )
+{
+	// remove expired entries, and then the soonest to expire if still full
+	const std::size_t limit = static_cast<std::size_t>( G::Limits<>::resolver_cache ) ;
+	if( m_map.size() < limit )
+		return ;
+	while( !m_index.empty() && ( m_map.size() >= limit || !G::TimerTime::less( now , m_index.begin()->first ) ) )
+	{
+		m_map.erase( m_index.begin()->second ) ;
+		m_index.erase( m_index.begin() ) ;
+	}
+}
+
+void GNet::ResolverCache::report( std::ostream & s , const std::string & px , const std::string & eol ) const
+{
+	using G::txt ;
+	s << px << txt("DNS cache entries: ") << m_map.size() << eol ;
+	s << px << txt("DNS cache hits: ") << m_hits << eol ;
+	s << px << txt("DNS cache misses: ") << m_misses << eol ;
 }
 
 // ==
 
 GNet::Resolver::Resolver( Resolver::Callback & callback , EventState es ) :
 	m_callback(callback) ,
-	m_es(es)
+	m_es(es) ,
+	m_timer(*this,&Resolver::onTimeout,m_es)
 {
 	// lazy imp construction
 }
 
 GNet::Resolver::~Resolver()
 {
+	if( m_dns )
+		m_dns->doneSignal().disconnect() ;
 	if( m_imp && m_imp->zombify() )
 	{
+		// a worker thread is still busy with it, so release the
+		// imp until its getaddrinfo() call completes
 		G_DEBUG( "GNet::Resolver::dtor: zcount=" << ResolverImp::zcount() ) ;
-		if( ResolverImp::zcount() == 100U )
-			G_WARNING_ONCE( "GNet::Resolver::dtor: large number of threads waiting for dns results" ) ;
-
-		// release the imp to the timer-list until its getaddrinfo() thread completes
 		GDEF_IGNORE_RETURN m_imp.release() ;
 	}
 }
@@ -201,9 +345,21 @@ std::pair<std::string,std::string> GNet::Resolver::resolve( Location & location
 	using Result = ResolverFuture::Result ;
 	G_DEBUG( "GNet::Resolver::resolve: resolve request [" << location.displayString() << "]"
 		<< " (" << location.family() << ")" ) ;
+	std::string key = ResolverCache::key( location.host() , location.service() , location.family() , config , true ) ;
+	const ResolverCache::Entry * entry = ResolverCache::instance().find( key ) ;
+	if( entry )
+	{
+		G_DEBUG( "GNet::Resolver::resolve: resolve result from cache: [" << entry->reason << "]" ) ;
+		if( entry->reason.empty() )
+			location.update( entry->list.at(0U) , entry->list ) ;
+		return { entry->reason , entry->reason.empty() ? entry->canonical_name : std::string() } ;
+	}
 	ResolverFuture future( location.host() , location.service() , location.family() , config ) ;
 	future.run() ; // blocks until complete
 	Result result = future.get() ;
+	AddressList list ;
+	future.get( list ) ;
+	ResolverCache::instance().add( key , future.reason() , list , result.canonicalName , config ) ;
 	if( future.error() )
 	{
 		G_DEBUG( "GNet::Resolver::resolve: resolve error [" << future.reason() << "]" ) ;
@@ -212,7 +368,7 @@ std::pair<std::string,std::string> GNet::Resolver::resolve( Location & location
 	else
 	{
 		G_DEBUG( "GNet::Resolver::resolve: resolve result [" << result.address.displayString() << "]" ) ;
-		location.update( result.address ) ;
+		location.update( result.address , list ) ;
 		return {{},result.canonicalName} ;
 	}
 }
@@ -224,10 +380,16 @@ GNet::Resolver::AddressList GNet::Resolver::resolve( const std::string & host ,
 	// synchronous resolve
 	G_DEBUG( "GNet::Resolver::resolve: resolve-request [" << host << "/"
 		<< service << "/" << (family==AF_UNSPEC?"ip":(family==AF_INET?"ipv4":"ipv6")) << "]" ) ;
+	std::string key = ResolverCache::key( host , service , family , config , true ) ;
+	const ResolverCache::Entry * entry = ResolverCache::instance().find( key ) ;
+	if( entry )
+		return entry->list ;
 	ResolverFuture future( host , service , family , config ) ;
 	future.run() ;
+	ResolverFuture::Result result = future.get() ;
 	AddressList list ;
 	future.get( list ) ;
+	ResolverCache::instance().add( key , future.reason() , list , result.canonicalName , config ) ;
 	G_DEBUG( "GNet::Resolver::resolve: resolve result: list of " << list.size() ) ;
 	return list ;
 }
@@ -237,10 +399,64 @@ void GNet::Resolver::start( const Location & location , const Config & config )
 {
 	// asynchronous resolve
 	if( !EventLoop::instance().running() ) throw Error( "no event loop" ) ;
-	if( !async() ) throw Error( "not multi-threaded" ) ; // precondition
+	if( !async() && !native(location,config) ) throw Error( "not multi-threaded" ) ; // precondition
 	if( busy() ) throw BusyError() ;
 	G_DEBUG( "GNet::Resolver::start: resolve start [" << location.displayString() << "]" ) ;
-	m_imp = std::make_unique<ResolverImp>( *this , m_es , location , config ) ;
+	std::string key = ResolverCache::key( location.host() , location.service() , location.family() , config ) ;
+	const ResolverCache::Entry * entry = ResolverCache::instance().find( key ) ;
+	if( entry )
+	{
+		// deliver the cached result asynchronously
+		m_cached_error = entry->reason ;
+		m_location = std::make_unique<Location>( location ) ;
+		if( entry->reason.empty() )
+			m_location->update( entry->list.at(0U) , entry->list ) ;
+		m_timer.startTimer( 0U ) ;
+	}
+	else if( native(location,config) )
+	{
+		// talk to the nameservers directly from the event loop
+		if( !m_dns )
+		{
+			m_dns = std::make_unique<DnsResolver>( m_es , DnsResolver::Config() ) ;
+			m_dns->doneSignal().connect( G::Slot::slot(*this,&Resolver::onDnsDone) ) ;
+		}
+		m_config = config ;
+		m_location = std::make_unique<Location>( location ) ;
+		m_dns->start( ResolverFuture::encode(location.host(),config.raw) ,
+			G::Str::toUInt(location.service()) , location.family() ) ;
+	}
+	else
+	{
+		m_imp = std::make_unique<ResolverImp>( *this , m_es , location , config ) ;
+	}
+}
+
+bool GNet::Resolver::native( const Location & location , const Config & config )
+{
+	// the native resolver only does numeric services and no canonical names
+	return config.native && !config.with_canonical_name && !config.test_slow &&
+		G::Str::isUInt( location.service() ) ;
+}
+
+void GNet::Resolver::onTimeout()
+{
+	G_ASSERT( m_location != nullptr ) ;
+	Location location = *m_location ;
+	m_location.reset() ;
+	done( std::string(m_cached_error) , location ) ;
+}
+
+void GNet::Resolver::onDnsDone( const std::string & error , const AddressList & list , unsigned int ttl )
+{
+	G_ASSERT( m_location != nullptr ) ;
+	Location location = *m_location ;
+	m_location.reset() ;
+	ResolverCache::instance().add( ResolverCache::key(location.host(),location.service(),location.family(),m_config) ,
+		error , list , {} , m_config , ttl ) ;
+	if( error.empty() )
+		location.update( list.at(0U) , list ) ;
+	done( error , location ) ;
 }
 
 void GNet::Resolver::done( const std::string & error , const Location & location )
@@ -254,7 +470,22 @@ void GNet::Resolver::done( const std::string & error , const Location & location
 
 bool GNet::Resolver::busy() const
 {
-	return m_imp != nullptr ;
+	return m_imp != nullptr || m_location != nullptr ;
+}
+
+void GNet::Resolver::report( std::ostream & stream , const std::string & px , const std::string & eol )
+{
+	if( G::threading::works() )
+	{
+		using G::txt ;
+		WorkerPool::Stats stats = ResolverImp::pool().stats() ;
+		stream << px << txt("DNS threads: ") << stats.threads << eol ;
+		stream << px << txt("DNS requests: ") << stats.jobs << eol ;
+		stream << px << txt("DNS requests active: ") << stats.running << eol ;
+		stream << px << txt("DNS requests queued: ") << stats.queued << eol ;
+	}
+	ResolverCache::instance().report( stream , px , eol ) ;
+	DnsResolver::report( stream , px , eol ) ;
 }
 
 bool GNet::Resolver::async()
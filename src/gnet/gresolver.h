@@ -27,21 +27,33 @@
 #include "geventstate.h"
 #include "gexception.h"
 #include "gaddress.h"
+#include "gtimer.h"
 #include <vector>
 #include <utility>
 #include <memory>
+#include <iostream>
 
 namespace GNet
 {
 	class Resolver ;
 	class ResolverImp ;
+	class DnsResolver ;
 }
 
 //| \class GNet::Resolver
 /// A class for synchronous or asynchronous network name to address resolution.
-/// The implementation uses getaddrinfo() at its core, with std::thread used for
-/// asynchronous resolve requests, with hooks into the GNet::EventLoop via
-/// GNet::FutureEvent.
+/// The implementation uses getaddrinfo() at its core, with a bounded pool of
+/// worker threads used for asynchronous resolve requests, with hooks into the
+/// GNet::EventLoop via GNet::FutureEvent.
+///
+/// The results of asynchronous requests are cached for a short time (see
+/// Config::cache_ttl), so repeated lookups of the same name are satisfied
+/// without a getaddrinfo() call. Synchronous requests only use the cache
+/// if Config::sync_cache is set.
+///
+/// Alternatively, asynchronous resolve requests can use GNet::DnsResolver
+/// to talk directly to the nameservers without any threads (see
+/// Config::native).
 ///
 class GNet::Resolver
 {
@@ -56,11 +68,19 @@ public:
 		bool datagram {false} ; // for datagram sockets
 		bool idn_flag {false} ; // use glibc's AI_IDN flag if available
 		bool test_slow {false} ; // run slow for testing
+		unsigned int cache_ttl {60U} ; // seconds, zero for no caching
+		unsigned int cache_negative_ttl {10U} ; // seconds, zero for no caching of failures
+		bool sync_cache {false} ; // use the cache for synchronous resolve() too
+		bool native {false} ; // use GNet::DnsResolver for asynchronous requests, if possible
 		Config & set_with_canonical_name( bool = true ) noexcept ;
 		Config & set_raw( bool = true ) noexcept ;
 		Config & set_convert_to_punycode( bool = true ) noexcept ;
 		Config & set_datagram( bool = true ) noexcept ;
 		Config & set_idn_flag( bool = true ) noexcept ;
+		Config & set_cache_ttl( unsigned int ) noexcept ;
+		Config & set_cache_negative_ttl( unsigned int ) noexcept ;
+		Config & set_sync_cache( bool = true ) noexcept ;
+		Config & set_native( bool = true ) noexcept ;
 	} ;
 	using AddressList = std::vector<Address> ;
 	struct Callback /// An interface used for GNet::Resolver callbacks.
@@ -84,7 +104,7 @@ public:
 
 	void start( const Location & , const Config & = {} ) ;
 		///< Starts asynchronous name-to-address resolution.
-		///< Precondition: async() && !busy()
+		///< Precondition: ( async() || Config::native ) && !busy()
 
 	static std::pair<std::string,std::string> resolve( Location & , const Config & ) ;
 		///< Does synchronous name resolution. Fills in the address
@@ -104,11 +124,24 @@ public:
 
 	static bool async() ;
 		///< Returns true if the resolver supports asynchronous operation.
-		///< If it doesnt then start() will always throw.
+		///< If it doesnt then start() will always throw, unless
+		///< native().
+
+	static bool native( const Location & , const Config & ) ;
+		///< Returns true if start() would use GNet::DnsResolver
+		///< rather than getaddrinfo(), ie. Config::native is set and
+		///< the location has a numeric port and no canonical name is
+		///< required.
 
 	bool busy() const ;
 		///< Returns true if there is a pending resolve request.
 
+	static void report( std::ostream & stream ,
+		const std::string & line_prefix = {} ,
+		const std::string & eol = std::string("\n") ) ;
+			///< Reports resolver thread and cache statistics onto
+			///< a stream.
+
 public:
 	Resolver( const Resolver & ) = delete ;
 	Resolver( Resolver && ) = delete ;
@@ -118,16 +151,27 @@ public:
 private:
 	friend class GNet::ResolverImp ;
 	void done( const std::string & , const Location & ) ;
+	void onTimeout() ;
+	void onDnsDone( const std::string & , const AddressList & , unsigned int ) ;
 
 private:
 	Callback & m_callback ;
 	EventState m_es ;
 	std::unique_ptr<ResolverImp> m_imp ;
+	std::unique_ptr<DnsResolver> m_dns ;
+	Timer<Resolver> m_timer ;
+	Config m_config ;
+	std::string m_cached_error ;
+	std::unique_ptr<Location> m_location ; // while busy with a cached or native result
 } ;
 
 inline GNet::Resolver::Config & GNet::Resolver::Config::set_with_canonical_name( bool b ) noexcept { with_canonical_name = b ; return *this ; }
 inline GNet::Resolver::Config & GNet::Resolver::Config::set_raw( bool b ) noexcept { raw = b ; return *this ; }
 inline GNet::Resolver::Config & GNet::Resolver::Config::set_datagram( bool b ) noexcept { datagram = b ; return *this ; }
 inline GNet::Resolver::Config & GNet::Resolver::Config::set_idn_flag( bool b ) noexcept { idn_flag = b ; return *this ; }
+inline GNet::Resolver::Config & GNet::Resolver::Config::set_cache_ttl( unsigned int n ) noexcept { cache_ttl = n ; return *this ; }
+inline GNet::Resolver::Config & GNet::Resolver::Config::set_cache_negative_ttl( unsigned int n ) noexcept { cache_negative_ttl = n ; return *this ; }
+inline GNet::Resolver::Config & GNet::Resolver::Config::set_sync_cache( bool b ) noexcept { sync_cache = b ; return *this ; }
+inline GNet::Resolver::Config & GNet::Resolver::Config::set_native( bool b ) noexcept { native = b ; return *this ; }
 
 #endif
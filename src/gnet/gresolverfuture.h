@@ -92,6 +92,9 @@ public:
 		///< Returns the reason for the error().
 		///< Precondition: error()
 
+	static std::string encode( const std::string & host , bool raw ) ;
+		///< Returns the host name with any IDN encoding, unless 'raw'.
+
 public:
 	ResolverFuture( const ResolverFuture & ) = delete ;
 	ResolverFuture( ResolverFuture && ) = delete ;
@@ -99,7 +102,6 @@ public:
 	ResolverFuture & operator=( ResolverFuture && ) = delete ;
 
 private:
-	static std::string encode( const std::string & , bool ) ;
 	std::string failure() const ;
 	bool fetch( List & ) const ;
 	bool fetch( Result & ) const ;
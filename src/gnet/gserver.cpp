@@ -38,7 +38,8 @@ GNet::Server::Server( EventState es , Descriptor fd ,
 		m_es(es) ,
 		m_config(server_config) ,
 		m_server_peer_config(server_peer_config) ,
-		m_socket(StreamSocket::Listener(),fd,m_config.stream_socket_config)
+		m_socket(StreamSocket::Listener(),fd,m_config.stream_socket_config) ,
+		m_limiter(es,m_config.connection_limiter_config)
 {
 	G_DEBUG( "GNet::Server::ctor: listening on socket " << m_socket.asString()
 		<< " with address " << m_socket.getLocalAddress().displayString() ) ;
@@ -52,7 +53,8 @@ GNet::Server::Server( EventState es , const Address & listening_address ,
 		m_es(es) ,
 		m_config(server_config) ,
 		m_server_peer_config(server_peer_config) ,
-		m_socket(listening_address.family(),StreamSocket::Listener(),m_config.stream_socket_config)
+		m_socket(listening_address.family(),StreamSocket::Listener(),m_config.stream_socket_config) ,
+		m_limiter(es,m_config.connection_limiter_config)
 {
 	G_DEBUG( "GNet::Server::ctor: listening on socket " << m_socket.asString()
 		<< " with address " << listening_address.displayString() ) ;
@@ -102,15 +104,54 @@ GNet::Address GNet::Server::address() const
 
 void GNet::Server::readEvent()
 {
-	// read-event-on-listening-port => new connection to accept
+	// read-event-on-listening-port => new connection(s) to accept
 	G_DEBUG( "GNet::Server::readEvent: " << this ) ;
 
-	// accept the connection
+	// accept a batch of connections so that we keep up with
+	// connection storms -- the listening socket is non-blocking
+	// so we stop early once the accept queue is drained -- each
+	// new connection is subject to rate limiting before any
+	// peer object is created
 	//
-	ServerPeerInfo peer_info( this , m_server_peer_config ) ;
-	accept( peer_info ) ;
+	constexpr int batch = G::Limits<>::net_accept_batch ;
+	for( int i = 0 ; i < batch ; i++ )
+	{
+		AcceptInfo accept_info ;
+		if( !accept( accept_info ) )
+			break ;
+		if( !m_limiter.admit( accept_info.address ) )
+		{
+			refuse( accept_info ) ;
+			continue ;
+		}
+		ServerPeerInfo peer_info( this , m_server_peer_config ) ;
+		peer_info.m_address = accept_info.address ;
+		peer_info.m_socket = std::move( accept_info.socket_ptr ) ;
+		addPeer( std::move(peer_info) ) ;
+	}
+}
+
+const char * GNet::Server::statsName() const noexcept
+{
+	return "GNet::Server" ;
+}
+
+void GNet::Server::refuse( AcceptInfo & accept_info )
+{
+	// best-effort write of the canned response straight into the
+	// new socket's send buffer, then close -- the limiter does
+	// the (rate-limited) logging
+	G_DEBUG( "GNet::Server::refuse: refusing connection from " << accept_info.address.displayString() ) ;
+	const std::string & response = m_limiter.response() ;
+	if( !response.empty() )
+		accept_info.socket_ptr->write( response.data() , response.size() ) ;
+	accept_info.socket_ptr.reset() ;
+}
+
+void GNet::Server::addPeer( ServerPeerInfo && peer_info )
+{
 	Address peer_address = peer_info.m_address ;
-	G_DEBUG( "GNet::Server::readEvent: new connection from " << peer_address.displayString()
+	G_DEBUG( "GNet::Server::addPeer: new connection from " << peer_address.displayString()
 		<< " on " << peer_info.m_socket->asString() ) ;
 
 	// change the logging context asap to reflect the server peer object
@@ -131,53 +172,46 @@ void GNet::Server::readEvent()
 	// commit or roll back
 	if( peer == nullptr )
 	{
-		G_WARNING( "GNet::Server::readEvent: connection rejected from " << peer_address.displayString() ) ;
+		G_WARNING( "GNet::Server::addPeer: connection rejected from " << peer_address.displayString() ) ;
 	}
 	else
 	{
-		G_DEBUG( "GNet::Server::readEvent: new connection accepted" ) ;
-		m_peer_list.push_back( std::shared_ptr<ServerPeer>(peer.release()) ) ;
+		G_DEBUG( "GNet::Server::addPeer: new connection accepted" ) ;
+		const ExceptionSource * esrc = peer.get() ; // implicit ServerPeer/ExceptionSource static cast
+		auto list_p = m_peer_list.insert( m_peer_list.end() , std::shared_ptr<ServerPeer>(peer.release()) ) ;
+		m_peer_index[esrc] = list_p ;
 	}
 }
 
-void GNet::Server::accept( ServerPeerInfo & peer_info )
+bool GNet::Server::accept( AcceptInfo & accept_info )
 {
-	AcceptInfo accept_info ;
 	{
 		G::Root claim_root ;
 		accept_info = m_socket.accept() ;
 	}
-	peer_info.m_address = accept_info.address ;
-	peer_info.m_socket = std::move( accept_info.socket_ptr ) ;
+	return accept_info.socket_ptr != nullptr ; // false if would block
 }
 
 void GNet::Server::onException( ExceptionSource * esrc , std::exception & e , bool done )
 {
 	G_DEBUG( "GNet::Server::onException: exception=[" << e.what() << "] esrc=[" << static_cast<void*>(esrc) << "]" ) ;
-	bool handled = false ;
-	if( esrc != nullptr )
-	{
-		for( auto list_p = m_peer_list.begin() ; list_p != m_peer_list.end() ; ++list_p )
-		{
-			if( (*list_p).get() == esrc ) // implicit ServerPeer/ExceptionSource static cast
-			{
-				std::shared_ptr<ServerPeer> peer_p = *list_p ;
-				m_peer_list.erase( list_p ) ; // remove first, in case onDelete() throws
-				(*peer_p).doOnDelete( e.what() , done ) ;
-				handled = true ;
-				break ; // ServerPeer deleted here
-			}
-		}
-	}
-	if( !handled )
+	auto index_p = esrc == nullptr ? m_peer_index.end() : m_peer_index.find( esrc ) ;
+	if( index_p == m_peer_index.end() )
 	{
 		G_WARNING( "GNet::Server::onException: unhandled exception: " << e.what() ) ;
 		throw ; // should never get here -- rethrow just in case
 	}
+
+	std::shared_ptr<ServerPeer> peer_p = *(index_p->second) ;
+	m_peer_list.erase( index_p->second ) ; // remove first, in case onDelete() throws
+	m_peer_index.erase( index_p ) ;
+	(*peer_p).doOnDelete( e.what() , done ) ;
+	// ServerPeer deleted here
 }
 
 void GNet::Server::serverCleanup()
 {
+	m_peer_index.clear() ;
 	m_peer_list.clear() ;
 }
 
@@ -196,6 +230,16 @@ std::vector<std::weak_ptr<GNet::ServerPeer>> GNet::Server::peers()
 	return result ;
 }
 
+GNet::Descriptor GNet::Server::listeningFd() const noexcept
+{
+	return m_socket.fdd() ;
+}
+
+void GNet::Server::stopListening() noexcept
+{
+	m_socket.dropReadHandler() ;
+}
+
 void GNet::Server::writeEvent()
 {
 	G_DEBUG( "GNet::Server::writeEvent" ) ;
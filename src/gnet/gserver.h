@@ -28,12 +28,15 @@
 #include "gexception.h"
 #include "gsocket.h"
 #include "glistener.h"
+#include "gconnectionlimiter.h"
 #include "glimits.h"
 #include "gprocess.h"
 #include "gevent.h"
 #include <utility>
 #include <memory>
 #include <string>
+#include <list>
+#include <unordered_map>
 
 namespace GNet
 {
@@ -56,8 +59,10 @@ public:
 	{
 		StreamSocket::Config stream_socket_config ;
 		bool uds_open_permissions {false} ;
+		ConnectionLimiter::Config connection_limiter_config ;
 		Config & set_stream_socket_config( const StreamSocket::Config & ) ;
 		Config & set_uds_open_permissions( bool b = true ) noexcept ;
+		Config & set_connection_limiter_config( const ConnectionLimiter::Config & ) ;
 	} ;
 
 	Server( EventState , const Address & listening_address , const ServerPeer::Config & , const Config & ) ;
@@ -85,6 +90,15 @@ public:
 	bool hasPeers() const ;
 		///< Returns true if peers() is not empty.
 
+	Descriptor listeningFd() const noexcept ;
+		///< Returns the listening socket's file descriptor.
+
+	void stopListening() noexcept ;
+		///< Stops accepting new connections. Existing peers are
+		///< unaffected and the listening socket is left open so
+		///< that another process sharing it can carry on accepting
+		///< connections from the listen queue.
+
 protected:
 	virtual std::unique_ptr<ServerPeer> newPeer( EventStateUnbound , ServerPeerInfo && ) = 0 ;
 		///< A factory method which new()s a ServerPeer-derived
@@ -112,6 +126,7 @@ protected:
 
 private: // overrides
 	void readEvent() override ; // Override from GNet::EventHandler.
+	const char * statsName() const noexcept override ; // Override from GNet::EventHandler.
 	void writeEvent() override ; // Override from GNet::EventHandler.
 	void onException( ExceptionSource * , std::exception & , bool ) override ; // Override from GNet::ExceptionHandler.
 
@@ -122,15 +137,20 @@ public:
 	Server & operator=( Server && ) = delete ;
 
 private:
-	void accept( ServerPeerInfo & ) ;
+	bool accept( AcceptInfo & ) ;
+	void addPeer( ServerPeerInfo && ) ;
+	void refuse( AcceptInfo & ) ;
 
 private:
-	using PeerList = std::vector<std::shared_ptr<ServerPeer>> ;
+	using PeerList = std::list<std::shared_ptr<ServerPeer>> ;
+	using PeerIndex = std::unordered_map<const ExceptionSource*,PeerList::iterator> ;
 	EventState m_es ;
 	Config m_config ;
 	ServerPeer::Config m_server_peer_config ;
 	StreamSocket m_socket ; // listening socket
+	ConnectionLimiter m_limiter ;
 	PeerList m_peer_list ;
+	PeerIndex m_peer_index ; // for O(1) removal
 	std::string m_event_logging_string ;
 } ;
 
@@ -150,5 +170,6 @@ public:
 
 inline GNet::Server::Config & GNet::Server::Config::set_stream_socket_config( const StreamSocket::Config & c ) { stream_socket_config = c ; return *this ; }
 inline GNet::Server::Config & GNet::Server::Config::set_uds_open_permissions( bool b ) noexcept { uds_open_permissions = b ; return *this ; }
+inline GNet::Server::Config & GNet::Server::Config::set_connection_limiter_config( const ConnectionLimiter::Config & c ) { connection_limiter_config = c ; return *this ; }
 
 #endif
@@ -112,6 +112,11 @@ void GNet::ServerPeer::readEvent()
 		onSendComplete() ;
 }
 
+const char * GNet::ServerPeer::statsName() const noexcept
+{
+	return "GNet::ServerPeer" ;
+}
+
 GNet::Address GNet::ServerPeer::localAddress() const
 {
 	G_ASSERT( m_socket != nullptr ) ;
@@ -209,12 +214,10 @@ void GNet::ServerPeer::setIdleTimeout( unsigned int s )
 		m_idle_timer.startTimer( m_config.idle_timeout ) ;
 }
 
-#ifndef G_LIB_SMALL
 void GNet::ServerPeer::finish()
 {
 	m_sp.shutdown() ;
 }
-#endif
 
 void GNet::ServerPeer::onPeerDisconnect()
 {
@@ -172,10 +172,12 @@ protected:
 		///< a chunk of non-line-delimited data.
 
 	void finish() ;
-		///< Does a socket shutdown(). See also GNet::Client::finish().
+		///< Does a socket shutdown(), preceded by a TLS close-notify
+		///< alert if secure. See also GNet::Client::finish().
 
 private: // overrides
 	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
 	void writeEvent() override ; // GNet::EventHandler
 	void otherEvent( EventHandler::Reason ) override ; // GNet::EventHandler
 	void onPeerDisconnect() override ; // GNet::SocketProtocolSink
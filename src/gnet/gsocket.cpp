@@ -202,12 +202,10 @@ SOCKET GNet::SocketBase::fd() const noexcept
 	return m_fd.fd() ;
 }
 
-#ifndef G_LIB_SMALL
 GNet::Descriptor GNet::SocketBase::fdd() const noexcept
 {
 	return m_fd ;
 }
-#endif
 
 std::string GNet::SocketBase::reason() const
 {
@@ -389,6 +387,8 @@ void GNet::Socket::setOptionsOnBind( Address::Family af )
 			setOptionReuse() ;
 		if( m_config.bind_exclusive )
 			setOptionExclusive() ;
+		if( m_config.bind_reuseport )
+			setOptionReusePort() ;
 		if( m_config.free_bind )
 			setOptionFreeBind() ;
 		if( af == Address::Family::ipv6 && m_config.bind_pureipv6 )
@@ -524,14 +524,25 @@ GNet::Socket::ssize_type GNet::StreamSocket::write( const char * buffer , size_t
 	return writeImp( buffer , length ) ; // SocketBase
 }
 
+GNet::Socket::ssize_type GNet::StreamSocket::write( const std::vector<std::string_view> & data )
+{
+	return writeImp( data ) ; // SocketBase
+}
+
 GNet::AcceptInfo GNet::StreamSocket::accept()
 {
 	AddressStorage addr ;
-	Descriptor new_fd( ::accept(fd(),addr.p1(),addr.p2()) ) ;
+	#if GCONFIG_HAVE_ACCEPT4
+		Descriptor new_fd( ::accept4(fd(),addr.p1(),addr.p2(),SOCK_NONBLOCK|SOCK_CLOEXEC) ) ;
+	#else
+		Descriptor new_fd( ::accept(fd(),addr.p1(),addr.p2()) ) ;
+	#endif
 	if( !new_fd.validfd() )
 	{
 		saveReason() ;
-		if( eTooMany() )
+		if( eWouldBlock() )
+			return AcceptInfo() ;
+		else if( eTooMany() )
 			throw SocketTooMany( "cannot accept on listening socket" , reason() ) ;
 		else
 			throw SocketError( "cannot accept on listening socket" , reason() ) ;
@@ -31,6 +31,7 @@
 #include "gstringview.h"
 #include <string>
 #include <utility>
+#include <vector>
 #include <memory>
 #include <new>
 
@@ -172,6 +173,13 @@ protected:
 		///< for write() that can be called from derived classes'
 		///< overrides.
 
+	ssize_type writeImp( const std::vector<std::string_view> & ) ;
+		///< Writes a number of data chunks to the socket using a
+		///< single gather-write system call, if supported. Returns
+		///< the total number of bytes written, which might be less
+		///< than the total size of the chunks if flow control is
+		///< asserted, or -1 on error.
+
 	static bool error( int rc ) ;
 		///< Returns true if the given return code indicates an
 		///< error.
@@ -236,10 +244,12 @@ public:
 		bool bind_pureipv6 {true} ;
 		bool bind_reuse {true} ;
 		bool bind_exclusive {false} ; // (windows, einval if also bind_reuse)
+		bool bind_reuseport {false} ; // (unix) port sharing between processes
 		bool free_bind {false} ; // (linux) (not yet implemented)
 		Config & set_listen_queue( int ) noexcept ;
 		Config & set_bind_reuse( bool ) noexcept ;
 		Config & set_bind_exclusive( bool ) noexcept ;
+		Config & set_bind_reuseport( bool ) noexcept ;
 		Config & set_free_bind( bool ) noexcept ;
 		template <typename T> const T & set_last() ;
 	} ;
@@ -329,6 +339,7 @@ private:
 	void setOptionsOnConnect( Address::Family ) ;
 	void setOptionReuse() ;
 	void setOptionExclusive() ;
+	void setOptionReusePort() ;
 	void setOptionPureV6() ;
 	bool setOptionPureV6( std::nothrow_t ) ;
 
@@ -402,9 +413,24 @@ public:
 	ssize_type write( const char * buf , size_type len ) override ;
 		///< Override from Socket::write().
 
+	ssize_type write( const std::vector<std::string_view> & ) ;
+		///< Writes a number of data chunks using a gather-write.
+		///< Returns the number of bytes written, or -1 on error.
+		///< See also SocketBase::writeImp().
+
+	ssize_type writeFile( int fd , std::size_t offset , size_type len ) ;
+		///< Writes up to 'len' bytes from the given file descriptor
+		///< starting at the given file offset. Uses sendfile() where
+		///< available so that the data does not pass through user
+		///< space. Returns the number of bytes written, or zero at
+		///< end-of-file, or -1 on error. The file position is not
+		///< used, but it might be changed on some platforms.
+
 	AcceptInfo accept() ;
 		///< Accepts an incoming connection, returning a new()ed
-		///< socket and the peer address.
+		///< socket and the peer address. Returns a null socket
+		///< pointer if there are no more connections waiting
+		///< to be accepted. Throws on error.
 
 public:
 	~StreamSocket() override = default ;
@@ -507,6 +533,7 @@ inline GNet::Socket::SocketBindError::SocketBindError( const Address & a , const
 inline GNet::Socket::Config & GNet::Socket::Config::set_listen_queue( int n ) noexcept { listen_queue = n ; return *this ; }
 inline GNet::Socket::Config & GNet::Socket::Config::set_bind_reuse( bool b ) noexcept { bind_reuse = b ; return *this ; }
 inline GNet::Socket::Config & GNet::Socket::Config::set_bind_exclusive( bool b ) noexcept { bind_exclusive = b ; return *this ; }
+inline GNet::Socket::Config & GNet::Socket::Config::set_bind_reuseport( bool b ) noexcept { bind_reuseport = b ; return *this ; }
 inline GNet::Socket::Config & GNet::Socket::Config::set_free_bind( bool b ) noexcept { free_bind = b ; return *this ; }
 template <typename T> const T & GNet::Socket::Config::set_last() { return static_cast<const T&>(*this) ; }
 
@@ -25,11 +25,17 @@
 #include "gstr.h"
 #include "gfile.h"
 #include "gcleanup.h"
+#include "glimits.h"
 #include "glog.h"
+#include <vector>
+#include <algorithm>
 #include <cerrno> // EWOULDBLOCK etc
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#if GCONFIG_HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
 
 bool GNet::SocketBase::supports( Address::Family af , int type , int protocol )
 {
@@ -51,7 +57,7 @@ bool GNet::SocketBase::create( int domain , int type , int protocol )
 	return true ;
 }
 
-bool GNet::SocketBase::prepare( bool /*accepted*/ )
+bool GNet::SocketBase::prepare( bool accepted )
 {
 	static bool first = true ;
 	if( first )
@@ -60,6 +66,9 @@ bool GNet::SocketBase::prepare( bool /*accepted*/ )
 		G::Cleanup::init() ; // ignore SIGPIPE
 	}
 
+	if( accepted && GCONFIG_HAVE_ACCEPT4 )
+		return true ; // already non-blocking
+
 	if( !setNonBlocking() )
 	{
 		saveReason() ;
@@ -191,6 +200,17 @@ void GNet::Socket::setOptionExclusive()
 	// no-op
 }
 
+void GNet::Socket::setOptionReusePort()
+{
+	// allow several processes to bind the same address, with the
+	// kernel distributing incoming connections between them
+	#ifdef SO_REUSEPORT
+		setOption( SOL_SOCKET , "so_reuseport" , SO_REUSEPORT , 1 ) ;
+	#else
+		throw SocketError( "cannot set socket option for port sharing" ) ;
+	#endif
+}
+
 void GNet::Socket::setOptionPureV6()
 {
 	#if GCONFIG_HAVE_IPV6
@@ -254,6 +274,42 @@ std::size_t GNet::DatagramSocket::limit( std::size_t default_in ) const
 }
 #endif
 
+GNet::SocketBase::ssize_type GNet::SocketBase::writeImp( const std::vector<std::string_view> & data )
+{
+	ssize_type nsent = G::Msg::sendto( m_fd.fd() , data , MSG_NOSIGNAL , nullptr , 0U ) ;
+	if( sizeError(nsent) ) // if -1
+	{
+		saveReason() ;
+		G_DEBUG( "GNet::SocketBase::writeImp: write error: " << reason() ) ;
+		return -1 ;
+	}
+	return nsent ;
+}
+
+GNet::Socket::ssize_type GNet::StreamSocket::writeFile( int file_fd , std::size_t offset , size_type length )
+{
+	#if GCONFIG_HAVE_SENDFILE
+		off_t file_offset = static_cast<off_t>( offset ) ;
+		ssize_type nsent = ::sendfile( fd() , file_fd , &file_offset , length ) ;
+		if( sizeError(nsent) )
+		{
+			saveReason() ;
+			G_DEBUG( "GNet::StreamSocket::writeFile: write error: " << reason() ) ;
+			return -1 ;
+		}
+		return nsent ;
+	#else
+		std::vector<char> buffer( std::min(length,std::size_t(G::Limits<>::net_buffer)) ) ;
+		ssize_t nread = ::pread( file_fd , buffer.data() , buffer.size() , static_cast<off_t>(offset) ) ;
+		if( nread <= 0 )
+		{
+			saveReason() ;
+			return nread < 0 ? -1 : 0 ;
+		}
+		return writeImp( buffer.data() , static_cast<size_type>(nread) ) ; // SocketBase
+	#endif
+}
+
 #ifndef G_LIB_SMALL
 GNet::Socket::ssize_type GNet::DatagramSocket::writeto( const std::vector<std::string_view> & data , const Address & dst )
 {
@@ -22,8 +22,12 @@
 #include "gsocket.h"
 #include "gprocess.h"
 #include "gstr.h"
+#include "gfile.h"
+#include "glimits.h"
 #include "gassert.h"
 #include <errno.h>
+#include <vector>
+#include <algorithm>
 
 bool GNet::SocketBase::supports( Address::Family af , int type , int protocol )
 {
@@ -208,6 +212,11 @@ void GNet::Socket::setOptionExclusive()
 	setOption( SOL_SOCKET , "so_exclusiveaddruse" , SO_EXCLUSIVEADDRUSE , 1 ) ;
 }
 
+void GNet::Socket::setOptionReusePort()
+{
+	throw SocketError( "cannot set socket option for port sharing" ) ;
+}
+
 void GNet::Socket::setOptionPureV6()
 {
 	// no-op
@@ -233,3 +242,22 @@ std::size_t GNet::DatagramSocket::limit( std::size_t default_in ) const
 	return default_in ;
 }
 
+
+GNet::SocketBase::ssize_type GNet::SocketBase::writeImp( const std::vector<std::string_view> & data )
+{
+	// no gather-write -- just write the first non-empty chunk
+	auto p = std::find_if( data.begin() , data.end() , [](std::string_view s){return !s.empty();} ) ;
+	return p == data.end() ? 0 : writeImp( p->data() , p->size() ) ;
+}
+
+GNet::Socket::ssize_type GNet::StreamSocket::writeFile( int file_fd , std::size_t offset , size_type length )
+{
+	// no TransmitFile() -- read the file into a buffer and write that
+	std::vector<char> buffer( std::min(length,std::size_t(G::Limits<>::net_buffer)) ) ;
+	if( G::File::seek( file_fd , static_cast<std::streamoff>(offset) , G::File::Seek::Start ) < 0 )
+		return -1 ;
+	ssize_t nread = G::File::read( file_fd , buffer.data() , buffer.size() ) ;
+	if( nread <= 0 )
+		return nread < 0 ? -1 : 0 ;
+	return writeImp( buffer.data() , static_cast<size_type>(nread) ) ; // SocketBase
+}
@@ -23,19 +23,42 @@
 #include "gstringview.h"
 #include "gcall.h"
 #include "gtimer.h"
+#include "gfutureevent.h"
+#include "gworkerpool.h"
 #include "gssl.h"
 #include "gsocketprotocol.h"
+#include "gmetrics.h"
 #include "gstr.h"
+#include "gfile.h"
 #include "gtest.h"
 #include "gassert.h"
 #include "glog.h"
 #include <memory>
 #include <numeric>
+#include <algorithm>
+#include <exception>
+
+namespace GNet
+{
+	namespace SocketProtocolMetrics
+	{
+		Metrics::Counter bytes_in( "emailrelay_network_received_bytes_total" , "Bytes received over network connections" ) ; // NOLINT
+		Metrics::Counter bytes_out( "emailrelay_network_sent_bytes_total" , "Bytes sent over network connections" ) ; // NOLINT
+	}
+}
 
 //| \class GNet::SocketProtocolImp
 /// A pimple-pattern implementation class used by GNet::SocketProtocol.
 ///
-class GNet::SocketProtocolImp
+/// If the TLS profile is threaded() then each call to the TLS connect
+/// or accept function is run on a GNet::WorkerPool worker thread
+/// so that the cpu-heavy public-key operations do not hold up the
+/// event loop. The pool is a never-deleted singleton with up to
+/// G::Limits::tls_threads threads. The socket's event handlers are dropped while the
+/// worker thread is busy and the result is delivered back through a
+/// GNet::FutureEvent. Data transfer is always done on the main thread.
+///
+class GNet::SocketProtocolImp : private FutureEventHandler , private WorkerPoolJob
 {
 public:
 	using Result = GSsl::Protocol::Result ;
@@ -52,14 +75,16 @@ public:
 public:
 	SocketProtocolImp( EventHandler & , EventState , SocketProtocol::Sink & ,
 		StreamSocket & , const SocketProtocol::Config & ) ;
-	~SocketProtocolImp() ;
+	~SocketProtocolImp() override ;
 	bool readEvent( bool ) ;
 	bool writeEvent() ;
 	void otherEvent( EventHandler::Reason , bool ) ;
 	bool send( std::string_view data , std::size_t offset ) ;
 	bool send( const Segments & , std::size_t ) ;
+	bool sendFile( std::string_view , int , std::size_t , std::size_t ) ;
+	bool sendFileZeroCopy() const ;
 	void shutdown() ;
-	void secureConnect() ;
+	void secureConnect( const std::string & ) ;
 	bool secureConnectCapable() const ;
 	void secureAccept() ;
 	bool secureAcceptCapable() const ;
@@ -67,6 +92,11 @@ public:
 	bool raw() const ;
 	std::string peerCertificate() const ;
 
+private: // overrides
+	void onFutureEvent() override ; // GNet::FutureEventHandler
+	void workerRun() noexcept override ; // GNet::WorkerPoolJob
+	void workerDone() noexcept override ; // GNet::WorkerPoolJob
+
 public:
 	SocketProtocolImp( const SocketProtocolImp & ) = delete ;
 	SocketProtocolImp( SocketProtocolImp && ) = delete ;
@@ -75,25 +105,41 @@ public:
 
 private:
 	enum class State { raw , connecting , accepting , writing , idle , shuttingdown } ;
-	static std::unique_ptr<GSsl::Protocol> newProtocol( const std::string & ) ;
+	static std::unique_ptr<GSsl::Protocol> newProtocol( const std::string & , const std::string & = {} ) ;
 	static void log( int level , const std::string & line ) ;
 	bool failed() const ;
 	bool rawReadEvent( bool ) ;
 	bool rawWriteEvent() ;
 	bool rawOtherEvent( EventHandler::Reason ) ;
 	bool rawSend( const Segments & , Position , bool = false ) ;
+	bool queue( const Segments & , Position ) ;
+	void dequeue() ;
+	std::size_t pending() const ;
+	bool completed( bool ) ;
 	bool rawSendImp( const Segments & , Position , Position & ) ;
+	bool rawSendFile() ;
+	bool rawSendFileImp() ;
+	bool sslSendFile() ;
+	bool sslSendFileImp() ;
+	static void readFile( int , std::size_t , std::size_t , std::string & ) ;
 	void rawReset() ;
 	void sslReadImp() ;
-	bool sslSend( const Segments & segments , Position pos ) ;
+	bool sslSend( const Segments & segments , Position pos , bool copied ) ;
 	bool sslSendImp() ;
 	bool sslSendImp( const Segments & segments , Position pos , Position & ) ;
 	void secureConnectImp() ;
+	void secureConnectResult( Result ) ;
 	void secureAcceptImp() ;
+	void secureAcceptResult( Result ) ;
+	bool offload() const ;
+	void startOffload() ;
+	static WorkerPool & pool() ;
 	void shutdownImp() ;
 	void logSecure( const std::string & , const std::string & ) const ;
 	void onSecureConnectionTimeout() ;
 	static std::size_t size( const Segments & ) ;
+	static std::size_t residue( const Segments & , Position ) ;
+	static void append( std::string & , const Segments & , Position ) ;
 	static bool finished( const Segments & , Position ) ;
 	static Position firstPosition( const Segments & , std::size_t ) ;
 	static Position newPosition( const Segments & , Position , std::size_t ) ;
@@ -101,6 +147,7 @@ private:
 	friend std::ostream & operator<<( std::ostream & , State ) ;
 
 private:
+	static constexpr std::size_t gather_limit = 64U ; // well below IOV_MAX
 	EventHandler & m_handler ;
 	EventState m_es ;
 	SocketProtocol::Sink & m_sink ;
@@ -109,8 +156,15 @@ private:
 	SocketProtocol::Config m_config ;
 	Segments m_one_segment ;
 	Segments m_segments ;
+	Segments m_gather ;
 	Position m_position ;
 	std::string m_data_copy ;
+	std::string m_queue ;
+	bool m_blocked {false} ;
+	bool m_shutdown_pending {false} ;
+	int m_file_fd {-1} ;
+	std::size_t m_file_offset {0U} ;
+	std::size_t m_file_size {0U} ;
 	bool m_failed {false} ;
 	std::unique_ptr<GSsl::Protocol> m_ssl ;
 	State m_state {State::raw} ;
@@ -118,6 +172,11 @@ private:
 	ssize_t m_read_buffer_n {0} ;
 	Timer<SocketProtocolImp> m_secure_connection_timer ;
 	std::string m_peer_certificate ;
+	std::unique_ptr<FutureEvent> m_future_event ;
+	HANDLE m_future_handle {HNULL} ;
+	bool m_offloaded {false} ;
+	Result m_offload_result {Result::error} ;
+	std::exception_ptr m_offload_exception ;
 } ;
 
 namespace GNet
@@ -158,7 +217,13 @@ GNet::SocketProtocolImp::SocketProtocolImp( EventHandler & handler , EventState
 }
 
 GNet::SocketProtocolImp::~SocketProtocolImp()
-= default;
+{
+	// the socket is non-blocking so any running handshake step
+	// will finish soon enough -- if the step never started then
+	// close the unused future-event handle
+	if( m_offloaded && pool().cancel( this , true ) )
+		FutureEvent::send( m_future_handle ) ;
+}
 
 void GNet::SocketProtocolImp::onSecureConnectionTimeout()
 {
@@ -183,7 +248,7 @@ bool GNet::SocketProtocolImp::readEvent( bool no_throw_on_peer_disconnect )
 		shutdownImp() ;
 	else // State::idle
 		sslReadImp() ;
-	return all_sent ;
+	return completed( all_sent ) ;
 }
 
 bool GNet::SocketProtocolImp::writeEvent()
@@ -203,7 +268,16 @@ bool GNet::SocketProtocolImp::writeEvent()
 		shutdownImp() ;
 	else // State::idle
 		sslReadImp() ;
-	return all_sent ;
+	return completed( all_sent ) ;
+}
+
+bool GNet::SocketProtocolImp::completed( bool all_sent )
+{
+	// only report completion if the user has seen a send() return false
+	bool result = all_sent && m_blocked ;
+	if( all_sent )
+		m_blocked = false ;
+	return result ;
 }
 
 void GNet::SocketProtocolImp::otherEvent( EventHandler::Reason reason , bool no_throw_on_peer_disconnect )
@@ -233,6 +307,23 @@ std::size_t GNet::SocketProtocolImp::size( const Segments & segments )
 		[](std::size_t n,std::string_view s){return n+s.size();} ) ;
 }
 
+std::size_t GNet::SocketProtocolImp::residue( const Segments & segments , Position pos )
+{
+	std::size_t n = 0U ;
+	for( std::size_t i = pos.segment ; i < segments.size() ; i++ )
+		n += segments[i].size() ;
+	return n - ( pos.segment < segments.size() ? pos.offset : 0U ) ;
+}
+
+void GNet::SocketProtocolImp::append( std::string & out , const Segments & segments , Position pos )
+{
+	for( std::size_t i = pos.segment ; i < segments.size() ; i++ )
+	{
+		std::string_view s = i == pos.segment ? segments[i].substr(pos.offset) : segments[i] ;
+		out.append( s.data() , s.size() ) ;
+	}
+}
+
 GNet::SocketProtocolImp::Position GNet::SocketProtocolImp::firstPosition( const Segments & s , std::size_t offset )
 {
 	return newPosition( s , Position() , offset ) ;
@@ -274,7 +365,9 @@ bool GNet::SocketProtocolImp::send( std::string_view data , std::size_t offset )
 	}
 	else if( m_state == State::writing )
 	{
-		throw SocketProtocol::SendError( "still busy sending the last packet" ) ;
+		G_ASSERT( m_one_segment.size() == 1U ) ;
+		m_one_segment[0] = data ;
+		rc = queue( m_one_segment , Position(0U,offset) ) ;
 	}
 	else if( m_state == State::shuttingdown )
 	{
@@ -286,8 +379,10 @@ bool GNet::SocketProtocolImp::send( std::string_view data , std::size_t offset )
 		m_data_copy.assign( data.data()+offset , data.size()-offset ) ;
 		G_ASSERT( m_one_segment.size() == 1U ) ;
 		m_one_segment[0] = std::string_view( m_data_copy.data() , m_data_copy.size() ) ;
-		rc = sslSend( m_one_segment , Position() ) ;
+		rc = sslSend( m_one_segment , Position() , true ) ;
 	}
+	if( !rc )
+		m_blocked = true ;
 	return rc ;
 }
 
@@ -307,7 +402,7 @@ bool GNet::SocketProtocolImp::send( const Segments & segments , std::size_t offs
 	}
 	else if( m_state == State::writing )
 	{
-		throw SocketProtocol::SendError( "still busy sending the last packet" ) ;
+		rc = queue( segments , firstPosition(segments,offset) ) ;
 	}
 	else if( m_state == State::shuttingdown )
 	{
@@ -315,14 +410,117 @@ bool GNet::SocketProtocolImp::send( const Segments & segments , std::size_t offs
 	}
 	else
 	{
-		rc = sslSend( segments , firstPosition(segments,offset) ) ;
+		rc = sslSend( segments , firstPosition(segments,offset) , false ) ;
 	}
+	if( !rc )
+		m_blocked = true ;
 	return rc ;
 }
 
+bool GNet::SocketProtocolImp::sendFile( std::string_view head , int fd , std::size_t offset , std::size_t size )
+{
+	if( fd < 0 )
+		throw SocketProtocol::ProtocolError( "invalid file send" ) ;
+
+	m_blocked = true ; // cleared below if all sent
+	if( ( m_state == State::raw && !finished(m_segments,m_position) ) ||
+		( m_state == State::writing && m_ssl->kernelTls() ) )
+	{
+		// queue the head and have the file data follow on from
+		// rawWriteEvent() or sslSendImp()
+		G_ASSERT( m_one_segment.size() == 1U ) ;
+		m_one_segment[0] = head ;
+		queue( m_one_segment , Position() ) ; // throws if no queue or already sending a file
+		m_file_fd = fd ;
+		m_file_offset = offset ;
+		m_file_size = size ;
+		return false ;
+	}
+	else if( m_state == State::writing )
+	{
+		// no kernel tls so read the file data into the queue
+		G_ASSERT( m_one_segment.size() == 1U ) ;
+		m_one_segment[0] = head ;
+		queue( m_one_segment , Position() ) ;
+		readFile( fd , offset , size , m_queue ) ;
+		m_blocked = pending() > m_config.send_queue_limit ;
+		return !m_blocked ;
+	}
+	else if( m_state == State::raw )
+	{
+		if( m_file_size != 0U )
+			throw SocketProtocol::SendError( "still busy sending the last packet" ) ;
+
+		bool all_sent = true ;
+		if( !head.empty() )
+		{
+			G_ASSERT( m_one_segment.size() == 1U ) ;
+			m_one_segment[0] = head ;
+			all_sent = rawSend( m_one_segment , Position() , true/*copy*/ ) && finished(m_segments,m_position) ;
+		}
+
+		// if blocked then the file data follows on from rawWriteEvent()
+		m_file_fd = fd ;
+		m_file_offset = offset ;
+		m_file_size = size ;
+		m_blocked = !( all_sent && rawSendFile() ) ;
+		return !m_blocked ;
+	}
+	else if( m_state == State::idle && m_ssl->kernelTls() )
+	{
+		bool all_sent = send( head , 0U ) && m_state == State::idle ;
+
+		// if blocked then the file data follows on from sslSendImp()
+		m_file_fd = fd ;
+		m_file_offset = offset ;
+		m_file_size = size ;
+		m_blocked = !( all_sent && sslSendFile() ) ;
+		return !m_blocked ;
+	}
+	else if( m_state == State::idle )
+	{
+		// no kernel tls so read the file data and encrypt it here
+		m_data_copy.assign( head.data() , head.size() ) ;
+		readFile( fd , offset , size , m_data_copy ) ;
+		G_ASSERT( m_one_segment.size() == 1U ) ;
+		m_one_segment[0] = std::string_view( m_data_copy.data() , m_data_copy.size() ) ;
+		m_blocked = !sslSend( m_one_segment , Position() , true ) ;
+		return !m_blocked ;
+	}
+	else
+	{
+		throw SocketProtocol::SendError( "still busy" ) ;
+	}
+}
+
+bool GNet::SocketProtocolImp::sendFileZeroCopy() const
+{
+	return m_state == State::raw || ( m_ssl && m_ssl->kernelTls() ) ;
+}
+
+void GNet::SocketProtocolImp::readFile( int fd , std::size_t offset , std::size_t size , std::string & out )
+{
+	std::size_t pos = out.size() ;
+	out.resize( pos + size ) ;
+	if( G::File::seek( fd , static_cast<std::streamoff>(offset) , G::File::Seek::Start ) < 0 )
+		throw SocketProtocol::SendError( "cannot read file" ) ;
+	while( pos < out.size() )
+	{
+		ssize_t n = G::File::read( fd , &out[pos] , out.size()-pos ) ;
+		if( n <= 0 )
+			throw SocketProtocol::SendError( "cannot read file" ) ;
+		pos += static_cast<std::size_t>(n) ;
+	}
+}
+
 void GNet::SocketProtocolImp::shutdown()
 {
-	if( m_state == State::raw )
+	if( m_config.send_queue_limit != 0U && pending() != 0U && ( m_state == State::raw || m_state == State::writing ) )
+	{
+		G_DEBUG( "GNet::SocketProtocolImp::shutdown: shutdown deferred until the output queue has drained" ) ;
+		m_shutdown_pending = true ;
+	}
+	else if( m_state == State::raw )
 	{
 		m_socket.dropWriteHandler() ;
 		m_socket.shutdown() ;
@@ -379,7 +577,7 @@ bool GNet::SocketProtocolImp::secureConnectCapable() const
 	return GSsl::Library::enabledAs( m_config.client_tls_profile ) ;
 }
 
-void GNet::SocketProtocolImp::secureConnect()
+void GNet::SocketProtocolImp::secureConnect( const std::string & session_key )
 {
 	G_DEBUG( "SocketProtocolImp::secureConnect" ) ;
 	G_ASSERT( m_state == State::raw ) ;
@@ -388,7 +586,7 @@ void GNet::SocketProtocolImp::secureConnect()
 		throw SocketProtocol::ProtocolError() ;
 
 	rawReset() ;
-	m_ssl = newProtocol( m_config.client_tls_profile ) ;
+	m_ssl = newProtocol( m_config.client_tls_profile , session_key ) ;
 	m_state = State::connecting ;
 	if( m_config.secure_connection_timeout != 0U )
 		m_secure_connection_timer.startTimer( m_config.secure_connection_timeout ) ;
@@ -401,8 +599,17 @@ void GNet::SocketProtocolImp::secureConnectImp()
 	G_ASSERT( m_ssl != nullptr ) ;
 	G_ASSERT( m_state == State::connecting ) ;
 
-	Result rc = m_ssl->connect( m_socket ) ;
-	G_DEBUG( "SocketProtocolImp::secureConnectImp: result=" << GSsl::Protocol::str(rc) ) ;
+	if( m_offloaded )
+		return ;
+	else if( offload() )
+		startOffload() ;
+	else
+		secureConnectResult( m_ssl->connect( m_socket ) ) ;
+}
+
+void GNet::SocketProtocolImp::secureConnectResult( Result rc )
+{
+	G_DEBUG( "SocketProtocolImp::secureConnectResult: result=" << GSsl::Protocol::str(rc) ) ;
 	if( rc == Result::error )
 	{
 		m_socket.dropWriteHandler() ;
@@ -456,8 +663,17 @@ void GNet::SocketProtocolImp::secureAcceptImp()
 	G_ASSERT( m_ssl != nullptr ) ;
 	G_ASSERT( m_state == State::accepting ) ;
 
-	Result rc = m_ssl->accept( m_socket ) ;
-	G_DEBUG( "SocketProtocolImp::secureAcceptImp: result=" << GSsl::Protocol::str(rc) ) ;
+	if( m_offloaded )
+		return ;
+	else if( offload() )
+		startOffload() ;
+	else
+		secureAcceptResult( m_ssl->accept( m_socket ) ) ;
+}
+
+void GNet::SocketProtocolImp::secureAcceptResult( Result rc )
+{
+	G_DEBUG( "SocketProtocolImp::secureAcceptResult: result=" << GSsl::Protocol::str(rc) ) ;
 	if( rc == Result::error )
 	{
 		m_socket.dropWriteHandler() ;
@@ -484,7 +700,73 @@ void GNet::SocketProtocolImp::secureAcceptImp()
 	}
 }
 
-bool GNet::SocketProtocolImp::sslSend( const Segments & segments , Position pos )
+bool GNet::SocketProtocolImp::offload() const
+{
+	// (no debug logging from worker threads)
+	return m_ssl->threaded() && G::threading::works() && !G::LogOutput::Instance::atDebug() ;
+}
+
+void GNet::SocketProtocolImp::startOffload()
+{
+	G_DEBUG( "SocketProtocolImp::startOffload: tls handshake step on worker thread" ) ;
+	m_socket.dropReadHandler() ;
+	m_socket.dropWriteHandler() ;
+	m_future_event = std::make_unique<FutureEvent>( static_cast<FutureEventHandler&>(*this) , m_es ) ;
+	m_future_handle = m_future_event->handle() ;
+	m_offload_result = Result::error ;
+	m_offload_exception = nullptr ;
+	m_offloaded = true ;
+	pool().submit( this ) ;
+}
+
+GNet::WorkerPool & GNet::SocketProtocolImp::pool()
+{
+	static WorkerPool * pool = new WorkerPool( G::Limits<>::tls_threads ) ; // NOLINT never deleted
+	return *pool ;
+}
+
+void GNet::SocketProtocolImp::workerRun() noexcept
+{
+	// worker thread
+	try
+	{
+		if( m_state == State::connecting )
+			m_offload_result = m_ssl->connect( m_socket ) ;
+		else
+			m_offload_result = m_ssl->accept( m_socket ) ;
+	}
+	catch(...)
+	{
+		m_offload_exception = std::current_exception() ;
+	}
+}
+
+void GNet::SocketProtocolImp::workerDone() noexcept
+{
+	// worker thread
+	FutureEvent::send( m_future_handle ) ;
+}
+
+void GNet::SocketProtocolImp::onFutureEvent()
+{
+	pool().sync() ;
+	G_ASSERT( m_offloaded ) ;
+	m_offloaded = false ;
+	m_ssl->flushLog() ;
+	m_socket.addReadHandler( m_handler , m_es ) ;
+	if( m_offload_exception )
+	{
+		std::exception_ptr e = m_offload_exception ;
+		m_offload_exception = nullptr ;
+		std::rethrow_exception( e ) ;
+	}
+	if( m_state == State::connecting )
+		secureConnectResult( m_offload_result ) ;
+	else
+		secureAcceptResult( m_offload_result ) ;
+}
+
+bool GNet::SocketProtocolImp::sslSend( const Segments & segments , Position pos , bool copied )
 {
 	if( !finished(m_segments,m_position) )
 		throw SocketProtocol::SendError( "still busy sending the last packet" ) ;
@@ -507,15 +789,91 @@ bool GNet::SocketProtocolImp::sslSend( const Segments & segments , Position pos
 	}
 	else
 	{
+		// keep the write position -- the ssl write has to be retried
+		// using the same buffer so uncopied segments block the caller
 		m_segments = segments ;
 		m_position = pos_out ;
 	}
-	return all_sent ;
+	return all_sent || ( copied && pending() <= m_config.send_queue_limit ) ;
 }
 
 bool GNet::SocketProtocolImp::sslSendImp()
 {
-	return sslSendImp( m_segments , m_position , m_position ) ;
+	bool all_sent = sslSendImp( m_segments , m_position , m_position ) ;
+	while( all_sent && !m_queue.empty() )
+	{
+		dequeue() ;
+		m_state = State::writing ;
+		all_sent = sslSendImp( m_segments , m_position , m_position ) ;
+	}
+	if( all_sent && m_file_size != 0U )
+	{
+		m_segments.clear() ;
+		m_position = Position() ;
+		all_sent = sslSendFile() ;
+	}
+	if( all_sent && m_shutdown_pending )
+	{
+		m_shutdown_pending = false ;
+		shutdown() ;
+	}
+	return all_sent ;
+}
+
+bool GNet::SocketProtocolImp::sslSendFile()
+{
+	if( m_file_size == 0U )
+		return true ;
+
+	G_ASSERT( m_state == State::idle ) ;
+	m_state = State::writing ;
+	bool all_sent = sslSendFileImp() ;
+	if( !all_sent && failed() )
+	{
+		m_file_fd = -1 ;
+		m_file_size = 0U ;
+		throw SocketProtocol::SendError() ;
+	}
+	else if( all_sent )
+	{
+		m_file_fd = -1 ;
+	}
+	return all_sent ;
+}
+
+bool GNet::SocketProtocolImp::sslSendFileImp()
+{
+	while( m_file_size != 0U )
+	{
+		ssize_t nsent = 0 ;
+		GSsl::Protocol::Result result = m_ssl->sendfile( m_file_fd , m_file_offset , m_file_size , nsent ) ;
+		if( result == Result::error || ( result == Result::ok && nsent <= 0 ) )
+		{
+			m_socket.dropWriteHandler() ;
+			m_state = State::idle ;
+			m_failed = true ;
+			return false ; // failed, or the file has been truncated
+		}
+		else if( result == Result::read )
+		{
+			m_socket.dropWriteHandler() ;
+			return false ; // not all sent - retry on read event
+		}
+		else if( result == Result::write )
+		{
+			m_socket.addWriteHandler( m_handler , m_es ) ;
+			return false ; // not all sent - retry on write event
+		}
+		else // Result::ok
+		{
+			std::size_t n = std::min( m_file_size , static_cast<std::size_t>(nsent) ) ;
+			m_file_offset += n ;
+			m_file_size -= n ;
+			SocketProtocolMetrics::bytes_out.add( n ) ;
+		}
+	}
+	m_state = State::idle ;
+	return true ; // all sent
 }
 
 bool GNet::SocketProtocolImp::sslSendImp( const Segments & segments , Position pos , Position & pos_out )
@@ -546,8 +904,9 @@ bool GNet::SocketProtocolImp::sslSendImp( const Segments & segments , Position p
 		{
 			// continue to next chunk
 			G_ASSERT( nsent >= 0 ) ;
-			pos_out = pos = newPosition( segments , pos ,
-				nsent >= 0 ? static_cast<std::size_t>(nsent) : std::size_t(0U) ) ;
+			const std::size_t n = nsent >= 0 ? static_cast<std::size_t>(nsent) : std::size_t(0U) ;
+			pos_out = pos = newPosition( segments , pos , n ) ;
+			SocketProtocolMetrics::bytes_out.add( n ) ;
 		}
 	}
 	m_state = State::idle ;
@@ -590,6 +949,7 @@ void GNet::SocketProtocolImp::sslReadImp()
 			G_DEBUG( "SocketProtocolImp::sslReadImp: calling onData(): " << n ) ;
 			if( n != 0U )
 			{
+				SocketProtocolMetrics::bytes_in.add( n ) ;
 				G::CallFrame this_( m_stack ) ;
 				m_sink.onData( m_read_buffer.data() , n ) ;
 				if( this_.deleted() ) break ;
@@ -622,6 +982,7 @@ bool GNet::SocketProtocolImp::rawOtherEvent( EventHandler::Reason reason )
 				throw SocketProtocol::ReadError( m_socket.reason() ) ;
 			}
 			G_ASSERT( static_cast<std::size_t>(rc) <= m_read_buffer.size() ) ;
+			SocketProtocolMetrics::bytes_in.add( static_cast<std::size_t>(rc) ) ;
 			G::CallFrame this_( m_stack ) ;
 			m_sink.onData( m_read_buffer.data() , static_cast<std::size_t>(rc) ) ;
 			if( this_.deleted() ) break ;
@@ -650,6 +1011,7 @@ bool GNet::SocketProtocolImp::rawReadEvent( bool no_throw_on_peer_disconnect )
 	else if( rc != -1 )
 	{
 		G_ASSERT( static_cast<std::size_t>(rc) <= m_read_buffer.size() ) ;
+		SocketProtocolMetrics::bytes_in.add( static_cast<std::size_t>(rc) ) ;
 		m_sink.onData( m_read_buffer.data() , static_cast<std::size_t>(rc) ) ;
 	}
 	else
@@ -664,8 +1026,8 @@ bool GNet::SocketProtocolImp::rawSend( const Segments & segments , Position pos
 {
 	G_ASSERT( !do_copy || segments.size() == 1U ) ; // copy => one segment
 
-	if( !finished(m_segments,m_position) )
-		throw SocketProtocol::SendError( "still busy sending the last packet" ) ;
+	if( !finished(m_segments,m_position) || m_file_size != 0U )
+		return queue( segments , pos ) ;
 
 	Position pos_out ;
 	bool all_sent = rawSendImp( segments , pos , pos_out ) ;
@@ -682,17 +1044,17 @@ bool GNet::SocketProtocolImp::rawSend( const Segments & segments , Position pos
 		m_position = Position() ;
 		m_data_copy.clear() ;
 	}
-	else if( do_copy )
+	else if( do_copy || residue(segments,pos_out) <= m_config.send_queue_limit )
 	{
 		// keep the residue in m_segments/m_position/m_data_copy
-		G_ASSERT( segments.size() == 1U ) ; // precondition
-		G_ASSERT( pos_out.offset < segments[0].size() ) ; // since not all sent
-		m_segments = segments ;
-		m_data_copy.assign( segments[0].data()+pos_out.offset , segments[0].size()-pos_out.offset ) ;
-		m_segments[0] = std::string_view( m_data_copy.data() , m_data_copy.size() ) ;
+		G_ASSERT( !finished(segments,pos_out) ) ; // since not all sent
+		m_data_copy.clear() ;
+		append( m_data_copy , segments , pos_out ) ;
+		m_segments.assign( 1U , std::string_view( m_data_copy.data() , m_data_copy.size() ) ) ;
 		m_position = Position() ;
 
 		m_socket.addWriteHandler( m_handler , m_es ) ;
+		all_sent = pending() <= m_config.send_queue_limit ; // accepted into the queue
 	}
 	else
 	{
@@ -710,11 +1072,17 @@ bool GNet::SocketProtocolImp::rawWriteEvent()
 {
 	m_socket.dropWriteHandler() ;
 	bool all_sent = rawSendImp( m_segments , m_position , m_position ) ;
+	while( all_sent && !m_queue.empty() )
+	{
+		dequeue() ;
+		all_sent = rawSendImp( m_segments , m_position , m_position ) ;
+	}
 	if( !all_sent && failed() )
 	{
 		m_segments.clear() ;
 		m_position = Position() ;
 		m_data_copy.clear() ;
+		m_queue.clear() ;
 		throw SocketProtocol::SendError() ;
 	}
 	if( all_sent )
@@ -722,6 +1090,60 @@ bool GNet::SocketProtocolImp::rawWriteEvent()
 		m_segments.clear() ;
 		m_position = Position() ;
 		m_data_copy.clear() ;
+		all_sent = rawSendFile() ;
+	}
+	else
+	{
+		m_socket.addWriteHandler( m_handler , m_es ) ;
+	}
+	if( all_sent && m_shutdown_pending )
+	{
+		m_shutdown_pending = false ;
+		shutdown() ;
+	}
+	return all_sent ;
+}
+
+bool GNet::SocketProtocolImp::queue( const Segments & segments , Position pos )
+{
+	// add to the output queue behind the current send, returning
+	// false if over budget so that the caller waits for the
+	// write-event -- file data cannot be queued
+	if( m_config.send_queue_limit == 0U || m_file_size != 0U )
+		throw SocketProtocol::SendError( "still busy sending the last packet" ) ;
+	append( m_queue , segments , pos ) ;
+	return pending() <= m_config.send_queue_limit ;
+}
+
+void GNet::SocketProtocolImp::dequeue()
+{
+	// move the queued data into m_data_copy as the current send
+	m_data_copy.swap( m_queue ) ;
+	m_queue.clear() ;
+	m_segments.assign( 1U , std::string_view( m_data_copy.data() , m_data_copy.size() ) ) ;
+	m_position = Position() ;
+}
+
+std::size_t GNet::SocketProtocolImp::pending() const
+{
+	return residue( m_segments , m_position ) + m_queue.size() + m_file_size ;
+}
+
+bool GNet::SocketProtocolImp::rawSendFile()
+{
+	if( m_file_size == 0U )
+		return true ;
+
+	bool all_sent = rawSendFileImp() ;
+	if( !all_sent && failed() )
+	{
+		m_file_fd = -1 ;
+		m_file_size = 0U ;
+		throw SocketProtocol::SendError( m_socket.reason() ) ;
+	}
+	else if( all_sent )
+	{
+		m_file_fd = -1 ;
 	}
 	else
 	{
@@ -730,12 +1152,45 @@ bool GNet::SocketProtocolImp::rawWriteEvent()
 	return all_sent ;
 }
 
+bool GNet::SocketProtocolImp::rawSendFileImp()
+{
+	while( m_file_size != 0U )
+	{
+		ssize_t rc = m_socket.writeFile( m_file_fd , m_file_offset , m_file_size ) ;
+		if( rc == 0 || ( rc < 0 && !m_socket.eWouldBlock() ) )
+		{
+			// fatal error, or the file has been truncated
+			m_failed = true ;
+			return false ; // failed()
+		}
+		else if( rc < 0 )
+		{
+			return false ; // flow control asserted
+		}
+		G_ASSERT( static_cast<std::size_t>(rc) <= m_file_size ) ;
+		std::size_t n = std::min( m_file_size , static_cast<std::size_t>(rc) ) ;
+		m_file_offset += n ;
+		m_file_size -= n ;
+		SocketProtocolMetrics::bytes_out.add( n ) ;
+	}
+	return true ; // all sent
+}
+
 bool GNet::SocketProtocolImp::rawSendImp( const Segments & segments , Position pos , Position & pos_out )
 {
 	while( !finished(segments,pos) )
 	{
-		std::string_view c = chunk( segments , pos ) ;
-		ssize_t rc = m_socket.write( c.data() , c.size() ) ;
+		// gather up to a few dozen chunks into one write
+		m_gather.clear() ;
+		m_gather.push_back( chunk( segments , pos ) ) ;
+		for( std::size_t i = pos.segment + 1U ; i < segments.size() && m_gather.size() < gather_limit ; i++ )
+			m_gather.push_back( segments[i] ) ;
+		std::size_t n = size( m_gather ) ;
+
+		ssize_t rc = m_gather.size() == 1U ?
+			m_socket.write( m_gather[0].data() , m_gather[0].size() ) :
+			m_socket.write( m_gather ) ;
+
 		if( rc < 0 && ! m_socket.eWouldBlock() )
 		{
 			// fatal error, eg. disconnection
@@ -743,17 +1198,19 @@ bool GNet::SocketProtocolImp::rawSendImp( const Segments & segments , Position p
 			m_failed = true ;
 			return false ; // failed()
 		}
-		else if( rc < 0 || static_cast<std::size_t>(rc) < c.size() )
+		else if( rc < 0 || static_cast<std::size_t>(rc) < n )
 		{
 			// flow control asserted -- return the position where we stopped
 			std::size_t nsent = rc > 0 ? static_cast<std::size_t>(rc) : 0U ;
 			pos_out = newPosition( segments , pos , nsent ) ;
+			SocketProtocolMetrics::bytes_out.add( nsent ) ;
 			G_ASSERT( !finished(segments,pos_out) ) ;
 			return false ; // not all sent
 		}
 		else
 		{
 			pos = newPosition( segments , pos , static_cast<std::size_t>(rc) ) ;
+			SocketProtocolMetrics::bytes_out.add( static_cast<std::size_t>(rc) ) ;
 		}
 	}
 	return true ; // all sent
@@ -764,16 +1221,22 @@ void GNet::SocketProtocolImp::rawReset()
 	m_segments.clear() ;
 	m_position = Position() ;
 	m_data_copy.clear() ;
+	m_queue.clear() ;
+	m_blocked = false ;
+	m_shutdown_pending = false ;
+	m_file_fd = -1 ;
+	m_file_size = 0U ;
 	m_socket.dropWriteHandler() ;
 }
 
-std::unique_ptr<GSsl::Protocol> GNet::SocketProtocolImp::newProtocol( const std::string & profile_name )
+std::unique_ptr<GSsl::Protocol> GNet::SocketProtocolImp::newProtocol( const std::string & profile_name ,
+	const std::string & session_key )
 {
 	GSsl::Library * library = GSsl::Library::instance() ;
 	if( library == nullptr )
 		throw G::Exception( "SocketProtocolImp::newProtocol: no tls library available" ) ;
 
-	return std::make_unique<GSsl::Protocol>( library->profile(profile_name) ) ;
+	return std::make_unique<GSsl::Protocol>( library->profile(profile_name) , std::string() , std::string() , session_key ) ;
 }
 
 bool GNet::SocketProtocolImp::finished( const Segments & segments , Position pos )
@@ -809,7 +1272,8 @@ void GNet::SocketProtocolImp::logSecure( const std::string & protocol , const st
 	G_LOG( "GNet::SocketProtocolImp: tls protocol established with "
 		<< m_socket.getPeerAddress().second.displayString()
 		<< (protocol.empty()?"":" protocol ") << protocol
-		<< (cipher.empty()?"":" cipher ") << G::Str::printable(cipher) ) ;
+		<< (cipher.empty()?"":" cipher ") << G::Str::printable(cipher)
+		<< (m_ssl->kernelTls()?" (kernel tls)":"") ) ;
 }
 
 //
@@ -848,6 +1312,11 @@ bool GNet::SocketProtocol::send( std::string_view data )
 	return m_imp->send( data , 0U ) ;
 }
 
+bool GNet::SocketProtocol::sendFile( std::string_view head , int fd , std::size_t offset , std::size_t size )
+{
+	return m_imp->sendFile( head , fd , offset , size ) ;
+}
+
 bool GNet::SocketProtocol::send( const std::vector<std::string_view> & data , std::size_t offset )
 {
 	return m_imp->send( data , offset ) ;
@@ -863,9 +1332,9 @@ bool GNet::SocketProtocol::secureConnectCapable() const
 	return m_imp->secureConnectCapable() ;
 }
 
-void GNet::SocketProtocol::secureConnect()
+void GNet::SocketProtocol::secureConnect( const std::string & session_key )
 {
-	m_imp->secureConnect() ;
+	m_imp->secureConnect( session_key ) ;
 }
 
 bool GNet::SocketProtocol::secureAcceptCapable() const
@@ -878,6 +1347,11 @@ void GNet::SocketProtocol::secureAccept()
 	m_imp->secureAccept() ;
 }
 
+bool GNet::SocketProtocol::sendFileZeroCopy() const
+{
+	return m_imp->sendFileZeroCopy() ;
+}
+
 #ifndef G_LIB_SMALL
 bool GNet::SocketProtocol::secure() const
 {
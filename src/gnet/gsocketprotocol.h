@@ -49,6 +49,12 @@ namespace GNet
 /// interface is half-duplex. If no TLS/SSL session is in effect ('raw') then
 /// the protocol layer is transparent down to the socket.
 ///
+/// Data that cannot be sent immediately because of flow control is held
+/// in a per-connection output queue, and further send()s are added to
+/// the queue, until the queue reaches a configurable byte budget. This
+/// allows producers to keep filling the socket without stopping to
+/// wait for every send to drain.
+///
 /// The interface has read-event and write-event handlers that should be
 /// called when events are detected on the socket file descriptor. In raw
 /// mode the read handler delivers data via the onData() callback interface
@@ -69,10 +75,12 @@ public:
 	struct Config /// A configuration structure for GNet::SocketProtocol.
 	{
 		std::size_t read_buffer_size {G::Limits<>::net_buffer} ;
+		std::size_t send_queue_limit {G::Limits<>::net_send_queue} ; // output queue byte budget, zero to disable
 		unsigned int secure_connection_timeout {0U} ;
 		std::string server_tls_profile ;
 		std::string client_tls_profile ;
 		Config & set_read_buffer_size( std::size_t n ) noexcept ;
+		Config & set_send_queue_limit( std::size_t n ) noexcept ;
 		Config & set_secure_connection_timeout( unsigned int t ) noexcept ;
 		Config & set_server_tls_profile( const std::string & s ) ;
 		Config & set_client_tls_profile( const std::string & s ) ;
@@ -106,38 +114,70 @@ public:
 		///< normally, otherwise an exception is thrown.
 
 	bool send( const std::string & data , std::size_t offset ) ;
-		///< Sends data. Returns false if flow control asserted before
-		///< all the data is sent. Returns true if all the data was sent,
-		///< or if the data passed in (taking the offset into account)
-		///< is empty. Throws SendError on error.
+		///< Sends data. Returns true if all the data was sent, or
+		///< if the data passed in (taking the offset into account)
+		///< is empty, or if any unsent data has been copied into the
+		///< output queue without exceeding the configured byte
+		///< budget. Returns false if flow control is asserted and
+		///< the output queue is full. Throws SendError on error.
 		///<
 		///< If flow control is asserted then the socket write-event
-		///< handler is installed and send() returns false. Unsent
-		///< portions of the data string are copied internally. When
-		///< the subsequent write-event is triggered the user should
-		///< call writeEvent(). There should be no new calls to send()
-		///< until writeEvent() or readEvent() returns true.
+		///< handler is installed and unsent portions of the data
+		///< string are copied internally. When the subsequent
+		///< write-event is triggered the user should call
+		///< writeEvent(). After send() returns false there should
+		///< be no new calls to send() until writeEvent() or
+		///< readEvent() returns true. If the output queue is
+		///< disabled then this applies after any incomplete send.
 
 	bool send( std::string_view data ) ;
 		///< Overload for string_view.
 
 	bool send( const std::vector<std::string_view> & data , std::size_t offset = 0U ) ;
 		///< Overload to send data using scatter-gather segments.
-		///< In this overload any unsent residue is not copied
+		///< In this overload any unsent residue is only copied if
+		///< it fits in the output queue, otherwise false is returned
 		///< and the segment pointers must stay valid until
 		///< writeEvent() returns true.
 
+	bool sendFile( std::string_view head , int fd , std::size_t offset , std::size_t size ) ;
+		///< Sends the 'head' data followed by 'size' bytes from the
+		///< given file starting at the given file offset. Flow control
+		///< is handled as for send(); the head is copied internally if
+		///< necessary but the file descriptor must stay open until
+		///< writeEvent() or readEvent() returns true. The file data
+		///< is never queued, so if sendFile() is used while earlier
+		///< send()s are still queued then it returns false. Throws
+		///< SendError on error, including a file that is shorter than
+		///< expected.
+		///<
+		///< If raw() then StreamSocket::writeFile() is used so that the
+		///< file data is not copied through user space. If secure() and
+		///< the TLS library has enabled kernel TLS then the file data
+		///< is sent by GSsl::Protocol::sendfile(). Otherwise the file
+		///< data is read into memory and sent like send(), in which case
+		///< the file position is changed.
+
+	bool sendFileZeroCopy() const ;
+		///< Returns true if sendFile() would send the file data without
+		///< copying it through user space, ie. if raw() or if kernel TLS
+		///< is active.
+
 	void shutdown() ;
 		///< Initiates a TLS-close if secure, together with a
-		///< Socket::shutdown(1).
+		///< Socket::shutdown(1). If there is queued output then
+		///< the shutdown is deferred until the queue has drained.
 
 	bool secureConnectCapable() const ;
 		///< Returns true if the implementation supports TLS/SSL and a
 		///< "client" profile has been configured. See also GSsl::enabledAs().
 
-	void secureConnect() ;
+	void secureConnect( const std::string & session_key = {} ) ;
 		///< Initiates the TLS/SSL handshake, acting as a client.
 		///< Any send() data blocked by flow control is discarded.
+		///< The optional session key identifies the peer so that
+		///< a TLS session from an earlier connection can be resumed;
+		///< see GSsl::Protocol::Protocol().
 
 	bool secureAcceptCapable() const ;
 		///< Returns true if the implementation supports TLS/SSL and a
@@ -198,6 +238,7 @@ public:
 } ;
 
 inline GNet::SocketProtocol::Config & GNet::SocketProtocol::Config::set_read_buffer_size( std::size_t n ) noexcept { read_buffer_size = n ; return *this ; }
+inline GNet::SocketProtocol::Config & GNet::SocketProtocol::Config::set_send_queue_limit( std::size_t n ) noexcept { send_queue_limit = n ; return *this ; }
 inline GNet::SocketProtocol::Config & GNet::SocketProtocol::Config::set_secure_connection_timeout( unsigned int t ) noexcept { secure_connection_timeout = t ; return *this ; }
 inline GNet::SocketProtocol::Config & GNet::SocketProtocol::Config::set_server_tls_profile( const std::string & s ) { server_tls_profile = s ; return *this ; }
 inline GNet::SocketProtocol::Config & GNet::SocketProtocol::Config::set_client_tls_profile( const std::string & s ) { client_tls_profile = s ; return *this ; }
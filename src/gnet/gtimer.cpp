@@ -109,6 +109,11 @@ void GNet::TimerBase::doTimeout()
 	onTimeout() ;
 }
 
+const char * GNet::TimerBase::statsName() const noexcept
+{
+	return "GNet::Timer" ;
+}
+
 G::TimerTime GNet::TimerBase::t() const
 {
 	return m_time ;
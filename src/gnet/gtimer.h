@@ -70,6 +70,11 @@ public:
 	void doTimeout() ;
 		///< Used by TimerList to execute the onTimeout() callback.
 
+	virtual const char * statsName() const noexcept ;
+		///< Returns a static name used to break down the event
+		///< loop statistics (see GNet::EventLoopStats). Overridable.
+		///< The default implementation returns "GNet::Timer".
+
 	G::TimerTime t() const ;
 		///< Used by TimerList to get the expiry epoch time. Zero-length
 		///< timers return TimerTime::zero() plus any adjust()ment,
@@ -89,6 +94,12 @@ public:
 		///< TimerTime::zero() then it is initialised with
 		///< TimerTime::now().
 
+	std::size_t listIndex() const noexcept ;
+		///< Used by TimerList to find the timer's list item.
+
+	void setListIndex( std::size_t ) noexcept ;
+		///< Used by TimerList to record the timer's list item.
+
 protected:
 	virtual void onTimeout() = 0 ;
 		///< Called when the timer expires (or soon after).
@@ -106,6 +117,7 @@ private:
 	bool m_active {false} ;
 	bool m_immediate {false} ;
 	G::TimerTime m_time ;
+	std::size_t m_list_index {0U} ;
 } ;
 
 inline
@@ -120,6 +132,18 @@ bool GNet::TimerBase::active() const noexcept
 	return m_active ;
 }
 
+inline
+std::size_t GNet::TimerBase::listIndex() const noexcept
+{
+	return m_list_index ;
+}
+
+inline
+void GNet::TimerBase::setListIndex( std::size_t i ) noexcept
+{
+	m_list_index = i ;
+}
+
 //| \class GNet::Timer
 /// A timer class template in which the timeout is delivered to the specified
 /// method. Any exception thrown out of the timeout handler is delivered to
@@ -24,11 +24,11 @@
 #include "gnetdone.h"
 #include "geventloop.h"
 #include "geventloggingcontext.h"
+#include "geventloopstats.h"
 #include "glog.h"
 #include "gassert.h"
 #include <algorithm>
-#include <functional>
-#include <sstream>
+#include <limits>
 
 GNet::TimerList::ListItem::ListItem( TimerBase * t , EventState es ) :
 	m_timer(t) ,
@@ -36,19 +36,6 @@ GNet::TimerList::ListItem::ListItem( TimerBase * t , EventState es ) :
 {
 }
 
-#ifndef G_LIB_SMALL
-inline bool GNet::TimerList::ListItem::operator==( const ListItem & rhs ) const noexcept
-{
-	return m_timer == rhs.m_timer ;
-}
-#endif
-
-inline void GNet::TimerList::ListItem::resetIf( TimerBase * p ) noexcept
-{
-	if( m_timer == p )
-		m_timer = nullptr ;
-}
-
 void GNet::TimerList::ListItem::disarmIf( ExceptionHandler * eh ) noexcept
 {
 	if( m_es.eh() == eh )
@@ -72,7 +59,11 @@ GNet::TimerList::Lock::~Lock()
 
 GNet::TimerList * GNet::TimerList::m_this = nullptr ;
 
-GNet::TimerList::TimerList()
+GNet::TimerList::TimerList() :
+	m_base(G::TimerTime::now()) ,
+	m_buckets(b_count) ,
+	m_bitmap(levels) ,
+	m_es_current(EventState::Private(),nullptr,nullptr)
 {
 	if( m_this == nullptr )
 		m_this = this ;
@@ -86,32 +77,47 @@ GNet::TimerList::~TimerList()
 
 void GNet::TimerList::add( TimerBase & t , EventState es )
 {
-	(m_locked?m_list_added:m_list).emplace_back( &t , es ) ;
+	std::size_t i = m_list.size() ;
+	if( m_free.empty() )
+	{
+		m_list.emplace_back( &t , es ) ;
+
+		// make sure that remove() never allocates
+		if( m_free.capacity() < m_list.size() )
+		{
+			m_free.reserve( m_list.capacity() ) ;
+			m_free_locked.reserve( m_list.capacity() ) ;
+		}
+	}
+	else
+	{
+		// (indexes are not recycled while locked -- see remove())
+		i = m_free.back() ;
+		m_free.pop_back() ;
+		m_list[i].m_timer = &t ;
+		m_list[i].m_es = es ;
+	}
+	t.setListIndex( i ) ;
 }
 
 void GNet::TimerList::remove( TimerBase & timer ) noexcept
 {
-	m_removed = true ;
-	removeFrom( m_list , &timer ) ;
-	removeFrom( m_list_added , &timer ) ;
-	if( m_soonest == &timer ) m_soonest = nullptr ;
-}
-
-void GNet::TimerList::removeFrom( List & list , TimerBase * timer_p ) noexcept
-{
-	for( auto & list_item : list )
-		list_item.resetIf( timer_p ) ;
+	std::size_t i = timer.listIndex() ;
+	if( i < m_list.size() && m_list[i].m_timer == &timer )
+	{
+		unlink( i ) ;
+		m_list[i].m_timer = nullptr ;
+		m_list[i].m_es = EventState( EventState::Private() , nullptr , nullptr ) ;
+		(m_locked?m_free_locked:m_free).push_back( i ) ; // no-throw, see add()
+	}
 }
 
 void GNet::TimerList::disarm( ExceptionHandler * eh ) noexcept
 {
-	disarmIn( m_list , eh ) ;
-	disarmIn( m_list_added , eh ) ;
-}
+	if( m_es_current.eh() == eh )
+		m_es_current.disarm() ;
 
-void GNet::TimerList::disarmIn( List & list , ExceptionHandler * eh ) noexcept
-{
-	for( auto & list_item : list )
+	for( auto & list_item : m_list )
 		list_item.disarmIf( eh ) ;
 }
 
@@ -120,51 +126,211 @@ void GNet::TimerList::updateOnStart( TimerBase & timer )
 	if( timer.immediate() )
 		timer.adjust( m_adjust++ ) ; // well-defined t() order for immediate timers
 
-	if( m_soonest == &timer )
-		m_soonest = nullptr ;
-
-	if( m_soonest != nullptr && timer.tref() < m_soonest->tref() )
-		m_soonest = &timer ;
+	std::size_t i = timer.listIndex() ;
+	G_ASSERT( i < m_list.size() && m_list[i].m_timer == &timer ) ;
+	unlink( i ) ;
+	link( i ) ;
 }
 
 void GNet::TimerList::updateOnCancel( TimerBase & timer )
 {
 	G_ASSERT( !timer.active() ) ;
-	if( m_soonest == &timer )
-		m_soonest = nullptr ;
+	std::size_t i = timer.listIndex() ;
+	G_ASSERT( i < m_list.size() && m_list[i].m_timer == &timer ) ;
+	unlink( i ) ;
 }
 
-const GNet::TimerBase * GNet::TimerList::findSoonest() const
+void GNet::TimerList::link( std::size_t i )
 {
-	G_ASSERT( !m_locked ) ;
-	TimerBase * result = nullptr ;
-	for( const auto & t : m_list )
+	const TimerBase & timer = *m_list[i].m_timer ;
+	if( timer.immediate() )
 	{
-		if( t.m_timer != nullptr && t.m_timer->active() && ( result == nullptr || t.m_timer->tref() < result->tref() ) )
-			result = t.m_timer ;
+		link( i , b_immediate ) ;
+	}
+	else
+	{
+		tick_type t = tick( timer.tref() ) ;
+		if( t <= m_tick )
+		{
+			link( i , b_due ) ;
+		}
+		else
+		{
+			// the level is given by the most significant slot number that
+			// differs from the current tick
+			unsigned int level = 0U ;
+			for( tick_type diff = (t^m_tick) >> slot_bits ; diff != 0U && level < levels ; diff >>= slot_bits )
+				level++ ;
+
+			if( level == levels )
+				link( i , b_overflow ) ;
+			else
+				link( i , level * slots + static_cast<std::size_t>((t >> (level*slot_bits)) & (slots-1U)) ) ;
+		}
 	}
-	return result ;
 }
 
-std::pair<G::TimeInterval,bool> GNet::TimerList::interval() const
+void GNet::TimerList::link( std::size_t i , std::size_t bucket )
+{
+	ListItem & item = m_list[i] ;
+	Bucket & b = m_buckets[bucket] ;
+	item.m_bucket = bucket ;
+	item.m_prev = b.m_tail ;
+	item.m_next = npos ;
+	if( b.m_tail == npos )
+		b.m_head = i ;
+	else
+		m_list[b.m_tail].m_next = i ;
+	b.m_tail = i ;
+	if( bucket < b_overflow )
+		m_bitmap[bucket/slots] |= ( std::uint64_t(1U) << (bucket%slots) ) ;
+}
+
+void GNet::TimerList::unlink( std::size_t i ) noexcept
 {
-	if( m_soonest == nullptr )
-		m_soonest = findSoonest() ;
+	ListItem & item = m_list[i] ;
+	if( item.m_bucket == npos )
+		return ;
+
+	Bucket & b = m_buckets[item.m_bucket] ;
+	if( item.m_prev == npos )
+		b.m_head = item.m_next ;
+	else
+		m_list[item.m_prev].m_next = item.m_next ;
+	if( item.m_next == npos )
+		b.m_tail = item.m_prev ;
+	else
+		m_list[item.m_next].m_prev = item.m_prev ;
+
+	if( b.m_head == npos && item.m_bucket < b_overflow )
+		m_bitmap[item.m_bucket/slots] &= ~( std::uint64_t(1U) << (item.m_bucket%slots) ) ;
 
-	if( m_soonest == nullptr )
+	item.m_bucket = npos ;
+	item.m_prev = npos ;
+	item.m_next = npos ;
+}
+
+bool GNet::TimerList::nextTick( tick_type & n , std::size_t & bucket ) const
+{
+	// the lowest level with anything in it has the soonest bucket,
+	// and every occupied slot is ahead of the current tick's slot
+	for( unsigned int level = 0U ; level < levels ; level++ )
 	{
-		return std::make_pair( G::TimeInterval(0) , true ) ;
+		if( m_bitmap[level] != 0U )
+		{
+			unsigned int slot = lowestBit( m_bitmap[level] ) ;
+			unsigned int shift = level * slot_bits ;
+			tick_type mask = ( tick_type(1U) << (shift+slot_bits) ) - 1U ;
+			n = ( m_tick & ~mask ) | ( tick_type(slot) << shift ) ;
+			bucket = level * slots + slot ;
+			return true ;
+		}
 	}
-	else if( m_soonest->immediate() )
+	if( m_buckets[b_overflow].m_head != npos )
 	{
-		return std::make_pair( G::TimeInterval(0) , false ) ;
+		unsigned int shift = levels * slot_bits ;
+		n = ( (m_tick >> shift) + 1U ) << shift ;
+		bucket = b_overflow ;
+		return true ;
 	}
-	else
+	return false ;
+}
+
+void GNet::TimerList::advance( tick_type t )
+{
+	tick_type n = 0U ;
+	std::size_t bucket = 0U ;
+	while( nextTick( n , bucket ) && n <= t )
+	{
+		m_tick = n ;
+		cascade( bucket ) ;
+	}
+	if( t > m_tick )
+		m_tick = t ;
+}
+
+void GNet::TimerList::cascade( std::size_t bucket )
+{
+	// re-link the bucket's timers relative to the new current tick --
+	// they go onto the due list or down to a lower level
+	std::size_t i = m_buckets[bucket].m_head ;
+	m_buckets[bucket] = Bucket() ;
+	if( bucket < b_overflow )
+		m_bitmap[bucket/slots] &= ~( std::uint64_t(1U) << (bucket%slots) ) ;
+	while( i != npos )
+	{
+		std::size_t next = m_list[i].m_next ;
+		link( i ) ;
+		i = next ;
+	}
+}
+
+bool GNet::TimerList::wheelEmpty() const noexcept
+{
+	return
+		std::all_of( m_bitmap.begin() , m_bitmap.end() , [](std::uint64_t w_){ return w_ == 0U ; } ) &&
+		m_buckets[b_overflow].m_head == npos &&
+		m_buckets[b_due].m_head == npos ;
+}
+
+GNet::TimerList::tick_type GNet::TimerList::tick( const G::TimerTime & t ) const
+{
+	G::TimeInterval d( m_base , t ) ; // zero on underflow
+	return tick_type(d.s()) * 1000U + d.us() / 1000U ;
+}
+
+G::TimerTime GNet::TimerList::time( tick_type n ) const
+{
+	constexpr tick_type s_max = std::numeric_limits<G::TimeInterval::s_type>::max() ;
+	return m_base + G::TimeInterval( static_cast<G::TimeInterval::s_type>( std::min(n/1000U,s_max) ) ,
+		static_cast<G::TimeInterval::us_type>( (n%1000U) * 1000U ) ) ;
+}
+
+const GNet::TimerBase * GNet::TimerList::soonest( std::size_t bucket ) const
+{
+	const TimerBase * result = nullptr ;
+	for( std::size_t i = m_buckets[bucket].m_head ; i != npos ; i = m_list[i].m_next )
 	{
-		G::TimerTime now = G::TimerTime::now() ;
-		G::TimerTime then = m_soonest->t() ;
-		return std::make_pair( G::TimeInterval(now,then) , false ) ;
+		const TimerBase * t = m_list[i].m_timer ;
+		if( result == nullptr || t->tref() < result->tref() )
+			result = t ;
 	}
+	return result ;
+}
+
+unsigned int GNet::TimerList::lowestBit( std::uint64_t bits ) noexcept
+{
+	G_ASSERT( bits != 0U ) ;
+	unsigned int n = 0U ;
+	for( ; (bits & 0xffU) == 0U ; bits >>= 8 )
+		n += 8U ;
+	for( ; (bits & 1U) == 0U ; bits >>= 1 )
+		n++ ;
+	return n ;
+}
+
+std::pair<G::TimeInterval,bool> GNet::TimerList::interval() const
+{
+	if( m_buckets[b_immediate].m_head != npos )
+		return std::make_pair( G::TimeInterval(0) , false ) ;
+
+	// use the soonest timer on the due list or in the first
+	// level-zero bucket, or otherwise wake up at the next
+	// cascade
+	G::TimerTime then = G::TimerTime::zero() ;
+	tick_type n = 0U ;
+	std::size_t bucket = 0U ;
+	if( m_buckets[b_due].m_head != npos )
+		then = soonest( b_due )->t() ;
+	else if( !nextTick( n , bucket ) )
+		return std::make_pair( G::TimeInterval(0) , true ) ;
+	else if( bucket < slots )
+		then = soonest( bucket )->t() ;
+	else
+		then = time( n ) ;
+
+	G::TimerTime now = G::TimerTime::now() ;
+	return std::make_pair( G::TimeInterval(now,then) , false ) ;
 }
 
 GNet::TimerList * GNet::TimerList::ptr() noexcept
@@ -196,84 +362,79 @@ void GNet::TimerList::unlock()
 	if( m_locked )
 	{
 		m_locked = false ;
-		mergeAdded() ; // accept any add()ed while locked
-		purgeRemoved() ; // collect garbage created by remove()
-	}
-}
-
-void GNet::TimerList::mergeAdded()
-{
-	if( !m_list_added.empty() )
-	{
-		if( m_soonest != nullptr && (m_list.size()+m_list_added.size()) > m_list.capacity() )
-			m_soonest = nullptr ; // about to be invalidated
-		m_list.reserve( m_list.size() + m_list_added.size() ) ;
-		m_list.insert( m_list.end() , m_list_added.begin() , m_list_added.end() ) ;
-		m_list_added.clear() ;
-	}
-}
-
-void GNet::TimerList::purgeRemoved()
-{
-	if( m_removed )
-	{
-		m_removed = false ;
-		m_soonest = nullptr ; // about to be invalidated
-		m_list.erase( std::remove_if( m_list.begin() , m_list.end() ,
-			[](const ListItem &v_){ return v_.m_timer == nullptr ; } ) , m_list.end() ) ;
+		m_free.insert( m_free.end() , m_free_locked.begin() , m_free_locked.end() ) ; // no-throw, see add()
+		m_free_locked.clear() ;
 	}
 }
 
 void GNet::TimerList::doTimeouts()
 {
-	G_ASSERT( m_list_added.empty() ) ;
 	Lock lock( *this ) ;
 	m_adjust = 0 ;
 	G::TimerTime now = G::TimerTime::zero() ; // lazy initialisation to G::TimerTime::now() in G::Timer::expired()
 
-	// move expired timers to the front
-	auto expired_end = std::partition( m_list.begin() , m_list.end() ,
-		[&now](const ListItem &li_){ return li_.m_timer != nullptr && li_.m_timer->active() && li_.m_timer->expired(now) ; } ) ;
+	// turn the wheel so that anything due by now is on the due list
+	if( !wheelEmpty() )
+	{
+		now = G::TimerTime::now() ;
+		advance( tick(now) ) ;
+	}
 
-	// sort expired timers so that they are handled in time order
-	std::sort( m_list.begin() , expired_end ,
-		[](const ListItem &a,const ListItem &b){ return a.m_timer->tref() < b.m_timer->tref() ; } ) ;
+	// collect expired timers, immediate timers first in the order they were started
+	m_expired.clear() ;
+	for( std::size_t i = m_buckets[b_immediate].m_head ; i != npos ; i = m_list[i].m_next )
+		m_expired.push_back( i ) ;
+	std::size_t immediate_count = m_expired.size() ;
+	for( std::size_t i = m_buckets[b_due].m_head ; i != npos ; i = m_list[i].m_next )
+	{
+		if( m_list[i].m_timer->expired(now) )
+			m_expired.push_back( i ) ;
+	}
 
-	// invalidate the soonest pointer, except in the degenerate case where nothing changes
-	if( expired_end != m_list.begin() )
-		m_soonest = nullptr ;
+	// sort expired timers so that they are handled in time order
+	std::sort( m_expired.begin() + immediate_count , m_expired.end() ,
+		[this](std::size_t a,std::size_t b){ return m_list[a].m_timer->tref() < m_list[b].m_timer->tref() ; } ) ;
 
-	// call each expired timer's handler
-	for( List::iterator item_p = m_list.begin() ; item_p != expired_end ; ++item_p )
+	// call each expired timer's handler -- list items are not recycled
+	// while locked so the indexes stay valid even if the timer is deleted
+	for( std::size_t n = 0U ; n < m_expired.size() ; n++ )
 	{
+		std::size_t i = m_expired[n] ;
+		TimerBase * timer = m_list[i].m_timer ;
+
 		// (make sure the timer is still valid and expired in case another timer's handler has changed it)
-		if( item_p->m_timer != nullptr && item_p->m_timer->active() && item_p->m_timer->expired(now) )
-			doTimeout( *item_p ) ;
+		if( timer != nullptr && timer->active() && timer->expired(now) )
+		{
+			m_es_current = m_list[i].m_es ; // see disarm()
+			unlink( i ) ;
+			doTimeout( timer ) ;
+		}
 	}
 
 	// unlock the list explicitly to avoid the Lock dtor throwing
 	unlock() ;
 }
 
-void GNet::TimerList::doTimeout( ListItem & item )
+void GNet::TimerList::doTimeout( TimerBase * timer )
 {
 	// see also GNet::EventEmitter::raiseEvent()
-	EventLoggingContext set_logging_context( item.m_es ) ;
+	EventLoggingContext set_logging_context( m_es_current ) ;
+	EventLoopStats::Dispatch stats( EventLoopStats::Type::timer , timer->statsName() ) ;
 	try
 	{
-		item.m_timer->doTimeout() ;
+		timer->doTimeout() ;
 	}
 	catch( GNet::Done & e ) // (caught separately to avoid requiring rtti)
 	{
-		if( item.m_es.hasExceptionHandler() )
-			item.m_es.doOnException( e , true ) ;
+		if( m_es_current.hasExceptionHandler() )
+			m_es_current.doOnException( e , true ) ;
 		else
 			throw ;
 	}
 	catch( std::exception & e )
 	{
-		if( item.m_es.hasExceptionHandler() )
-			item.m_es.doOnException( e , false ) ;
+		if( m_es_current.hasExceptionHandler() )
+			m_es_current.doOnException( e , false ) ;
 		else
 			throw ;
 	}
@@ -27,6 +27,7 @@
 #include "geventhandler.h"
 #include "gexception.h"
 #include "geventstate.h"
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -59,9 +60,12 @@ namespace GNet
 /// exception handler base-class destructor uses the timer list's disarm()
 /// mechanism. This is the same behaviour as in the EventLoop.
 ///
-/// The implementation maintains a pointer to the timer that will
-/// expire soonest so that interval() is fast and O(1) when the set
-/// of timers is stable and most events are non-timer events.
+/// The implementation is a hierarchical timing wheel with millisecond
+/// ticks so that starting, cancelling and destroying a timer is O(1)
+/// and expired timers are collected in batches. Timers far in the future
+/// sit in coarse buckets and are cascaded down into finer buckets as the
+/// wheel turns. Non-empty buckets are tracked in a bitmap per level so
+/// that interval() does not have to scan the timers.
 ///
 /// Zero-length timers expire in the same order as they were started,
 /// which allows them to be used as a mechanism for asynchronous
@@ -123,15 +127,30 @@ public:
 	TimerList & operator=( TimerList && ) = delete ;
 
 private:
+	using tick_type = std::uint64_t ;
+	static constexpr unsigned int slot_bits = 6U ;
+	static constexpr std::size_t slots = std::size_t(1U) << slot_bits ;
+	static constexpr unsigned int levels = 6U ; // 2^36ms, about two years
+	static constexpr std::size_t npos = ~std::size_t(0) ;
+	static constexpr std::size_t b_overflow = levels * slots ;
+	static constexpr std::size_t b_due = b_overflow + 1U ;
+	static constexpr std::size_t b_immediate = b_due + 1U ;
+	static constexpr std::size_t b_count = b_immediate + 1U ;
 	struct ListItem /// A value type for the GNet::TimerList.
 	{
 		TimerBase * m_timer{nullptr} ; // handler for the timeout event
 		EventState m_es ; // handler for any exception thrown
+		std::size_t m_bucket{npos} ;
+		std::size_t m_prev{npos} ;
+		std::size_t m_next{npos} ;
 		ListItem( TimerBase * t , EventState es ) ;
-		bool operator==( const ListItem & v ) const noexcept ;
-		void resetIf( TimerBase * p ) noexcept ;
 		void disarmIf( ExceptionHandler * eh ) noexcept ;
 	} ;
+	struct Bucket /// A doubly-linked list of GNet::TimerList::ListItem indexes.
+	{
+		std::size_t m_head{npos} ;
+		std::size_t m_tail{npos} ;
+	} ;
 	using List = std::vector<ListItem> ;
 	struct Lock /// A RAII class to lock and unlock GNet::TimerList.
 	{
@@ -147,23 +166,34 @@ private:
 	friend struct Lock ;
 
 private:
-	const TimerBase * findSoonest() const ;
 	void lock() ;
 	void unlock() ;
-	void purgeRemoved() ;
-	void mergeAdded() ;
-	void doTimeout( ListItem & ) ;
-	static void removeFrom( List & , TimerBase * ) noexcept ;
-	static void disarmIn( List & , ExceptionHandler * ) noexcept ;
+	void link( std::size_t ) ;
+	void link( std::size_t , std::size_t bucket ) ;
+	void unlink( std::size_t ) noexcept ;
+	void advance( tick_type ) ;
+	void cascade( std::size_t bucket ) ;
+	bool nextTick( tick_type & , std::size_t & bucket ) const ;
+	bool wheelEmpty() const noexcept ;
+	tick_type tick( const G::TimerTime & ) const ;
+	G::TimerTime time( tick_type ) const ;
+	const TimerBase * soonest( std::size_t bucket ) const ;
+	void doTimeout( TimerBase * ) ;
+	static unsigned int lowestBit( std::uint64_t ) noexcept ;
 
 private:
 	static TimerList * m_this ;
-	mutable const TimerBase * m_soonest{nullptr} ;
+	G::TimerTime m_base ;
+	tick_type m_tick{0U} ;
 	unsigned int m_adjust{0} ;
 	bool m_locked{false} ;
-	bool m_removed{false} ;
 	List m_list ;
-	List m_list_added ; // temporary list for when add()ed from within doTimeouts()
+	std::vector<std::size_t> m_free ;
+	std::vector<std::size_t> m_free_locked ; // garbage created by remove() from within doTimeouts()
+	std::vector<Bucket> m_buckets ;
+	std::vector<std::uint64_t> m_bitmap ; // non-empty buckets, one word per level
+	std::vector<std::size_t> m_expired ;
+	EventState m_es_current ;
 } ;
 
 #endif
@@ -0,0 +1,103 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gworkerpool.cpp
+///
+
+#include "gdef.h"
+#include "gworkerpool.h"
+#include "gcleanup.h"
+#include "glog.h"
+#include <algorithm>
+
+GNet::WorkerPool::WorkerPool( std::size_t max_threads ) :
+	m_max_threads(std::max(std::size_t(1U),max_threads))
+{
+}
+
+void GNet::WorkerPool::submit( WorkerPoolJob * job )
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	if( m_idle <= m_queue.size() && m_threads < m_max_threads )
+	{
+		G_DEBUG( "GNet::WorkerPool::submit: new worker thread: " << (m_threads+1U) ) ;
+		G::Cleanup::Block block_signals ;
+		G::threading::thread_type( WorkerPool::work , this ).detach() ;
+		m_threads++ ;
+	}
+	m_queue.push_back( job ) ;
+	m_jobs++ ;
+	m_cond.notify_one() ;
+}
+
+bool GNet::WorkerPool::cancel( WorkerPoolJob * job , bool wait )
+{
+	G::threading::unique_lock_type lock( m_mutex ) ;
+	auto p = std::find( m_queue.begin() , m_queue.end() , job ) ;
+	if( p != m_queue.end() )
+	{
+		m_queue.erase( p ) ;
+		return true ;
+	}
+	while( wait && std::find( m_running.begin() , m_running.end() , job ) != m_running.end() )
+		m_done_cond.wait( lock ) ;
+	return false ;
+}
+
+void GNet::WorkerPool::sync()
+{
+	G::threading::lock_type lock( m_mutex ) ;
+}
+
+GNet::WorkerPool::Stats GNet::WorkerPool::stats()
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	Stats s ;
+	s.threads = m_threads ;
+	s.running = m_running.size() ;
+	s.queued = m_queue.size() ;
+	s.jobs = m_jobs ;
+	return s ;
+}
+
+void GNet::WorkerPool::work( WorkerPool * This ) noexcept
+{
+	// thread function, detached from submit() and runs forever
+	for(;;)
+	{
+		WorkerPoolJob * job = nullptr ;
+		{
+			G::threading::unique_lock_type lock( This->m_mutex ) ;
+			This->m_idle++ ;
+			while( This->m_queue.empty() )
+				This->m_cond.wait( lock ) ;
+			This->m_idle-- ;
+			job = This->m_queue.front() ;
+			This->m_queue.pop_front() ;
+			This->m_running.push_back( job ) ;
+		}
+		job->workerRun() ;
+		{
+			// the job can be deleted as soon as it is signalled so do
+			// it while holding the lock -- see cancel() and sync()
+			G::threading::lock_type lock( This->m_mutex ) ;
+			This->m_running.erase( std::find( This->m_running.begin() , This->m_running.end() , job ) ) ;
+			job->workerDone() ;
+			This->m_done_cond.notify_all() ;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gworkerpool.h
+///
+
+#ifndef G_NET_WORKER_POOL_H
+#define G_NET_WORKER_POOL_H
+
+#include "gdef.h"
+#include <deque>
+#include <vector>
+
+namespace GNet
+{
+	class WorkerPool ;
+	class WorkerPoolJob ;
+}
+
+//| \class GNet::WorkerPool
+/// A bounded pool of long-lived worker threads that run queued
+/// jobs. Threads are created on demand up to a fixed limit and
+/// are then kept running, so the pool object should never be
+/// destroyed.
+///
+/// A job's workerRun() method is called from a worker thread and
+/// then its workerDone() method is called while holding the pool's
+/// lock. The workerDone() implementation typically uses a
+/// GNet::FutureEvent to signal the main thread, which then calls
+/// sync() before looking at the job's results.
+///
+/// \see GNet::Resolver, GNet::SocketProtocol
+///
+class GNet::WorkerPool
+{
+public:
+	struct Stats /// Statistics for GNet::WorkerPool.
+	{
+		std::size_t threads {0U} ;
+		std::size_t running {0U} ;
+		std::size_t queued {0U} ;
+		unsigned long jobs {0UL} ;
+	} ;
+
+	explicit WorkerPool( std::size_t max_threads ) ;
+		///< Constructor.
+
+	void submit( WorkerPoolJob * ) ;
+		///< Queues a job, creating a new worker thread if
+		///< there are not enough idle threads.
+
+	bool cancel( WorkerPoolJob * , bool wait = false ) ;
+		///< Removes a job from the queue. Returns false if not
+		///< queued, ie. already started or finished. If the job
+		///< has started and 'wait' is true then waits for it
+		///< to finish.
+
+	void sync() ;
+		///< Synchronises with the worker threads so that the
+		///< results of a finished job are visible.
+
+	Stats stats() ;
+		///< Returns current statistics.
+
+public:
+	WorkerPool( const WorkerPool & ) = delete ;
+	WorkerPool( WorkerPool && ) = delete ;
+	WorkerPool & operator=( const WorkerPool & ) = delete ;
+	WorkerPool & operator=( WorkerPool && ) = delete ;
+
+private:
+	static void work( WorkerPool * ) noexcept ;
+
+private:
+	G::threading::mutex_type m_mutex ;
+	G::threading::cond_type m_cond ;
+	G::threading::cond_type m_done_cond ;
+	std::deque<WorkerPoolJob*> m_queue ;
+	std::vector<WorkerPoolJob*> m_running ;
+	std::size_t m_max_threads ;
+	std::size_t m_threads {0U} ;
+	std::size_t m_idle {0U} ;
+	unsigned long m_jobs {0UL} ;
+} ;
+
+//| \class GNet::WorkerPoolJob
+/// An interface for jobs run by GNet::WorkerPool.
+///
+class GNet::WorkerPoolJob
+{
+public:
+	virtual ~WorkerPoolJob() = default ;
+		///< Destructor.
+
+	virtual void workerRun() noexcept = 0 ;
+		///< Does the work. Called from a worker thread.
+
+	virtual void workerDone() noexcept = 0 ;
+		///< Called from a worker thread after workerRun() while
+		///< holding the pool's lock. The job object can be
+		///< deleted by the main thread as soon as this returns.
+} ;
+
+#endif
@@ -91,6 +91,7 @@ private:
 	void forward() ;
 	void help() ;
 	void status() ;
+	void stats( std::string_view ) ;
 	void sendMessageIds( const std::vector<GStore::MessageId> & ) ;
 	void sendLine( std::string && ) ;
 	void sendLineCopy( std::string ) ;
@@ -146,7 +147,8 @@ public:
 	{
 		forward ,
 		dnsbl ,
-		smtp_enable
+		smtp_enable ,
+		upgrade
 	} ;
 
 	static bool enabled() ;
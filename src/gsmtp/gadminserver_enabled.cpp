@@ -27,6 +27,10 @@
 #include "gprocess.h"
 #include "glocal.h"
 #include "gmonitor.h"
+#include "geventloopstats.h"
+#include "gresolver.h"
+#include "gdnsbl.h"
+#include "gconnectionlimiter.h"
 #include "gslot.h"
 #include "gstringtoken.h"
 #include "gstr.h"
@@ -140,6 +144,10 @@ bool GSmtp::AdminServerPeer::onReceive( const char * line_data , std::size_t lin
 	{
 		status() ;
 	}
+	else if( is(t(),"stats") )
+	{
+		stats( (++t)() ) ;
+	}
 	else if( is(t(),"notify") )
 	{
 		m_notifying = true ;
@@ -173,6 +181,13 @@ bool GSmtp::AdminServerPeer::onReceive( const char * line_data , std::size_t lin
 		if( GNet::EventLoop::exists() )
 			GNet::EventLoop::instance().quit("") ;
 	}
+	else if( is(t(),"upgrade") && m_with_terminate )
+	{
+		G_LOG_S( "GSmtp::AdminServerPeer::onReceive: received an upgrade command from "
+			<< peerAddress().displayString() ) ;
+		sendLine( "OK" ) ;
+		m_server_imp.emitCommand( AdminServer::Command::upgrade , 0U ) ;
+	}
 	else if( is(t(),"info") && !m_info_commands.empty() )
 	{
 		std::string_view arg = (++t)() ;
@@ -264,9 +279,11 @@ void GSmtp::AdminServerPeer::help()
 		.append( "pid, " )
 		.append( "quit, " )
 		.append( "smtp, " )
+		.append( "stats, " )
 		.append( "status, " )
 		.append( "terminate, " , m_with_terminate ? 11U : 0U )
-		.append( "unfail-all" )) ) ;
+		.append( "unfail-all" )
+		.append( ", upgrade" , m_with_terminate ? 9U : 0U )) ) ;
 }
 
 void GSmtp::AdminServerPeer::flush()
@@ -351,6 +368,9 @@ void GSmtp::AdminServerPeer::status()
 	{
 		const std::string eolstr = eol() ;
 		GNet::Monitor::instance()->report( ss , "" , eolstr ) ;
+		GNet::Resolver::report( ss , "" , eolstr ) ;
+		GNet::Dnsbl::report( ss , "" , eolstr ) ;
+		GNet::ConnectionLimiter::report( ss , "" , eolstr ) ;
 		std::string report = ss.str() ;
 		G::Str::trimRight( report , eolstr ) ;
 		sendLine( std::move(report) ) ;
@@ -361,6 +381,32 @@ void GSmtp::AdminServerPeer::status()
 	}
 }
 
+void GSmtp::AdminServerPeer::stats( std::string_view arg )
+{
+	if( !GNet::EventLoopStats::enabled() )
+	{
+		sendLine( "error: no statistics: use --admin-stats" ) ;
+	}
+	else if( G::Str::imatch( arg , "reset" ) )
+	{
+		GNet::EventLoopStats::reset() ;
+		sendLine( "OK" ) ;
+	}
+	else if( !arg.empty() )
+	{
+		sendLine( "usage: stats [reset]" ) ;
+	}
+	else
+	{
+		std::ostringstream ss ;
+		const std::string eolstr = eol() ;
+		GNet::EventLoopStats::report( ss , "" , eolstr ) ;
+		std::string report = ss.str() ;
+		G::Str::trimRight( report , eolstr ) ;
+		sendLine( std::move(report) ) ;
+	}
+}
+
 void GSmtp::AdminServerPeer::sendMessageIds( const std::vector<GStore::MessageId> & ids )
 {
 	std::ostringstream ss ;
@@ -0,0 +1,158 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gmetricsserver.cpp
+///
+
+#include "gdef.h"
+#include "gmetricsserver.h"
+#include "gmetrics.h"
+#include "glinebuffer.h"
+#include "gnetdone.h"
+#include "gstringtoken.h"
+#include "gstr.h"
+#include "glog.h"
+#include <sstream>
+#include <utility>
+
+GSmtp::MetricsServerPeer::MetricsServerPeer( GNet::EventStateUnbound esu , GNet::ServerPeerInfo && peer_info ) :
+	GNet::ServerPeer(esbind(esu,this),std::move(peer_info),GNet::LineBuffer::Config::http())
+{
+	G_DEBUG( "GSmtp::MetricsServerPeer: metrics connection from " << peerAddress().displayString() ) ;
+}
+
+void GSmtp::MetricsServerPeer::onDelete( const std::string & reason )
+{
+	G_LOG( "GSmtp::MetricsServerPeer: metrics connection closed: " << reason << (reason.empty()?"":": ")
+		<< peerAddress().displayString() ) ;
+}
+
+void GSmtp::MetricsServerPeer::onSecure( const std::string & , const std::string & , const std::string & )
+{
+}
+
+bool GSmtp::MetricsServerPeer::onReceive( const char * line_data , std::size_t line_size , std::size_t ,
+	std::size_t , char )
+{
+	if( m_responded )
+		return true ; // ignore pipelined requests
+
+	std::string_view line( line_data , line_size ) ;
+	if( m_method.empty() )
+	{
+		// request line
+		G::StringTokenView t( line , " " , 1U ) ;
+		m_method = G::Str::upper( t() ) ;
+		m_path = G::sv_to_string( (++t)() ) ;
+		if( m_method.empty() )
+			throw GNet::Done() ;
+	}
+	else if( line.empty() )
+	{
+		// end of headers -- any request body is not expected
+		m_responded = true ;
+		respond() ;
+	}
+	return true ;
+}
+
+void GSmtp::MetricsServerPeer::respond()
+{
+	std::string path = G::Str::head( m_path , m_path.find('?') , m_path ) ;
+	if( m_method != "GET" && m_method != "HEAD" )
+	{
+		sendResponse( "405 Method Not Allowed" , "text/plain" , "method not allowed\n" ) ;
+	}
+	else if( path != "/metrics" )
+	{
+		sendResponse( "404 Not Found" , "text/plain" , "not found\n" ) ;
+	}
+	else
+	{
+		std::ostringstream ss ;
+		GNet::Metrics::output( ss ) ;
+		sendResponse( "200 OK" , GNet::Metrics::contentType() , ss.str() ) ;
+	}
+}
+
+void GSmtp::MetricsServerPeer::sendResponse( const std::string & status , const std::string & content_type ,
+	const std::string & body )
+{
+	std::string response ;
+	response.reserve( body.size() + 200U ) ;
+	response.append( "HTTP/1.1 " ).append( status ).append( "\r\n" ) ;
+	response.append( "Content-Type: " ).append( content_type ).append( "\r\n" ) ;
+	response.append( "Content-Length: " ).append( std::to_string(body.size()) ).append( "\r\n" ) ;
+	response.append( "Connection: close\r\n" ) ;
+	response.append( "\r\n" ) ;
+	if( m_method != "HEAD" )
+		response.append( body ) ;
+
+	// send() returning true can mean that the response is still
+	// sitting in the output queue, so rather than closing now do
+	// a socket shutdown, deferred until the queue has drained,
+	// and let the client close the connection -- if flow control
+	// is asserted then onSendComplete() closes as well
+	send( response ) ; // GNet::ServerPeer::send()
+	finish() ;
+}
+
+void GSmtp::MetricsServerPeer::onSendComplete()
+{
+	throw GNet::Done() ;
+}
+
+// ==
+
+GSmtp::MetricsServer::MetricsServer( GNet::EventState es , const G::StringArray & interfaces , const Config & config ) :
+	GNet::MultiServer(es,interfaces,config.port,"metrics",config.net_server_peer_config,config.net_server_config) ,
+	m_config(config)
+{
+}
+
+GSmtp::MetricsServer::~MetricsServer()
+{
+	serverCleanup() ; // base class early cleanup
+}
+
+std::unique_ptr<GNet::ServerPeer> GSmtp::MetricsServer::newPeer( GNet::EventStateUnbound esu ,
+	GNet::ServerPeerInfo && peer_info , GNet::MultiServer::ServerInfo )
+{
+	std::unique_ptr<GNet::ServerPeer> ptr ;
+	try
+	{
+		std::string reason ;
+		if( !m_config.allow_remote && !peer_info.m_address.isLocal(reason) )
+		{
+			G_WARNING( "GSmtp::MetricsServer: configured to reject non-local metrics connection: " << reason ) ;
+		}
+		else
+		{
+			ptr = std::make_unique<MetricsServerPeer>( esu , std::move(peer_info) ) ;
+		}
+	}
+	catch( std::exception & e ) // newPeer()
+	{
+		G_WARNING( "GSmtp::MetricsServer: new connection error: " << e.what() ) ;
+	}
+	return ptr ;
+}
+
+void GSmtp::MetricsServer::report( const std::string & group ) const
+{
+	serverReport( group ) ;
+}
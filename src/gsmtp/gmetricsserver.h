@@ -0,0 +1,121 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gmetricsserver.h
+///
+
+#ifndef G_SMTP_METRICS_SERVER_H
+#define G_SMTP_METRICS_SERVER_H
+
+#include "gdef.h"
+#include "gmultiserver.h"
+#include "gserverpeer.h"
+#include "gstringarray.h"
+#include <string>
+#include <memory>
+
+namespace GSmtp
+{
+	class MetricsServer ;
+	class MetricsServerPeer ;
+}
+
+//| \class GSmtp::MetricsServerPeer
+/// A derivation of ServerPeer that responds to a single HTTP
+/// request for "/metrics" with the GNet::Metrics output, and
+/// then disconnects.
+///
+/// \see GSmtp::MetricsServer
+///
+class GSmtp::MetricsServerPeer : public GNet::ServerPeer
+{
+public:
+	MetricsServerPeer( GNet::EventStateUnbound , GNet::ServerPeerInfo && ) ;
+		///< Constructor.
+
+private: // overrides
+	void onSendComplete() override ; // GNet::BufferedServerPeer
+	bool onReceive( const char * , std::size_t , std::size_t , std::size_t , char ) override ; // GNet::BufferedServerPeer
+	void onDelete( const std::string & ) override ; // GNet::ServerPeer
+	void onSecure( const std::string & , const std::string & , const std::string & ) override ; // GNet::SocketProtocolSink
+
+public:
+	~MetricsServerPeer() override = default ;
+	MetricsServerPeer( const MetricsServerPeer & ) = delete ;
+	MetricsServerPeer( MetricsServerPeer && ) = delete ;
+	MetricsServerPeer & operator=( const MetricsServerPeer & ) = delete ;
+	MetricsServerPeer & operator=( MetricsServerPeer && ) = delete ;
+
+private:
+	void respond() ;
+	void sendResponse( const std::string & status , const std::string & content_type , const std::string & body ) ;
+
+private:
+	std::string m_method ;
+	std::string m_path ;
+	bool m_responded {false} ;
+} ;
+
+//| \class GSmtp::MetricsServer
+/// A minimal HTTP server that exposes the GNet::Metrics registry
+/// in the Prometheus text format at "/metrics".
+///
+class GSmtp::MetricsServer : public GNet::MultiServer
+{
+public:
+	struct Config /// A configuration structure for GSmtp::MetricsServer.
+	{
+		unsigned int port {0U} ;
+		bool allow_remote {false} ;
+		GNet::Server::Config net_server_config ;
+		GNet::ServerPeer::Config net_server_peer_config ;
+
+		Config & set_port( unsigned int ) noexcept ;
+		Config & set_allow_remote( bool = true ) noexcept ;
+		Config & set_net_server_config( const GNet::Server::Config & ) ;
+		Config & set_net_server_peer_config( const GNet::ServerPeer::Config & ) ;
+	} ;
+
+	MetricsServer( GNet::EventState , const G::StringArray & interfaces , const Config & config ) ;
+		///< Constructor.
+
+	~MetricsServer() override ;
+		///< Destructor.
+
+	void report( const std::string & group = {} ) const ;
+		///< Generates helpful diagnostics.
+
+private: // overrides
+	std::unique_ptr<GNet::ServerPeer> newPeer( GNet::EventStateUnbound ,
+		GNet::ServerPeerInfo && , GNet::MultiServer::ServerInfo ) override ; // GNet::MultiServer
+
+public:
+	MetricsServer( const MetricsServer & ) = delete ;
+	MetricsServer( MetricsServer && ) = delete ;
+	MetricsServer & operator=( const MetricsServer & ) = delete ;
+	MetricsServer & operator=( MetricsServer && ) = delete ;
+
+private:
+	Config m_config ;
+} ;
+
+inline GSmtp::MetricsServer::Config & GSmtp::MetricsServer::Config::set_port( unsigned int n ) noexcept { port = n ; return *this ; }
+inline GSmtp::MetricsServer::Config & GSmtp::MetricsServer::Config::set_allow_remote( bool b ) noexcept { allow_remote = b ; return *this ; }
+inline GSmtp::MetricsServer::Config & GSmtp::MetricsServer::Config::set_net_server_config( const GNet::Server::Config & c ) { net_server_config = c ; return *this ; }
+inline GSmtp::MetricsServer::Config & GSmtp::MetricsServer::Config::set_net_server_peer_config( const GNet::ServerPeer::Config & c ) { net_server_peer_config = c ; return *this ; }
+
+#endif
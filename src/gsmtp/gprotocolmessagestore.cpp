@@ -21,10 +21,21 @@
 #include "gdef.h"
 #include "gprotocolmessagestore.h"
 #include "gmessagestore.h"
+#include "gmetrics.h"
 #include "gstr.h"
 #include "gassert.h"
 #include "glog.h"
 
+namespace GSmtp
+{
+	namespace ProtocolMessageStoreImp
+	{
+		GNet::Metrics::Counter received( "emailrelay_messages_received_total" , "Messages accepted by the SMTP server" ) ; // NOLINT
+		GNet::Metrics::Counter rejected( "emailrelay_messages_rejected_total" , "Messages rejected by the SMTP server filter" ) ; // NOLINT
+		GNet::Metrics::Histogram filter_duration( "emailrelay_filter_duration_seconds" , "Time spent running filters" , GNet::Metrics::label("filter","server") ) ; // NOLINT
+	}
+}
+
 GSmtp::ProtocolMessageStore::ProtocolMessageStore( GStore::MessageStore & store ,
 	std::unique_ptr<Filter> filter ) :
 		m_store(store) ,
@@ -145,6 +156,7 @@ void GSmtp::ProtocolMessageStore::process( const std::string & session_auth_id ,
 
 		// start filtering
 		G_LOG_MORE( "GSmtp::ProtocolMessageStore::process: filter [" << m_filter->id() << "]: [" << m_new_msg->id().str() << "]" ) ;
+		m_filter_start = G::TimerTime::now() ;
 		m_filter->start( m_new_msg->id() ) ;
 	}
 	catch( std::exception & e ) // catch filtering errors, size-limit errors, and file i/o errors
@@ -166,6 +178,7 @@ void GSmtp::ProtocolMessageStore::filterDone( int filter_result )
 		const bool ok = filter_result == 0 ;
 		const bool abandon = filter_result == 1 ;
 		const bool rescan = m_filter->special() ;
+		ProtocolMessageStoreImp::filter_duration.observe( m_filter_start ) ;
 
 		std::string filter_response = G::Str::replaced( (ok||abandon) ? std::string() : m_filter->response() , '\t' , ' ' ) ;
 		int filter_response_code = (ok||abandon) ? 0 : m_filter->responseCode() ;
@@ -181,6 +194,7 @@ void GSmtp::ProtocolMessageStore::filterDone( int filter_result )
 			// commit the message to the store
 			m_new_msg->commit( true ) ;
 			message_id = m_new_msg->id() ;
+			ProtocolMessageStoreImp::received.add() ;
 		}
 		else if( abandon )
 		{
@@ -191,6 +205,7 @@ void GSmtp::ProtocolMessageStore::filterDone( int filter_result )
 		else
 		{
 			G_LOG_S( "GSmtp::ProtocolMessageStore::filterDone: rejected by filter: [" << filter_reason << "]" ) ;
+			ProtocolMessageStoreImp::rejected.add() ;
 		}
 
 		if( rescan )
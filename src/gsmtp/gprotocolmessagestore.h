@@ -27,6 +27,7 @@
 #include "gnewmessage.h"
 #include "gfilter.h"
 #include "gslot.h"
+#include "gdatetime.h"
 #include <string>
 #include <memory>
 
@@ -80,6 +81,7 @@ private:
 	std::unique_ptr<GStore::NewMessage> m_new_msg ;
 	std::string m_from ;
 	FromInfo m_from_info ;
+	G::TimerTime m_filter_start {G::TimerTime::zero()} ;
 	ProtocolMessage::ProcessedSignal m_processed_signal ;
 } ;
 
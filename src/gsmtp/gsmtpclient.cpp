@@ -27,10 +27,22 @@
 #include "gsmtpclient.h"
 #include "gfilterfactorybase.h"
 #include "gresolver.h"
+#include "gmetrics.h"
+#include "gtest.h"
 #include "gassert.h"
 #include "glog.h"
 #include <utility>
 
+namespace GSmtp
+{
+	namespace ClientImp
+	{
+		GNet::Metrics::Counter forwarded( "emailrelay_messages_forwarded_total" , "Messages forwarded successfully" ) ; // NOLINT
+		GNet::Metrics::Counter failed( "emailrelay_messages_failed_total" , "Messages that failed to be forwarded" , GNet::Metrics::label("stage","smtp") ) ; // NOLINT
+		GNet::Metrics::Histogram filter_duration( "emailrelay_filter_duration_seconds" , "Time spent running filters" , GNet::Metrics::label("filter","client") ) ; // NOLINT
+	}
+}
+
 GSmtp::Client::Client( GNet::EventState es , FilterFactoryBase & ff , const GNet::Location & remote ,
 	const GAuth::SaslClientSecrets & secrets , const Config & config ) :
 		GNet::Client(es.logging(this),remote,normalise(config.net_client_config)) ,
@@ -56,6 +68,8 @@ GSmtp::Client::~Client()
 
 GNet::Client::Config GSmtp::Client::normalise( GNet::Client::Config net_client_config )
 {
+	if( G::Test::enabled("smtp-client-no-send-queue") )
+		net_client_config.socket_protocol_config.set_send_queue_limit( 0U ) ; // as if G_LIB_SMALL
 	return net_client_config.set_line_buffer_config( GNet::LineBuffer::Config::smtp() ) ;
 }
 
@@ -125,6 +139,16 @@ bool GSmtp::Client::protocolSend( std::string_view line , std::size_t offset , b
 	return rc ;
 }
 
+bool GSmtp::Client::protocolSendFile( std::string_view head , int fd , std::size_t offset , std::size_t size )
+{
+	return sendFile( head , fd , offset , size ) ; // GNet::Client -> GNet::SocketProtocol
+}
+
+bool GSmtp::Client::protocolSendFileZeroCopy() const
+{
+	return sendFileZeroCopy() ; // GNet::Client -> GNet::SocketProtocol
+}
+
 void GSmtp::Client::filterStart()
 {
 	if( !message()->forwardTo().empty() )
@@ -137,6 +161,7 @@ void GSmtp::Client::filterStart()
 		G_LOG_MORE( "GSmtp::Client::filterStart: client-filter [" << m_filter->id() << "]: [" << message()->id().str() << "]" ) ;
 		message()->close() ; // allow external editing
 		m_filter_special = false ;
+		m_filter_start = G::TimerTime::now() ;
 		m_filter->start( message()->id() ) ;
 	}
 }
@@ -153,6 +178,7 @@ void GSmtp::Client::filterDone( int filter_result )
 	const bool ok = filter_result == 0 ;
 	const bool abandon = filter_result == 1 ;
 	m_filter_special = m_filter->special() ;
+	ClientImp::filter_duration.observe( m_filter_start ) ;
 
 	G_LOG_IF( !m_filter->quiet() , "GSmtp::Client::filterDone: client-filter "
 		"[" << m_filter->id() << "]: [" << message()->id().str() << "]: "
@@ -236,16 +262,29 @@ void GSmtp::Client::quitAndFinish()
 	finish() ; // GNet::Client::finish() -- expect a disconnect
 }
 
+bool GSmtp::Client::idle() const
+{
+	return connected() && !finished() && m_message == nullptr && m_protocol.idle() ;
+}
+
+void GSmtp::Client::keepalive()
+{
+	if( idle() )
+		m_protocol.keepalive() ;
+}
+
 void GSmtp::Client::messageDestroy()
 {
 	message()->destroy() ;
 	m_message.reset() ;
+	ClientImp::forwarded.add() ;
 }
 
 void GSmtp::Client::messageFail( int response_code , const std::string & reason )
 {
 	message()->fail( reason , response_code ) ;
 	m_message.reset() ;
+	ClientImp::failed.add() ;
 }
 
 bool GSmtp::Client::onReceive( const char * line_data , std::size_t line_size , std::size_t , std::size_t , char )
@@ -36,9 +36,11 @@
 #include "gsocket.h"
 #include "gslot.h"
 #include "gtimer.h"
+#include "gdatetime.h"
 #include "gstringview.h"
 #include "gstringarray.h"
 #include "gexception.h"
+#include "glimits.h"
 #include <memory>
 #include <iostream>
 
@@ -72,6 +74,9 @@ public:
 		bool secure_tunnel {false} ;
 		std::string sasl_client_config ;
 		bool fail_if_no_remote_recipients {true} ; // used by GSmtp::Forward
+		unsigned int forward_concurrency {1U} ; // used by GSmtp::Forward
+		unsigned int forward_destination_concurrency {0U} ; // used by GSmtp::Forward
+		std::size_t forward_queue_limit {G::Limits<>::forward_queue} ; // used by GSmtp::Forward
 		bool log_msgid {false} ;
 		Config & set_client_protocol_config( const ClientProtocol::Config & ) ;
 		Config & set_net_client_config( const GNet::Client::Config & ) ;
@@ -80,6 +85,9 @@ public:
 		Config & set_secure_tunnel( bool = true ) noexcept ;
 		Config & set_sasl_client_config( const std::string & ) ;
 		Config & set_fail_if_no_remote_recipients( bool = true ) noexcept ;
+		Config & set_forward_concurrency( unsigned int ) noexcept ;
+		Config & set_forward_destination_concurrency( unsigned int ) noexcept ;
+		Config & set_forward_queue_limit( std::size_t ) noexcept ;
 		Config & set_log_msgid( bool = true ) noexcept ;
 	} ;
 
@@ -120,6 +128,15 @@ public:
 		///< Finishes a sendMessage() sequence. Sends a QUIT command and
 		///< finish()es the GNet::Client.
 
+	bool idle() const ;
+		///< Returns true if connected and between messages with the
+		///< smtp session still established, so that the Client can
+		///< be kept for a later sendMessage().
+
+	void keepalive() ;
+		///< Sends a NOOP to keep an idle() session open.
+		///< Does nothing if not idle().
+
 	G::Slot::Signal<const MessageDoneInfo&> & messageDoneSignal() noexcept ;
 		///< Returns a signal that indicates that sendMessage()
 		///< has completed or failed.
@@ -134,6 +151,8 @@ private: // overrides
 	void onSendComplete() override ; // GNet::Client
 	void onSecure( const std::string & , const std::string & , const std::string & ) override ; // GNet::SocketProtocol
 	bool protocolSend( std::string_view , std::size_t , bool ) override ; // ClientProtocol::Sender
+	bool protocolSendFile( std::string_view , int , std::size_t , std::size_t ) override ; // ClientProtocol::Sender
+	bool protocolSendFileZeroCopy() const override ; // ClientProtocol::Sender
 	std::string_view eventLoggingString() const noexcept override ; // GNet::EventLogging
 
 public:
@@ -164,6 +183,7 @@ private:
 	G::Slot::Signal<const MessageDoneInfo&> m_message_done_signal ;
 	bool m_secure {false} ;
 	bool m_filter_special {false} ;
+	G::TimerTime m_filter_start {G::TimerTime::zero()} ;
 	G::CallStack m_stack ;
 	std::string m_event_logging_string ;
 } ;
@@ -175,6 +195,9 @@ inline GSmtp::Client::Config & GSmtp::Client::Config::set_filter_config( const F
 inline GSmtp::Client::Config & GSmtp::Client::Config::set_secure_tunnel( bool b ) noexcept { secure_tunnel = b ; return *this ; }
 inline GSmtp::Client::Config & GSmtp::Client::Config::set_sasl_client_config( const std::string & s ) { sasl_client_config = s ; return *this ; }
 inline GSmtp::Client::Config & GSmtp::Client::Config::set_fail_if_no_remote_recipients( bool b ) noexcept { fail_if_no_remote_recipients = b ; return *this ; }
+inline GSmtp::Client::Config & GSmtp::Client::Config::set_forward_concurrency( unsigned int n ) noexcept { forward_concurrency = n ; return *this ; }
+inline GSmtp::Client::Config & GSmtp::Client::Config::set_forward_destination_concurrency( unsigned int n ) noexcept { forward_destination_concurrency = n ; return *this ; }
+inline GSmtp::Client::Config & GSmtp::Client::Config::set_forward_queue_limit( std::size_t n ) noexcept { forward_queue_limit = n ; return *this ; }
 inline GSmtp::Client::Config & GSmtp::Client::Config::set_log_msgid( bool b ) noexcept { log_msgid = b ; return *this ; }
 
 #endif
@@ -27,6 +27,7 @@
 #include "gstringfield.h"
 #include "gstringtoken.h"
 #include "gxtext.h"
+#include "glimits.h"
 #include "glog.h"
 #include "gassert.h"
 #include <algorithm>
@@ -105,6 +106,18 @@ void GSmtp::ClientProtocol::finish()
 	send( "QUIT\r\n"_sv ) ;
 }
 
+bool GSmtp::ClientProtocol::idle() const noexcept
+{
+	return m_protocol.state == State::MessageDone ;
+}
+
+void GSmtp::ClientProtocol::keepalive()
+{
+	G_ASSERT( idle() ) ;
+	m_protocol.state = State::SentNoop ;
+	send( "NOOP\r\n"_sv ) ;
+}
+
 void GSmtp::ClientProtocol::secure()
 {
 	applyEvent( ClientReply::secure() ) ;
@@ -115,10 +128,8 @@ void GSmtp::ClientProtocol::sendComplete()
 	if( m_protocol.state == State::Data )
 	{
 		std::size_t n = sendContentLines() ;
-		n++ ; // since the socket protocol has now sent the line that was blocked
-
 		G_LOG( "GSmtp::ClientProtocol: tx>>: [" << n << " line(s) of content]" ) ;
-		if( endOfContent() )
+		if( !m_message_state.content_blocked && endOfContent() )
 		{
 			m_protocol.state = State::SentDot ;
 			sendEot() ;
@@ -429,6 +440,13 @@ bool GSmtp::ClientProtocol::applyEvent( const ClientReply & reply )
 			m_message_state.content_size = message().contentSize() ;
 			std::string content_size_str = std::to_string( m_message_state.content_size ) ;
 
+			// the chunks can go straight from the content file to the socket, or
+			// through kernel tls (see GNet::SocketProtocol::sendFile()), but
+			// otherwise they are streamed through the content buffer
+			m_message_state.content_offset = 0U ;
+			m_message_state.content_fd = ( !m_sender.protocolSendFileZeroCopy() || G::Test::enabled("smtp-client-no-sendfile") ) ?
+				-1 : message().contentFd() ;
+
 			bool one_chunk = (m_message_state.content_size+5U) <= m_config.bdat_chunk_size ; // 5 for " LAST"
 			if( one_chunk )
 			{
@@ -459,7 +477,7 @@ bool GSmtp::ClientProtocol::applyEvent( const ClientReply & reply )
 		m_protocol.state = State::Data ;
 		std::size_t n = sendContentLines() ;
 		G_LOG( "GSmtp::ClientProtocol: tx>>: [" << n << " line(s) of content]" ) ;
-		if( endOfContent() )
+		if( !m_message_state.content_blocked && endOfContent() )
 		{
 			m_protocol.state = State::SentDot ;
 			sendEot() ;
@@ -497,6 +515,11 @@ bool GSmtp::ClientProtocol::applyEvent( const ClientReply & reply )
 		else
 			raiseDoneSignal( reply.doneCode() , reply.errorText() ) ;
 	}
+	else if( m_protocol.state == State::SentNoop && reply.is(ClientReply::Value::Ok_250) )
+	{
+		// got NOOP response -- idle again
+		m_protocol.state = State::MessageDone ;
+	}
 	else if( m_protocol.state == State::Quitting && reply.value() == 221 )
 	{
 		// got QUIT response
@@ -749,19 +772,46 @@ void GSmtp::ClientProtocol::sendRcptTo()
 
 std::size_t GSmtp::ClientProtocol::sendContentLines()
 {
+	// dot-stuffed content lines are packed into a large buffer so that
+	// there is one socket write per block rather than one per line --
+	// the last line in each block can take it over the nominal size
+
 	cancelTimer() ; // response timer only when blocked
+	m_message_state.content_blocked = false ;
 
 	m_message_line.resize( 1U ) ;
 	m_message_line.at(0) = '.' ;
 
+	const std::size_t block_size = static_cast<std::size_t>( G::Limits<>::smtp_data_buffer ) ;
+	m_message_buffer.clear() ;
+	m_message_buffer.reserve( block_size + 1000U ) ;
+
 	std::size_t line_count = 0U ;
-	while( sendNextContentLine(m_message_line) )
+	while( readContentLine(m_message_line) )
+	{
 		line_count++ ;
+		std::size_t offset = m_message_line.at(1U) == '.' ? 0U : 1U ;
+		m_message_buffer.insert( m_message_buffer.end() , m_message_line.begin()+offset , m_message_line.end() ) ;
+		if( m_message_buffer.size() >= block_size )
+		{
+			if( !sendContentImp(m_message_buffer) )
+			{
+				m_message_state.content_blocked = true ;
+				return line_count ; // blocked -- continue on sendComplete()
+			}
+			m_message_buffer.clear() ;
+		}
+	}
 
+	// the last block can also be blocked, in which case the eot
+	// must wait for sendComplete() even though there is no more
+	// content to read
+	if( !m_message_buffer.empty() && !sendContentImp(m_message_buffer) )
+		m_message_state.content_blocked = true ;
 	return line_count ;
 }
 
-bool GSmtp::ClientProtocol::sendNextContentLine( std::string & line )
+bool GSmtp::ClientProtocol::readContentLine( std::string & line )
 {
 	// read one line of content including any unterminated last line -- all
 	// content should be in reasonably-sized lines with CR-LF endings, even
@@ -772,16 +822,15 @@ bool GSmtp::ClientProtocol::sendNextContentLine( std::string & line )
 	// bare LF line endings -- to avoid data shuffling the dot-escaping is
 	// done by keeping a leading dot in the string buffer
 	G_ASSERT( !line.empty() && line.at(0) == '.' ) ;
-	bool ok = false ;
 	line.erase( 1U ) ; // leave "."
 	if( G::Str::readLine( message().contentStream() , line ,
 		m_config.crlf_only ? G::Str::Eol::CrLf : G::Str::Eol::Cr_Lf_CrLf ,
 		/*pre_erase_result=*/false ) )
 	{
 		line.append( "\r\n" , 2U ) ;
-		ok = sendContentLineImp( line , line.at(1U) == '.' ? 0U : 1U ) ;
+		return true ;
 	}
-	return ok ;
+	return false ;
 }
 
 void GSmtp::ClientProtocol::sendEhlo()
@@ -831,6 +880,9 @@ bool GSmtp::ClientProtocol::sendBdatAndChunk( std::size_t size , const std::stri
 	// to allow for "LAST" at EOF the actual allocation includes a small leading
 	// margin
 
+	if( m_message_state.content_fd >= 0 )
+		return sendBdatAndFileChunk( size , last ) ;
+
 	std::size_t buffer_size = size + (last?12U:7U) + size_str.size() ;
 	std::size_t eolpos = (last?10U:5U) + size_str.size() ;
 	std::size_t datapos = eolpos + 2U ;
@@ -875,6 +927,28 @@ bool GSmtp::ClientProtocol::sendBdatAndChunk( std::size_t size , const std::stri
 	return last ;
 }
 
+bool GSmtp::ClientProtocol::sendBdatAndFileChunk( std::size_t size , bool last )
+{
+	// as above, but the chunk data is sent from the content file
+	// with a known content size rather than read via the content
+	// stream until EOF
+
+	G_ASSERT( m_message_state.content_offset <= m_message_state.content_size ) ;
+	std::size_t offset = m_message_state.content_offset ;
+	std::size_t n = std::min( size , m_message_state.content_size - offset ) ;
+	last = last || (offset+n) == m_message_state.content_size ;
+
+	std::string head = std::string("BDAT ",5U).append(std::to_string(n)).append(last?" LAST\r\n":"\r\n") ;
+	m_message_state.content_offset += n ;
+
+	if( m_config.response_timeout != 0U )
+		startTimer( m_config.response_timeout ) ; // response timer on every bdat block
+
+	logChunk( head ) ;
+	m_sender.protocolSendFile( head , m_message_state.content_fd , offset , n ) ;
+	return last ;
+}
+
 // --
 
 void GSmtp::ClientProtocol::sendChunkImp( const char * p , std::size_t n )
@@ -884,22 +958,26 @@ void GSmtp::ClientProtocol::sendChunkImp( const char * p , std::size_t n )
 	if( m_config.response_timeout != 0U )
 		startTimer( m_config.response_timeout ) ; // response timer on every bdat block
 
+	logChunk( sv ) ;
+	m_sender.protocolSend( sv , 0U , false ) ;
+}
+
+void GSmtp::ClientProtocol::logChunk( std::string_view sv )
+{
 	if( G::LogOutput::Instance::atVerbose() )
 	{
 		std::size_t pos = sv.find( "\r\n"_sv ) ;
-		std::string_view cmd = G::Str::headView( sv , pos , {p,std::size_t(0U)} ) ;
+		std::string_view cmd = G::Str::headView( sv , pos , {sv.data(),std::size_t(0U)} ) ;
 		G::StringTokenView t( cmd , " "_sv ) ;
 		std::string_view count = t.next()() ;
 		std::string_view end = count.size() == 1U && count[0] == '1' ? "]"_sv : "s]"_sv ;
 		G_LOG( "GSmtp::ClientProtocol: tx>>: \"" << cmd << "\" [" << count << " byte" << end ) ;
 	}
-
-	m_sender.protocolSend( sv , 0U , false ) ;
 }
 
-bool GSmtp::ClientProtocol::sendContentLineImp( const std::string & line , std::size_t offset )
+bool GSmtp::ClientProtocol::sendContentImp( const std::vector<char> & buffer )
 {
-	bool all_sent = m_sender.protocolSend( line , offset , false ) ;
+	bool all_sent = m_sender.protocolSend( {buffer.data(),buffer.size()} , 0U , false ) ;
 	if( !all_sent && m_config.response_timeout != 0U )
 		startTimer( m_config.response_timeout ) ; // response timer while blocked by flow-control
 	return all_sent ;
@@ -70,6 +70,16 @@ public:
 			///<
 			///< Throws on error, eg. if disconnected.
 
+		virtual bool protocolSendFile( std::string_view head , int fd , std::size_t offset , std::size_t size ) = 0 ;
+			///< Called by the Protocol class to send a BDAT command
+			///< followed by a chunk of message content taken directly
+			///< from the content file, bypassing the content stream.
+			///< Flow control is as for protocolSend().
+
+		virtual bool protocolSendFileZeroCopy() const = 0 ;
+			///< Returns true if protocolSendFile() would send the
+			///< file data without copying it through user space.
+
 		virtual ~Sender() = default ;
 			///< Destructor.
 	} ;
@@ -151,6 +161,18 @@ public:
 		///< Called after the last message has been sent. Sends a quit
 		///< command and shuts down the socket.
 
+	bool idle() const noexcept ;
+		///< Returns true if the protocol is between messages with
+		///< a session established, so that start() can go straight
+		///< to the client filter and MAIL-FROM.
+
+	void keepalive() ;
+		///< Sends a NOOP command to keep an idle session from
+		///< timing out at the server. The session is idle() again
+		///< once the response has been received.
+		///<
+		///< Precondition: idle()
+
 	void sendComplete() ;
 		///< To be called when a blocked connection becomes unblocked.
 		///< See ClientProtocol::Sender::protocolSend().
@@ -202,6 +224,7 @@ private:
 		StartTls ,
 		SentTlsEhlo ,
 		MessageDone ,
+		SentNoop ,
 		Quitting
 	} ;
 	struct ServerInfo
@@ -227,6 +250,9 @@ private:
 		G::StringArray to_rejected ; // list of rejected recipients
 		std::size_t chunk_data_size {0U} ;
 		std::string chunk_data_size_str ;
+		int content_fd {-1} ; // for zero-copy bdat chunks
+		std::size_t content_offset {0U} ;
+		bool content_blocked {false} ; // flow control asserted while sending DATA content
 	} ;
 	struct SessionState
 	{
@@ -264,15 +290,17 @@ private:
 	void send( std::string_view ) ;
 	void send( std::string_view , std::string_view , std::string_view = {} , std::string_view = {} , bool = false ) ;
 	std::size_t sendContentLines() ;
-	bool sendNextContentLine( std::string & ) ;
+	bool readContentLine( std::string & ) ;
 	void sendEhlo() ;
 	void sendHelo() ;
 	bool sendMailFrom() ;
 	void sendRcptTo() ;
 	bool sendBdatAndChunk( std::size_t , const std::string & , bool ) ;
+	bool sendBdatAndFileChunk( std::size_t , bool ) ;
 	//
-	bool sendContentLineImp( const std::string & , std::size_t ) ;
+	bool sendContentImp( const std::vector<char> & ) ;
 	void sendChunkImp( const char * , std::size_t ) ;
+	void logChunk( std::string_view ) ;
 	bool sendImp( std::string_view , std::size_t sensitive_from = std::string::npos ) ;
 
 private:
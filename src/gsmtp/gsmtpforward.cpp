@@ -22,17 +22,30 @@
 #include "gsmtpforward.h"
 #include "geventloggingcontext.h"
 #include "gcall.h"
+#include "gmetrics.h"
 #include "glog.h"
 #include <algorithm>
 #include <sstream>
 
+namespace GSmtp
+{
+	namespace ForwardImp
+	{
+		GNet::Metrics::Counter failed( "emailrelay_messages_failed_total" , "Messages that failed to be forwarded" , GNet::Metrics::label("stage","forward") ) ; // NOLINT
+	}
+}
+
 GSmtp::Forward::Forward( GNet::EventState es , GStore::MessageStore & store ,
 	FilterFactoryBase & ff , const GNet::Location & forward_to_default ,
-	const GAuth::SaslClientSecrets & secrets , const Config & config ) :
+	const GAuth::SaslClientSecrets & secrets , const Config & config , Pool * pool ) :
 		Forward( es , ff , forward_to_default , secrets , config )
 {
 	m_store = &store ; // NOLINT
+	m_pool = pool ;
 	m_iter = m_store->iterator( /*lock=*/true ) ;
+	m_channels.clear() ;
+	for( unsigned int i = 0U ; i < std::max(1U,m_config.forward_concurrency) ; i++ )
+		m_channels.push_back( std::make_unique<Channel>( this , m_forward_to_default ) ) ;
 	m_continue_timer.startTimer( 0U ) ;
 }
 
@@ -41,51 +54,200 @@ GSmtp::Forward::Forward( GNet::EventState es ,
 	const GAuth::SaslClientSecrets & secrets , const Config & config ) :
 		m_es(es) ,
 		m_store(nullptr) ,
+		m_pool(nullptr) ,
 		m_ff(ff) ,
 		m_forward_to_default(forward_to_default) ,
-		m_forward_to_location(forward_to_default) ,
+		m_forward_to_default_name(forward_to_default.host()+":"+forward_to_default.service()) ,
 		m_secrets(secrets) ,
 		m_config(config) ,
 		m_error_timer(*this,&Forward::onErrorTimeout,m_es) ,
 		m_continue_timer(*this,&Forward::onContinueTimeout,m_es) ,
+		m_queued(0U) ,
 		m_message_count(0U) ,
-		m_has_connected(false) ,
+		m_no_more(false) ,
+		m_no_more_logged(false) ,
+		m_stopping(false) ,
 		m_finished(false)
 {
-	m_client_ptr.eventSignal().connect( G::Slot::slot(*this,&Forward::onEventSignal) ) ;
-	m_client_ptr.deleteSignal().connect( G::Slot::slot(*this,&Forward::onDeleteSignal) ) ;
-	m_client_ptr.deletedSignal().connect( G::Slot::slot(*this,&Forward::onDeletedSignal) ) ;
+	m_channels.push_back( std::make_unique<Channel>( this , m_forward_to_default ) ) ;
 }
 
 GSmtp::Forward::~Forward()
+= default;
+
+GSmtp::Forward::Channel * GSmtp::Forward::reuse( Channel & channel , const GStore::StoredMessage & message )
 {
-	if( m_client_ptr.get() )
-		m_client_ptr->messageDoneSignal().disconnect() ;
-	if( m_routing_filter )
-		m_routing_filter->doneSignal().disconnect() ;
-	m_client_ptr.deletedSignal().disconnect() ;
-	m_client_ptr.deleteSignal().disconnect() ;
-	m_client_ptr.eventSignal().disconnect() ;
+	// swap an unconnected channel for a pooled one with the same destination,
+	// keeping the unconnected one until it is safe to delete
+	G_ASSERT( channel.m_client_ptr.get() == nullptr ) ;
+	auto channel_p = std::find_if( m_channels.begin() , m_channels.end() ,
+		[&channel](const std::unique_ptr<Channel> & channel_ptr){ return channel_ptr.get() == &channel ; } ) ;
+	std::unique_ptr<Channel> pooled = ( m_pool && channel_p != m_channels.end() ) ?
+		m_pool->take( poolKey(destination(message)) ) : std::unique_ptr<Channel>() ;
+	if( !pooled )
+		return nullptr ;
+
+	G_LOG_MORE( "GSmtp::Forward::reuse: reusing connection to " << pooled->m_client_ptr->peerAddressString() ) ;
+	pooled->m_forward = this ;
+	channel.m_busy = false ;
+	m_spare_channels.push_back( std::move(*channel_p) ) ;
+	*channel_p = std::move( pooled ) ;
+	return channel_p->get() ;
+}
+
+void GSmtp::Forward::release( std::unique_ptr<Channel> & channel_ptr )
+{
+	// give an idle connection to the pool, or drop it
+	G_ASSERT( channel_ptr->m_client_ptr.get() ) ;
+	if( m_pool && channel_ptr->m_client_ptr->idle() )
+	{
+		Pool::Key key = poolKey( destination(*channel_ptr) ) ;
+		channel_ptr->m_forward = nullptr ;
+		m_pool->add( key , std::move(channel_ptr) ) ;
+		channel_ptr = std::make_unique<Channel>( this , m_forward_to_default ) ;
+	}
+	else
+	{
+		channel_ptr->m_client_ptr->quitAndFinish() ;
+		channel_ptr->m_client_ptr.reset() ;
+	}
 }
 
 void GSmtp::Forward::onContinueTimeout()
 {
 	G_ASSERT( m_store != nullptr ) ;
-	if( !sendNext() )
+	m_spare_channels.clear() ;
+	if( !sendAll() )
 	{
 		quitAndFinish() ;
+		if( !m_error.empty() )
+			throw G::Exception( m_error ) ; // a channel failed earlier -- terminates us
 		throw GNet::Done() ; // terminates us
 	}
 }
 
-bool GSmtp::Forward::sendNext()
+bool GSmtp::Forward::sendAll()
+{
+	// start() the next message on each idle channel, or return false if all idle
+	if( !m_stopping )
+	{
+		// connected channels first, so that they can reuse their connection
+		for( bool connected : {true,false} )
+		{
+			for( auto & channel_ptr : m_channels )
+			{
+				if( !channel_ptr->m_busy && !channel_ptr->m_failed && connected == (channel_ptr->m_client_ptr.get() != nullptr) )
+					sendNext( *channel_ptr ) ;
+			}
+		}
+	}
+
+	// pool or drop idle connections
+	for( auto & channel_ptr : m_channels )
+	{
+		if( !channel_ptr->m_busy && channel_ptr->m_client_ptr.get() )
+			release( channel_ptr ) ;
+	}
+	return busy() ;
+}
+
+bool GSmtp::Forward::busy() const
+{
+	return std::any_of( m_channels.begin() , m_channels.end() ,
+		[](const std::unique_ptr<Channel> & channel_ptr){ return channel_ptr->m_busy ; } ) ;
+}
+
+bool GSmtp::Forward::idle() const
+{
+	return std::any_of( m_channels.begin() , m_channels.end() ,
+		[](const std::unique_ptr<Channel> & channel_ptr){ return !channel_ptr->m_busy && !channel_ptr->m_failed ; } ) ;
+}
+
+bool GSmtp::Forward::sendNext( Channel & channel )
+{
+	// start the next message on the given channel, preferring one queued
+	// for the same destination, then one from the store, then one queued
+	// for some other destination -- or return false if none
+	bool sent =
+		sendQueued( channel , true ) ||
+		sendStored( channel ) ||
+		sendQueued( channel , false ) ;
+
+	if( !sent && m_no_more && m_queued == 0U && !m_no_more_logged )
+	{
+		m_no_more_logged = true ;
+		if( m_message_count != 0U )
+			G_LOG( "GSmtp::Forward: forwarding: no more messages to send" ) ;
+	}
+	return sent ;
+}
+
+bool GSmtp::Forward::sendQueued( Channel & channel , bool same_destination )
 {
-	// start() the next message from the store, or return false if none
 	for(;;)
+	{
+		auto queue_p = selectQueue( channel , same_destination ) ;
+		if( queue_p == m_queues.end() )
+			return false ;
+
+		std::unique_ptr<GStore::StoredMessage> message = std::move( queue_p->second.front() ) ;
+		queue_p->second.pop_front() ;
+		if( queue_p->second.empty() )
+			m_queues.erase( queue_p ) ;
+		m_queued-- ;
+
+		GNet::EventLoggingContext inner( m_es , Client::eventLoggingString(message.get(),m_config) ) ;
+		std::string reopen_error = message->reopen() ;
+		if( !reopen_error.empty() )
+		{
+			G_WARNING( "GSmtp::Forward::sendQueued: forwarding [" << message->id().str() << "]: " << reopen_error ) ;
+			message->fail( reopen_error , 0 ) ;
+			ForwardImp::failed.add() ;
+		}
+		else
+		{
+			G_LOG( "GSmtp::Forward::sendQueued: forwarding [" << message->id().str() << "]" << messageInfo(*message) ) ;
+			if( startClient( channel , std::move(message) ) )
+				return true ;
+		}
+	}
+}
+
+GSmtp::Forward::QueueMap::iterator GSmtp::Forward::selectQueue( const Channel & channel , bool same_destination )
+{
+	// choose the channel's own destination, or the least active destination
+	if( same_destination )
+	{
+		auto p = channel.m_client_ptr.get() ? m_queues.find( destination(channel) ) : m_queues.end() ;
+		return ( p != m_queues.end() && startable(p->first) ) ? p : m_queues.end() ;
+	}
+	auto result = m_queues.end() ;
+	std::size_t result_active = 0U ;
+	for( auto p = m_queues.begin() ; p != m_queues.end() ; ++p )
+	{
+		std::size_t n = active( p->first ) ;
+		if( startable(p->first) && ( result == m_queues.end() || n < result_active ) )
+		{
+			result = p ;
+			result_active = n ;
+		}
+	}
+	return result ;
+}
+
+bool GSmtp::Forward::sendStored( Channel & channel )
+{
+	// start() the next message from the store, queueing messages for
+	// other destinations where necessary, or return false if none
+	const std::size_t queue_limit = m_config.forward_queue_limit ;
+	while( !m_no_more && m_queued < queue_limit )
 	{
 		std::unique_ptr<GStore::StoredMessage> message( ++m_iter ) ;
 		if( message == nullptr )
+		{
+			m_no_more = true ;
 			break ;
+		}
 
 		// change the logging context asap to reflect the new message being forwarded
 		GNet::EventLoggingContext inner( m_es , Client::eventLoggingString(message.get(),m_config) ) ;
@@ -94,75 +256,177 @@ bool GSmtp::Forward::sendNext()
 		{
 			G_WARNING( "GSmtp::Forward::sendNext: forwarding [" << message->id().str() << "]: failing message with no remote recipients" ) ;
 			message->fail( "no remote recipients" , 0 ) ;
+			ForwardImp::failed.add() ;
 		}
 		else if( message->toCount() == 0U )
 		{
 			G_DEBUG( "GSmtp::Forward::sendNext: forwarding [" << message->id().str() << "]: skipping message with no remote recipients" ) ;
 		}
-		else
+		else if( !message->forwardTo().empty() )
 		{
 			G_LOG( "GSmtp::Forward::sendNext: forwarding [" << message->id().str() << "]" << messageInfo(*message) ) ;
-			start( std::move(message) ) ;
+			startRouting( channel , std::move(message) ) ;
 			return true ;
 		}
+		else if( !unconnectable(message->forwardToAddress()) && deferrable( channel , destination(*message) ) )
+		{
+			enqueue( std::move(message) ) ;
+		}
+		else
+		{
+			G_LOG( "GSmtp::Forward::sendNext: forwarding [" << message->id().str() << "]" << messageInfo(*message) ) ;
+			if( startClient( channel , std::move(message) ) )
+				return true ;
+		}
 	}
-	if( m_message_count != 0U )
-		G_LOG( "GSmtp::Forward: forwarding: no more messages to send" ) ;
 	return false ;
 }
 
-void GSmtp::Forward::sendMessage( std::unique_ptr<GStore::StoredMessage> message )
+bool GSmtp::Forward::deferrable( const Channel & channel , const Destination & d ) const
 {
-	G_LOG( "GSmtp::Forward::sendMessage: forwarding [" << message->id().str() << "]" << messageInfo(*message) ) ;
-	start( std::move(message) ) ;
+	// returns true if a message for the given destination should be
+	// queued rather than sent on the given channel, either because the
+	// destination is at its connection limit or because the channel
+	// is connected elsewhere and might find a message for its own
+	// destination further on -- no queueing unless there is a
+	// per-destination limit
+	if( m_config.forward_destination_concurrency == 0U )
+		return false ;
+	if( !startable( d ) )
+		return true ;
+	return
+		channel.m_client_ptr.get() != nullptr &&
+		destination(channel) != d &&
+		( m_queued + 1U ) < m_config.forward_queue_limit ;
 }
 
-void GSmtp::Forward::start( std::unique_ptr<GStore::StoredMessage> message )
+void GSmtp::Forward::enqueue( std::unique_ptr<GStore::StoredMessage> message )
 {
-	m_message_count++ ;
-	if( !message->forwardTo().empty() )
-	{
-		message->close() ;
-		m_message = std::move( message ) ;
+	G_DEBUG( "GSmtp::Forward::enqueue: queueing [" << message->id().str() << "] for [" << message->forwardToAddress() << "]" ) ;
+	message->close() ; // release the content file while queued
+	Destination d = destination( *message ) ;
+	m_queues[d].push_back( std::move(message) ) ;
+	m_queued++ ;
+	if( idle() && startable(d) )
+		m_continue_timer.startTimer( 0U ) ;
+}
 
-		m_routing_filter = m_ff.newFilter( m_es , Filter::Type::routing , m_config.filter_config , m_config.filter_spec ) ;
-		G_LOG_MORE( "GSmtp::Forward::start: routing-filter [" << m_routing_filter->id() << "]: [" << m_message->id().str() << "]" ) ;
-		m_routing_filter->doneSignal().connect( G::Slot::slot(*this,&Forward::routingFilterDone) ) ;
-		m_routing_filter->start( m_message->id() ) ;
-	}
-	else if( updateClient( *message ) )
+void GSmtp::Forward::dequeue( const std::string & forward_to_address )
+{
+	// drop queued messages for an unconnectable address, leaving them unlocked
+	for( auto p = m_queues.begin() ; p != m_queues.end() ; )
 	{
-		m_client_ptr->sendMessage( std::move(message) ) ;
+		if( p->first.first == forward_to_address )
+		{
+			m_queued -= p->second.size() ;
+			p = m_queues.erase( p ) ;
+		}
+		else
+		{
+			++p ;
+		}
 	}
+}
+
+std::size_t GSmtp::Forward::active( const Destination & d ) const
+{
+	// returns the number of channels sending to the given destination
+	return static_cast<std::size_t>( std::count_if( m_channels.begin() , m_channels.end() ,
+		[&d](const std::unique_ptr<Channel> & channel_ptr){
+			return channel_ptr->m_busy && !channel_ptr->m_message &&
+				channel_ptr->m_client_ptr.get() && destination(*channel_ptr) == d ; } ) ) ;
+}
+
+bool GSmtp::Forward::startable( const Destination & d ) const
+{
+	const unsigned int limit = m_config.forward_destination_concurrency ;
+	return limit == 0U || active(d) < limit ;
+}
+
+GSmtp::Forward::Destination GSmtp::Forward::destination( const GStore::StoredMessage & message )
+{
+	return { message.forwardToAddress() , message.clientAccountSelector() } ;
+}
+
+GSmtp::Forward::Destination GSmtp::Forward::destination( const Channel & channel )
+{
+	return { channel.m_forward_to_address , channel.m_selector } ;
+}
+
+std::tuple<std::string,std::string,std::string> GSmtp::Forward::poolKey( const Destination & d ) const
+{
+	return std::make_tuple( d.first.empty() ? m_forward_to_default_name : d.first , d.second ,
+		m_config.net_client_config.socket_protocol_config.client_tls_profile ) ;
+}
+
+void GSmtp::Forward::sendMessage( std::unique_ptr<GStore::StoredMessage> message )
+{
+	G_LOG( "GSmtp::Forward::sendMessage: forwarding [" << message->id().str() << "]" << messageInfo(*message) ) ;
+	Channel & channel = *m_channels.at( 0U ) ;
+	if( !message->forwardTo().empty() )
+		startRouting( channel , std::move(message) ) ;
 	else
+		startClient( channel , std::move(message) ) ;
+}
+
+void GSmtp::Forward::startRouting( Channel & channel , std::unique_ptr<GStore::StoredMessage> message )
+{
+	m_message_count++ ;
+	message->close() ;
+	channel.m_message = std::move( message ) ;
+	channel.m_busy = true ;
+
+	channel.m_routing_filter = m_ff.newFilter( m_es , Filter::Type::routing , m_config.filter_config , m_config.filter_spec ) ;
+	G_LOG_MORE( "GSmtp::Forward::start: routing-filter [" << channel.m_routing_filter->id() << "]: [" << channel.m_message->id().str() << "]" ) ;
+	channel.m_routing_filter->doneSignal().connect( G::Slot::slot(channel,&Channel::onRoutingFilterDone) ) ;
+	channel.m_routing_filter->start( channel.m_message->id() ) ;
+}
+
+bool GSmtp::Forward::startClient( Channel & channel , std::unique_ptr<GStore::StoredMessage> message )
+{
+	// start the client, or return false if unconnectable
+	m_message_count++ ;
+	Channel * client_channel = updateClient( channel , *message ) ;
+	if( client_channel )
 	{
-		m_continue_timer.startTimer( 0U ) ;
+		client_channel->m_busy = true ;
+		client_channel->m_client_ptr->sendMessage( std::move(message) ) ;
+		return true ;
 	}
+	return false ;
 }
 
-void GSmtp::Forward::routingFilterDone( int filter_result )
+void GSmtp::Forward::routingFilterDone( Channel & channel , int filter_result )
 {
-	G_ASSERT( m_routing_filter.get() != nullptr ) ;
-	G_ASSERT( m_message.get() != nullptr ) ;
-	G_ASSERT( static_cast<int>(m_routing_filter->result()) == filter_result ) ;
+	G_ASSERT( channel.m_routing_filter.get() != nullptr ) ;
+	G_ASSERT( channel.m_message.get() != nullptr ) ;
+	G_ASSERT( static_cast<int>(channel.m_routing_filter->result()) == filter_result ) ;
 	G_DEBUG( "GSmtp::Forward::routingFilterDone: result=" << filter_result ) ;
 
-	G_LOG_IF( !m_routing_filter->quiet() , "GSmtp::Forward::routingFilterDone: routing-filter "
-		"[" << m_routing_filter->id() << "]: [" << m_message->id().str() << "]: "
-		<< m_routing_filter->str(Filter::Type::client) ) ;
+	G_LOG_IF( !channel.m_routing_filter->quiet() , "GSmtp::Forward::routingFilterDone: routing-filter "
+		"[" << channel.m_routing_filter->id() << "]: [" << channel.m_message->id().str() << "]: "
+		<< channel.m_routing_filter->str(Filter::Type::client) ) ;
 
-	const bool ok = filter_result == 0 && m_message ;
+	const bool ok = filter_result == 0 && channel.m_message ;
 	const bool abandon = filter_result == 1 ;
 	//const bool fail = filter_result == 2 ;
 
-	std::string reopen_error = ok ? m_message->reopen() : std::string() ;
+	std::string reopen_error = ok ? channel.m_message->reopen() : std::string() ;
 	bool continue_ = true ;
-	if( ok && reopen_error.empty() )
+	if( ok && reopen_error.empty() && m_store && !unconnectable(channel.m_message->forwardToAddress()) &&
+		!startable( destination(*channel.m_message) ) )
 	{
-		if( updateClient( *m_message ) )
+		// destination is busy so queue it for later
+		enqueue( std::move(channel.m_message) ) ;
+	}
+	else if( ok && reopen_error.empty() )
+	{
+		Channel * client_channel = updateClient( channel , *channel.m_message ) ;
+		if( client_channel )
 		{
 			continue_ = false ;
-			m_client_ptr->sendMessage( std::move(m_message) ) ;
+			client_channel->m_busy = true ;
+			client_channel->m_client_ptr->sendMessage( std::move(channel.m_message) ) ;
 		}
 	}
 	else if( abandon )
@@ -171,12 +435,15 @@ void GSmtp::Forward::routingFilterDone( int filter_result )
 	}
 	else
 	{
-		m_message->fail( "routing filter failed" , 0 ) ;
-		m_message.reset() ;
+		channel.m_message->fail( "routing filter failed" , 0 ) ;
+		ForwardImp::failed.add() ;
+		channel.m_message.reset() ;
 	}
 
 	if( continue_ )
 	{
+		channel.m_message.reset() ; // unlock if not failed
+		channel.m_busy = false ;
 		if( m_store == nullptr )
 			m_message_done_signal.emit( { 0 , abandon?"":"routing failed" , false } ) ;
 		else
@@ -184,25 +451,30 @@ void GSmtp::Forward::routingFilterDone( int filter_result )
 	}
 }
 
-bool GSmtp::Forward::updateClient( const GStore::StoredMessage & message )
+GSmtp::Forward::Channel * GSmtp::Forward::updateClient( Channel & channel , const GStore::StoredMessage & message )
 {
-	bool new_address = m_forward_to_address != message.forwardToAddress() ;
-	bool new_selector = m_selector != message.clientAccountSelector() ;
+	// returns the channel to use, which is a pooled one if reusing a connection
+	Channel * pooled = nullptr ;
+	bool new_address = channel.m_forward_to_address != message.forwardToAddress() ;
+	bool new_selector = channel.m_selector != message.clientAccountSelector() ;
 	if( unconnectable( message.forwardToAddress() ) )
 	{
 		G_LOG( "GSmtp::Forward::updateClient: forwarding [" << message.id().str() << "]: "
 			"skipping message with unconnectable address [" << message.forwardToAddress() << "]" ) ;
-		return false ;
+		return nullptr ;
 	}
-	else if( m_client_ptr.get() == nullptr )
+	else if( channel.m_client_ptr.get() == nullptr && ( pooled = reuse( channel , message ) ) != nullptr )
+	{
+		return pooled ;
+	}
+	else if( channel.m_client_ptr.get() == nullptr )
 	{
 		G_DEBUG( "GSmtpForward::updateClient: new client [" << message.forwardToAddress() << "][" << message.clientAccountSelector() << "]" ) ;
-		newClient( message ) ;
+		newClient( channel , message ) ;
 	}
-	else if( m_forward_to_address != message.forwardToAddress() ||
-		m_selector != message.clientAccountSelector() )
+	else if( new_address || new_selector )
 	{
-		m_client_ptr->quitAndFinish() ;
+		channel.m_client_ptr->quitAndFinish() ;
 
 		std::ostringstream ss ;
 		if( new_address ) ss << "[" << message.forwardToAddress() << "]" ;
@@ -210,67 +482,81 @@ bool GSmtp::Forward::updateClient( const GStore::StoredMessage & message )
 		if( new_selector ) ss << "account selector [" << message.clientAccountSelector() << "]" ;
 		G_LOG( "GSmtpForward::updateClient: forwarding [" << message.id().str() << "]: new connection for " << ss.str() ) ;
 
-		newClient( message ) ;
+		newClient( channel , message ) ;
 	}
-	G_ASSERT( m_client_ptr.get() ) ;
-	return true ;
+	G_ASSERT( channel.m_client_ptr.get() ) ;
+	return &channel ;
 }
 
-void GSmtp::Forward::newClient( const GStore::StoredMessage & message )
+void GSmtp::Forward::newClient( Channel & channel , const GStore::StoredMessage & message )
 {
-	m_has_connected = false ;
-	m_forward_to_address = message.forwardToAddress() ;
-	m_selector = message.clientAccountSelector() ;
+	channel.m_has_connected = false ;
+	channel.m_forward_to_address = message.forwardToAddress() ;
+	channel.m_selector = message.clientAccountSelector() ;
 
-	if( m_client_ptr.get() )
-		m_client_ptr->messageDoneSignal().disconnect() ;
+	if( channel.m_client_ptr.get() )
+		channel.m_client_ptr->messageDoneSignal().disconnect() ;
 
-	if( m_forward_to_address.empty() )
-		m_forward_to_location = m_forward_to_default ;
+	if( channel.m_forward_to_address.empty() )
+		channel.m_forward_to_location = m_forward_to_default ;
 	else
-		m_forward_to_location = GNet::Location( m_forward_to_address ) ;
+		channel.m_forward_to_location = GNet::Location( channel.m_forward_to_address ) ;
 
-	m_client_ptr.reset( std::make_unique<GSmtp::Client>( m_es.eh(m_client_ptr) ,
-		m_ff , m_forward_to_location , m_secrets , m_config ) ) ;
+	channel.m_client_ptr.reset( std::make_unique<GSmtp::Client>( m_es.eh(channel.m_client_ptr) ,
+		m_ff , channel.m_forward_to_location , m_secrets , m_config ) ) ;
 
-	m_client_ptr->messageDoneSignal().connect( G::Slot::slot(*this,&Forward::onMessageDoneSignal) ) ;
+	channel.m_client_ptr->messageDoneSignal().connect( G::Slot::slot(channel,&Channel::onMessageDoneSignal) ) ;
 }
 
 void GSmtp::Forward::quitAndFinish()
 {
 	m_finished = true ;
-	if( m_client_ptr.get() )
-		m_client_ptr->quitAndFinish() ;
-}
-
-void GSmtp::Forward::onEventSignal( const std::string & p1 , const std::string & p2 , const std::string & p3 )
-{
-	m_event_signal.emit( std::string(p1) , std::string(p2) , std::string(p3) ) ;
+	for( auto & channel_ptr : m_channels )
+	{
+		if( channel_ptr->m_client_ptr.get() )
+			channel_ptr->m_client_ptr->quitAndFinish() ;
+	}
 }
 
-void GSmtp::Forward::onDeleteSignal( const std::string & )
+void GSmtp::Forward::onDeleteSignal( Channel & channel )
 {
 	// save the state of the Client before it goes away
-	G_ASSERT( m_client_ptr.get() ) ;
-	m_has_connected = m_client_ptr->hasConnected() ;
+	G_ASSERT( channel.m_client_ptr.get() ) ;
+	channel.m_has_connected = channel.m_client_ptr->hasConnected() ;
 }
 
-void GSmtp::Forward::onDeletedSignal( const std::string & reason )
+void GSmtp::Forward::onDeletedSignal( Channel & channel , const std::string & reason )
 {
 	G_DEBUG( "GSmtp::Forward::onDeletedSignal: [" << reason << "]" ) ;
-	if( m_store && !m_has_connected && !m_forward_to_address.empty() )
+	channel.m_busy = false ;
+	if( m_store && !channel.m_has_connected && !channel.m_forward_to_address.empty() )
 	{
 		// ignore connection failures to routed addresses -- just go on to the next message
 		G_ASSERT( !reason.empty() ) ; // GNet::Done only after connected
 		G_WARNING( "GSmtp::Forward::onDeletedSignal: smtp connection failed: " << reason ) ;
-		insert( m_unconnectable , m_forward_to_address ) ;
-		m_client_ptr.reset() ;
+		insert( m_unconnectable , channel.m_forward_to_address ) ;
+		dequeue( channel.m_forward_to_address ) ;
+		channel.m_client_ptr.reset() ;
 		m_continue_timer.startTimer( 0U ) ;
 	}
-	else
+	else if( m_store && reason.empty() && busy() )
 	{
-		// async throw
+		// this channel is finished but others are still going
+		G_DEBUG( "GSmtp::Forward::onDeletedSignal: channel finished" ) ;
+	}
+	else if( m_store && busy() )
+	{
+		// this channel has failed but others are still going -- let them
+		// carry on without it and report the error once they finish
+		G_WARNING( "GSmtp::Forward::onDeletedSignal: smtp client error: " << reason ) ;
+		channel.m_failed = true ;
 		m_error = reason ;
+	}
+	else
+	{
+		// async throw, reporting any earlier channel failure
+		if( !reason.empty() || m_error.empty() )
+			m_error = reason ;
 		m_error_timer.startTimer( 0U ) ;
 	}
 }
@@ -280,21 +566,38 @@ void GSmtp::Forward::onErrorTimeout()
 	throw G::Exception( m_error ) ; // terminates us
 }
 
-void GSmtp::Forward::onMessageDoneSignal( const Client::MessageDoneInfo & info )
+void GSmtp::Forward::onMessageDoneSignal( Channel & channel , const Client::MessageDoneInfo & info )
 {
 	// optimise away repeated DNS queries on the default forward-to address
-	G_ASSERT( m_client_ptr.get() ) ;
-	if( m_client_ptr.get() && m_client_ptr->hasConnected() && m_forward_to_address.empty() &&
-		!m_forward_to_default.resolved() && m_client_ptr->remoteLocation().resolved() )
+	G_ASSERT( channel.m_client_ptr.get() ) ;
+	if( channel.m_client_ptr.get() && channel.m_client_ptr->hasConnected() && channel.m_forward_to_address.empty() &&
+		!m_forward_to_default.resolved() && channel.m_client_ptr->remoteLocation().resolved() )
 	{
-		m_forward_to_default = m_client_ptr->remoteLocation() ;
+		m_forward_to_default = channel.m_client_ptr->remoteLocation() ;
 	}
 
+	channel.m_busy = false ;
 	if( m_store )
 	{
-		if( info.filter_special || !sendNext() )
+		if( info.filter_special )
+			m_stopping = true ;
+
+		G::CallFrame this_( m_stack ) ;
+		m_message_done_signal.emit( info ) ;
+		if( this_.deleted() ) return ;
+
+		if( m_stopping || !sendNext( channel ) )
 		{
-			quitAndFinish() ;
+			if( m_pool && channel.m_client_ptr->idle() )
+			{
+				// leave the connection idle -- sendAll() will pool it
+				m_continue_timer.startTimer( 0U ) ;
+				return ;
+			}
+			if( busy() )
+				channel.m_client_ptr->quitAndFinish() ;
+			else
+				quitAndFinish() ;
 			throw GNet::Done() ; // terminates the client -- m_client_ptr calls onDeletedSignal()
 		}
 	}
@@ -304,27 +607,38 @@ void GSmtp::Forward::onMessageDoneSignal( const Client::MessageDoneInfo & info )
 	}
 }
 
-void GSmtp::Forward::doOnDelete( const std::string & reason , bool /*done*/ )
+void GSmtp::Forward::doOnDelete( const std::string & reason , bool done )
 {
-	// (our owning ClientPtr is handling an exception by deleting us)
-	onDelete( reason ) ;
+	// (our owning ClientPtr is handling an exception by deleting us,
+	// possibly a GNet::Done from onContinueTimeout() when all the
+	// channels have finished)
+	onDelete( done ? std::string() : reason ) ;
 }
 
 void GSmtp::Forward::onDelete( const std::string & reason )
 {
 	G_WARNING_IF( !reason.empty() , "GSmtp::Forward::onDelete: smtp client error: " << reason ) ;
-	if( m_message ) // if we own the message ie. while filtering
+	for( auto & channel_ptr : m_channels )
 	{
-		// fail the message, otherwise the dtor will just unlock it
-		G_ASSERT( !reason.empty() ) ; // filters dont throw GNet::Done
-		m_message->fail( reason , 0 ) ;
+		if( channel_ptr->m_message ) // if we own the message ie. while filtering
+		{
+			// fail the message, otherwise the dtor will just unlock it
+			G_ASSERT( !reason.empty() ) ; // filters dont throw GNet::Done
+			channel_ptr->m_message->fail( reason , 0 ) ;
+			ForwardImp::failed.add() ;
+		}
 	}
 }
 
 std::string GSmtp::Forward::peerAddressString() const
 {
 	// (used for logging)
-	return m_client_ptr.get() ? m_client_ptr->peerAddressString() : std::string() ;
+	for( const auto & channel_ptr : m_channels )
+	{
+		if( channel_ptr->m_client_ptr.get() )
+			return channel_ptr->m_client_ptr->peerAddressString() ;
+	}
+	return {} ;
 }
 
 bool GSmtp::Forward::finished() const
@@ -372,3 +686,145 @@ G::Slot::Signal<const std::string&,const std::string&,const std::string&> & GSmt
 	return m_event_signal ;
 }
 
+// ==
+
+GSmtp::Forward::Channel::Channel( Forward * forward , const GNet::Location & forward_to_location ) :
+	m_forward(forward) ,
+	m_forward_to_location(forward_to_location)
+{
+	m_client_ptr.eventSignal().connect( G::Slot::slot(*this,&Channel::onEventSignal) ) ;
+	m_client_ptr.deleteSignal().connect( G::Slot::slot(*this,&Channel::onDeleteSignal) ) ;
+	m_client_ptr.deletedSignal().connect( G::Slot::slot(*this,&Channel::onDeletedSignal) ) ;
+}
+
+GSmtp::Forward::Channel::~Channel()
+{
+	if( m_client_ptr.get() )
+		m_client_ptr->messageDoneSignal().disconnect() ;
+	if( m_routing_filter )
+		m_routing_filter->doneSignal().disconnect() ;
+	m_client_ptr.deletedSignal().disconnect() ;
+	m_client_ptr.deleteSignal().disconnect() ;
+	m_client_ptr.eventSignal().disconnect() ;
+}
+
+void GSmtp::Forward::Channel::onMessageDoneSignal( const Client::MessageDoneInfo & info )
+{
+	if( m_forward )
+		m_forward->onMessageDoneSignal( *this , info ) ;
+}
+
+void GSmtp::Forward::Channel::onEventSignal( const std::string & p1 , const std::string & p2 , const std::string & p3 )
+{
+	if( m_forward )
+		m_forward->m_event_signal.emit( std::string(p1) , std::string(p2) , std::string(p3) ) ;
+}
+
+void GSmtp::Forward::Channel::onDeleteSignal( const std::string & )
+{
+	if( m_forward )
+		m_forward->onDeleteSignal( *this ) ;
+}
+
+void GSmtp::Forward::Channel::onDeletedSignal( const std::string & reason )
+{
+	// (a pooled connection that fails is pruned by the pool's timer)
+	if( m_forward )
+		m_forward->onDeletedSignal( *this , reason ) ;
+}
+
+void GSmtp::Forward::Channel::onRoutingFilterDone( int filter_result )
+{
+	if( m_forward )
+		m_forward->routingFilterDone( *this , filter_result ) ;
+}
+
+// ==
+
+GSmtp::Forward::Pool::Pool( GNet::EventState es , unsigned int idle_timeout ) :
+	m_es(es) ,
+	m_idle_timeout(idle_timeout) ,
+	m_timer(*this,&Pool::onTimeout,m_es)
+{
+}
+
+GSmtp::Forward::Pool::~Pool()
+= default;
+
+std::size_t GSmtp::Forward::Pool::size() const noexcept
+{
+	return m_items.size() ;
+}
+
+void GSmtp::Forward::Pool::add( const Key & key , std::unique_ptr<Channel> channel_ptr )
+{
+	G_ASSERT( channel_ptr && channel_ptr->m_client_ptr.get() ) ;
+	G_DEBUG( "GSmtp::Forward::Pool::add: idle connection to " << channel_ptr->m_client_ptr->peerAddressString() ) ;
+	m_items.emplace( key , Item{ std::move(channel_ptr) , G::TimerTime::now() + G::TimeInterval(m_idle_timeout) } ) ;
+	if( !m_timer.active() )
+		m_timer.startTimer( interval() ) ;
+}
+
+std::unique_ptr<GSmtp::Forward::Channel> GSmtp::Forward::Pool::take( const Key & key )
+{
+	// most recently used first, so that surplus connections time out --
+	// equal keys are kept in insertion order
+	auto range = m_items.equal_range( key ) ;
+	for( auto p = range.second ; p != range.first ; )
+	{
+		--p ;
+		Client * client = p->second.channel->m_client_ptr.get() ;
+		if( client && client->idle() )
+		{
+			std::unique_ptr<Channel> channel_ptr = std::move( p->second.channel ) ;
+			m_items.erase( p ) ;
+			return channel_ptr ;
+		}
+	}
+	return {} ;
+}
+
+void GSmtp::Forward::Pool::onTimeout()
+{
+	G::TimerTime now = G::TimerTime::now() ;
+	for( auto & key_item : m_items )
+	{
+		Item & item = key_item.second ;
+		Client * client = item.channel->m_client_ptr.get() ;
+		if( client == nullptr )
+			continue ;
+		try
+		{
+			if( item.time <= now || !client->idle() )
+			{
+				G_LOG_MORE( "GSmtp::Forward::Pool::onTimeout: closing idle connection to " << client->peerAddressString() ) ;
+				client->quitAndFinish() ;
+				item.channel->m_client_ptr.reset() ;
+			}
+			else
+			{
+				client->keepalive() ;
+			}
+		}
+		catch( std::exception & e )
+		{
+			G_WARNING( "GSmtp::Forward::Pool::onTimeout: idle connection failed: " << e.what() ) ;
+			item.channel->m_client_ptr.reset() ;
+		}
+	}
+	for( auto p = m_items.begin() ; p != m_items.end() ; )
+	{
+		if( p->second.channel->m_client_ptr.get() == nullptr )
+			p = m_items.erase( p ) ;
+		else
+			++p ;
+	}
+	if( !m_items.empty() )
+		m_timer.startTimer( interval() ) ;
+}
+
+unsigned int GSmtp::Forward::Pool::interval() const
+{
+	// keepalive interval
+	return std::max( 1U , std::min( m_idle_timeout , 60U ) ) ;
+}
@@ -35,10 +35,16 @@
 #include "gfilter.h"
 #include "gsocket.h"
 #include "gslot.h"
+#include "gcall.h"
 #include "gtimer.h"
 #include "gstringarray.h"
 #include "gexception.h"
 #include <memory>
+#include <vector>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <utility>
 #include <iostream>
 
 namespace GSmtp
@@ -48,25 +54,53 @@ namespace GSmtp
 
 //| \class GSmtp::Forward
 /// A class for forwarding messages from a message store that manages
-/// a GSmtp::Client instance, connecting and disconnecting as necessary
+/// GSmtp::Client instances, connecting and disconnecting as necessary
 /// to do routing and re-authentication.
 ///
+/// When forwarding from a message store there can be more than one
+/// client connection working in parallel (see Config::forward_concurrency),
+/// with each connection taking the next message from the store as soon
+/// as it has finished with the previous one. If one connection fails
+/// then it is not used again and the others carry on, with the error
+/// being reported once they have finished.
+///
+/// If there is a limit on the number of connections to each
+/// destination (ie. forward-to address and account selector, see
+/// Config::forward_destination_concurrency) then messages are grouped
+/// by destination so that a connection can be reused for consecutive
+/// messages to the same destination. Messages that cannot be sent
+/// straight away are held in per-destination queues, up to
+/// Config::forward_queue_limit, so that one slow destination does
+/// not hold up all the others.
+///
+/// An optional Forward::Pool can be used to keep idle connections
+/// open from one Forward object to the next. A pooled connection is
+/// only reused for a message with the same destination.
+///
 class GSmtp::Forward
 {
 public:
 	using Config = GSmtp::Client::Config ;
+	class Pool ;
 
 	Forward( GNet::EventState , GStore::MessageStore & store ,
 		FilterFactoryBase & , const GNet::Location & forward_to_default ,
-		const GAuth::SaslClientSecrets & , const Config & config ) ;
+		const GAuth::SaslClientSecrets & , const Config & config ,
+		Pool * pool = nullptr ) ;
 			///< Constructor. Starts sending the first message from the
 			///< message store.
 			///<
+			///< If a pool is given then idle connections are taken
+			///< from it as messages for their destination come up and
+			///< given back to it when there are no more messages. The
+			///< pool must outlive this object.
+			///<
 			///< Once all messages have been sent the client will
 			///< throw GNet::Done. See GNet::ClientPtr.
 			///<
 			///< Do not use sendMessage(). The messageDoneSignal()
-			///< is not emitted.
+			///< is emitted as each message is done, from whichever
+			///< client connection sent it.
 
 	Forward( GNet::EventState ,
 		FilterFactoryBase & , const GNet::Location & forward_to_default ,
@@ -112,7 +146,8 @@ public:
 		///< Returns true after quitAndFinish().
 
 	std::string peerAddressString() const ;
-		///< Returns the Client's peerAddressString() if currently connected.
+		///< Returns the first Client's peerAddressString() if
+		///< currently connected.
 
 public:
 	Forward( const Forward & ) = delete ;
@@ -120,47 +155,144 @@ public:
 	Forward & operator=( const Forward & ) = delete ;
 	Forward & operator=( Forward && ) = delete ;
 
+private:
+	struct Channel /// One of the parallel client connections used by GSmtp::Forward.
+	{
+		Channel( Forward * , const GNet::Location & ) ;
+		~Channel() ;
+		void onMessageDoneSignal( const Client::MessageDoneInfo & ) ;
+		void onEventSignal( const std::string & , const std::string & , const std::string & ) ;
+		void onDeleteSignal( const std::string & ) ;
+		void onDeletedSignal( const std::string & ) ;
+		void onRoutingFilterDone( int ) ;
+		Forward * m_forward ; // nullptr while pooled
+		GNet::ClientPtr<GSmtp::Client> m_client_ptr ;
+		GNet::Location m_forward_to_location ;
+		std::string m_forward_to_address ;
+		std::string m_selector ;
+		std::unique_ptr<GStore::StoredMessage> m_message ;
+		std::unique_ptr<Filter> m_routing_filter ;
+		bool m_busy {false} ;
+		bool m_has_connected {false} ;
+		bool m_failed {false} ; // not used again in this forwarding run
+		Channel( const Channel & ) = delete ;
+		Channel( Channel && ) = delete ;
+		Channel & operator=( const Channel & ) = delete ;
+		Channel & operator=( Channel && ) = delete ;
+	} ;
+
 private:
 	void onErrorTimeout() ;
 	void onContinueTimeout() ;
-	bool sendNext() ;
-	void start( std::unique_ptr<GStore::StoredMessage> ) ;
-	void onMessageDoneSignal( const Client::MessageDoneInfo & ) ;
-	void onEventSignal( const std::string & , const std::string & , const std::string & ) ;
+	using Destination = std::pair<std::string,std::string> ; // forward-to address, selector
+	using Queue = std::deque<std::unique_ptr<GStore::StoredMessage>> ;
+	using QueueMap = std::map<Destination,Queue> ;
+
+private:
+	bool sendAll() ;
+	bool sendNext( Channel & ) ;
+	bool sendQueued( Channel & , bool same_destination ) ;
+	bool sendStored( Channel & ) ;
+	QueueMap::iterator selectQueue( const Channel & , bool same_destination ) ;
+	bool deferrable( const Channel & , const Destination & ) const ;
+	void enqueue( std::unique_ptr<GStore::StoredMessage> ) ;
+	void dequeue( const std::string & forward_to_address ) ;
+	std::size_t active( const Destination & ) const ;
+	bool startable( const Destination & ) const ;
+	void startRouting( Channel & , std::unique_ptr<GStore::StoredMessage> ) ;
+	bool startClient( Channel & , std::unique_ptr<GStore::StoredMessage> ) ;
+	bool busy() const ;
+	bool idle() const ;
+	Channel * reuse( Channel & , const GStore::StoredMessage & ) ;
+	void release( std::unique_ptr<Channel> & ) ;
+	void onMessageDoneSignal( Channel & , const Client::MessageDoneInfo & ) ;
 	void onDelete( const std::string & reason ) ;
-	void onDeleteSignal( const std::string & ) ;
-	void onDeletedSignal( const std::string & ) ;
-	bool updateClient( const GStore::StoredMessage & ) ;
-	void newClient( const GStore::StoredMessage & ) ;
-	void routingFilterDone( int ) ;
+	void onDeleteSignal( Channel & ) ;
+	void onDeletedSignal( Channel & , const std::string & ) ;
+	Channel * updateClient( Channel & , const GStore::StoredMessage & ) ;
+	void newClient( Channel & , const GStore::StoredMessage & ) ;
+	void routingFilterDone( Channel & , int ) ;
 	bool unconnectable( const std::string & ) const ;
 	static void insert( G::StringArray & , const std::string & ) ;
 	static bool contains( const G::StringArray & , const std::string & ) ;
 	static std::string messageInfo( const GStore::StoredMessage & ) ;
+	static Destination destination( const GStore::StoredMessage & ) ;
+	static Destination destination( const Channel & ) ;
+	std::tuple<std::string,std::string,std::string> poolKey( const Destination & ) const ;
 
 private:
 	GNet::EventState m_es ;
 	GStore::MessageStore * m_store ;
+	Pool * m_pool ;
 	FilterFactoryBase & m_ff ;
 	GNet::Location m_forward_to_default ;
-	GNet::Location m_forward_to_location ;
-	std::string m_forward_to_address ;
+	std::string m_forward_to_default_name ;
 	G::StringArray m_unconnectable ;
-	GNet::ClientPtr<GSmtp::Client> m_client_ptr ;
+	std::vector<std::unique_ptr<Channel>> m_channels ;
+	std::vector<std::unique_ptr<Channel>> m_spare_channels ; // swapped out for pooled channels
 	const GAuth::SaslClientSecrets & m_secrets ;
 	Config m_config ;
 	GNet::Timer<Forward> m_error_timer ;
 	GNet::Timer<Forward> m_continue_timer ;
 	std::string m_error ;
 	std::shared_ptr<GStore::MessageStore::Iterator> m_iter ;
-	std::unique_ptr<GStore::StoredMessage> m_message ;
+	QueueMap m_queues ;
+	std::size_t m_queued ;
 	unsigned int m_message_count ;
-	std::unique_ptr<Filter> m_routing_filter ;
-	std::string m_selector ;
-	bool m_has_connected ;
+	bool m_no_more ;
+	bool m_no_more_logged ;
+	bool m_stopping ;
 	bool m_finished ;
+	G::CallStack m_stack ;
 	G::Slot::Signal<const Client::MessageDoneInfo&> m_message_done_signal ;
 	G::Slot::Signal<const std::string&,const std::string&,const std::string&> m_event_signal ;
 } ;
 
+//| \class GSmtp::Forward::Pool
+/// A pool of idle smtp client connections that lets a connected and
+/// authenticated session be reused by the next GSmtp::Forward object,
+/// so that new messages can go straight to MAIL-FROM. Connections are
+/// keyed by their destination, ie. forward-to address, account selector
+/// and TLS profile, and are only reused for the same destination. Idle
+/// connections are kept open with periodic NOOP commands and are closed
+/// after an idle timeout.
+///
+class GSmtp::Forward::Pool
+{
+public:
+	Pool( GNet::EventState , unsigned int idle_timeout ) ;
+		///< Constructor. The idle timeout is in seconds.
+
+	~Pool() ;
+		///< Destructor. Any idle connections are dropped.
+
+	std::size_t size() const noexcept ;
+		///< Returns the number of pooled connections.
+
+public:
+	Pool( const Pool & ) = delete ;
+	Pool( Pool && ) = delete ;
+	Pool & operator=( const Pool & ) = delete ;
+	Pool & operator=( Pool && ) = delete ;
+
+private:
+	friend class GSmtp::Forward ;
+	using Key = std::tuple<std::string,std::string,std::string> ; // forward-to address, selector, tls profile
+	struct Item
+	{
+		std::unique_ptr<Channel> channel ;
+		G::TimerTime time ;
+	} ;
+	void add( const Key & , std::unique_ptr<Channel> ) ;
+	std::unique_ptr<Channel> take( const Key & ) ;
+	void onTimeout() ;
+	unsigned int interval() const ;
+
+private:
+	GNet::EventState m_es ;
+	unsigned int m_idle_timeout ;
+	std::multimap<Key,Item> m_items ;
+	GNet::Timer<Pool> m_timer ;
+} ;
+
 #endif
@@ -142,7 +142,11 @@ void GSmtp::ServerPeer::onSendComplete()
 
 void GSmtp::ServerPeer::protocolShutdown( int how )
 {
-	if( how >= 0 )
+	// a tls close-notify before the socket shutdown allows
+	// the tls session to be resumed later
+	if( how == 1 )
+		finish() ; // GNet::ServerPeer::finish()
+	else if( how >= 0 )
 		socket().shutdown( how ) ;
 }
 
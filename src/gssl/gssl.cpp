@@ -142,8 +142,9 @@ GSsl::Digester GSsl::Library::digester( const std::string & hash_function , cons
 
 // ==
 
-GSsl::Protocol::Protocol( const Profile & profile , const std::string & peer_certificate_name , const std::string & peer_host_name ) :
-	m_imp( profile.newProtocol(peer_certificate_name,peer_host_name) )
+GSsl::Protocol::Protocol( const Profile & profile , const std::string & peer_certificate_name , const std::string & peer_host_name ,
+	const std::string & session_key ) :
+		m_imp( profile.newProtocol(peer_certificate_name,peer_host_name,session_key) )
 {
 }
 
@@ -213,6 +214,26 @@ GSsl::Protocol::Result GSsl::Protocol::shutdown()
 	return m_imp->shutdown() ;
 }
 
+bool GSsl::Protocol::kernelTls() const
+{
+	return m_imp->kernelTls() ;
+}
+
+GSsl::Protocol::Result GSsl::Protocol::sendfile( int fd , std::size_t offset , std::size_t size , ssize_t & data_size_out )
+{
+	return m_imp->sendfile( fd , offset , size , data_size_out ) ;
+}
+
+bool GSsl::Protocol::threaded() const
+{
+	return m_imp->threaded() ;
+}
+
+void GSsl::Protocol::flushLog()
+{
+	m_imp->flushLog() ;
+}
+
 // ==
 
 GSsl::Digester::Digester( std::unique_ptr<DigesterImpBase> p ) :
@@ -266,3 +287,20 @@ bool GSsl::LibraryImpBase::consume( G::StringArray & list , std::string_view key
 	}
 }
 
+bool GSsl::LibraryImpBase::consume( G::StringArray & list , std::string_view key , unsigned int & value )
+{
+	std::string prefix = G::sv_to_string(key).append( 1U , '=' ) ;
+	auto p = std::find_if( list.begin() , list.end() , [&prefix](const std::string & item){
+		return G::Str::headMatch( item , prefix ) && G::Str::isUInt( std::string_view(item).substr(prefix.size()) ) ; } ) ;
+	if( p != list.end() )
+	{
+		value = G::Str::toUInt( std::string_view(*p).substr(prefix.size()) ) ;
+		list.erase( p ) ;
+		return true ;
+	}
+	else
+	{
+		return false ;
+	}
+}
+
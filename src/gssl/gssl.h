@@ -31,6 +31,8 @@
 #include <string>
 #include <memory>
 #include <utility>
+#include <map>
+#include <ctime>
 
 namespace GSsl
 {
@@ -41,6 +43,7 @@ namespace GSsl
 	class LibraryImpBase ;
 	class ProtocolImpBase ;
 	class DigesterImpBase ;
+	template <typename T> class SessionCache ;
 }
 
 //| \class GSsl::Protocol
@@ -77,7 +80,7 @@ public:
 	} ;
 
 	explicit Protocol( const Profile & , const std::string & peer_certificate_name = {} ,
-		const std::string & peer_host_name = {} ) ;
+		const std::string & peer_host_name = {} , const std::string & session_key = {} ) ;
 			///< Constructor.
 			///<
 			///< The optional "peer-certificate-name" parameter is used as an
@@ -99,6 +102,13 @@ public:
 			///< Some underlying libraries treat peer-certificate-name and
 			///< peer-host-name to be the same, using wildcard matching of
 			///< the certificate CNAME against the peer-host-name.
+			///<
+			///< The optional "session-key" parameter is used by clients
+			///< to identify the peer, typically by its transport address,
+			///< so that a session saved from an earlier connection to the
+			///< same peer can be offered for resumption. This has no effect
+			///< unless the profile has a session cache (see the "sessioncache"
+			///< library configuration keyword).
 
 	~Protocol() ;
 		///< Destructor.
@@ -162,6 +172,27 @@ public:
 		///< Returns Result::error if the transport connnection was lost
 		///< or if the TLS session was shut down by the peer or on error.
 
+	bool kernelTls() const ;
+		///< Returns true if the TLS record encryption for sending is
+		///< being done by the operating system kernel so that
+		///< sendfile() can be used.
+
+	bool threaded() const ;
+		///< Returns true if the profile is configured with the "threads"
+		///< keyword and the underlying library allows connect() and
+		///< accept() to be called from a worker thread, one call at a
+		///< time. Any logging from connect() and accept() is then held
+		///< back until flushLog() is called from the main thread.
+
+	void flushLog() ;
+		///< Emits any log output held back by a threaded() handshake.
+
+	Result sendfile( int fd , std::size_t offset , std::size_t size , ssize_t & data_size_out ) ;
+		///< Sends user data directly from an open file, with the
+		///< same return values as write(). Returns Result::ok with
+		///< a zero data size at end-of-file.
+		///< Precondition: kernelTls()
+
 	static std::string str( Result result ) ;
 		///< Converts a result enumeration into a printable string.
 		///< Used in logging and diagnostics.
@@ -409,6 +440,12 @@ public:
 	static bool consume( G::StringArray & list , std::string_view item ) ;
 		///< A convenience function that removes the item from
 		///< the list and returns true iff is was removed.
+
+	static bool consume( G::StringArray & list , std::string_view key , unsigned int & value ) ;
+		///< A convenience function that removes a "<key>=<number>"
+		///< item from the list, returning true iff it was removed.
+		///< The number is returned by reference. Items with an
+		///< invalid number are left in the list.
 } ;
 
 //| \class GSsl::Profile
@@ -421,7 +458,8 @@ public:
 	virtual ~Profile() = default ;
 		///< Destructor.
 
-	virtual std::unique_ptr<ProtocolImpBase> newProtocol( const std::string & , const std::string & ) const = 0 ;
+	virtual std::unique_ptr<ProtocolImpBase> newProtocol( const std::string & , const std::string & ,
+		const std::string & ) const = 0 ;
 		///< Factory method for a new Protocol object.
 } ;
 
@@ -449,6 +487,18 @@ public:
 	virtual Protocol::Result write( const char * , std::size_t , ssize_t & ) = 0 ;
 		///< Implements Protocol::write().
 
+	virtual bool kernelTls() const = 0 ;
+		///< Implements Protocol::kernelTls().
+
+	virtual Protocol::Result sendfile( int , std::size_t , std::size_t , ssize_t & ) = 0 ;
+		///< Implements Protocol::sendfile().
+
+	virtual bool threaded() const = 0 ;
+		///< Implements Protocol::threaded().
+
+	virtual void flushLog() = 0 ;
+		///< Implements Protocol::flushLog().
+
 	virtual std::string peerCertificate() const = 0 ;
 		///< Implements Protocol::peerCertificate().
 
@@ -493,4 +543,98 @@ public:
 		///< Implements Digester::statesize().
 } ;
 
+//| \class GSsl::SessionCache
+/// A client-side cache of TLS sessions, keyed by peer, used by the
+/// library implementations to offer session resumption when
+/// reconnecting to the same server. Entries expire after the given
+/// timeout and the oldest entry is evicted when the cache is full.
+/// Access is serialised with a mutex.
+///
+template <typename T>
+class GSsl::SessionCache
+{
+public:
+	using Session = std::shared_ptr<T> ;
+
+	SessionCache( std::size_t limit , unsigned int timeout ) ;
+		///< Constructor.
+
+	void store( const std::string & key , Session ) ;
+		///< Adds or replaces a session.
+
+	Session find( const std::string & key ) ;
+		///< Returns the unexpired session for the given key, or
+		///< an empty pointer.
+
+	void remove( const std::string & key ) ;
+		///< Removes the session for the given key.
+
+public:
+	~SessionCache() = default ;
+	SessionCache( const SessionCache<T> & ) = delete ;
+	SessionCache( SessionCache<T> && ) = delete ;
+	SessionCache<T> & operator=( const SessionCache<T> & ) = delete ;
+	SessionCache<T> & operator=( SessionCache<T> && ) = delete ;
+
+private:
+	struct Entry
+	{
+		Session session ;
+		std::time_t time ;
+	} ;
+	using Map = std::map<std::string,Entry> ;
+
+private:
+	std::size_t m_limit ;
+	std::time_t m_timeout ;
+	G::threading::mutex_type m_mutex ;
+	Map m_map ;
+} ;
+
+template <typename T>
+GSsl::SessionCache<T>::SessionCache( std::size_t limit , unsigned int timeout ) :
+	m_limit(limit?limit:1U) ,
+	m_timeout(static_cast<std::time_t>(timeout))
+{
+}
+
+template <typename T>
+void GSsl::SessionCache<T>::store( const std::string & key , Session session )
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	m_map[key] = Entry{ session , std::time(nullptr) } ;
+	if( m_map.size() > m_limit )
+	{
+		auto oldest = m_map.begin() ;
+		for( auto p = m_map.begin() ; p != m_map.end() ; ++p )
+		{
+			if( (*p).second.time < (*oldest).second.time )
+				oldest = p ;
+		}
+		m_map.erase( oldest ) ;
+	}
+}
+
+template <typename T>
+typename GSsl::SessionCache<T>::Session GSsl::SessionCache<T>::find( const std::string & key )
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	auto p = m_map.find( key ) ;
+	if( p == m_map.end() )
+		return {} ;
+	if( (std::time(nullptr)-(*p).second.time) >= m_timeout )
+	{
+		m_map.erase( p ) ;
+		return {} ;
+	}
+	return (*p).second.session ;
+}
+
+template <typename T>
+void GSsl::SessionCache<T>::remove( const std::string & key )
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	m_map.erase( key ) ;
+}
+
 #endif
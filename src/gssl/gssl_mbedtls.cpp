@@ -213,6 +213,17 @@ GSsl::MbedTls::Config::Config( G::StringArray & config ) :
 	if( consume(config,"nopsa") )
 		m_psa = false ;
 #endif
+
+	// session resumption
+	m_session_cache = consume( config , "sessioncache" ) ;
+	if( consume( config , "sessioncache" , m_session_cache_size ) )
+		m_session_cache = m_session_cache_size != 0U ;
+	if( consume( config , "sessiontimeout" , m_session_timeout ) && m_session_timeout == 0U )
+		m_session_timeout = 300U ;
+	m_tickets = consume( config , "tickets" ) ;
+
+	// handshakes on worker threads
+	m_threads = consume( config , "threads" ) ;
 }
 
 int GSsl::MbedTls::Config::min_() const noexcept
@@ -240,11 +251,41 @@ bool GSsl::MbedTls::Config::noisy() const noexcept
 	return m_noisy ;
 }
 
+bool GSsl::MbedTls::Config::sessionCache() const noexcept
+{
+	return m_session_cache ;
+}
+
+unsigned int GSsl::MbedTls::Config::sessionCacheSize() const noexcept
+{
+	return m_session_cache_size ;
+}
+
+unsigned int GSsl::MbedTls::Config::sessionTimeout() const noexcept
+{
+	return m_session_timeout ;
+}
+
+bool GSsl::MbedTls::Config::tickets() const noexcept
+{
+	return m_tickets ;
+}
+
+bool GSsl::MbedTls::Config::threads() const noexcept
+{
+	return m_threads ;
+}
+
 bool GSsl::MbedTls::Config::consume( G::StringArray & list , std::string_view item )
 {
 	return LibraryImp::consume( list , item ) ;
 }
 
+bool GSsl::MbedTls::Config::consume( G::StringArray & list , std::string_view key , unsigned int & value )
+{
+	return LibraryImp::consume( list , key , value ) ;
+}
+
 // ==
 
 GSsl::MbedTls::DigesterImp::DigesterImp( const std::string & hash_name , const std::string & state , bool need_state ) :
@@ -421,6 +462,15 @@ GSsl::MbedTls::ProfileImp::ProfileImp( const LibraryImp & library_imp , bool is_
 	}
 	m_noisy = extra_config.noisy() ;
 
+	// handshakes on worker threads if the library was built thread-safe --
+	// the debug callback logs directly so not if noisy
+	#if defined(MBEDTLS_THREADING_C)
+		m_threaded = extra_config.threads() && !m_noisy ;
+	#else
+		if( extra_config.threads() )
+			G_WARNING( "GSsl::MbedTls::ProfileImp::ctor: tls-config: threads not supported by this build of mbedtls" ) ;
+	#endif
+
 	// initialise the mbedtls_ssl_config structure
 	{
 		mbedtls_ssl_config_init( &m_config ) ;
@@ -499,20 +549,86 @@ GSsl::MbedTls::ProfileImp::ProfileImp( const LibraryImp & library_imp , bool is_
 	{
 		mbedtls_ssl_conf_renegotiation( &m_config , MBEDTLS_SSL_RENEGOTIATION_DISABLED ) ;
 	}
+
+	// session resumption
+	if( is_server_profile )
+		applySessions( extra_config ) ;
+	else if( extra_config.sessionCache() )
+		m_session_cache = std::make_unique<SessionCache<mbedtls_ssl_session>>(
+			extra_config.sessionCacheSize() ? extra_config.sessionCacheSize() : 100U , extra_config.sessionTimeout() ) ;
+
 	cleanup.release() ;
 }
 
+void GSsl::MbedTls::ProfileImp::applySessions( const Config & config )
+{
+	if( config.sessionCache() )
+	{
+		#if defined(MBEDTLS_SSL_CACHE_C)
+			m_cache = std::make_unique<mbedtls_ssl_cache_context>() ;
+			mbedtls_ssl_cache_init( m_cache.get() ) ;
+			if( config.sessionCacheSize() )
+				mbedtls_ssl_cache_set_max_entries( m_cache.get() , static_cast<int>(config.sessionCacheSize()) ) ;
+			#if defined(MBEDTLS_HAVE_TIME)
+				mbedtls_ssl_cache_set_timeout( m_cache.get() , static_cast<int>(config.sessionTimeout()) ) ;
+			#endif
+			mbedtls_ssl_conf_session_cache( &m_config , m_cache.get() , mbedtls_ssl_cache_get , mbedtls_ssl_cache_set ) ;
+		#else
+			G_WARNING( "GSsl::MbedTls::ProfileImp::applySessions: tls-config: sessioncache not supported by this build of mbedtls" ) ;
+		#endif
+	}
+
+	if( config.tickets() )
+	{
+		#if defined(MBEDTLS_SSL_TICKET_C)
+			// mbedtls rotates the ticket key after the lifetime and
+			// still accepts tickets made with the previous key
+			m_ticket = std::make_unique<mbedtls_ssl_ticket_context>() ;
+			mbedtls_ssl_ticket_init( m_ticket.get() ) ;
+			int rc = mbedtls_ssl_ticket_setup( m_ticket.get() , mbedtls_ctr_drbg_random , m_library_imp.rng().ptr() ,
+				MBEDTLS_CIPHER_AES_256_GCM , config.sessionTimeout() ) ;
+			if( rc )
+			{
+				mbedtls_ssl_ticket_free( m_ticket.get() ) ;
+				m_ticket.reset() ;
+				throw Error( "mbedtls_ssl_ticket_setup" , rc ) ;
+			}
+			mbedtls_ssl_conf_session_tickets_cb( &m_config , mbedtls_ssl_ticket_write , mbedtls_ssl_ticket_parse , m_ticket.get() ) ;
+		#else
+			G_WARNING( "GSsl::MbedTls::ProfileImp::applySessions: tls-config: tickets not supported by this build of mbedtls" ) ;
+		#endif
+	}
+}
+
 GSsl::MbedTls::ProfileImp::~ProfileImp()
 {
 	mbedtls_ssl_config_free( &m_config ) ;
+	#if defined(MBEDTLS_SSL_CACHE_C)
+		if( m_cache )
+			mbedtls_ssl_cache_free( m_cache.get() ) ;
+	#endif
+	#if defined(MBEDTLS_SSL_TICKET_C)
+		if( m_ticket )
+			mbedtls_ssl_ticket_free( m_ticket.get() ) ;
+	#endif
 }
 
 std::unique_ptr<GSsl::ProtocolImpBase> GSsl::MbedTls::ProfileImp::newProtocol( const std::string & peer_certificate_name ,
-	const std::string & peer_host_name ) const
+	const std::string & peer_host_name , const std::string & session_key ) const
 {
 	return std::make_unique<MbedTls::ProtocolImp>( *this ,
 		peer_certificate_name.empty()?defaultPeerCertificateName():peer_certificate_name ,
-		peer_host_name.empty()?defaultPeerHostName():peer_host_name ) ; // upcast
+		peer_host_name.empty()?defaultPeerHostName():peer_host_name , session_key ) ; // upcast
+}
+
+GSsl::SessionCache<mbedtls_ssl_session> * GSsl::MbedTls::ProfileImp::sessionCache() const
+{
+	return m_session_cache.get() ;
+}
+
+bool GSsl::MbedTls::ProfileImp::threaded() const
+{
+	return m_threaded ;
 }
 
 mbedtls_x509_crl * GSsl::MbedTls::ProfileImp::crl() const
@@ -591,9 +707,12 @@ int GSsl::MbedTls::ProfileImp::authmode() const
 // ==
 
 GSsl::MbedTls::ProtocolImp::ProtocolImp( const ProfileImp & profile , const std::string & required_peer_certificate_name ,
-	const std::string & target_peer_host_name ) :
+	const std::string & target_peer_host_name , const std::string & session_key ) :
 		m_profile(profile) ,
-		m_ssl(profile.config())
+		m_ssl(profile.config()) ,
+		m_session_cache(session_key.empty()?nullptr:profile.sessionCache()) ,
+		m_session_key(session_key) ,
+		m_threaded(profile.threaded())
 {
 	mbedtls_ssl_set_bio( m_ssl.ptr() , this , doSend , doRecv , nullptr/*doRecvTimeout*/ ) ;
 
@@ -605,6 +724,16 @@ GSsl::MbedTls::ProtocolImp::ProtocolImp( const ProfileImp & profile , const std:
 	std::string name = target_peer_host_name.empty() ? required_peer_certificate_name : target_peer_host_name ;
 	if( !name.empty() )
 		mbedtls_ssl_set_hostname( m_ssl.ptr() , name.c_str() ) ;
+
+	// offer to resume a session from an earlier connection to the same peer
+	#if defined(MBEDTLS_SSL_CLI_C)
+	if( m_session_cache )
+	{
+		std::shared_ptr<mbedtls_ssl_session> session = m_session_cache->find( m_session_key ) ;
+		if( session && mbedtls_ssl_set_session( m_ssl.ptr() , session.get() ) != 0 )
+			m_session_cache->remove( m_session_key ) ;
+	}
+	#endif
 }
 
 GSsl::MbedTls::ProtocolImp::~ProtocolImp()
@@ -753,11 +882,31 @@ GSsl::Protocol::Result GSsl::MbedTls::ProtocolImp::handshake()
 		m_peer_certificate = getPeerCertificate() ;
 		m_peer_certificate_chain = m_peer_certificate ; // not implemented
 
-		m_profile.logAt( 2 , std::string("certificate verification: [") + vstr + "]" ) ;
+		log( 2 , std::string("certificate verification: [") + vstr + "]" ) ;
+		saveSession() ;
+		m_established = true ;
+	}
+	else if( result == Protocol::Result::error && m_session_cache )
+	{
+		m_session_cache->remove( m_session_key ) ; // in case the saved session is to blame
 	}
 	return result ;
 }
 
+void GSsl::MbedTls::ProtocolImp::saveSession()
+{
+	#if defined(MBEDTLS_SSL_CLI_C)
+	if( m_session_cache )
+	{
+		std::shared_ptr<mbedtls_ssl_session> session( new mbedtls_ssl_session ,
+			[](mbedtls_ssl_session * p){ mbedtls_ssl_session_free(p) ; delete p ; } ) ;
+		mbedtls_ssl_session_init( session.get() ) ;
+		if( mbedtls_ssl_get_session( m_ssl.ptr() , session.get() ) == 0 )
+			m_session_cache->store( m_session_key , session ) ;
+	}
+	#endif
+}
+
 std::string GSsl::MbedTls::ProtocolImp::protocol() const
 {
 	const char * p = mbedtls_ssl_get_version( m_ssl.ptr() ) ;
@@ -825,6 +974,40 @@ bool GSsl::MbedTls::ProtocolImp::verified() const
 	return m_verified ;
 }
 
+bool GSsl::MbedTls::ProtocolImp::kernelTls() const
+{
+	return false ;
+}
+
+void GSsl::MbedTls::ProtocolImp::log( int level , const std::string & line ) const
+{
+	// logging is not thread-safe so hold it back if the handshake
+	// might be running on a worker thread -- see flushLog()
+	if( m_threaded && !m_established )
+		m_deferred_log.emplace_back( level , line ) ;
+	else
+		m_profile.logAt( level , line ) ;
+}
+
+bool GSsl::MbedTls::ProtocolImp::threaded() const
+{
+	return m_threaded ;
+}
+
+void GSsl::MbedTls::ProtocolImp::flushLog()
+{
+	std::vector<std::pair<int,std::string>> lines ;
+	lines.swap( m_deferred_log ) ;
+	for( const auto & line : lines )
+		m_profile.logAt( line.first , line.second ) ;
+}
+
+GSsl::Protocol::Result GSsl::MbedTls::ProtocolImp::sendfile( int , std::size_t , std::size_t , ssize_t & data_size_out )
+{
+	data_size_out = 0 ;
+	return Protocol::Result::error ; // no kernel tls
+}
+
 // ==
 
 GSsl::MbedTls::Context::Context( const mbedtls_ssl_config * config_p ) :
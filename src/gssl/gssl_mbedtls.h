@@ -29,6 +29,7 @@
 #include <memory>
 #include <stdexcept>
 #include <vector>
+#include <utility>
 #include <map>
 
 namespace GSsl
@@ -194,9 +195,15 @@ public:
 	bool noverify() const noexcept ;
 	bool noisy() const noexcept ;
 	bool psa() const noexcept ;
+	bool sessionCache() const noexcept ;
+	unsigned int sessionCacheSize() const noexcept ; // zero for the library default
+	unsigned int sessionTimeout() const noexcept ;
+	bool tickets() const noexcept ;
+	bool threads() const noexcept ;
 
 private:
 	static bool consume( G::StringArray & , std::string_view ) ;
+	static bool consume( G::StringArray & , std::string_view , unsigned int & ) ;
 
 private:
 	bool m_noverify ;
@@ -204,6 +211,11 @@ private:
 	int m_min {-1} ;
 	int m_max {-1} ;
 	bool m_psa {true} ;
+	bool m_session_cache {false} ;
+	unsigned int m_session_cache_size {0U} ;
+	unsigned int m_session_timeout {300U} ;
+	bool m_tickets {false} ;
+	bool m_threads {false} ;
 } ;
 
 //| \class GSsl::MbedTls::LibraryImp
@@ -273,9 +285,12 @@ public:
 	const std::string & defaultPeerCertificateName() const ;
 	const std::string & defaultPeerHostName() const ;
 	int authmode() const ;
+	SessionCache<mbedtls_ssl_session> * sessionCache() const ;
+	bool threaded() const ;
 
 private: // overrides
-	std::unique_ptr<ProtocolImpBase> newProtocol( const std::string & , const std::string & ) const override ;
+	std::unique_ptr<ProtocolImpBase> newProtocol( const std::string & , const std::string & ,
+		const std::string & ) const override ;
 
 public:
 	ProfileImp( const ProfileImp & ) = delete ;
@@ -286,6 +301,7 @@ public:
 private:
 	static void onDebug( void * , int , const char * , int , const char * ) ;
 	void doDebug( int , const char * , int , const char * ) ;
+	void applySessions( const Config & ) ;
 
 private:
 	const LibraryImp & m_library_imp ;
@@ -297,6 +313,14 @@ private:
 	Certificate m_ca_list ;
 	int m_authmode {0} ;
 	bool m_noisy {false} ;
+	bool m_threaded {false} ;
+	#if defined(MBEDTLS_SSL_CACHE_C)
+	std::unique_ptr<mbedtls_ssl_cache_context> m_cache ;
+	#endif
+	#if defined(MBEDTLS_SSL_TICKET_C)
+	std::unique_ptr<mbedtls_ssl_ticket_context> m_ticket ;
+	#endif
+	std::unique_ptr<SessionCache<mbedtls_ssl_session>> m_session_cache ;
 } ;
 
 //| \class GSsl::MbedTls::ProtocolImp
@@ -309,7 +333,7 @@ public:
 	using Context = MbedTls::Context ;
 	using Error = MbedTls::Error ;
 
-	ProtocolImp( const ProfileImp & , const std::string & , const std::string & ) ;
+	ProtocolImp( const ProfileImp & , const std::string & , const std::string & , const std::string & ) ;
 	~ProtocolImp() override ;
 
 	static int doSend( void * , const unsigned char * , std::size_t ) ;
@@ -322,6 +346,10 @@ private: // overrides
 	Result accept( G::ReadWrite & ) override ;
 	Result read( char * buffer , std::size_t buffer_size_in , ssize_t & data_size_out ) override ;
 	Result write( const char * buffer , std::size_t data_size_in , ssize_t & data_size_out ) override ;
+	bool kernelTls() const override ;
+	bool threaded() const override ;
+	void flushLog() override ;
+	Result sendfile( int , std::size_t , std::size_t , ssize_t & ) override ;
 	Result shutdown() override ;
 	std::string peerCertificate() const override ;
 	std::string peerCertificateChain() const override ;
@@ -338,6 +366,8 @@ public:
 private:
 	Result convert( const char * , int , bool more = false ) ;
 	Result handshake() ;
+	void saveSession() ;
+	void log( int , const std::string & ) const ;
 	std::string getPeerCertificate() ;
 	std::string verifyResultString( int ) ;
 
@@ -348,6 +378,11 @@ private:
 	std::string m_peer_certificate ;
 	std::string m_peer_certificate_chain ;
 	bool m_verified {false} ;
+	SessionCache<mbedtls_ssl_session> * m_session_cache {nullptr} ;
+	std::string m_session_key ;
+	bool m_threaded {false} ;
+	bool m_established {false} ;
+	mutable std::vector<std::pair<int,std::string>> m_deferred_log ;
 } ;
 
 //| \class GSsl::MbedTls::DigesterImp
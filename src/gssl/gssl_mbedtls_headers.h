@@ -60,6 +60,8 @@
 #include <mbedtls/net_sockets.h>
 #endif
 #include <mbedtls/ctr_drbg.h>
+#include <mbedtls/ssl_cache.h>
+#include <mbedtls/ssl_ticket.h>
 #include <mbedtls/error.h>
 #include <mbedtls/version.h>
 #include <mbedtls/pem.h>
@@ -105,7 +105,7 @@ GSsl::Digester GSsl::Library::digester( const std::string & , const std::string
 
 // ==
 
-GSsl::Protocol::Protocol( const Profile & , const std::string & , const std::string & )
+GSsl::Protocol::Protocol( const Profile & , const std::string & , const std::string & , const std::string & )
 {
 }
 
@@ -137,6 +137,25 @@ GSsl::Protocol::Result GSsl::Protocol::write( const char * , std::size_t , ssize
 	return Result::error ;
 }
 
+bool GSsl::Protocol::kernelTls() const
+{
+	return false ;
+}
+
+GSsl::Protocol::Result GSsl::Protocol::sendfile( int , std::size_t , std::size_t , ssize_t & )
+{
+	return Result::error ;
+}
+
+bool GSsl::Protocol::threaded() const
+{
+	return false ;
+}
+
+void GSsl::Protocol::flushLog()
+{
+}
+
 std::string GSsl::Protocol::str( Protocol::Result )
 {
 	return {} ;
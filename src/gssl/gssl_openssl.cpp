@@ -39,6 +39,7 @@
 #include <utility>
 #include <algorithm>
 #include <memory>
+#include <cstring>
 
 GSsl::OpenSSL::LibraryImp::LibraryImp( G::StringArray & library_config , Library::LogFn log_fn , bool verbose ) :
 	m_log_fn(log_fn) ,
@@ -313,6 +314,7 @@ GSsl::OpenSSL::ProfileImp::ProfileImp( const LibraryImp & library_imp , bool is_
 			G_WARNING( "GSsl::OpenSSL::ProfileImp::ctor: tls-config: tls " << (is_server_profile?"server":"client")
 				<< " profile configuration ignored: [" << G::Str::join(",",profile_config_list) << "]" ) ;
 	}
+	m_threaded = extra_config.threads() ;
 
 	if( m_ssl_ctx == nullptr )
 	{
@@ -380,6 +382,129 @@ GSsl::OpenSSL::ProfileImp::ProfileImp( const LibraryImp & library_imp , bool is_
 	{
 		static std::string x = "GSsl.OpenSSL." + G::Path(G::Process::exe()).basename() ;
 		SSL_CTX_set_session_id_context( m_ssl_ctx.get() , reinterpret_cast<const unsigned char *>(x.data()) , static_cast<unsigned>(x.size()) ) ;
+		applySessions( extra_config ) ;
+	}
+	else
+	{
+		applyClientSessions( extra_config ) ;
+	}
+}
+
+void GSsl::OpenSSL::ProfileImp::applySessions( const Config & config )
+{
+	// optional server-side session cache -- the session timeout also
+	// limits the lifetime of session tickets
+	SSL_CTX_set_timeout( m_ssl_ctx.get() , static_cast<long>(config.sessionTimeout()) ) ;
+	if( config.sessionCache() )
+	{
+		SSL_CTX_set_session_cache_mode( m_ssl_ctx.get() , SSL_SESS_CACHE_SERVER ) ;
+		if( config.sessionCacheSize() )
+			SSL_CTX_sess_set_cache_size( m_ssl_ctx.get() , static_cast<long>(config.sessionCacheSize()) ) ;
+	}
+
+	// optional stateless session tickets using our own rotating keys
+	// rather than a fixed key for the lifetime of the process
+	if( config.tickets() )
+	{
+		m_ticket_keys = std::make_unique<TicketKeys>( config.sessionTimeout() ) ;
+		SSL_CTX_set_app_data( m_ssl_ctx.get() , this ) ;
+		SSL_CTX_clear_options( m_ssl_ctx.get() , SSL_OP_NO_TICKET ) ;
+		#if GCONFIG_HAVE_OPENSSL_TICKET_EVP
+			SSL_CTX_set_tlsext_ticket_key_evp_cb( m_ssl_ctx.get() , onTicketKey ) ;
+		#else
+			SSL_CTX_set_tlsext_ticket_key_cb( m_ssl_ctx.get() , onTicketKey ) ;
+		#endif
+	}
+}
+
+void GSsl::OpenSSL::ProfileImp::applyClientSessions( const Config & config )
+{
+	// optional client-side session cache keyed by peer -- the openssl
+	// internal cache is not used because it cannot be keyed by peer
+	if( config.sessionCache() )
+	{
+		std::size_t limit = config.sessionCacheSize() ? config.sessionCacheSize() : 100U ;
+		m_session_cache = std::make_unique<SessionCache<SSL_SESSION>>( limit , config.sessionTimeout() ) ;
+		SSL_CTX_set_app_data( m_ssl_ctx.get() , this ) ;
+		SSL_CTX_set_session_cache_mode( m_ssl_ctx.get() , SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE ) ;
+		SSL_CTX_sess_set_new_cb( m_ssl_ctx.get() , onNewSession ) ;
+	}
+}
+
+int GSsl::OpenSSL::ProfileImp::onNewSession( SSL * ssl , SSL_SESSION * session )
+{
+	// called at the end of a tls 1.2 handshake or when a tls 1.3 ticket arrives
+	try
+	{
+		auto * profile = static_cast<ProfileImp*>( SSL_CTX_get_app_data( SSL_get_SSL_CTX(ssl) ) ) ;
+		if( profile == nullptr )
+			return 0 ;
+		auto * protocol = static_cast<ProtocolImp*>( SSL_get_ex_data( ssl , profile->lib().index() ) ) ;
+		return protocol && protocol->saveSession( session ) ? 1 : 0 ; // 1 => we keep the reference
+	}
+	catch(...) // callback from c code
+	{
+		return 0 ;
+	}
+}
+
+GSsl::SessionCache<SSL_SESSION> * GSsl::OpenSSL::ProfileImp::sessionCache() const
+{
+	return m_session_cache.get() ;
+}
+
+#if GCONFIG_HAVE_OPENSSL_TICKET_EVP
+int GSsl::OpenSSL::ProfileImp::onTicketKey( SSL * ssl , unsigned char * key_name , unsigned char * iv ,
+	EVP_CIPHER_CTX * cipher_ctx , EVP_MAC_CTX * mac_ctx , int enc )
+#else
+int GSsl::OpenSSL::ProfileImp::onTicketKey( SSL * ssl , unsigned char * key_name , unsigned char * iv ,
+	EVP_CIPHER_CTX * cipher_ctx , HMAC_CTX * mac_ctx , int enc )
+#endif
+{
+	// see man SSL_CTX_set_tlsext_ticket_key_evp_cb(3)
+	try
+	{
+		auto * profile = static_cast<ProfileImp*>( SSL_CTX_get_app_data( SSL_get_SSL_CTX(ssl) ) ) ;
+		if( profile == nullptr || profile->m_ticket_keys == nullptr )
+			return -1 ;
+		TicketKeys & keys = *profile->m_ticket_keys ;
+
+		TicketKeys::Key key ;
+		bool is_current = true ;
+		if( enc == 1 )
+		{
+			key = keys.current() ;
+			std::memcpy( key_name , key.name.data() , key.name.size() ) ;
+			if( RAND_bytes( iv , EVP_CIPHER_iv_length(EVP_aes_256_cbc()) ) != 1 )
+				return -1 ;
+			if( EVP_EncryptInit_ex( cipher_ctx , EVP_aes_256_cbc() , nullptr , key.aes.data() , iv ) != 1 )
+				return -1 ;
+		}
+		else
+		{
+			if( !keys.find( key_name , key , is_current ) )
+				return 0 ; // unknown key, so full handshake
+			if( EVP_DecryptInit_ex( cipher_ctx , EVP_aes_256_cbc() , nullptr , key.aes.data() , iv ) != 1 )
+				return -1 ;
+		}
+
+		#if GCONFIG_HAVE_OPENSSL_TICKET_EVP
+			std::array<OSSL_PARAM,3U> params {{
+				OSSL_PARAM_construct_octet_string( OSSL_MAC_PARAM_KEY , key.hmac.data() , key.hmac.size() ) ,
+				OSSL_PARAM_construct_utf8_string( OSSL_MAC_PARAM_DIGEST , const_cast<char*>("sha256") , 0 ) ,
+				OSSL_PARAM_construct_end() }} ;
+			if( EVP_MAC_CTX_set_params( mac_ctx , params.data() ) != 1 )
+				return -1 ;
+		#else
+			if( HMAC_Init_ex( mac_ctx , key.hmac.data() , static_cast<int>(key.hmac.size()) , EVP_sha256() , nullptr ) != 1 )
+				return -1 ;
+		#endif
+
+		return is_current ? 1 : 2 ; // 2 => ticket from the previous key, so renew it
+	}
+	catch(...) // callback from c code
+	{
+		return -1 ;
 	}
 }
 
@@ -393,11 +518,11 @@ void GSsl::OpenSSL::ProfileImp::deleter( SSL_CTX * p )
 }
 
 std::unique_ptr<GSsl::ProtocolImpBase> GSsl::OpenSSL::ProfileImp::newProtocol( const std::string & peer_certificate_name ,
-	const std::string & peer_host_name ) const
+	const std::string & peer_host_name , const std::string & session_key ) const
 {
 	return std::make_unique<OpenSSL::ProtocolImp>( *this ,
 			peer_certificate_name.empty()?defaultPeerCertificateName():peer_certificate_name ,
-			peer_host_name.empty()?defaultPeerHostName():peer_host_name ) ; // up-cast
+			peer_host_name.empty()?defaultPeerHostName():peer_host_name , session_key ) ; // up-cast
 }
 
 SSL_CTX * GSsl::OpenSSL::ProfileImp::p() const
@@ -410,6 +535,11 @@ const GSsl::OpenSSL::LibraryImp & GSsl::OpenSSL::ProfileImp::lib() const
 	return m_library_imp ;
 }
 
+bool GSsl::OpenSSL::ProfileImp::threaded() const
+{
+	return m_threaded ;
+}
+
 const std::string & GSsl::OpenSSL::ProfileImp::defaultPeerCertificateName() const
 {
 	return m_default_peer_certificate_name ;
@@ -477,7 +607,7 @@ int GSsl::OpenSSL::ProfileImp::verifyPeerName( int ok , X509_STORE_CTX * ctx )
 				std::string subject = name(X509_get_subject_name(cert)) ;
 				G::StringArray subject_parts = G::Str::splitIntoTokens( subject , "/" ) ;
 				bool found = std::find( subject_parts.begin() , subject_parts.end() , "CN="+required_peer_certificate_name ) != subject_parts.end() ;
-				library.log()( 2 , std::string("certificate-subject=[")
+				protocol->log( 2 , std::string("certificate-subject=[")
 					.append(subject)
 					.append("] required-peer-name=[")
 					.append(required_peer_certificate_name)
@@ -508,11 +638,14 @@ std::string GSsl::OpenSSL::ProfileImp::name( X509_NAME * x509_name )
 // ==
 
 GSsl::OpenSSL::ProtocolImp::ProtocolImp( const ProfileImp & profile , const std::string & required_peer_certificate_name ,
-	const std::string & target_peer_host_name ) :
+	const std::string & target_peer_host_name , const std::string & session_key ) :
 		m_ssl(nullptr,std::function<void(SSL*)>(deleter)) ,
 		m_log_fn(profile.lib().log()) ,
 		m_verbose(profile.lib().verbose()) ,
-		m_required_peer_certificate_name(required_peer_certificate_name)
+		m_required_peer_certificate_name(required_peer_certificate_name) ,
+		m_session_cache(session_key.empty()?nullptr:profile.sessionCache()) ,
+		m_session_key(session_key) ,
+		m_threaded(profile.threaded())
 {
 	m_ssl.reset( SSL_new(profile.p()) ) ;
 	if( m_ssl == nullptr )
@@ -524,6 +657,22 @@ GSsl::OpenSSL::ProtocolImp::ProtocolImp( const ProfileImp & profile , const std:
 
 	// store a pointer from SSL to ProtocolImp
 	SSL_set_ex_data( m_ssl.get() , profile.lib().index() , this ) ;
+
+	// offer to resume a session from an earlier connection to the same peer
+	if( m_session_cache )
+	{
+		std::shared_ptr<SSL_SESSION> session = m_session_cache->find( m_session_key ) ;
+		if( session && SSL_set_session( m_ssl.get() , session.get() ) != 1 )
+			m_session_cache->remove( m_session_key ) ;
+	}
+}
+
+bool GSsl::OpenSSL::ProtocolImp::saveSession( SSL_SESSION * session )
+{
+	if( m_session_cache == nullptr )
+		return false ;
+	m_session_cache->store( m_session_key , std::shared_ptr<SSL_SESSION>(session,SSL_SESSION_free) ) ;
+	return true ;
 }
 
 GSsl::OpenSSL::ProtocolImp::~ProtocolImp()
@@ -591,7 +740,10 @@ GSsl::Protocol::Result GSsl::OpenSSL::ProtocolImp::connect()
 	}
 	else
 	{
-		return convert(error("SSL_connect",rc)) ;
+		Result result = convert( error("SSL_connect",rc) ) ;
+		if( result == Protocol::Result::error && m_session_cache )
+			m_session_cache->remove( m_session_key ) ; // in case the saved session is to blame
+		return result ;
 	}
 }
 
@@ -612,6 +764,7 @@ GSsl::Protocol::Result GSsl::OpenSSL::ProtocolImp::accept()
 
 void GSsl::OpenSSL::ProtocolImp::saveResult()
 {
+	m_established = true ;
 	m_peer_certificate = Certificate(SSL_get_peer_certificate(m_ssl.get()),true).str() ;
 	m_peer_certificate_chain = CertificateChain(SSL_get_peer_cert_chain(m_ssl.get())).str() ;
 	m_verified = !m_peer_certificate.empty() && SSL_get_verify_result(m_ssl.get()) == X509_V_OK ;
@@ -640,7 +793,10 @@ GSsl::Protocol::Result GSsl::OpenSSL::ProtocolImp::read( char * buffer , std::si
 	}
 	else
 	{
-		return convert(error("SSL_read",rc)) ;
+		int e = error( "SSL_read" , rc ) ;
+		if( e == SSL_ERROR_ZERO_RETURN )
+			SSL_shutdown( m_ssl.get() ) ; // best-effort close-notify reply, keeps the session resumable
+		return convert( e ) ;
 	}
 }
 
@@ -661,6 +817,37 @@ GSsl::Protocol::Result GSsl::OpenSSL::ProtocolImp::write( const char * buffer ,
 	}
 }
 
+bool GSsl::OpenSSL::ProtocolImp::kernelTls() const
+{
+	#if GCONFIG_HAVE_OPENSSL_KTLS
+		// true only if the kernel accepted the keys after the handshake
+		return BIO_get_ktls_send( SSL_get_wbio(m_ssl.get()) ) != 0 ;
+	#else
+		return false ;
+	#endif
+}
+
+GSsl::Protocol::Result GSsl::OpenSSL::ProtocolImp::sendfile( int fd , std::size_t offset , std::size_t size , ssize_t & size_out )
+{
+	size_out = 0 ;
+	#if GCONFIG_HAVE_OPENSSL_KTLS
+		clearErrors() ;
+		ossl_ssize_t rc = SSL_sendfile( m_ssl.get() , fd , static_cast<off_t>(offset) , size , 0 ) ;
+		if( rc >= 0 )
+		{
+			size_out = static_cast<ssize_t>(rc) ;
+			return Protocol::Result::ok ;
+		}
+		else
+		{
+			return convert(error("SSL_sendfile",static_cast<int>(rc))) ;
+		}
+	#else
+		G_ASSERT( false ) ;
+		return Protocol::Result::error ;
+	#endif
+}
+
 std::string GSsl::OpenSSL::ProtocolImp::peerCertificate() const
 {
 	return m_peer_certificate ;
@@ -713,7 +900,7 @@ void GSsl::OpenSSL::ProtocolImp::logErrors( const std::string & op , int rc , in
 		{
 			std::ostringstream ss ;
 			ss << op << ": rc=" << rc << ": error " << e << " => " << strerr ;
-			(*m_log_fn)( 1 , ss.str() ) ; // 1 => verbose-debug
+			log( 1 , ss.str() ) ; // 1 => verbose-debug
 		}
 
 		for( int i = 2 ; i < 10000 ; i++ )
@@ -721,11 +908,37 @@ void GSsl::OpenSSL::ProtocolImp::logErrors( const std::string & op , int rc , in
 			unsigned long ee = ERR_get_error() ;
 			if( ee == 0 ) break ;
 			Error eee( op , ee ) ;
-			(*m_log_fn)( 3 , std::string() + eee.what() ) ; // 3 => errors-and-warnings
+			log( 3 , std::string() + eee.what() ) ; // 3 => errors-and-warnings
 		}
 	}
 }
 
+void GSsl::OpenSSL::ProtocolImp::log( int level , const std::string & line ) const
+{
+	// logging is not thread-safe so hold it back if the handshake
+	// might be running on a worker thread -- see flushLog()
+	if( m_threaded && !m_established )
+		m_deferred_log.emplace_back( level , line ) ;
+	else if( m_log_fn != nullptr )
+		(*m_log_fn)( level , line ) ;
+}
+
+bool GSsl::OpenSSL::ProtocolImp::threaded() const
+{
+	return m_threaded ;
+}
+
+void GSsl::OpenSSL::ProtocolImp::flushLog()
+{
+	std::vector<std::pair<int,std::string>> lines ;
+	lines.swap( m_deferred_log ) ;
+	for( const auto & line : lines )
+	{
+		if( m_log_fn != nullptr )
+			(*m_log_fn)( line.first , line.second ) ;
+	}
+}
+
 std::string GSsl::OpenSSL::ProtocolImp::requiredPeerCertificateName() const
 {
 	return m_required_peer_certificate_name ;
@@ -867,6 +1080,22 @@ GSsl::OpenSSL::Config::Config( G::StringArray & cfg ) :
 	#ifdef SSL_OP_CIPHER_SERVER_PREFERENCE
 		if( consume(cfg,"op_server_preference") ) m_options_set |= SSL_OP_CIPHER_SERVER_PREFERENCE ;
 	#endif
+
+	// kernel tls, with silent fallback if the kernel does not support it
+	#if GCONFIG_HAVE_OPENSSL_KTLS
+		if( consume(cfg,"ktls") ) m_options_set |= SSL_OP_ENABLE_KTLS ;
+	#endif
+
+	// session resumption
+	m_session_cache = consume( cfg , "sessioncache" ) ;
+	if( consume( cfg , "sessioncache" , m_session_cache_size ) )
+		m_session_cache = m_session_cache_size != 0U ;
+	if( consume( cfg , "sessiontimeout" , m_session_timeout ) && m_session_timeout == 0U )
+		m_session_timeout = 300U ;
+	m_tickets = consume( cfg , "tickets" ) ;
+
+	// handshakes on worker threads
+	m_threads = consume( cfg , "threads" ) ;
 }
 
 bool GSsl::OpenSSL::Config::consume( G::StringArray & list , std::string_view item )
@@ -874,6 +1103,11 @@ bool GSsl::OpenSSL::Config::consume( G::StringArray & list , std::string_view it
 	return LibraryImp::consume( list , item ) ;
 }
 
+bool GSsl::OpenSSL::Config::consume( G::StringArray & list , std::string_view key , unsigned int & value )
+{
+	return LibraryImp::consume( list , key , value ) ;
+}
+
 GSsl::OpenSSL::Config::Fn GSsl::OpenSSL::Config::fn( bool server )
 {
 	return server ? m_server_fn : m_client_fn ;
@@ -903,3 +1137,73 @@ bool GSsl::OpenSSL::Config::noverify() const
 {
 	return m_noverify ;
 }
+
+bool GSsl::OpenSSL::Config::sessionCache() const
+{
+	return m_session_cache ;
+}
+
+unsigned int GSsl::OpenSSL::Config::sessionCacheSize() const
+{
+	return m_session_cache_size ;
+}
+
+unsigned int GSsl::OpenSSL::Config::sessionTimeout() const
+{
+	return m_session_timeout ;
+}
+
+bool GSsl::OpenSSL::Config::tickets() const
+{
+	return m_tickets ;
+}
+
+bool GSsl::OpenSSL::Config::threads() const
+{
+	return m_threads ;
+}
+
+// ==
+
+GSsl::OpenSSL::TicketKeys::TicketKeys( unsigned int lifetime ) :
+	m_lifetime(lifetime) ,
+	m_current(create())
+{
+}
+
+GSsl::OpenSSL::TicketKeys::Key GSsl::OpenSSL::TicketKeys::create()
+{
+	Key key ;
+	if( RAND_bytes( key.name.data() , static_cast<int>(key.name.size()) ) != 1 ||
+		RAND_bytes( key.aes.data() , static_cast<int>(key.aes.size()) ) != 1 ||
+		RAND_bytes( key.hmac.data() , static_cast<int>(key.hmac.size()) ) != 1 )
+			throw Error( "RAND_bytes" , ERR_get_error() ) ;
+	key.created = std::time( nullptr ) ;
+	return key ;
+}
+
+GSsl::OpenSSL::TicketKeys::Key GSsl::OpenSSL::TicketKeys::current()
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	std::time_t now = std::time( nullptr ) ;
+	if( now < m_current.created || (now-m_current.created) >= static_cast<std::time_t>(m_lifetime) )
+	{
+		m_previous = m_current ;
+		m_have_previous = true ;
+		m_current = create() ;
+	}
+	return m_current ;
+}
+
+bool GSsl::OpenSSL::TicketKeys::find( const unsigned char * name , Key & key_out , bool & is_current ) const
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	is_current = std::memcmp( name , m_current.name.data() , m_current.name.size() ) == 0 ;
+	if( is_current )
+		key_out = m_current ;
+	else if( m_have_previous && std::memcmp( name , m_previous.name.data() , m_previous.name.size() ) == 0 )
+		key_out = m_previous ;
+	else
+		return false ;
+	return true ;
+}
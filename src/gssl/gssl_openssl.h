@@ -33,6 +33,10 @@
 #include <openssl/md5.h>
 #include <openssl/sha.h>
 #include <openssl/hmac.h>
+#include <array>
+#include <vector>
+#include <utility>
+#include <ctime>
 #include <memory>
 #include <stdexcept>
 #include <functional>
@@ -48,6 +52,23 @@
 #define GCONFIG_HAVE_OPENSSL_HASH_FUNCTIONS 1
 #endif
 #endif
+#ifndef GCONFIG_HAVE_OPENSSL_TICKET_EVP
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
+#define GCONFIG_HAVE_OPENSSL_TICKET_EVP 1
+#else
+#define GCONFIG_HAVE_OPENSSL_TICKET_EVP 0
+#endif
+#endif
+#if GCONFIG_HAVE_OPENSSL_TICKET_EVP
+#include <openssl/core_names.h>
+#endif
+#ifndef GCONFIG_HAVE_OPENSSL_KTLS
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS) && !defined(LIBRESSL_VERSION_NUMBER)
+#define GCONFIG_HAVE_OPENSSL_KTLS 1
+#else
+#define GCONFIG_HAVE_OPENSSL_KTLS 0
+#endif
+#endif
 
 // debugging...
 //  * network logging
@@ -76,6 +97,7 @@ namespace GSsl
 		class ProtocolImp ;
 		class DigesterImp ;
 		class Config ;
+		class TicketKeys ;
 	}
 }
 
@@ -106,9 +128,15 @@ public:
 	int min_() const ;
 	int max_() const ;
 	bool noverify() const ;
+	bool sessionCache() const ;
+	unsigned int sessionCacheSize() const ; // zero for the library default
+	unsigned int sessionTimeout() const ;
+	bool tickets() const ;
+	bool threads() const ;
 
 private:
 	static bool consume( G::StringArray & , std::string_view ) ;
+	static bool consume( G::StringArray & , std::string_view , unsigned int & ) ;
 	static int map( int , int ) ;
 
 private:
@@ -119,6 +147,43 @@ private:
 	long m_options_set {0L} ;
 	long m_options_reset {0L} ;
 	bool m_noverify ;
+	bool m_session_cache {false} ;
+	unsigned int m_session_cache_size {0U} ;
+	unsigned int m_session_timeout {300U} ;
+	bool m_tickets {false} ;
+	bool m_threads {false} ;
+} ;
+
+//| \class GSsl::OpenSSL::TicketKeys
+/// Holds the current and previous keys used to encrypt and
+/// authenticate stateless session tickets on the server side,
+/// rotating them once the current key reaches the given age.
+/// Tickets encrypted with the previous key are still accepted
+/// but are renewed. Access is serialised with a mutex.
+///
+class GSsl::OpenSSL::TicketKeys
+{
+public:
+	struct Key /// A session ticket key.
+	{
+		std::array<unsigned char,16U> name {} ;
+		std::array<unsigned char,32U> aes {} ;
+		std::array<unsigned char,32U> hmac {} ;
+		std::time_t created {0} ;
+	} ;
+	explicit TicketKeys( unsigned int lifetime ) ;
+	Key current() ;
+	bool find( const unsigned char * name , Key & , bool & is_current ) const ;
+
+private:
+	static Key create() ;
+
+private:
+	unsigned int m_lifetime ;
+	Key m_current ;
+	Key m_previous ;
+	bool m_have_previous {false} ;
+	mutable G::threading::mutex_type m_mutex ;
 } ;
 
 //| \class GSsl::OpenSSL::CertificateChain
@@ -164,12 +229,15 @@ public:
 	~ProfileImp() override ;
 	SSL_CTX * p() const ;
 	const LibraryImp & lib() const ;
+	bool threaded() const ;
 	const std::string & defaultPeerCertificateName() const ;
 	const std::string & defaultPeerHostName() const ;
 	void apply( const Config & ) ;
+	SessionCache<SSL_SESSION> * sessionCache() const ;
 
 private: // overrides
-	std::unique_ptr<ProtocolImpBase> newProtocol( const std::string & , const std::string & ) const override ;
+	std::unique_ptr<ProtocolImpBase> newProtocol( const std::string & , const std::string & ,
+		const std::string & ) const override ;
 
 public:
 	ProfileImp( const ProfileImp & ) = delete ;
@@ -183,12 +251,23 @@ private:
 	static int verifyPeerName( int , X509_STORE_CTX * ) ;
 	static std::string name( X509_NAME * ) ;
 	static void deleter( SSL_CTX * ) ;
+	void applySessions( const Config & ) ;
+	void applyClientSessions( const Config & ) ;
+	static int onNewSession( SSL * , SSL_SESSION * ) ;
+	#if GCONFIG_HAVE_OPENSSL_TICKET_EVP
+	static int onTicketKey( SSL * , unsigned char * , unsigned char * , EVP_CIPHER_CTX * , EVP_MAC_CTX * , int ) ;
+	#else
+	static int onTicketKey( SSL * , unsigned char * , unsigned char * , EVP_CIPHER_CTX * , HMAC_CTX * , int ) ;
+	#endif
 
 private:
 	const LibraryImp & m_library_imp ;
 	const std::string m_default_peer_certificate_name ;
 	const std::string m_default_peer_host_name ;
 	std::unique_ptr<SSL_CTX,std::function<void(SSL_CTX*)>> m_ssl_ctx ;
+	std::unique_ptr<TicketKeys> m_ticket_keys ;
+	std::unique_ptr<SessionCache<SSL_SESSION>> m_session_cache ;
+	bool m_threaded {false} ;
 } ;
 
 //| \class GSsl::OpenSSL::LibraryImp
@@ -251,9 +330,11 @@ public:
 	using Certificate = OpenSSL::Certificate ;
 	using CertificateChain = OpenSSL::CertificateChain ;
 
-	ProtocolImp( const ProfileImp & , const std::string & , const std::string & ) ;
+	ProtocolImp( const ProfileImp & , const std::string & , const std::string & , const std::string & ) ;
 	~ProtocolImp() override ;
 	std::string requiredPeerCertificateName() const ;
+	bool saveSession( SSL_SESSION * ) ;
+	void log( int level , const std::string & line ) const ;
 
 private: // overrides
 	Result connect( G::ReadWrite & ) override ;
@@ -261,6 +342,10 @@ private: // overrides
 	Result shutdown() override ;
 	Result read( char * buffer , std::size_t buffer_size , ssize_t & read_size ) override ;
 	Result write( const char * buffer , std::size_t size_in , ssize_t & size_out ) override ;
+	bool kernelTls() const override ;
+	Result sendfile( int fd , std::size_t offset , std::size_t size , ssize_t & size_out ) override ;
+	bool threaded() const override ;
+	void flushLog() override ;
 	std::string peerCertificate() const override ;
 	std::string peerCertificateChain() const override ;
 	std::string protocol() const override ;
@@ -293,6 +378,11 @@ private:
 	std::string m_peer_certificate ;
 	std::string m_peer_certificate_chain ;
 	bool m_verified {false} ;
+	SessionCache<SSL_SESSION> * m_session_cache {nullptr} ;
+	std::string m_session_key ;
+	bool m_threaded ;
+	bool m_established {false} ;
+	mutable std::vector<std::pair<int,std::string>> m_deferred_log ;
 } ;
 
 //| \class GSsl::OpenSSL::DigesterImp
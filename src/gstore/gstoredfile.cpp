@@ -305,6 +305,11 @@ std::istream & GStore::StoredFile::contentStream()
 	return *m_content ;
 }
 
+int GStore::StoredFile::contentFd() const
+{
+	return m_content ? m_content->fd() : -1 ;
+}
+
 std::string GStore::StoredFile::authentication() const
 {
 	return m_env.authentication ;
@@ -362,6 +367,7 @@ void GStore::StoredFile::Stream::open( const G::Path & path )
 	if( fd >= 0 )
 	{
 		StreamBuf::open( fd ) ;
+		m_open = true ;
 		clear() ;
 	}
 	else
@@ -370,6 +376,11 @@ void GStore::StoredFile::Stream::open( const G::Path & path )
 	}
 }
 
+int GStore::StoredFile::Stream::fd() const noexcept
+{
+	return m_open ? file() : -1 ;
+}
+
 std::streamoff GStore::StoredFile::Stream::size() const
 {
 	// (G::fbuf is not seekable)
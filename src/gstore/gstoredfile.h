@@ -103,6 +103,7 @@ private: // overrides
 	void destroy() override ; // GStore::StoredMessage
 	std::size_t contentSize() const override ; // GStore::StoredMessage
 	std::istream & contentStream() override ; // GStore::StoredMessage
+	int contentFd() const override ; // GStore::StoredMessage
 	void editRecipients( const G::StringArray & ) override ; // GStore::StoredMessage
 
 public:
@@ -120,6 +121,8 @@ private:
 		explicit Stream( const G::Path & ) ;
 		void open( const G::Path & ) ;
 		std::streamoff size() const ;
+		int fd() const noexcept ;
+		bool m_open {false} ;
 	} ;
 
 private:
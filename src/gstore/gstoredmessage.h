@@ -64,6 +64,12 @@ public:
 	virtual std::istream & contentStream() = 0 ;
 		///< Returns a reference to the content stream.
 
+	virtual int contentFd() const = 0 ;
+		///< Returns the file descriptor of the open content file,
+		///< or -1. This can be used to send the content without
+		///< using contentStream(), in which case the content
+		///< stream should not be used.
+
 	virtual void close() = 0 ;
 		///< Releases the message to allow external editing.
 
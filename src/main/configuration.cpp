@@ -268,6 +268,16 @@ const char * Main::Configuration::semanticError1() const
 		return tx("the --admin-terminate option requires --admin") ;
 	}
 
+	if( contains("admin-stats") && !contains_admin )
+	{
+		return tx("the --admin-stats option requires --admin") ;
+	}
+
+	if( contains("metrics-port") && _metricsPort() == 0U )
+	{
+		return tx("invalid --metrics-port port number") ;
+	}
+
 	const bool contains_as_proxy = contains( "as-proxy" ) ;
 	const bool contains_as_client = contains( "as-client" ) ;
 	if( contains("forward-to") && ( contains_as_proxy || contains_as_client ) )
@@ -287,6 +297,12 @@ const char * Main::Configuration::semanticError1() const
 		if( contains("client-filter") ) return tx("--client-filter requires --forward-to") ;
 	}
 
+	if( contains("forward-concurrency") && forwardConcurrency() == 0U )
+		return tx("invalid --forward-concurrency count") ;
+
+	if( contains("forward-destination-concurrency") && forwardDestinationConcurrency() == 0U )
+		return tx("invalid --forward-destination-concurrency count") ;
+
 	//forwarding := "admin" "forward" "forward-on-disconnect" "immediate" "poll"
 	//if( !forwarding && contains("forward-to") )
 	//{
@@ -331,6 +347,19 @@ const char * Main::Configuration::semanticError1() const
 			return tx("the --server-auth option cannot be used with --no-smtp") ;
 	}
 
+	if( contains("server-processes") )
+	{
+		if( serverProcesses() == 0U )
+			return tx("invalid --server-processes count") ;
+
+		if( not_serving || contains("no-smtp") )
+			return tx("the --server-processes option requires an smtp server") ;
+
+		const std::string interfaces = stringValue( "interface" ) ;
+		if( interfaces.find("fd#") != std::string::npos || interfaces.find('/') != std::string::npos )
+			return tx("the --server-processes option cannot be used with inherited or unix-domain listening sockets") ;
+	}
+
 	if( contains("server-auth-config") && !contains("server-auth") )
 	{
 		return tx("the --server-auth-config option requires --server-auth") ;
@@ -422,6 +451,11 @@ const char * Main::Configuration::semanticError1() const
 		return tx("--dnsbl requires --remote-clients or -r") ;
 	}
 
+	if( contains("connection-rate-limit") && !_connectionRateLimitValid() )
+	{
+		return tx("invalid --connection-rate-limit value: use <count>[/<seconds>][,<ipv4-bits>[,<ipv6-bits>]]") ;
+	}
+
 	if( contains("client-interface") && GNet::Address::isFamilyLocal(serverAddress()) )
 	{
 		return tx("the --client-interface option cannot be used with a unix-domain forwarding address") ;
@@ -504,6 +538,18 @@ G::StringArray Main::Configuration::semanticWarnings() const
 			txt("pam authentication should be enabled with pam: rather than /pam") ) ;
 	}
 
+	if( contains("metrics-port") && serverProcesses() > 1U )
+	{
+		warnings.emplace_back(
+			txt("the --metrics-port metrics do not include the --server-processes worker processes") ) ;
+	}
+
+	if( contains("connection-rate-limit") && serverProcesses() > 1U )
+	{
+		warnings.emplace_back(
+			txt("the --connection-rate-limit is applied separately by each of the --server-processes") ) ;
+	}
+
 	std::string domain = stringValue( "domain" ) ;
 	if( !domain.empty() && !G::Str::isPrintableAscii(domain) )
 	{
@@ -719,16 +765,50 @@ GSmtp::ServerProtocol::Config Main::Configuration::_smtpServerProtocolConfig( bo
 					.set_alabels( switches("alabels",true) ) ) ;
 }
 
-GNet::Server::Config Main::Configuration::_netServerConfig( std::pair<int,int> linger ) const
+GNet::Server::Config Main::Configuration::_netServerConfig( std::pair<int,int> linger , bool reuseport ) const
 {
 	bool open_permissions = user().empty() || user() == "root" ;
 	return
 		GNet::Server::Config()
-			.set_stream_socket_config( _netSocketConfig(linger) )
+			.set_stream_socket_config( _netSocketConfig(linger,reuseport) )
 			.set_uds_open_permissions( open_permissions ) ;
 }
 
-GNet::StreamSocket::Config Main::Configuration::_netSocketConfig( std::pair<int,int> linger ) const
+GNet::ConnectionLimiter::Config Main::Configuration::_connectionLimiterConfig( const std::string & response ) const
+{
+	// eg. "20/60,24,64"
+	GNet::ConnectionLimiter::Config config ;
+	if( contains("connection-rate-limit") && _connectionRateLimitValid() )
+	{
+		G::StringArray parts = G::Str::splitIntoFields( stringValue("connection-rate-limit") , ',' ) ;
+		G::StringArray rate = G::Str::splitIntoFields( parts[0] , '/' ) ;
+		config.set_count( G::Str::toUInt(rate[0]) ) ;
+		if( rate.size() > 1U ) config.set_interval( G::Str::toUInt(rate[1]) ) ;
+		if( parts.size() > 1U ) config.set_ipv4_bits( G::Str::toUInt(parts[1]) ) ;
+		if( parts.size() > 2U ) config.set_ipv6_bits( G::Str::toUInt(parts[2]) ) ;
+		config.set_response( response ) ;
+	}
+	return config ;
+}
+
+bool Main::Configuration::_connectionRateLimitValid() const
+{
+	G::StringArray parts = G::Str::splitIntoFields( stringValue("connection-rate-limit") , ',' ) ;
+	if( parts.empty() || parts.size() > 3U )
+		return false ;
+	G::StringArray rate = G::Str::splitIntoFields( parts[0] , '/' ) ;
+	if( rate.empty() || rate.size() > 2U || !G::Str::isUInt(rate[0]) || G::Str::toUInt(rate[0]) == 0U )
+		return false ;
+	if( rate.size() == 2U && ( !G::Str::isUInt(rate[1]) || G::Str::toUInt(rate[1]) == 0U ) )
+		return false ;
+	if( parts.size() > 1U && ( !G::Str::isUInt(parts[1]) || G::Str::toUInt(parts[1]) > 32U ) )
+		return false ;
+	if( parts.size() > 2U && ( !G::Str::isUInt(parts[2]) || G::Str::toUInt(parts[2]) > 128U ) )
+		return false ;
+	return true ;
+}
+
+GNet::StreamSocket::Config Main::Configuration::_netSocketConfig( std::pair<int,int> linger , bool reuseport ) const
 {
 	return
 		GNet::StreamSocket::Config()
@@ -736,6 +816,7 @@ GNet::StreamSocket::Config Main::Configuration::_netSocketConfig( std::pair<int,
 			.set_accept_linger( linger )
 			.set_bind_reuse( !G::is_windows() )
 			.set_bind_exclusive( G::is_windows() )
+			.set_bind_reuseport( reuseport )
 			.set_last<GNet::StreamSocket::Config>() ;
 }
 
@@ -767,7 +848,8 @@ GSmtp::Server::Config Main::Configuration::smtpServerConfig( const std::string &
 					.set_idle_timeout( _idleTimeout() )
 					.set_log_address( contains("log-address") || logFormatContains("address") )
 					.set_log_port( logFormatContains("port") ) )
-			.set_net_server_config( _netServerConfig(_smtpServerSocketLinger()) )
+			.set_net_server_config( _netServerConfig(_smtpServerSocketLinger(),serverProcesses()>1U)
+				.set_connection_limiter_config( _connectionLimiterConfig("421 "+domain+" too many connections\r\n") ) )
 			.set_protocol_config( _smtpServerProtocolConfig(server_secrets_valid,domain) )
 			.set_dnsbl_config( dnsbl() )
 			.set_buffer_config( GSmtp::ServerBufferIn::Config() )
@@ -795,7 +877,8 @@ GPop::Server::Config Main::Configuration::popServerConfig( const std::string & s
 				GNet::ServerPeer::Config()
 					.set_socket_protocol_config( _socketProtocolConfig(server_tls_profile) )
 					.set_idle_timeout( _idleTimeout() ) )
-			.set_net_server_config( _netServerConfig(_popServerSocketLinger()) )
+			.set_net_server_config( _netServerConfig(_popServerSocketLinger())
+				.set_connection_limiter_config( _connectionLimiterConfig("-ERR too many connections\r\n") ) )
 			.set_protocol_config(
 				GPop::ServerProtocol::Config()
 					.set_sasl_server_challenge_domain( domain ) )
@@ -846,6 +929,7 @@ GSmtp::Client::Config Main::Configuration::smtpClientConfig( const std::string &
 					.set_bind_local_address( !local_address_str.empty() )
 					.set_local_address( local_address )
 					.set_connection_timeout( _connectionTimeout() )
+					.set_native_dns( _nativeDns() )
 					.set_socket_protocol_config(
 						GNet::SocketProtocol::Config()
 							.set_client_tls_profile( client_tls_profile )
@@ -858,6 +942,8 @@ GSmtp::Client::Config Main::Configuration::smtpClientConfig( const std::string &
 			.set_secure_tunnel( clientOverTls() )
 			.set_sasl_client_config( _smtpSaslClientConfig() )
 			.set_fail_if_no_remote_recipients()
+			.set_forward_concurrency( forwardConcurrency() )
+			.set_forward_destination_concurrency( forwardDestinationConcurrency() )
 			.set_log_msgid( logFormatContains("msgid") ) ;
 }
 
@@ -882,6 +968,18 @@ GSmtp::AdminServer::Config Main::Configuration::adminServerConfig( const G::Stri
 					.set_idle_timeout( 0 ) ) ; // not idleTimeout()
 }
 
+GSmtp::MetricsServer::Config Main::Configuration::metricsServerConfig() const
+{
+	return
+		GSmtp::MetricsServer::Config()
+			.set_port( _metricsPort() )
+			.set_allow_remote( _allowRemoteClients() )
+			.set_net_server_config( _netServerConfig(_adminServerSocketLinger()) )
+			.set_net_server_peer_config(
+				GNet::ServerPeer::Config()
+					.set_idle_timeout( _connectionTimeout() ) ) ;
+}
+
 GNet::SocketProtocol::Config Main::Configuration::_socketProtocolConfig( const std::string & server_tls_profile ) const
 {
 	return
@@ -959,6 +1057,8 @@ GSmtp::FilterFactoryBase::Spec Main::Configuration::_filter() const { return fil
 unsigned int Main::Configuration::_filterTimeout() const noexcept { return numberValue( "filter-timeout" , 60U ) ; }
 unsigned int Main::Configuration::_idleTimeout() const noexcept { return numberValue( "idle-timeout" , 1800U ) ; }
 unsigned int Main::Configuration::_maxSize() const noexcept { return numberValue( "size" , 0U ) ; }
+unsigned int Main::Configuration::_metricsPort() const noexcept { return numberValue( "metrics-port" , 0U ) ; }
+bool Main::Configuration::_nativeDns() const noexcept { return contains( "native-dns" ) ; }
 unsigned int Main::Configuration::_popPort() const noexcept { return numberValue( "pop-port" , 110U ) ; }
 std::string Main::Configuration::_popSaslServerConfig() const { return stringValue( "server-auth-config" ) ; }
 std::pair<int,int> Main::Configuration::_popServerSocketLinger() const noexcept { return std::make_pair( -1 , -1 ) ; }
@@ -989,10 +1089,15 @@ bool Main::Configuration::debug() const noexcept { return contains( "debug" ) ;
 std::string Main::Configuration::dnsbl() const { return stringValue( "dnsbl" ) ; }
 std::string Main::Configuration::domain( std::function<std::string()> default_domain_fn ) const { return stringValue( "domain" , default_domain_fn ) ; }
 bool Main::Configuration::doAdmin() const noexcept { return contains( "admin" ) ; }
+bool Main::Configuration::doMetrics() const noexcept { return contains( "metrics-port" ) ; }
+bool Main::Configuration::adminStats() const noexcept { return contains( "admin-stats" ) ; }
 bool Main::Configuration::doPolling() const noexcept { return contains( "poll" ) && pollingTimeout() > 0U ; }
 bool Main::Configuration::doPop() const noexcept { return contains( "pop" ) ; }
 bool Main::Configuration::doServing() const noexcept { return !contains( "dont-serve" ) && !contains( "as-client" ) ; }
 bool Main::Configuration::doSmtp() const noexcept { return !contains( "no-smtp" ) ; }
+unsigned int Main::Configuration::forwardConcurrency() const noexcept { return numberValue( "forward-concurrency" , 1U ) ; }
+unsigned int Main::Configuration::forwardDestinationConcurrency() const noexcept { return numberValue( "forward-destination-concurrency" , 0U ) ; }
+unsigned int Main::Configuration::forwardIdleTimeout() const noexcept { return numberValue( "forward-idle-timeout" , 0U ) ; }
 bool Main::Configuration::forwardOnDisconnect() const noexcept { return contains( "forward-on-disconnect" ) || contains( "as-proxy" ) ; }
 bool Main::Configuration::forwardOnStartup() const noexcept { return contains( "forward" ) || contains( "as-client" ) ; }
 bool Main::Configuration::hidden() const noexcept { return contains( "hidden" ) ; }
@@ -1008,6 +1113,7 @@ G::Path Main::Configuration::serverSecretsFile() const { return contains( "serve
 G::Path Main::Configuration::serverTlsCaList() const { return contains( "server-tls-verify" ) ? pathValue( "server-tls-verify" ) : G::Path() ; }
 G::Path Main::Configuration::serverTlsCertificate() const { return certificateFile( "server-tls-certificate" ) ; }
 bool Main::Configuration::serverTlsConnection() const noexcept { return contains( "server-tls-connection" ) ; }
+unsigned int Main::Configuration::serverProcesses() const noexcept { return numberValue( "server-processes" , 1U ) ; }
 bool Main::Configuration::serverTls() const noexcept { return contains( "server-tls" ) ; }
 G::Path Main::Configuration::serverTlsPrivateKey() const { return keyFile( "server-tls-certificate" ) ; }
 std::string Main::Configuration::tlsConfig() const { return stringValue( "tls-config" ) ; }
@@ -31,6 +31,7 @@
 #include "gserverpeer.h"
 #include "gsmtpserver.h"
 #include "gadminserver.h"
+#include "gmetricsserver.h"
 #include "gsmtpclient.h"
 #include "gfilestore.h"
 #include "gfilterfactory.h"
@@ -110,6 +111,10 @@ public:
 	bool daemon() const noexcept ;
 		///< Returns true if running in the background.
 
+	unsigned int serverProcesses() const noexcept ;
+		///< Returns the number of processes that do smtp serving,
+		///< including the main process.
+
 	bool forwardOnStartup() const noexcept ;
 		///< Returns true if running as a client.
 
@@ -125,6 +130,13 @@ public:
 	bool doAdmin() const noexcept ;
 		///< Returns true if listening for admin connections.
 
+	bool doMetrics() const noexcept ;
+		///< Returns true if listening for metrics connections.
+
+	bool adminStats() const noexcept ;
+		///< Returns true if event loop statistics should be
+		///< collected for the admin interface.
+
 	G::Path spoolDir() const ;
 		///< Returns the spool directory.
 
@@ -174,6 +186,18 @@ public:
 		///< Returns true if forwarding should occur when the
 		///< submitter's network connection disconnects.
 
+	unsigned int forwardConcurrency() const noexcept ;
+		///< Returns the number of parallel client connections
+		///< used when forwarding from the spool directory.
+
+	unsigned int forwardDestinationConcurrency() const noexcept ;
+		///< Returns the maximum number of parallel client connections
+		///< to any one destination, or zero for no limit.
+
+	unsigned int forwardIdleTimeout() const noexcept ;
+		///< Returns the number of seconds that idle forwarding
+		///< connections are kept for reuse, or zero.
+
 	bool clientTls() const noexcept ;
 		///< Returns true if the client protocol should take
 		///< account of the server's TLS capability.
@@ -254,6 +278,9 @@ public:
 		const std::string & filter_domain , const std::string & client_domain ) const ;
 			///< Returns the admin server configuration structure.
 
+	GSmtp::MetricsServer::Config metricsServerConfig() const ;
+		///< Returns the metrics server configuration structure.
+
 	G::StringArray listeningNames( std::string_view protocol = {} ) const ;
 		///< Returns the listening addresses, interfaces and file descriptors.
 
@@ -285,21 +312,25 @@ private:
 	static bool tlsVerifyType( std::string_view ) ;
 	static bool specialTlsVerifyString( std::string_view ) ;
 	//
-	GNet::Server::Config _netServerConfig( std::pair<int,int> linger ) const ;
-	GNet::StreamSocket::Config _netSocketConfig( std::pair<int,int> linger ) const ;
+	GNet::Server::Config _netServerConfig( std::pair<int,int> linger , bool reuseport = false ) const ;
+	GNet::StreamSocket::Config _netSocketConfig( std::pair<int,int> linger , bool reuseport = false ) const ;
 	GSmtp::ServerProtocol::Config _smtpServerProtocolConfig( bool server_secrets_valid , const std::string & domain ) const ;
 	GNet::SocketProtocol::Config _socketProtocolConfig( const std::string & server_tls_profile ) const ;
 	//
 	unsigned int _adminPort() const noexcept ;
 	std::pair<int,int> _adminServerSocketLinger() const noexcept ;
+	unsigned int _metricsPort() const noexcept ;
 	bool _allowRemoteClients() const noexcept ;
 	GSmtp::FilterFactoryBase::Spec _clientFilter() const ;
 	std::pair<int,int> _clientSocketLinger() const ;
+	GNet::ConnectionLimiter::Config _connectionLimiterConfig( const std::string & response ) const ;
+	bool _connectionRateLimitValid() const ;
 	unsigned int _connectionTimeout() const noexcept ;
 	GSmtp::FilterFactoryBase::Spec _filter() const ;
 	unsigned int _filterTimeout() const noexcept ;
 	unsigned int _idleTimeout() const noexcept ;
 	unsigned int _maxSize() const noexcept ;
+	bool _nativeDns() const noexcept ;
 	bool _nodaemon() const noexcept ;
 	unsigned int _popPort() const noexcept ;
 	std::string _popSaslServerConfig() const ;
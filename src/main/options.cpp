@@ -172,6 +172,25 @@ G::Options Main::Options::spec()
 			// for the built-in default.
 	#endif
 
+	#ifdef G_UNIX
+	G::Options::add( opt , '\0' , "server-processes" ,
+		tx("runs the SMTP server in the given number of processes (default is 1)") , "" ,
+		M::one , "count" , 31 ,
+		t_process , t_smtpserver ) ;
+			//default: 1
+			//example: 4
+			// Starts additional worker processes that accept and process
+			// incoming SMTP connections in parallel, with each process having
+			// its own event loop and its own listening sockets bound using
+			// SO_REUSEPORT so that the operating system can spread new
+			// connections across them. The main process continues to do
+			// everything else, including forwarding, polling, and the POP and
+			// admin servers, with the workers asking the main process to start
+			// forwarding when --forward-on-disconnect is used. Worker processes
+			// terminate when the main process terminates. The listening addresses must be IP addresses,
+			// not unix-domain sockets or inherited file descriptors.
+	#endif
+
 	G::Options::add( opt , 'q' , "as-client" ,
 		tx("runs as a client, forwarding all spooled mail to <host>!: "
 			"equivalent to \"--log --no-syslog --no-daemon --dont-serve --forward --forward-to\"") , "" ,
@@ -396,7 +415,16 @@ G::Options Main::Options::spec()
 			// list of keywords. If OpenSSL and mbedTLS are both built in then keywords
 			// of "openssl" and "mbedtls" will select one or the other. Keywords like
 			// "tlsv1.0" can be used to set a minimum TLS protocol version, or
-			// "-tlsv1.2" to set a maximum version.
+			// "-tlsv1.2" to set a maximum version. With OpenSSL 3 on Linux the
+			// "ktls" keyword enables kernel TLS, if the kernel supports it. For
+			// TLS session resumption the "sessioncache" keyword, or
+			// "sessioncache=<size>", enables a session cache, both on the server
+			// side and on the client side where sessions are saved for each
+			// forwarding server. The "tickets" keyword enables server-side
+			// stateless session tickets with regularly rotated keys. The session
+			// lifetime can be set with "sessiontimeout=<seconds>". The "threads"
+			// keyword moves the processing-intensive parts of the TLS handshake
+			// onto a small pool of worker threads.
 
 	G::Options::add( opt , 'g' , "debug" ,
 		tx("generates debug-level logging if built in") , "" ,
@@ -550,6 +578,21 @@ G::Options Main::Options::spec()
 			// interface can be used to trigger forwarding of spooled mail messages
 			// if the --forward-to option is used.
 
+	G::Options::add( opt , '\0' , "metrics-port" ,
+		tx("enables a prometheus metrics endpoint on the specified listening port number") , "" ,
+		M::one , "port" , 30 ,
+		t_admin ) ;
+			//example: 9187
+			// Enables an HTTP listening port that serves operational metrics
+			// in the Prometheus text format at "/metrics". The metrics include
+			// connection counts, message counts, network byte counts, filter
+			// durations and spool directory depth. Connections from non-local
+			// addresses are rejected unless --remote-clients is also used. Use
+			// a "metrics=" prefix with --interface to control which addresses
+			// the port is bound to. With --server-processes the metrics come
+			// from the main process only and do not include the SMTP sessions
+			// handled by the worker processes.
+
 	G::Options::add( opt , 'x' , "dont-serve" ,
 		tx("disables acting as a server on any port! "
 			"(part of --as-client and usually used with --forward)") , "" ,
@@ -663,6 +706,54 @@ G::Options Main::Options::spec()
 			// server before forwarding. This is currently the default behaviour
 			// so this option is for forwards compatibility only.
 
+	G::Options::add( opt , '\0' , "forward-concurrency" ,
+		tx("sets the number of parallel connections used when forwarding (default is 1)") , "" ,
+		M::one , "count" , 32 ,
+		t_smtpclient ) ;
+			//default: 1
+			//example: 4
+			// Sets the maximum number of client connections that are used in
+			// parallel when forwarding spooled mail messages. Each connection
+			// takes the next message from the spool directory as soon as it
+			// has finished with the previous one, so a deep queue can be
+			// cleared more quickly when the remote server is slow to respond.
+
+	G::Options::add( opt , '\0' , "forward-destination-concurrency" ,
+		tx("limits the number of parallel forwarding connections to any one destination") , "" ,
+		M::one , "count" , 32 ,
+		t_smtpclient ) ;
+			//example: 2
+			// Limits the number of parallel client connections to any one
+			// destination when forwarding with --forward-concurrency, where
+			// messages have different destinations as a result of routing
+			// or account selection. Messages for a destination that is at
+			// its limit are queued until a connection becomes free, so that
+			// other destinations are not held up, and messages are grouped
+			// by destination so that connections can be reused. By default
+			// there is no per-destination limit.
+
+	G::Options::add( opt , '\0' , "forward-idle-timeout" ,
+		tx("keeps idle forwarding connections open for reuse (in seconds)") , "" ,
+		M::one , "time" , 32 ,
+		t_smtpclient ) ;
+			//example: 300
+			// Keeps forwarding connections open after each forwarding run,
+			// for up to the given number of seconds, so that they can be
+			// reused by the next run without another connection, TLS
+			// handshake and authentication. Idle connections are kept
+			// alive with NOOP commands. This is most useful with --poll.
+
+	G::Options::add( opt , '\0' , "native-dns" ,
+		tx("uses built-in asynchronous DNS queries rather than getaddrinfo() for forwarding") , "" ,
+		M::zero , "" , 32 ,
+		t_smtpclient ) ;
+			// Resolves the addresses of remote SMTP servers by sending DNS
+			// queries directly to the system's nameservers from the main
+			// event loop, rather than calling getaddrinfo() on a worker
+			// thread. The hosts file is checked first. Results are cached
+			// for no longer than the DNS time-to-live. This can be useful
+			// on systems without multi-threading.
+
 	G::Options::add( opt , 'T' , "response-timeout" ,
 		tx("sets the response timeout (in seconds) when talking to a remote server (default is 60)") , "" ,
 		M::one , "time" , 31 ,
@@ -788,7 +879,18 @@ G::Options Main::Options::spec()
 		tx("enables the terminate command on the admin interface") , "" ,
 		M::zero , "" , 30 ,
 		t_admin , t_process ) ;
-			// Enables the "terminate" command in the administration interface.
+			// Enables the "terminate" and "upgrade" commands in the administration
+			// interface.
+
+	G::Options::add( opt , '\0' , "admin-stats" ,
+		tx("enables event loop statistics for the stats command on the admin interface") , "" ,
+		M::zero , "" , 30 ,
+		t_admin ) ;
+			// Enables collection of event loop statistics, as reported by the
+			// "stats" command in the administration interface. The statistics
+			// show the time spent waiting for network events compared to the
+			// time spent handling them, the number of events per wakeup, and
+			// the time taken by each type of event handler.
 
 	G::Options::add( opt , 'A' , "anonymous" ,
 		tx("disables the SMTP VRFY command and sends less verbose SMTP responses") , "" ,
@@ -871,6 +973,23 @@ G::Options Main::Options::spec()
 			// milliseconds, and optionally the transport address of the
 			// DNS server.
 
+	G::Options::add( opt , '\0' , "connection-rate-limit" ,
+		tx("limits the rate of incoming connections from each remote address") , "" ,
+		M::one , "count[/seconds][,v4-bits[,v6-bits]]" , 30 ,
+		t_smtpserver , t_pop ) ;
+			//example: 20/60,24,64
+			// Limits the rate at which remote clients can connect to the SMTP
+			// and POP servers. The count is the number of connections allowed
+			// from each remote address within the given number of seconds
+			// (default 60), with short bursts allowed up to that count.
+			// Addresses can be grouped by giving an IPv4 prefix length and an
+			// IPv6 prefix length, so "20/60,24,64" allows twenty connections
+			// a minute from each IPv4 /24 and each IPv6 /64 network. Excess
+			// connections are sent a "421" error response and closed without
+			// any further processing. The limit is applied separately by each
+			// process, so with --server-processes a remote address can make
+			// up to that many times more connections.
+
 	G::Options::add( opt , '\0' , "test" , "testing" , "" , M::one , "x" , 0 , 0 ) ;
 
 	return opt ;
@@ -24,6 +24,7 @@
 #include "gssl.h"
 #include "gpop.h"
 #include "geventloop.h"
+#include "geventloopstats.h"
 #include "garg.h"
 #include "gdaemon.h"
 #include "gpidfile.h"
@@ -62,6 +63,7 @@ std::string Main::Run::versionNumber()
 Main::Run::Run( Main::Output & output , const G::Arg & arg , bool has_gui ) :
 	m_output(output) ,
 	m_arg(arg) ,
+	m_upgrade_args(arg.array(1U)) ,
 	m_has_gui(has_gui)
 {
 	// initialise gettext() early, before G::GetOpt
@@ -80,6 +82,8 @@ Main::Run::~Run()
 {
 	if( m_monitor )
 		m_monitor->signal().disconnect() ;
+	if( m_workers )
+		m_workers->forwardingSignal().disconnect() ;
 	for( auto & unit_ptr : m_units )
 	{
 		G_ASSERT( unit_ptr.get() != nullptr ) ;
@@ -96,6 +100,7 @@ void Main::Run::configure( const G::Options & options_spec )
 
 	G::Path cwd = G::Process::cwd() ; // before G::Daemon::detach()
 	G_ASSERT( cwd.isAbsolute() ) ;
+	m_cwd = cwd ;
 
 	// the CommandLine normally parses out one set of options
 	// and we use it to create a single Configuration object --
@@ -189,11 +194,17 @@ void Main::Run::run()
 	//
 	G::Process::Umask::set( G::Process::Umask::Mode::Tightest ) ;
 
+	// receive any listening sockets handed over by an old process
+	// that is being upgraded -- the old process will have closed
+	// all other inherited file descriptors already
+	//
+	m_upgrade = std::make_unique<Upgrade>() ;
+
 	// close inherited file descriptors to avoid locking file systems
 	// when running as a daemon -- this has to be done early, before
 	// opening any sockets or message-store streams
 	//
-	if( configuration().closeFiles() )
+	if( configuration().closeFiles() && !m_upgrade->upgrading() )
 	{
 		closeFiles() ;
 	}
@@ -235,6 +246,19 @@ void Main::Run::run()
 		G::Root::init( configuration().user() ) ;
 	}
 
+	// fork any smtp server worker processes, each with their own event loop
+	//
+	{
+		unsigned int server_processes = 1U ;
+		for( std::size_t i = 0U ; i < configurations() ; i++ )
+			server_processes = std::max( server_processes , configuration(i).serverProcesses() ) ;
+		m_workers = std::make_unique<Workers>( server_processes ) ;
+		if( worker() )
+			m_upgrade->drop() ; // workers bind their own sockets
+		else
+			m_workers->forwardingSignal().connect( G::Slot::slot(*this,&Run::onWorkerForwarding) ) ;
+	}
+
 	// create event loop singletons
 	//
 	m_event_loop = GNet::EventLoop::create() ;
@@ -275,6 +299,14 @@ void Main::Run::run()
 	m_monitor = std::make_unique<GNet::Monitor>() ;
 	m_monitor->signal().connect( G::Slot::slot(*this,&Run::onNetworkEvent) ) ;
 
+	// optional event loop instrumentation
+	//
+	for( std::size_t i = 0U ; i < configurations() ; i++ )
+	{
+		if( configuration(i).adminStats() )
+			GNet::EventLoopStats::enable() ;
+	}
+
 	// create the active units
 	//
 	for( std::size_t i = 0U ; i < configurations() ; i++ )
@@ -286,7 +318,12 @@ void Main::Run::run()
 
 	// do serving and/or forwarding
 	//
-	if( m_units.at(0U)->nothingToDo() )
+	if( worker() && std::all_of( m_units.begin() , m_units.end() ,
+		[](const std::unique_ptr<Unit> & unit_ptr){ return unit_ptr->nothingToDo() ; } ) )
+	{
+		// worker process with no smtp server
+	}
+	else if( m_units.at(0U)->nothingToDo() )
 	{
 		commandline().showNothingToDo( true ) ;
 	}
@@ -306,11 +343,13 @@ void Main::Run::run()
 			pid_file.mkdir() ;
 		}
 
-		// daemonise, create the pid file and close stderr
+		// daemonise, create the pid file and close stderr -- worker
+		// processes leave the pid file to the main process
 		//
 		if( configuration().daemon() )
-			G::Daemon::detach( pid_file.path() ) ;
-		commit( pid_file ) ;
+			G::Daemon::detach( worker() ? G::Path() : pid_file.path() ) ;
+		if( !worker() )
+			commit( pid_file ) ;
 		if( configuration().closeStderr() )
 			G::Process::closeStderr() ;
 
@@ -320,6 +359,12 @@ void Main::Run::run()
 		{
 			unit->start() ;
 		}
+		m_workers->start() ;
+
+		// tell any old process that we have taken over
+		//
+		if( !worker() )
+			m_upgrade->ready() ;
 
 		// run the event loop
 		//
@@ -329,6 +374,20 @@ void Main::Run::run()
 	}
 }
 
+void Main::Run::upgrade()
+{
+	try
+	{
+		if( !m_upgrade || worker() )
+			throw Upgrade::Error( "not the main process" ) ;
+		m_upgrade->start( m_upgrade_args , m_cwd ) ;
+	}
+	catch( std::exception & e )
+	{
+		G_ERROR( "Main::Run::upgrade: " << e.what() ) ;
+	}
+}
+
 std::string Main::Run::defaultDomain() const
 {
 	if( m_default_domain.empty() )
@@ -463,6 +522,25 @@ G::Path Main::Run::appDir() const
 		return this_exe.dirname() ;
 }
 
+unsigned int Main::Run::worker() const noexcept
+{
+	return m_workers ? m_workers->id() : 0U ;
+}
+
+void Main::Run::requestWorkerForwarding( unsigned int unit_id )
+{
+	if( m_workers )
+		m_workers->requestForwarding( unit_id ) ;
+}
+
+void Main::Run::onWorkerForwarding( unsigned int unit_id )
+{
+	// a worker's smtp client has disconnected (--forward-on-disconnect)
+	// or a worker's filter has requested a rescan
+	if( unit_id < m_units.size() && m_units[unit_id] )
+		m_units[unit_id]->requestForwarding( "worker request" ) ;
+}
+
 G::Slot::Signal<std::string,std::string,std::string,std::string> & Main::Run::signal() noexcept
 {
 	return m_signal ;
@@ -27,6 +27,8 @@
 #include "configuration.h"
 #include "commandline.h"
 #include "output.h"
+#include "workers.h"
+#include "upgrade.h"
 #include "geventloop.h"
 #include "gtimerlist.h"
 #include "glogoutput.h"
@@ -107,6 +109,20 @@ public:
 	G::Slot::Signal<std::string,std::string,std::string,std::string> & signal() noexcept ;
 		///< Provides a signal which is activated when something changes.
 
+	unsigned int worker() const noexcept ;
+		///< Returns a non-zero worker id if running as an smtp server
+		///< worker process (see --server-processes).
+
+	void requestWorkerForwarding( unsigned int unit_id ) ;
+		///< Used in an smtp server worker process to ask the main
+		///< process to start forwarding for the given unit.
+
+	void upgrade() ;
+		///< Starts a new process running the current executable and
+		///< hands over the listening sockets, with this process
+		///< terminating once its smtp and pop sessions have
+		///< finished. Errors are logged.
+
 private:
 	struct QueueItem
 	{
@@ -138,6 +154,7 @@ private:
 	void onUnitDone( unsigned int , std::string , bool ) ;
 	void onUnitEvent( unsigned int , std::string , std::string , std::string ) ;
 	void onNetworkEvent( const std::string & , const std::string & ) ;
+	void onWorkerForwarding( unsigned int ) ;
 	void addToSignalQueue( const std::string & , const std::string & , const std::string & = {} , const std::string & = {} ) ;
 	void onQueueTimeout() ;
 	void checkThreading() const ;
@@ -146,11 +163,15 @@ private:
 private:
 	Output & m_output ;
 	G::Arg m_arg ;
+	G::StringArray m_upgrade_args ;
+	G::Path m_cwd ;
 	mutable std::string m_default_domain ;
 	bool m_has_gui ;
 	G::Slot::Signal<std::string,std::string,std::string,std::string> m_signal ;
 	std::unique_ptr<CommandLine> m_commandline ;
 	std::unique_ptr<G::LogOutput> m_log_output ;
+	std::unique_ptr<Upgrade> m_upgrade ;
+	std::unique_ptr<Workers> m_workers ;
 	std::unique_ptr<GNet::EventLoop> m_event_loop ;
 	std::unique_ptr<GNet::TimerList> m_timer_list ;
 	std::unique_ptr<GNet::Monitor> m_monitor ;
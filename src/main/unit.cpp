@@ -97,25 +97,45 @@ Main::Unit::Unit( Run & run , unsigned int unit_id , const std::string & version
 	m_poll_timer = std::make_unique<GNet::Timer<Unit>>( *this ,
 		&Unit::onPollTimeout , m_es_log_only ) ;
 
-	// figure out what we're doing
+	// figure out what we're doing -- smtp server worker processes
+	// do only smtp serving (see --server-processes)
 	//
-	bool do_smtp = m_configuration.doServing() && m_configuration.doSmtp() ;
-	bool do_pop = m_configuration.doServing() && GPop::enabled() && m_configuration.doPop() ;
-	bool do_admin = GSmtp::AdminServer::enabled() && m_configuration.doServing() && m_configuration.doAdmin() ;
-	m_serving = do_smtp || do_pop || do_admin ;
+	const unsigned int worker = m_run.worker() ;
+	bool do_smtp = m_configuration.doServing() && m_configuration.doSmtp() && worker < m_configuration.serverProcesses() ;
+	bool do_pop = !worker && m_configuration.doServing() && GPop::enabled() && m_configuration.doPop() ;
+	bool do_admin = !worker && GSmtp::AdminServer::enabled() && m_configuration.doServing() && m_configuration.doAdmin() ;
+	bool do_metrics = !worker && m_configuration.doServing() && m_configuration.doMetrics() ;
+	m_serving = do_smtp || do_pop || do_admin || do_metrics ;
 	bool admin_forwarding = do_admin && !m_configuration.serverAddress().empty() ;
-	m_forwarding = m_configuration.forwardOnStartup() || m_configuration.doPolling() || admin_forwarding ;
+	m_forwarding = !worker && ( m_configuration.forwardOnStartup() || m_configuration.doPolling() || admin_forwarding ) ;
 	m_quit_when_sent =
+		!worker &&
 		!m_serving &&
 		m_configuration.forwardOnStartup() &&
 		!m_configuration.doPolling() &&
 		!admin_forwarding ;
 
+	// keep idle forwarding connections for reuse between forwarding runs
+	//
+	if( m_forwarding && !m_quit_when_sent && m_configuration.forwardIdleTimeout() )
+		m_forward_pool = std::make_unique<GSmtp::Forward::Pool>( m_es_log_only , m_configuration.forwardIdleTimeout() ) ;
+
 	// create message store stuff
 	//
 	m_file_store = std::make_unique<GStore::FileStore>( m_configuration.spoolDir() , m_configuration.deliveryDir() , m_configuration.fileStoreConfig() ) ;
 	m_filter_factory = std::make_unique<GFilters::FilterFactory>( *m_file_store ) ;
 	m_verifier_factory = std::make_unique<GVerifiers::VerifierFactory>() ;
+	if( do_metrics )
+	{
+		// spool depth, sampled when scraped
+		std::string spool_label = GNet::Metrics::label( "spool_dir" , m_configuration.spoolDir().str() ) ;
+		m_metric_spool = std::make_unique<GNet::Metrics::Gauge>( "emailrelay_spool_messages" ,
+			"Messages in the spool directory" , spool_label ,
+			[this](){ return static_cast<double>(store().ids().size()) ; } ) ;
+		m_metric_spool_failed = std::make_unique<GNet::Metrics::Gauge>( "emailrelay_spool_failed_messages" ,
+			"Failed messages in the spool directory" , spool_label ,
+			[this](){ return static_cast<double>(store().failures().size()) ; } ) ;
+	}
 	if( do_pop )
 	{
 		m_pop_store = GPop::newStore( m_configuration.spoolDir() , m_configuration.popStoreConfig() ) ;
@@ -188,6 +208,16 @@ Main::Unit::Unit( Run & run , unsigned int unit_id , const std::string & version
 			m_configuration.adminServerConfig( info_map , clientTlsProfile() , domain() , clientDomain() ) ) ;
 	}
 
+	// create the metrics server
+	//
+	if( do_metrics )
+	{
+		m_metrics_server = std::make_unique<GSmtp::MetricsServer>(
+			m_es_rethrow ,
+			m_configuration.listeningNames("metrics") ,
+			m_configuration.metricsServerConfig() ) ;
+	}
+
 	if( GSmtp::AdminServer::enabled() && m_admin_server ) m_admin_server->commandSignal().connect( G::Slot::slot(*this,&Unit::onAdminCommand) ) ;
 	if( m_smtp_server ) m_smtp_server->eventSignal().connect( G::Slot::slot(*this,&Main::Unit::onServerEvent) ) ;
 	store().messageStoreRescanSignal().connect( G::Slot::slot(*this,&Unit::onStoreRescanEvent) ) ;
@@ -253,6 +283,8 @@ void Main::Unit::onAdminCommand( GSmtp::AdminServer::Command command , unsigned
 {
 	if( command == GSmtp::AdminServer::Command::forward )
 		requestForwarding( "admin" ) ; // forward request from admin server's remote user
+	else if( command == GSmtp::AdminServer::Command::upgrade )
+		m_run.upgrade() ;
 	else if( m_smtp_server && command == GSmtp::AdminServer::Command::smtp_enable )
 		m_smtp_server->enable( !!arg ) ;
 	else if( m_smtp_server )
@@ -262,7 +294,13 @@ void Main::Unit::onAdminCommand( GSmtp::AdminServer::Command command , unsigned
 void Main::Unit::requestForwarding( const std::string & reason )
 {
 	G_ASSERT( m_forwarding_timer != nullptr ) ;
-	if( !m_configuration.serverAddress().empty() )
+	if( m_run.worker() )
+	{
+		// workers do no forwarding so they ask the main process
+		if( !m_configuration.serverAddress().empty() )
+			m_run.requestWorkerForwarding( m_unit_id ) ;
+	}
+	else if( !m_configuration.serverAddress().empty() )
 	{
 		if( !reason.empty() )
 			m_forwarding_reason = reason ;
@@ -321,7 +359,8 @@ std::string Main::Unit::startForwarding()
 			*m_filter_factory ,
 			GNet::Location(m_configuration.serverAddress(),m_resolver_family) ,
 			*m_client_secrets ,
-			m_configuration.smtpClientConfig( clientTlsProfile() , domain() , clientDomain() ) ) ) ;
+			m_configuration.smtpClientConfig( clientTlsProfile() , domain() , clientDomain() ) ,
+			m_forward_pool.get() ) ) ;
 		return {} ;
 	}
 	catch( std::exception & e )
@@ -365,12 +404,12 @@ void Main::Unit::start()
 
 	// kick off some forwarding
 	//
-	if( m_configuration.forwardOnStartup() )
+	if( m_configuration.forwardOnStartup() && !m_run.worker() )
 		requestForwarding( "startup" ) ;
 
 	// kick off the polling cycle
 	//
-	if( m_configuration.doPolling() )
+	if( m_configuration.doPolling() && !m_run.worker() )
 		m_poll_timer->startTimer( m_configuration.pollingTimeout() ) ;
 }
 
@@ -384,6 +423,9 @@ void Main::Unit::report()
 	if( m_admin_server )
 		m_admin_server->report( name_ ) ;
 
+	if( m_metrics_server )
+		m_metrics_server->report( name_ ) ;
+
 	if( m_pop_server )
 		GPop::report( m_pop_server.get() , name_ ) ;
 
@@ -32,6 +32,8 @@
 #include "gsmtpforward.h"
 #include "gsmtpserver.h"
 #include "gadminserver.h"
+#include "gmetricsserver.h"
+#include "gmetrics.h"
 #include "gpopserver.h"
 #include "gpopstore.h"
 #include <memory>
@@ -87,6 +89,10 @@ public:
 		///< Delivers the given event notification to remote clients of
 		///< the admin server.
 
+	void requestForwarding( const std::string & reason = {} ) ;
+		///< Starts forwarding soon, or when the current forwarding
+		///< client has finished.
+
 	G::Slot::Signal<unsigned,std::string,bool> & clientDoneSignal() noexcept ;
 		///< Returns a signal that indicates that a forwarding client
 		///< has done its work. The string parameter is a failure reason
@@ -117,7 +123,6 @@ private:
 	void onRequestForwardingTimeout() ;
 	bool logForwarding() const ;
 	std::string startForwarding() ;
-	void requestForwarding( const std::string & reason = {} ) ;
 	void onAdminCommand( GSmtp::AdminServer::Command , unsigned int ) ;
 	void onServerEvent( const std::string & s1 , const std::string & ) ;
 	void onStoreRescanEvent() ;
@@ -152,6 +157,8 @@ private:
 	std::unique_ptr<GNet::Timer<Unit>> m_forwarding_timer ;
 	std::unique_ptr<GNet::Timer<Unit>> m_poll_timer ;
 	std::unique_ptr<GStore::FileStore> m_file_store ;
+	std::unique_ptr<GNet::Metrics::Gauge> m_metric_spool ;
+	std::unique_ptr<GNet::Metrics::Gauge> m_metric_spool_failed ;
 	std::unique_ptr<GStore::FileDelivery> m_file_delivery ;
 	std::unique_ptr<GSmtp::FilterFactoryBase> m_filter_factory ;
 	std::unique_ptr<GSmtp::VerifierFactoryBase> m_verifier_factory ;
@@ -162,6 +169,8 @@ private:
 	std::unique_ptr<GPop::Store> m_pop_store ;
 	std::unique_ptr<GPop::Server> m_pop_server ;
 	std::unique_ptr<GSmtp::AdminServer> m_admin_server ;
+	std::unique_ptr<GSmtp::MetricsServer> m_metrics_server ;
+	std::unique_ptr<GSmtp::Forward::Pool> m_forward_pool ;
 	GNet::ClientPtr<GSmtp::Forward> m_client_ptr ;
 } ;
 
@@ -0,0 +1,98 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file upgrade.h
+///
+
+#ifndef G_MAIN_UPGRADE_H
+#define G_MAIN_UPGRADE_H
+
+#include "gdef.h"
+#include "gexception.h"
+#include "gstringarray.h"
+#include "gpath.h"
+#include <memory>
+
+namespace Main
+{
+	class Upgrade ;
+	class UpgradeImp ;
+}
+
+//| \class Main::Upgrade
+/// Implements a zero-downtime restart where the running process
+/// exec()s a new copy of the executable and hands over its listening
+/// sockets using GNet::Handover.
+///
+/// The sockets are passed over a private unix-domain socket using
+/// SCM_RIGHTS, with the socket's file descriptor number passed to the
+/// new process in an environment variable. Once the new process is
+/// ready it says so over the same socket and the old process stops
+/// accepting new connections, waits for its smtp and pop sessions to
+/// finish, and then terminates.
+///
+/// Listening sockets that were originally inherited as "fd#<n>" are
+/// simply inherited again by the new process.
+///
+/// Not implemented on Windows.
+///
+class Main::Upgrade
+{
+public:
+	G_EXCEPTION( Error , tx("cannot upgrade") )
+
+	Upgrade() ;
+		///< Constructor. If this process was started by start() in
+		///< another process then the handed-over listening sockets
+		///< are received and passed to GNet::Handover::adopt().
+		///< Must be used before any servers are created.
+
+	~Upgrade() ;
+		///< Destructor.
+
+	bool upgrading() const noexcept ;
+		///< Returns true if this process was started by start() in
+		///< another process.
+
+	void ready() ;
+		///< Tells the old process that this new process is up and
+		///< running and closes any adopted sockets that have not been
+		///< used. Does nothing if not upgrading().
+
+	void drop() ;
+		///< Closes the connection to the old process and any adopted
+		///< sockets. Used in worker processes.
+
+	void start( const G::StringArray & args , const G::Path & cwd ) ;
+		///< Starts a new process running the same executable with the
+		///< given command-line arguments and working directory, and
+		///< hands over the listening sockets. The event loop is
+		///< quit() once the new process is ready and the in-flight
+		///< smtp and pop sessions have finished. Throws on error.
+		///< Precondition: event loop exists
+
+public:
+	Upgrade( const Upgrade & ) = delete ;
+	Upgrade( Upgrade && ) = delete ;
+	Upgrade & operator=( const Upgrade & ) = delete ;
+	Upgrade & operator=( Upgrade && ) = delete ;
+
+private:
+	std::unique_ptr<UpgradeImp> m_imp ;
+} ;
+
+#endif
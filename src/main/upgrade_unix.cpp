@@ -0,0 +1,357 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file upgrade_unix.cpp
+///
+
+#include "gdef.h"
+#include "upgrade.h"
+#include "ghandover.h"
+#include "geventloop.h"
+#include "geventhandler.h"
+#include "geventstate.h"
+#include "gtimer.h"
+#include "gnewprocess.h"
+#include "gprocess.h"
+#include "genvironment.h"
+#include "garg.h"
+#include "groot.h"
+#include "gmsg.h"
+#include "gstr.h"
+#include "glog.h"
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+extern char ** environ ;
+
+namespace Main
+{
+	namespace UpgradeImpImp /// An implementation namespace for Main::UpgradeImp.
+	{
+		constexpr const char * env_name = "EMAILRELAY_UPGRADE_FD" ;
+		constexpr std::size_t record_size = 256U ;
+		using Record = std::array<char,record_size> ;
+	}
+}
+
+//| \class Main::UpgradeImp
+/// A pimple-pattern implementation class for Main::Upgrade.
+///
+class Main::UpgradeImp : public GNet::EventHandler
+{
+public:
+	UpgradeImp() ;
+	~UpgradeImp() override ;
+	bool upgrading() const noexcept ;
+	void ready() ;
+	void drop() ;
+	void start( const G::StringArray & , const G::Path & ) ;
+
+private: // overrides
+	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
+
+public:
+	UpgradeImp( const UpgradeImp & ) = delete ;
+	UpgradeImp( UpgradeImp && ) = delete ;
+	UpgradeImp & operator=( const UpgradeImp & ) = delete ;
+	UpgradeImp & operator=( UpgradeImp && ) = delete ;
+
+private:
+	void receive() ;
+	void send( const std::string & , int fd = -1 ) ;
+	void close() noexcept ;
+	void onDrainTimeout() ;
+	static void closeUntaken() ;
+
+private:
+	int m_fd {-1} ;
+	bool m_upgrading {false} ;
+	bool m_watching {false} ;
+	bool m_ready {false} ;
+	std::unique_ptr<GNet::Timer<UpgradeImp>> m_drain_timer ;
+} ;
+
+Main::UpgradeImp::UpgradeImp()
+{
+	namespace imp = UpgradeImpImp ;
+	std::string fd_str = G::Environment::get( imp::env_name , {} ) ;
+	if( !fd_str.empty() && G::Str::isUInt(fd_str) )
+	{
+		::unsetenv( imp::env_name ) ; // not for filters etc
+		m_fd = static_cast<int>( G::Str::toUInt(fd_str) ) ;
+		::fcntl( m_fd , F_SETFD , FD_CLOEXEC ) ;
+		m_upgrading = true ;
+		receive() ;
+	}
+}
+
+Main::UpgradeImp::~UpgradeImp()
+{
+	close() ;
+}
+
+bool Main::UpgradeImp::upgrading() const noexcept
+{
+	return m_upgrading ;
+}
+
+void Main::UpgradeImp::receive()
+{
+	// receive the listening sockets, one per fixed-size record, until "end"
+	namespace imp = UpgradeImpImp ;
+	for(;;)
+	{
+		imp::Record record {} ;
+		int fd = -1 ;
+		ssize_t rc = G::Msg::recvfrom( m_fd , record.data() , record.size() , MSG_WAITALL , nullptr , nullptr , &fd ) ;
+		if( rc != static_cast<ssize_t>(record.size()) )
+		{
+			if( fd >= 0 ) ::close( fd ) ;
+			throw Upgrade::Error( "cannot receive listening sockets from the old process" ) ;
+		}
+		record.back() = '\0' ;
+		std::string line( record.data() ) ;
+		if( line == "end" )
+			break ;
+
+		GNet::Handover::Item item ;
+		item.type = G::Str::head( line , " " ) ;
+		item.address = G::Str::tail( line , " " ) ;
+		item.fd = GNet::Descriptor( fd ) ;
+		if( fd < 0 || item.type.empty() || item.address.empty() )
+		{
+			if( fd >= 0 ) ::close( fd ) ;
+			throw Upgrade::Error( "invalid listening socket from the old process" ) ;
+		}
+		::fcntl( fd , F_SETFD , FD_CLOEXEC ) ;
+		GNet::Handover::adopt( item ) ;
+	}
+}
+
+void Main::UpgradeImp::ready()
+{
+	if( m_upgrading && m_fd >= 0 )
+	{
+		G_LOG_S( "Main::Upgrade::ready: taking over from the old process" ) ;
+		send( "ready" ) ;
+		close() ;
+		closeUntaken() ;
+	}
+}
+
+void Main::UpgradeImp::drop()
+{
+	close() ;
+	closeUntaken() ;
+}
+
+void Main::UpgradeImp::closeUntaken()
+{
+	for( const auto & item : GNet::Handover::untaken() )
+	{
+		G_DEBUG( "Main::Upgrade::closeUntaken: closing unused listening socket: " << item.type << " " << item.address ) ;
+		::close( item.fd.fd() ) ;
+	}
+}
+
+void Main::UpgradeImp::send( const std::string & line , int fd )
+{
+	namespace imp = UpgradeImpImp ;
+	imp::Record record {} ;
+	G::Str::strncpy_s( record.data() , record.size() , line.data() , line.size() ) ;
+	ssize_t rc = G::Msg::sendto( m_fd , record.data() , record.size() , 0 , nullptr , 0 , fd ) ;
+	if( rc != static_cast<ssize_t>(record.size()) )
+		throw Upgrade::Error( "cannot send to the new process" ) ;
+}
+
+void Main::UpgradeImp::close() noexcept
+{
+	if( m_watching && GNet::EventLoop::ptr() )
+		GNet::EventLoop::ptr()->drop( GNet::Descriptor(m_fd) ) ;
+	m_watching = false ;
+	if( m_fd >= 0 )
+		::close( m_fd ) ;
+	m_fd = -1 ;
+}
+
+void Main::UpgradeImp::start( const G::StringArray & args , const G::Path & cwd )
+{
+	namespace imp = UpgradeImpImp ;
+	if( m_fd >= 0 || m_ready )
+		throw Upgrade::Error( "already in progress" ) ;
+
+	// use the executable that is now on disk rather than the one we are running
+	std::string exe = G::Arg::exe().str() ;
+	if( G::Str::tailMatch( exe , " (deleted)" ) )
+		exe.resize( exe.size() - 10U ) ;
+
+	std::vector<GNet::Handover::Item> items = GNet::Handover::items() ;
+	std::array<int,2U> fds {{-1,-1}} ;
+	if( ::socketpair( AF_UNIX , SOCK_STREAM , 0 , fds.data() ) < 0 )
+		throw Upgrade::Error( "socketpair" ) ;
+	::fcntl( fds[0] , F_SETFD , FD_CLOEXEC ) ;
+
+	// prepare everything for the child before forking
+	std::vector<std::string> arg_strings { exe } ;
+	arg_strings.insert( arg_strings.end() , args.begin() , args.end() ) ;
+	std::vector<char*> argv ;
+	for( auto & s : arg_strings )
+		argv.push_back( const_cast<char*>(s.c_str()) ) ;
+	argv.push_back( nullptr ) ;
+
+	std::string env_item = std::string(imp::env_name).append(1U,'=').append(std::to_string(fds[1])) ;
+	std::vector<char*> envp ;
+	for( char ** p = environ ; p && *p ; ++p )
+	{
+		if( std::strncmp( *p , env_item.c_str() , std::strlen(imp::env_name)+1U ) != 0 )
+			envp.push_back( *p ) ;
+	}
+	envp.push_back( const_cast<char*>(env_item.c_str()) ) ;
+	envp.push_back( nullptr ) ;
+
+	std::vector<int> keep { STDIN_FILENO , STDOUT_FILENO , STDERR_FILENO , fds[1] } ;
+	for( const auto & item : items )
+	{
+		if( item.inherited )
+			keep.push_back( item.fd.fd() ) ;
+	}
+	int max_fd = 256 ;
+	long open_max = ::sysconf( _SC_OPEN_MAX ) ;
+	if( open_max > 0L )
+		max_fd = static_cast<int>( std::min( open_max , 65536L ) ) ;
+	std::string cwd_str = cwd.str() ;
+
+	G_LOG_S( "Main::Upgrade::start: starting new process: " << exe ) ;
+	{
+		G::Root claim_root ; // so that the new process starts with full privileges
+		if( G::NewProcess::fork().first )
+		{
+			// child -- close everything except the channel and any "fd#" listeners, and exec
+			for( int fd = 0 ; fd < max_fd ; fd++ )
+			{
+				if( std::find( keep.begin() , keep.end() , fd ) == keep.end() )
+					::close( fd ) ;
+				else if( fd > STDERR_FILENO )
+					::fcntl( fd , F_SETFD , 0 ) ;
+			}
+			if( !cwd_str.empty() )
+				GDEF_IGNORE_RETURN ::chdir( cwd_str.c_str() ) ;
+			::execve( exe.c_str() , argv.data() , envp.data() ) ;
+			std::_Exit( 127 ) ;
+		}
+	}
+
+	// parent -- hand over the listening sockets
+	::close( fds[1] ) ;
+	m_fd = fds[0] ;
+	try
+	{
+		for( const auto & item : items )
+		{
+			if( !item.inherited )
+			{
+				G_DEBUG( "Main::Upgrade::start: handing over " << item.type << " " << item.address ) ;
+				send( std::string(item.type).append(1U,' ').append(item.address) , item.fd.fd() ) ;
+			}
+		}
+		send( "end" ) ;
+	}
+	catch(...)
+	{
+		close() ; // new process sees eof
+		throw ;
+	}
+
+	// wait for the new process to say that it is ready
+	GNet::EventLoop::instance().addRead( GNet::Descriptor(m_fd) , *this , GNet::EventState::create() ) ;
+	m_watching = true ;
+}
+
+void Main::UpgradeImp::readEvent()
+{
+	std::array<char,64U> buffer {} ;
+	ssize_t rc = ::read( m_fd , buffer.data() , buffer.size()-1U ) ;
+	if( rc > 0 && std::string(buffer.data()) == "ready" )
+	{
+		G_LOG_S( "Main::Upgrade::readEvent: new process is ready: no longer accepting connections" ) ;
+		close() ;
+		m_ready = true ;
+		GNet::Handover::stop() ;
+		m_drain_timer = std::make_unique<GNet::Timer<UpgradeImp>>( *this , &UpgradeImp::onDrainTimeout , GNet::EventState::create() ) ;
+		m_drain_timer->startTimer( 0U ) ;
+	}
+	else if( rc <= 0 )
+	{
+		G_ERROR( "Main::Upgrade::readEvent: upgrade failed: the new process terminated early" ) ;
+		close() ;
+	}
+}
+
+const char * Main::UpgradeImp::statsName() const noexcept
+{
+	return "Main::Upgrade" ;
+}
+
+void Main::UpgradeImp::onDrainTimeout()
+{
+	if( GNet::Handover::busy( {"smtp","pop"} ) )
+	{
+		m_drain_timer->startTimer( 1U ) ;
+	}
+	else
+	{
+		G_LOG_S( "Main::Upgrade::onDrainTimeout: all sessions finished: terminating" ) ;
+		GNet::EventLoop::instance().quit( std::string() ) ;
+	}
+}
+
+// ==
+
+Main::Upgrade::Upgrade() :
+	m_imp(std::make_unique<UpgradeImp>())
+{
+}
+
+Main::Upgrade::~Upgrade()
+= default ;
+
+bool Main::Upgrade::upgrading() const noexcept
+{
+	return m_imp->upgrading() ;
+}
+
+void Main::Upgrade::ready()
+{
+	m_imp->ready() ;
+}
+
+void Main::Upgrade::drop()
+{
+	m_imp->drop() ;
+}
+
+void Main::Upgrade::start( const G::StringArray & args , const G::Path & cwd )
+{
+	m_imp->start( args , cwd ) ;
+}
@@ -0,0 +1,50 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file upgrade_win32.cpp
+///
+
+#include "gdef.h"
+#include "upgrade.h"
+
+class Main::UpgradeImp
+{
+} ;
+
+Main::Upgrade::Upgrade()
+= default ;
+
+Main::Upgrade::~Upgrade()
+= default ;
+
+bool Main::Upgrade::upgrading() const noexcept
+{
+	return false ;
+}
+
+void Main::Upgrade::ready()
+{
+}
+
+void Main::Upgrade::drop()
+{
+}
+
+void Main::Upgrade::start( const G::StringArray & , const G::Path & )
+{
+	throw Error( "not implemented" ) ;
+}
@@ -0,0 +1,95 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file workers.h
+///
+
+#ifndef G_MAIN_WORKERS_H
+#define G_MAIN_WORKERS_H
+
+#include "gdef.h"
+#include "geventhandler.h"
+#include "gexception.h"
+#include "gslot.h"
+#include <memory>
+
+namespace Main
+{
+	class Workers ;
+	class WorkersImp ;
+}
+
+//| \class Main::Workers
+/// Forks worker processes that do SMTP serving in parallel with the
+/// main process, with each worker having its own event loop and its own
+/// listening sockets bound with SO_REUSEPORT. Each worker holds one end
+/// of its own 'lifeline' socketpair so that it can terminate when the
+/// main process terminates. The main process holds the other ends so
+/// that when a worker terminates it is reaped and the main process
+/// shuts down with an error. Workers also use their lifeline to ask
+/// the main process to do forwarding (see --forward-on-disconnect)
+/// since they do no forwarding themselves.
+///
+/// Not implemented on Windows.
+///
+class Main::Workers
+{
+public:
+	G_EXCEPTION( Error , tx("cannot create worker processes") )
+
+	explicit Workers( unsigned int count ) ;
+		///< Constructor. Forks count-1 worker processes. Returns in
+		///< the main process and in each of the workers. Must be used
+		///< before the event loop is created.
+
+	~Workers() ;
+		///< Destructor.
+
+	unsigned int id() const noexcept ;
+		///< Returns the worker id, with zero for the main process.
+
+	bool worker() const noexcept ;
+		///< Returns true if running in a worker process.
+
+	void start() ;
+		///< Starts watching the lifelines. In a worker process the
+		///< event loop quit()s when the main process goes away. In the
+		///< main process the event loop quit()s with a failure reason
+		///< if any worker terminates.
+		///< Precondition: event loop exists
+
+	void requestForwarding( unsigned int unit_id ) ;
+		///< Used in a worker process to ask the main process to
+		///< start forwarding for the given unit. Does nothing if
+		///< there is already a request waiting on the lifeline.
+
+	G::Slot::Signal<unsigned int> & forwardingSignal() noexcept ;
+		///< Returns a signal that is emitted in the main process
+		///< when a worker calls requestForwarding(). The signal
+		///< parameter is the unit id.
+
+public:
+	Workers( const Workers & ) = delete ;
+	Workers( Workers && ) = delete ;
+	Workers & operator=( const Workers & ) = delete ;
+	Workers & operator=( Workers && ) = delete ;
+
+private:
+	std::unique_ptr<WorkersImp> m_imp ;
+} ;
+
+#endif
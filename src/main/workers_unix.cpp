@@ -0,0 +1,315 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file workers_unix.cpp
+///
+
+#include "gdef.h"
+#include "workers.h"
+#include "geventloop.h"
+#include "geventstate.h"
+#include "gnewprocess.h"
+#include "gprocess.h"
+#include "glog.h"
+#include <array>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+namespace Main
+{
+	class WorkerChild ;
+}
+
+//| \class Main::WorkerChild
+/// Holds the main process's end of one worker's lifeline. The worker
+/// holding the other end closes it when it terminates, so end-of-file
+/// here means that the worker has gone and needs to be reaped. Any
+/// data is a sequence of forwarding requests, one unit-id byte each.
+///
+class Main::WorkerChild : public GNet::EventHandler
+{
+public:
+	WorkerChild( unsigned int id , pid_t pid , int fd , G::Slot::Signal<unsigned int> & ) ;
+	~WorkerChild() override ;
+	void start() ;
+
+private: // overrides
+	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
+
+public:
+	WorkerChild( const WorkerChild & ) = delete ;
+	WorkerChild( WorkerChild && ) = delete ;
+	WorkerChild & operator=( const WorkerChild & ) = delete ;
+	WorkerChild & operator=( WorkerChild && ) = delete ;
+
+private:
+	void close() noexcept ;
+	std::string reap() ;
+
+private:
+	unsigned int m_id ;
+	pid_t m_pid ;
+	int m_fd ;
+	G::Slot::Signal<unsigned int> & m_forwarding_signal ;
+	bool m_started {false} ;
+} ;
+
+//| \class Main::WorkersImp
+/// A pimple-pattern implementation class for Main::Workers.
+///
+class Main::WorkersImp : public GNet::EventHandler
+{
+public:
+	explicit WorkersImp( unsigned int count ) ;
+	~WorkersImp() override ;
+	unsigned int id() const noexcept ;
+	void start() ;
+	void requestForwarding( unsigned int unit_id ) ;
+	G::Slot::Signal<unsigned int> & forwardingSignal() noexcept ;
+
+private: // overrides
+	void readEvent() override ; // GNet::EventHandler
+	const char * statsName() const noexcept override ; // GNet::EventHandler
+
+public:
+	WorkersImp( const WorkersImp & ) = delete ;
+	WorkersImp( WorkersImp && ) = delete ;
+	WorkersImp & operator=( const WorkersImp & ) = delete ;
+	WorkersImp & operator=( WorkersImp && ) = delete ;
+
+private:
+	unsigned int m_id {0U} ;
+	int m_fd {-1} ; // worker's end of its lifeline
+	bool m_started {false} ;
+	std::vector<std::unique_ptr<WorkerChild>> m_children ; // main process only
+	G::Slot::Signal<unsigned int> m_forwarding_signal ; // main process only
+} ;
+
+Main::WorkersImp::WorkersImp( unsigned int count )
+{
+	if( count <= 1U )
+		return ;
+
+	// each worker has its own lifeline -- the worker sees end-of-file when
+	// the main process terminates for any reason, and the main process sees
+	// end-of-file when the worker terminates -- use socketpairs rather than
+	// pipes so that epoll reports EPOLLIN
+	for( unsigned int i = 1U ; i < count ; i++ )
+	{
+		std::array<int,2U> fds {{-1,-1}} ;
+		if( ::socketpair( AF_UNIX , SOCK_STREAM , 0 , fds.data() ) < 0 )
+			throw Workers::Error( "socketpair" ) ;
+		::fcntl( fds[0] , F_SETFD , FD_CLOEXEC ) ;
+		::fcntl( fds[1] , F_SETFD , FD_CLOEXEC ) ;
+
+		std::pair<bool,pid_t> pair = G::NewProcess::fork() ;
+		if( pair.first )
+		{
+			m_id = i ;
+			m_fd = fds[0] ;
+			::close( fds[1] ) ;
+			m_children.clear() ; // close other workers' lifelines
+			G_LOG_S( "Main::Workers: smtp server worker " << m_id << ": pid " << G::Process::Id().str() ) ;
+			return ;
+		}
+		::close( fds[0] ) ;
+		m_children.push_back( std::make_unique<WorkerChild>( i , pair.second , fds[1] , m_forwarding_signal ) ) ;
+	}
+}
+
+Main::WorkersImp::~WorkersImp()
+{
+	if( m_started && GNet::EventLoop::ptr() )
+		GNet::EventLoop::ptr()->drop( GNet::Descriptor(m_fd) ) ;
+	if( m_fd >= 0 ) ::close( m_fd ) ;
+}
+
+unsigned int Main::WorkersImp::id() const noexcept
+{
+	return m_id ;
+}
+
+void Main::WorkersImp::start()
+{
+	if( m_id != 0U && !m_started )
+	{
+		GNet::EventLoop::instance().addRead( GNet::Descriptor(m_fd) , *this , GNet::EventState::create() ) ;
+		m_started = true ;
+	}
+	for( auto & child : m_children )
+		child->start() ;
+}
+
+void Main::WorkersImp::requestForwarding( unsigned int unit_id )
+{
+	// non-blocking so that a busy main process cannot stall the
+	// worker -- if the lifeline is full then the main process has
+	// requests to read already and one more adds nothing
+	if( m_id != 0U && m_fd >= 0 )
+	{
+		char c = static_cast<char>( unit_id ) ;
+		ssize_t rc = ::send( m_fd , &c , 1U , MSG_DONTWAIT | MSG_NOSIGNAL ) ;
+		if( rc != 1 )
+		{
+			G_DEBUG( "Main::WorkersImp::requestForwarding: lifeline write failed" ) ;
+		}
+	}
+}
+
+G::Slot::Signal<unsigned int> & Main::WorkersImp::forwardingSignal() noexcept
+{
+	return m_forwarding_signal ;
+}
+
+void Main::WorkersImp::readEvent()
+{
+	std::array<char,64U> buffer {} ;
+	ssize_t rc = ::read( m_fd , buffer.data() , buffer.size() ) ;
+	if( rc <= 0 )
+	{
+		G_LOG_S( "Main::Workers: smtp server worker " << m_id << ": main process has terminated" ) ;
+		GNet::EventLoop::instance().drop( GNet::Descriptor(m_fd) ) ;
+		m_started = false ;
+		GNet::EventLoop::instance().quit( std::string() ) ;
+	}
+}
+
+const char * Main::WorkersImp::statsName() const noexcept
+{
+	return "Main::Workers" ;
+}
+
+// ==
+
+Main::WorkerChild::WorkerChild( unsigned int id , pid_t pid , int fd , G::Slot::Signal<unsigned int> & forwarding_signal ) :
+	m_id(id) ,
+	m_pid(pid) ,
+	m_fd(fd) ,
+	m_forwarding_signal(forwarding_signal)
+{
+}
+
+Main::WorkerChild::~WorkerChild()
+{
+	close() ;
+}
+
+void Main::WorkerChild::start()
+{
+	if( !m_started && m_fd >= 0 )
+	{
+		GNet::EventLoop::instance().addRead( GNet::Descriptor(m_fd) , *this , GNet::EventState::create() ) ;
+		m_started = true ;
+	}
+}
+
+void Main::WorkerChild::close() noexcept
+{
+	if( m_started && GNet::EventLoop::ptr() )
+		GNet::EventLoop::ptr()->drop( GNet::Descriptor(m_fd) ) ;
+	m_started = false ;
+	if( m_fd >= 0 )
+		::close( m_fd ) ;
+	m_fd = -1 ;
+}
+
+void Main::WorkerChild::readEvent()
+{
+	// workers are not restarted because the main process has already
+	// given up its privileges and built its event loop, so a worker
+	// that has gone is reaped and the whole server shuts down rather
+	// than carrying on with less capacity than configured
+	std::array<char,64U> buffer {} ;
+	ssize_t rc = ::read( m_fd , buffer.data() , buffer.size() ) ;
+	if( rc <= 0 )
+	{
+		close() ;
+		std::string reason = "smtp server worker " + std::to_string(m_id) + " (pid " + std::to_string(m_pid) + ") " + reap() ;
+		G_ERROR( "Main::Workers: " << reason ) ;
+		GNet::EventLoop::instance().quit( reason ) ;
+	}
+	else
+	{
+		G_DEBUG( "Main::WorkerChild::readEvent: smtp server worker " << m_id << ": forwarding request" ) ;
+		for( std::size_t i = 0U ; i < static_cast<std::size_t>(rc) ; i++ )
+			m_forwarding_signal.emit( static_cast<unsigned char>(buffer[i]) ) ;
+	}
+}
+
+const char * Main::WorkerChild::statsName() const noexcept
+{
+	return "Main::Workers" ;
+}
+
+std::string Main::WorkerChild::reap()
+{
+	int status = 0 ;
+	pid_t rc = -1 ;
+	do { rc = ::waitpid( m_pid , &status , 0 ) ; } while( rc < 0 && errno == EINTR ) ;
+	if( rc != m_pid )
+		return "has terminated" ;
+	else if( WIFSIGNALED(status) )
+		return "was killed by signal " + std::to_string(WTERMSIG(status)) ;
+	else if( WIFEXITED(status) )
+		return "exited with status " + std::to_string(WEXITSTATUS(status)) ;
+	else
+		return "has terminated" ;
+}
+
+// ==
+
+Main::Workers::Workers( unsigned int count ) :
+	m_imp(std::make_unique<WorkersImp>(count))
+{
+}
+
+Main::Workers::~Workers()
+= default ;
+
+unsigned int Main::Workers::id() const noexcept
+{
+	return m_imp->id() ;
+}
+
+bool Main::Workers::worker() const noexcept
+{
+	return m_imp->id() != 0U ;
+}
+
+void Main::Workers::start()
+{
+	m_imp->start() ;
+}
+
+
+void Main::Workers::requestForwarding( unsigned int unit_id )
+{
+	m_imp->requestForwarding( unit_id ) ;
+}
+
+G::Slot::Signal<unsigned int> & Main::Workers::forwardingSignal() noexcept
+{
+	return m_imp->forwardingSignal() ;
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file workers_win32.cpp
+///
+
+#include "gdef.h"
+#include "workers.h"
+
+class Main::WorkersImp
+{
+public:
+	G::Slot::Signal<unsigned int> m_forwarding_signal ;
+} ;
+
+Main::Workers::Workers( unsigned int count ) :
+	m_imp(std::make_unique<WorkersImp>())
+{
+	if( count > 1U )
+		throw Error( "not implemented" ) ;
+}
+
+Main::Workers::~Workers()
+= default ;
+
+unsigned int Main::Workers::id() const noexcept
+{
+	return 0U ;
+}
+
+bool Main::Workers::worker() const noexcept
+{
+	return false ;
+}
+
+void Main::Workers::start()
+{
+}
+
+void Main::Workers::requestForwarding( unsigned int )
+{
+}
+
+G::Slot::Signal<unsigned int> & Main::Workers::forwardingSignal() noexcept
+{
+	return m_imp->m_forwarding_signal ;
+}
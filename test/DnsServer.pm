@@ -30,8 +30,9 @@ package DnsServer ;
 
 sub new
 {
-	my ( $classname , $port , $address ) = @_ ;
-	return bless { h => new Helper( "emailrelay_test_dnsserver" , $port , ["--address",$address] ) } , $classname ;
+	my ( $classname , $port , $address , $ttl ) = @_ ;
+	my @args = ( "--address" , $address , (defined($ttl)?("--ttl",$ttl):()) ) ;
+	return bless { h => new Helper( "emailrelay_test_dnsserver" , $port , \@args ) } , $classname ;
 }
 
 sub port { return shift->{h}->port(@_) }
@@ -239,6 +239,11 @@ sub _switches
 		( exists($sw{FilterTimeout}) ? "--filter-timeout 1 " : "" ) .
 		( exists($sw{ConnectionTimeout}) ? "--connection-timeout 1 " : "" ) .
 		( exists($sw{Immediate}) ? "--immediate " : "" ) .
+		( exists($sw{ForwardOnDisconnect}) ? "--forward-on-disconnect " : "" ) .
+		( exists($sw{ServerProcesses}) ? "--server-processes $sw{ServerProcesses} " : "" ) .
+		( exists($sw{ForwardIdleTimeout}) ? "--forward-idle-timeout $sw{ForwardIdleTimeout} " : "" ) .
+		( exists($sw{ForwardConcurrency}) ? "--forward-concurrency $sw{ForwardConcurrency} " : "" ) .
+		( exists($sw{ForwardDestinationConcurrency}) ? "--forward-destination-concurrency $sw{ForwardDestinationConcurrency} " : "" ) .
 		( exists($sw{ClientFilter}) ? "--client-filter __CLIENT_FILTER__ " : "" ) .
 		( exists($sw{ClientFilterNet}) ? "--client-filter __SCANNER__ " : "" ) .
 		( exists($sw{Scanner}) ? "--filter __SCANNER__ " : "" ) .
@@ -365,6 +365,54 @@ sub testPasswdDotted
 	Check::that( $ok , "password digest generation failed" ) ;
 }
 
+sub testTimerList
+{
+	# test timer expiry order, cancelling and re-arming (see emailrelay_test_timers.cpp)
+	my $exe = System::sanepath( System::exe( $opt_test_bin_dir , "emailrelay_test_timers" ) ) ;
+	my $rc = system( "$exe --test" ) ;
+	Check::that( $rc == 0 , "timer list test failed" ) ;
+}
+
+sub testClientConnectRace
+{
+	# test racing connections to several addresses (see emailrelay_test_gnet.cpp)
+	my $exe = System::sanepath( System::exe( $opt_test_bin_dir , "emailrelay_test_gnet" ) ) ;
+	my $rc = system( "$exe --test connect" ) ;
+	Check::that( $rc == 0 , "connection race test failed" ) ;
+}
+
+sub testSendQueue
+{
+	# test send queue flow control (see emailrelay_test_gnet.cpp)
+	my $exe = System::sanepath( System::exe( $opt_test_bin_dir , "emailrelay_test_gnet" ) ) ;
+	my $rc = system( "$exe --test send-queue" ) ;
+	Check::that( $rc == 0 , "send queue test failed" ) ;
+}
+
+sub testDnsResolver
+{
+	# test the native dns resolver's search list and ttl handling (see emailrelay_test_gnet.cpp)
+	my $exe = System::sanepath( System::exe( $opt_test_bin_dir , "emailrelay_test_gnet" ) ) ;
+	my $dnsserver = new DnsServer( System::nextPort() , "127.0.@.0" , 300 ) ;
+	my $hosts_file = System::tempfile( "hosts" ) ;
+	System::createFile( $hosts_file , "127.0.0.9 hosted" ) ;
+	$dnsserver->run() ;
+	Check::running( $dnsserver->pid() ) ;
+	my $rc = system( "$exe --test dns --dns-port " . $dnsserver->port() . " --hosts-file $hosts_file" ) ;
+	$dnsserver->kill() ;
+	Check::that( $rc == 0 , "dns resolver test failed" ) ;
+	$dnsserver->cleanup() ;
+	System::unlink( $hosts_file ) ;
+}
+
+sub testResolverCache
+{
+	# test the resolver cache (see emailrelay_test_gnet.cpp)
+	my $exe = System::sanepath( System::exe( $opt_test_bin_dir , "emailrelay_test_gnet" ) ) ;
+	my $rc = system( "$exe --test resolver-cache" ) ;
+	Check::that( $rc == 0 , "resolver cache test failed" ) ;
+}
+
 sub testSubmitPermissions
 {
 	# setup -- group-suid-daemon exe and group-daemon spool directory
@@ -1802,6 +1850,61 @@ sub testProxyConnectsOnce
 	System::deleteSpoolDir( $spool_dir_2 ) ;
 }
 
+sub testServerProcessesForwardOnDisconnect
+{
+	# setup
+	requireUnix() ;
+	my %args = (
+		Log => 1 ,
+		LogFile => 1 ,
+		Verbose => 1 ,
+		Domain => 1 ,
+		Port => 1 ,
+		SpoolDir => 1 ,
+		ForwardTo => 1 ,
+		ForwardOnDisconnect => 1 ,
+		ServerProcesses => 3 ,
+		PidFile => 1 ,
+	) ;
+	my $server_1 = new Server() ;
+	my $spool_dir_1 = $server_1->spoolDir() ;
+	my $server_2 = new Server() ;
+	my $spool_dir_2 = $server_2->spoolDir() ;
+	$server_1->set_forwardToPort( $server_2->smtpPort() ) ;
+	Check::ok( $server_1->run(\%args) , "failed to run" , $server_1->message() ) ;
+	delete $args{ForwardTo} ;
+	delete $args{ForwardOnDisconnect} ;
+	delete $args{ServerProcesses} ;
+	Check::ok( $server_2->run(\%args) , "failed to run" , $server_2->message() ) ;
+	Check::running( $server_1->pid() , $server_1->message() ) ;
+	Check::running( $server_2->pid() , $server_2->message() ) ;
+
+	# test that messages received by the worker processes are forwarded
+	# by the main process when asked over the worker's lifeline -- with
+	# several connections some are very likely to land on a worker
+	my $n = 8 ;
+	for( my $i = 0 ; $i < $n ; $i++ )
+	{
+		my $smtp_client = new SmtpClient( $server_1->smtpPort() ) ;
+		Check::ok( $smtp_client->open() ) ;
+		$smtp_client->submit() ;
+		$smtp_client->close() ;
+	}
+	System::waitForFiles( $spool_dir_2 ."/emailrelay.*.envelope" , $n , "messages not forwarded" ) ;
+	System::waitForFiles( $spool_dir_1 ."/emailrelay.*" , 0 , "messages not forwarded" ) ;
+	Check::fileContains( $server_1->log() , "forwarding: \\[worker request\\]" , "log" ) ;
+	Check::fileContains( $server_1->log() , "smtp server worker 2" , "log" ) ;
+	Check::fileDoesNotContain( $server_1->log() , [ "error" , "exception" ] , "log" ) ;
+
+	# tear down
+	$server_1->kill() ;
+	$server_2->kill() ;
+	$server_1->cleanup() ;
+	$server_2->cleanup() ;
+	System::deleteSpoolDir( $spool_dir_1 ) ;
+	System::deleteSpoolDir( $spool_dir_2 ) ;
+}
+
 sub testProxyServerRejection
 {
 	# setup
@@ -2268,6 +2371,187 @@ sub testRoutingWithSplitAndMxFilters
 	$test_server->cleanup() ;
 }
 
+sub testClientConnectionReuse
+{
+	# setup
+	my %args = (
+		Log => 1 ,
+		LogFile => 1 ,
+		Verbose => 1 ,
+		Domain => 1 ,
+		Port => 1 ,
+		SpoolDir => 1 ,
+		PidFile => 1 ,
+		ForwardTo => 1 ,
+		ForwardIdleTimeout => 60 ,
+		Admin => 1 ,
+	) ;
+	requireAdmin() ;
+	my $server = new Server() ;
+	my $spool_dir = $server->spoolDir() ;
+	my $test_server_1 = new TestServer( System::nextPort() ) ;
+	my $test_server_2 = new TestServer( System::nextPort() ) ;
+	my $admin_client = new AdminClient( $server->adminPort() ) ;
+	$server->set_forwardToPort( $test_server_1->port() ) ;
+	Check::ok( $server->run(\%args) , "failed to run server" , $server->message() ) ;
+	Check::running( $server->pid() , $server->message() ) ;
+	$test_server_1->run() ;
+	$test_server_2->run() ;
+	Check::running( $test_server_1->pid() ) ;
+	Check::running( $test_server_2->pid() ) ;
+	Check::ok( $admin_client->open() , "cannot connect for admin" , $server->adminPort() ) ;
+	my $forward_one = sub {
+		my ( $forward_to_address ) = @_ ;
+		System::submitSmallMessage( $spool_dir ) ;
+		System::editEnvelope( System::match($spool_dir."/emailrelay.*.envelope") ,
+			"ForwardToAddress" , $forward_to_address ) if $forward_to_address ;
+		$admin_client->doForward() ;
+		System::waitForFiles( $spool_dir."/emailrelay.*" , 0 , "message not forwarded" ) ;
+	} ;
+	my $address_2 = $System::localhost.":".$test_server_2->port() ;
+
+	# test that an idle connection is reused by the next forwarding run
+	# for the same destination but not for a different destination
+	$forward_one->() ;
+	$forward_one->() ;
+	Check::fileContains( $test_server_1->log() , "new connection" , undef , 1 ) ;
+	Check::fileContains( $test_server_1->log() , "MAIL FROM" , undef , 2 ) ;
+	$forward_one->( $address_2 ) ;
+	Check::fileContains( $test_server_2->log() , "new connection" , undef , 1 ) ;
+	Check::fileContains( $test_server_2->log() , "MAIL FROM" , undef , 1 ) ;
+	$forward_one->() ;
+	$forward_one->( $address_2 ) ;
+	Check::fileContains( $test_server_1->log() , "new connection" , undef , 1 ) ;
+	Check::fileContains( $test_server_1->log() , "MAIL FROM" , undef , 3 ) ;
+	Check::fileContains( $test_server_2->log() , "new connection" , undef , 1 ) ;
+	Check::fileContains( $test_server_2->log() , "MAIL FROM" , undef , 2 ) ;
+
+	# tear down
+	$server->kill() ;
+	$test_server_1->kill() ;
+	$test_server_2->kill() ;
+	$server->cleanup() ;
+	$test_server_1->cleanup() ;
+	$test_server_2->cleanup() ;
+}
+
+sub testClientForwardConcurrency
+{
+	# setup
+	my %args = (
+		Log => 1 ,
+		LogFile => 1 ,
+		Verbose => 1 ,
+		Domain => 1 ,
+		Port => 1 ,
+		SpoolDir => 1 ,
+		PidFile => 1 ,
+		ForwardTo => 1 ,
+		ForwardConcurrency => 3 ,
+		Admin => 1 ,
+	) ;
+	requireAdmin() ;
+	my $server = new Server() ;
+	my $spool_dir = $server->spoolDir() ;
+	my $test_server = new TestServer( System::nextPort() ) ;
+	my $admin_client = new AdminClient( $server->adminPort() ) ;
+	$server->set_forwardToPort( $test_server->port() ) ;
+	Check::ok( $server->run(\%args) , "failed to run server" , $server->message() ) ;
+	Check::running( $server->pid() , $server->message() ) ;
+	$test_server->run( "--pause --drop" ) ;
+	Check::running( $test_server->pid() ) ;
+	for my $i ( 1 .. 7 )
+	{
+		System::submitMessageText( $spool_dir , $i == 2 ? "DROP" : "hello" ) ;
+	}
+	Check::ok( $admin_client->open() , "cannot connect for admin" , $server->adminPort() ) ;
+
+	# test that the messages are forwarded over three parallel connections
+	# to the slow test server, and that the connection that is dropped
+	# part way through its message does not hold up the others
+	$admin_client->doForward() ;
+	System::waitForFiles( $spool_dir."/emailrelay.*.envelope*" , 1 , "messages not forwarded" ) ;
+	Check::fileMatchCount( $spool_dir."/emailrelay.*.envelope.bad" , 1 ) ;
+	Check::fileContains( System::match($spool_dir."/emailrelay.*.content") , "DROP" ) ;
+	Check::fileContains( $test_server->log() , "rx<<: \\[MAIL FROM" , undef , 7 ) ;
+	Check::fileContains( $test_server->log() , "rx<<: \\[\\.\\]" , undef , 6 ) ;
+	Check::fileContains( $test_server->log() , "new connection .*\\(3 connected\\)" ) ;
+	Check::fileDoesNotContain( $test_server->log() , "new connection .*\\(([4-9]|\\d\\d+) connected\\)" ) ;
+	Check::fileDoesNotContain( $server->log() , "client error: done" ) ;
+
+	# tear down
+	$server->kill() ;
+	$test_server->kill() ;
+	$server->cleanup() ;
+	$test_server->cleanup() ;
+}
+
+sub testClientForwardDestinationConcurrency
+{
+	# setup
+	my %args = (
+		Log => 1 ,
+		LogFile => 1 ,
+		Verbose => 1 ,
+		Domain => 1 ,
+		Port => 1 ,
+		SpoolDir => 1 ,
+		PidFile => 1 ,
+		ForwardTo => 1 ,
+		ForwardConcurrency => 3 ,
+		ForwardDestinationConcurrency => 2 ,
+		Admin => 1 ,
+	) ;
+	requireAdmin() ;
+	my $server = new Server() ;
+	my $spool_dir = $server->spoolDir() ;
+	my $test_server_1 = new TestServer( System::nextPort() ) ;
+	my $test_server_2 = new TestServer( System::nextPort() ) ;
+	my $admin_client = new AdminClient( $server->adminPort() ) ;
+	$server->set_forwardToPort( $test_server_1->port() ) ;
+	Check::ok( $server->run(\%args) , "failed to run server" , $server->message() ) ;
+	Check::running( $server->pid() , $server->message() ) ;
+	$test_server_1->run( "--pause" ) ;
+	$test_server_2->run() ;
+	Check::running( $test_server_1->pid() ) ;
+	Check::running( $test_server_2->pid() ) ;
+	my @envelopes_2 = () ;
+	for my $i ( 1 .. 8 )
+	{
+		my %old = map { $_ => 1 } System::glob_( $spool_dir."/emailrelay.*.envelope" ) ;
+		System::submitMessageText( $spool_dir , "hello" ) ;
+		next if $i <= 6 ;
+		my ( $envelope ) = grep { !$old{$_} } System::glob_( $spool_dir."/emailrelay.*.envelope" ) ;
+		System::editEnvelope( $envelope , "ForwardToAddress" , $System::localhost.":".$test_server_2->port() ) ;
+		push @envelopes_2 , $envelope ;
+	}
+	Check::ok( $admin_client->open() , "cannot connect for admin" , $server->adminPort() ) ;
+
+	# test that the slow destination gets no more than two of the three
+	# connections, and that the other destination is not held up by
+	# the messages that are waiting for the slow one
+	$admin_client->doForward() ;
+	for my $envelope ( @envelopes_2 )
+	{
+		System::waitForFiles( $envelope."*" , 0 , "second destination held up" ) ;
+	}
+	my $remaining = scalar( System::glob_( $spool_dir."/emailrelay.*.envelope*" ) ) ;
+	Check::that( $remaining >= 2 , "first destination not limited" ) ;
+	System::waitForFiles( $spool_dir."/emailrelay.*.envelope*" , 0 , "messages not forwarded" ) ;
+	Check::fileContains( $test_server_1->log() , "MAIL FROM" , undef , 6 ) ;
+	Check::fileContains( $test_server_2->log() , "MAIL FROM" , undef , 2 ) ;
+	Check::fileContains( $test_server_1->log() , "new connection .*\\(2 connected\\)" ) ;
+	Check::fileDoesNotContain( $test_server_1->log() , "new connection .*\\(([3-9]|\\d\\d+) connected\\)" ) ;
+
+	# tear down
+	$server->kill() ;
+	$test_server_1->kill() ;
+	$test_server_2->kill() ;
+	$server->cleanup() ;
+	$test_server_1->cleanup() ;
+	$test_server_2->cleanup() ;
+}
+
 sub testClientFilterPass
 {
 	# setup
@@ -2582,6 +2866,48 @@ sub testClientMessageFailure
 	$emailrelay->cleanup() ;
 }
 
+sub testClientContentLastBlockBlocked
+{
+	# setup
+	requireDebug() ;
+	my %args = (
+		Log => 1 ,
+		LogFile => 1 ,
+		Verbose => 1 ,
+		Domain => 1 ,
+		SpoolDir => 1 ,
+		Forward => 1 ,
+		ForwardTo => 1 ,
+		DontServe => 1 ,
+		NoDaemon => 1 ,
+		Hidden => 1 ,
+	) ;
+	my $spool_dir = System::createSpoolDir() ;
+	my $test_server = new TestServer( System::nextPort() ) ;
+	$test_server->run( "--quiet" ) ;
+	System::submitSmallMessage( $spool_dir ) ;
+	my $content_path = System::match( $spool_dir."/emailrelay.*.content" ) ;
+	my $fh = new FileHandle( $content_path , "w" ) or die ;
+	binmode $fh ;
+	print $fh "Subject: test\r\n\r\n" , "x" x 20000000 ; # no final newline, so one block
+	$fh->close() or die ;
+	my $emailrelay = new Server( {spool_dir=>$spool_dir} ) ;
+	$emailrelay->set_forwardToPort( $test_server->port() ) ;
+
+	# test that when the last block of DATA content is held up by flow control,
+	# with the send queue disabled as in a small build, the client waits for it
+	# to drain before sending the final dot and the message is forwarded
+	Check::ok( $emailrelay->run( \%args , undef , "smtp-client-no-send-queue" ) , "failed to run" , $emailrelay->message() ) ;
+	System::waitForFiles( $spool_dir ."/emailrelay.*" , 0 , "message not forwarded" ) ;
+	Check::fileDoesNotContain( $emailrelay->log() , "still busy" , "log" ) ;
+
+	# tear down
+	$test_server->kill() ;
+	$emailrelay->wait() ;
+	$test_server->cleanup() ;
+	$emailrelay->cleanup() ;
+}
+
 sub testClientInvalidRecipients
 {
 	# setup
@@ -19,7 +19,7 @@
 ///
 // A dummy DNS server for testing purposes.
 //
-// usage: emailrelay_test_dnsserver [--port <port>] [--address <ipv4-address>]
+// usage: emailrelay_test_dnsserver [--port <port>] [--address <ipv4-address>] [--ttl <seconds>]
 //
 // Default mappings:
 //    MX(*zero*) -> A(smtp.*zero*) -> 0.0.0.0
@@ -28,6 +28,7 @@
 //    MX(*two*) -> A(smtp.*two*) -> 127.0.2.1
 //    MX(*three*) -> A(smtp.*three*) -> 127.0.3.1
 //    MX(*) -> A(smtp.*) -> 127.0.0.1
+//    A(*missing*) -> NXDOMAIN
 //
 // Testing:
 //    $ dig @127.0.0.1 -p 10053 +short -t MX -q foo.zero.net
@@ -74,11 +75,13 @@ public:
 		unsigned int port {53U} ;
 		std::string answer_a ;
 		std::string answer_mx ;
+		unsigned int ttl {10U} ;
 		GNet::Address::Family family {GNet::Address::Family::ipv4} ;
 		GNet::DatagramSocket::Config socket_config ;
 		Config & set_port( unsigned int n ) { port = n ; return *this ; }
 		Config & set_answer_a( const std::string & s ) { answer_a = s ; return *this ; }
 		Config & set_answer_mx( const std::string & s ) { answer_mx = s ; return *this ; }
+		Config & set_ttl( unsigned int n ) { ttl = n ; return *this ; }
 	} ;
 
 public:
@@ -143,6 +146,11 @@ void Server::sendResponse( const GNet::Address & address , GNet::DnsMessage m )
 			log_message = "answer TYPE=MX EXCHANGE=" + answer ;
 			response = GNet::DnsMessageBuilder::response( m , answer ) ;
 		}
+		else if( m.question(0U).qtype() == 1U && m.question(0U).qname().find("missing") != std::string::npos )
+		{
+			log_message = "rejection RCODE=3" ;
+			response = GNet::DnsMessage::rejection( m , 3 ) ; // NXDOMAIN
+		}
 		else if( m.question(0U).qtype() == 1U ) // QTYPE "A"
 		{
 			std::string qname = m.question(0U).qname() ;
@@ -159,7 +167,7 @@ void Server::sendResponse( const GNet::Address & address , GNet::DnsMessage m )
 
 			GNet::Address a = GNet::Address::parse( answer ) ;
 			log_message = "answer TYPE=A NAME=" + a.displayString() ;
-			response = GNet::DnsMessageBuilder::response( m , a , 10U ) ;
+			response = GNet::DnsMessageBuilder::response( m , a , m_config.ttl ) ;
 		}
 	}
 	G_LOG( "Server::readEvent: response: " << response.n() << " bytes: " << log_message ) ;
@@ -257,6 +265,7 @@ int main( int argc , char * argv [] )
 		G::Options::add( options , 'l' , "log" , "enable logging" , "" , M::zero , "" , 1 , 0 ) ;
 		G::Options::add( options , 'N' , "log-file" , "output log to file" , "" , M::one , "path" , 1 , 0 ) ;
 		G::Options::add( options , '\0' , "address" , "address in response" , "" , M::one , "address" , 1 , 0 ) ;
+		G::Options::add( options , '\0' , "ttl" , "ttl in response" , "" , M::one , "seconds" , 1 , 0 ) ;
 		G::GetOpt opt( arg , options ) ;
 		if( opt.hasErrors() )
 		{
@@ -275,6 +284,7 @@ int main( int argc , char * argv [] )
 		config.port = opt.contains("port") ? G::Str::toUInt(opt.value("port")) : 10053U ;
 		config.answer_a = opt.value( "address" , "127.0.@.1" ) ; // @ -> "1" if query contains "one" etc.
 		config.answer_mx = "smtp.@" ; // @ -> <qname>
+		config.ttl = G::Str::toUInt( opt.value( "ttl" , "10" ) ) ;
 		bool debug = opt.contains( "debug" ) ;
 		std::string pid_file_name = opt.value( "pid-file" , "."+argv0.str()+".pid" ) ;
 		std::string log_file = opt.value( "log-file" , "" ) ;
@@ -0,0 +1,644 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file emailrelay_test_gnet.cpp
+///
+// Correctness tests for GNet classes that need a running event loop.
+//
+// usage: emailrelay_test_gnet [--debug] [--dns-port <port>] [--hosts-file <path>] --test <name>
+//
+// With "--test connect" it checks that GNet::Client races connections
+// to multiple addresses: a first address that refuses connections or
+// that never answers does not stop the second address from being used,
+// and if every address fails then the failure reason mentions each of
+// them. The "never answers" address is a listening socket with a full
+// accept queue.
+//
+// With "--test send-queue" it checks the GNet::SocketProtocol output
+// queue over a loopback connection where the reader stops reading.
+// The kernel's buffering is first measured with the queue disabled.
+// With the queue enabled, data that is within the queue's byte budget
+// is accepted by send() and then drains without writeEvent() ever
+// reporting a completion, since send() never returned false. Data
+// beyond the budget makes send() return false and then writeEvent()
+// reports exactly one completion once the queue has drained. The
+// reader checks that every byte arrives in order.
+//
+// With "--test dns --dns-port <port> --hosts-file <path>" it checks
+// GNet::DnsResolver against an "emailrelay_test_dnsserver" started
+// with "--address 127.0.@.0 --ttl 300" and a hosts file containing
+// "127.0.0.9 hosted". Unqualified names are tried with each search
+// domain in turn, skipping past a domain that gives NXDOMAIN; names
+// with enough dots are tried as-is first; names with a trailing dot
+// are not searched; and the answer TTL is passed on, or the maximum
+// value for a name found in the hosts file.
+//
+// With "--test resolver-cache" it checks that synchronous
+// GNet::Resolver::resolve() calls only use the cache when
+// Config::sync_cache is set, that a full cache evicts the entries that
+// are soonest to expire, and that expired entries are not used. The
+// cache statistics come from GNet::Resolver::report().
+//
+// The exit code is non-zero on failure.
+//
+
+#include "gdef.h"
+#include "gclient.h"
+#include "gclientptr.h"
+#include "gsocket.h"
+#include "gsocketprotocol.h"
+#include "gdnsresolver.h"
+#include "gresolver.h"
+#include "glimits.h"
+#include "gnameservers.h"
+#include "geventhandler.h"
+#include "gaddress.h"
+#include "glocation.h"
+#include "geventloop.h"
+#include "geventstate.h"
+#include "gtimerlist.h"
+#include "glogoutput.h"
+#include "gslot.h"
+#include "gstr.h"
+#include "garg.h"
+#include "ggetopt.h"
+#include "goptionsusage.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <limits>
+#include <stdexcept>
+
+namespace Test
+{
+	void check( bool ok , const std::string & what )
+	{
+		if( !ok )
+			throw std::runtime_error( "test failed: " + what ) ;
+	}
+}
+
+class TestClient : public GNet::Client
+{
+public:
+	TestClient( GNet::EventState es , const GNet::Location & location , unsigned int race_delay_ms ) :
+		GNet::Client(es,location,GNet::Client::Config()
+			.set_connection_timeout(10U)
+			.set_connection_race_delay_ms(race_delay_ms))
+	{
+	}
+	std::string m_peer ;
+
+private: // overrides
+	void onConnect() override
+	{
+		m_peer = socket().getPeerAddress().second.displayString() ;
+		GNet::EventLoop::instance().quit( "connected" ) ;
+	}
+	bool onReceive( const char * , std::size_t , std::size_t , std::size_t , char ) override
+	{
+		return true ;
+	}
+	void onSendComplete() override
+	{
+	}
+	void onSecure( const std::string & , const std::string & , const std::string & ) override
+	{
+	}
+	void onDelete( const std::string & ) override
+	{
+	}
+} ;
+
+class ConnectTest
+{
+public:
+	ConnectTest( GNet::EventState es , const std::vector<GNet::Address> & , unsigned int race_delay_ms ) ;
+	~ConnectTest() ;
+	std::string m_peer ;
+	std::string m_error ;
+	long m_ms {0L} ;
+
+public:
+	ConnectTest( const ConnectTest & ) = delete ;
+	ConnectTest( ConnectTest && ) = delete ;
+	ConnectTest & operator=( const ConnectTest & ) = delete ;
+	ConnectTest & operator=( ConnectTest && ) = delete ;
+
+private:
+	void onDelete( const std::string & reason ) ;
+
+private:
+	GNet::ClientPtr<TestClient> m_client_ptr ;
+} ;
+
+ConnectTest::ConnectTest( GNet::EventState es , const std::vector<GNet::Address> & addresses , unsigned int race_delay_ms )
+{
+	GNet::Location location( addresses.at(0U).displayString() ) ;
+	location.update( addresses.at(0U) , addresses ) ;
+	m_client_ptr.deleteSignal().connect( G::Slot::slot(*this,&ConnectTest::onDelete) ) ;
+
+	auto start = std::chrono::steady_clock::now() ;
+	m_client_ptr.reset( std::make_unique<TestClient>( es.eh(m_client_ptr) , location , race_delay_ms ) ) ;
+	GNet::EventLoop::instance().run() ;
+	m_ms = static_cast<long>( std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start).count() ) ;
+	if( m_client_ptr.get() )
+		m_peer = m_client_ptr->m_peer ;
+}
+
+ConnectTest::~ConnectTest()
+{
+	m_client_ptr.deleteSignal().disconnect() ;
+}
+
+void ConnectTest::onDelete( const std::string & reason )
+{
+	m_error = reason.empty() ? std::string("unknown error") : reason ;
+	GNet::EventLoop::instance().quit( "failed" ) ;
+}
+
+static std::unique_ptr<GNet::StreamSocket> newSocket( bool listening , int listen_queue = 0 )
+{
+	GNet::StreamSocket::Config config ;
+	config.listen_queue = listen_queue ;
+	auto s = listening ?
+		std::make_unique<GNet::StreamSocket>( GNet::Address::Family::ipv4 , GNet::StreamSocket::Listener() , config ) :
+		std::make_unique<GNet::StreamSocket>( GNet::Address::Family::ipv4 , config ) ;
+	s->bind( GNet::Address::loopback( GNet::Address::Family::ipv4 , 0U ) ) ;
+	if( listening )
+		s->listen() ;
+	return s ;
+}
+
+class Writer : private GNet::EventHandler , private GNet::SocketProtocolSink
+{
+public:
+	Writer( GNet::EventState es , std::unique_ptr<GNet::StreamSocket> , std::size_t send_queue_limit ) ;
+	bool send( std::size_t size ) ;
+	std::size_t m_sent {0U} ; // bytes passed to send()
+	unsigned int m_completed {0U} ; // writeEvent() completions
+
+public:
+	~Writer() override = default ;
+	Writer( const Writer & ) = delete ;
+	Writer( Writer && ) = delete ;
+	Writer & operator=( const Writer & ) = delete ;
+	Writer & operator=( Writer && ) = delete ;
+
+private: // overrides
+	void writeEvent() override ; // GNet::EventHandler
+	void onData( const char * , std::size_t ) override {} // GNet::SocketProtocolSink
+	void onSecure( const std::string & , const std::string & , const std::string & ) override {} // GNet::SocketProtocolSink
+	void onPeerDisconnect() override {} // GNet::SocketProtocolSink
+
+private:
+	std::unique_ptr<GNet::StreamSocket> m_socket ;
+	std::unique_ptr<GNet::SocketProtocol> m_sp ;
+} ;
+
+class Reader : private GNet::EventHandler
+{
+public:
+	Reader( GNet::EventState es , std::unique_ptr<GNet::StreamSocket> ) ;
+	void drain( std::size_t expected ) ;
+	std::size_t m_received {0U} ;
+
+public:
+	~Reader() override = default ;
+	Reader( const Reader & ) = delete ;
+	Reader( Reader && ) = delete ;
+	Reader & operator=( const Reader & ) = delete ;
+	Reader & operator=( Reader && ) = delete ;
+
+private: // overrides
+	void readEvent() override ; // GNet::EventHandler
+
+private:
+	GNet::EventState m_es ;
+	std::unique_ptr<GNet::StreamSocket> m_socket ;
+	std::size_t m_expected {0U} ;
+	std::vector<char> m_buffer ;
+} ;
+
+static char pattern( std::size_t n )
+{
+	return static_cast<char>( 'a' + n % 23U ) ;
+}
+
+Writer::Writer( GNet::EventState es , std::unique_ptr<GNet::StreamSocket> socket , std::size_t send_queue_limit ) :
+	m_socket(std::move(socket))
+{
+	GNet::EventHandler & eh = *this ;
+	GNet::SocketProtocolSink & sink = *this ;
+	m_sp = std::make_unique<GNet::SocketProtocol>( eh , es , sink , *m_socket ,
+		GNet::SocketProtocol::Config().set_send_queue_limit(send_queue_limit) ) ;
+}
+
+bool Writer::send( std::size_t size )
+{
+	std::string data ;
+	data.reserve( size ) ;
+	for( std::size_t i = 0U ; i < size ; i++ )
+		data.push_back( pattern(m_sent+i) ) ;
+	m_sent += size ;
+	return m_sp->send( data , 0U ) ;
+}
+
+void Writer::writeEvent()
+{
+	if( m_sp->writeEvent() )
+		m_completed++ ;
+}
+
+Reader::Reader( GNet::EventState es , std::unique_ptr<GNet::StreamSocket> socket ) :
+	m_es(es) ,
+	m_socket(std::move(socket)) ,
+	m_buffer(65536U)
+{
+}
+
+void Reader::drain( std::size_t expected )
+{
+	m_expected = expected ;
+	m_socket->addReadHandler( *this , m_es ) ;
+	GNet::EventLoop::instance().run() ;
+	m_socket->dropReadHandler() ;
+}
+
+void Reader::readEvent()
+{
+	auto rc = m_socket->read( m_buffer.data() , m_buffer.size() ) ;
+	if( rc == 0 || ( rc < 0 && !m_socket->eWouldBlock() ) )
+		throw std::runtime_error( "test failed: read error" ) ;
+	for( decltype(rc) i = 0 ; i < rc ; i++ , m_received++ )
+		Test::check( m_buffer[static_cast<std::size_t>(i)] == pattern(m_received) , "corrupt data" ) ;
+	if( m_received >= m_expected )
+		GNet::EventLoop::instance().quit( "drained" ) ;
+}
+
+static std::pair<std::unique_ptr<GNet::StreamSocket>,std::unique_ptr<GNet::StreamSocket>> socketPair()
+{
+	auto listener = newSocket( true ) ;
+	auto client = newSocket( false ) ;
+	client->connect( listener->getLocalAddress() ) ;
+	for( int i = 0 ; i < 100 ; i++ )
+	{
+		GNet::AcceptInfo info = listener->accept() ;
+		if( info.socket_ptr )
+			return { std::move(client) , std::move(info.socket_ptr) } ;
+		std::this_thread::sleep_for( std::chrono::milliseconds(10) ) ;
+	}
+	throw std::runtime_error( "cannot accept" ) ;
+}
+
+static void testSendQueue( GNet::EventState es )
+{
+	const std::size_t chunk = 10000U ;
+	const std::size_t limit = 1000000U ; // as G::Limits<>::net_send_queue
+
+	// measure the kernel buffering with the queue disabled -- send()
+	// returns false on the first partial write
+	std::size_t kernel = 0U ;
+	{
+		auto pair = socketPair() ;
+		Writer writer( es , std::move(pair.first) , 0U ) ;
+		while( writer.send( chunk ) )
+			Test::check( writer.m_sent < 0x10000000U , "no flow control" ) ;
+		kernel = writer.m_sent ;
+		Reader reader( es , std::move(pair.second) ) ;
+		reader.drain( writer.m_sent ) ;
+		Test::check( writer.m_completed == 1U , "no queue: wrong number of completions: " + std::to_string(writer.m_completed) ) ;
+		std::cout << "no queue: ok (kernel " << kernel << " bytes)" << std::endl ;
+	}
+
+	// with the queue enabled, data within the budget is accepted and
+	// drains without any completion
+	{
+		auto pair = socketPair() ;
+		Writer writer( es , std::move(pair.first) , limit ) ;
+		while( writer.m_sent < kernel + limit/2U )
+			Test::check( writer.send( chunk ) , "within budget: blocked after " + std::to_string(writer.m_sent) + " bytes" ) ;
+		Reader reader( es , std::move(pair.second) ) ;
+		reader.drain( writer.m_sent ) ;
+		Test::check( reader.m_received == writer.m_sent , "within budget: data lost" ) ;
+		Test::check( writer.m_completed == 0U , "within budget: unexpected completion" ) ;
+		std::cout << "within budget: ok (" << writer.m_sent << " bytes)" << std::endl ;
+	}
+
+	// data beyond the budget blocks, and there is exactly one completion
+	// once drained, after which send()s are accepted again
+	{
+		auto pair = socketPair() ;
+		Writer writer( es , std::move(pair.first) , limit ) ;
+		while( writer.send( chunk ) )
+			Test::check( writer.m_sent < 0x10000000U , "beyond budget: no flow control" ) ;
+		std::size_t blocked_at = writer.m_sent ;
+		Test::check( blocked_at + chunk >= kernel + limit , "beyond budget: blocked too soon at " + std::to_string(blocked_at) + " bytes" ) ;
+		Test::check( blocked_at <= kernel + 2U*limit , "beyond budget: blocked too late at " + std::to_string(blocked_at) + " bytes" ) ;
+		Reader reader( es , std::move(pair.second) ) ;
+		reader.drain( writer.m_sent ) ;
+		Test::check( writer.m_completed == 1U , "beyond budget: wrong number of completions: " + std::to_string(writer.m_completed) ) ;
+		Test::check( writer.send( chunk ) , "beyond budget: still blocked" ) ;
+		reader.drain( writer.m_sent ) ;
+		Test::check( writer.m_completed == 1U , "beyond budget: unexpected completion" ) ;
+		std::cout << "beyond budget: ok (blocked at " << blocked_at << " bytes)" << std::endl ;
+	}
+}
+
+static void testConnect( GNet::EventState es )
+{
+	const unsigned int race_delay_ms = 250U ;
+
+	// an address that refuses connections, ie. bound but not listening
+	auto refused_1 = newSocket( false ) ;
+	auto refused_2 = newSocket( false ) ;
+
+	// an address that never answers, ie. a full accept queue
+	auto black_hole = newSocket( true , 1 ) ;
+	std::vector<std::unique_ptr<GNet::StreamSocket>> fillers ;
+	for( int i = 0 ; i < 4 ; i++ )
+	{
+		fillers.push_back( newSocket( false ) ) ;
+		fillers.back()->connect( black_hole->getLocalAddress() ) ;
+	}
+
+	// an address that accepts connections
+	auto good = newSocket( true ) ;
+	std::string good_address = good->getLocalAddress().displayString() ;
+
+	// first address refuses
+	{
+		ConnectTest test( es , { refused_1->getLocalAddress() , good->getLocalAddress() } , race_delay_ms ) ;
+		Test::check( test.m_error.empty() , "refused: connection failed: " + test.m_error ) ;
+		Test::check( test.m_peer == good_address , "refused: connected to the wrong address: " + test.m_peer ) ;
+		std::cout << "refused: ok (" << test.m_ms << "ms)" << std::endl ;
+	}
+
+	// first address never answers, so the second attempt starts
+	// after the race delay and wins
+	{
+		ConnectTest test( es , { black_hole->getLocalAddress() , good->getLocalAddress() } , race_delay_ms ) ;
+		Test::check( test.m_error.empty() , "unanswered: connection failed: " + test.m_error ) ;
+		Test::check( test.m_peer == good_address , "unanswered: connected to the wrong address: " + test.m_peer ) ;
+		Test::check( test.m_ms >= static_cast<long>(race_delay_ms)-10L , "unanswered: no race delay" ) ;
+		Test::check( test.m_ms < 5000L , "unanswered: too slow" ) ;
+		std::cout << "unanswered: ok (" << test.m_ms << "ms)" << std::endl ;
+	}
+
+	// all addresses fail, so the reason mentions them all
+	{
+		std::string a1 = refused_1->getLocalAddress().displayString() ;
+		std::string a2 = refused_2->getLocalAddress().displayString() ;
+		ConnectTest test( es , { refused_1->getLocalAddress() , refused_2->getLocalAddress() } , race_delay_ms ) ;
+		Test::check( !test.m_error.empty() , "failed: unexpected connection to " + test.m_peer ) ;
+		Test::check( test.m_error.find(a1) != std::string::npos && test.m_error.find(a2) != std::string::npos ,
+			"failed: reason does not mention all addresses: " + test.m_error ) ;
+		std::cout << "failed: ok: " << test.m_error << std::endl ;
+	}
+}
+
+class DnsTest
+{
+public:
+	DnsTest( GNet::EventState es , const GNet::DnsResolver::Config & , unsigned int dns_port ,
+		const GNet::DnsSearch & , const std::string & host ) ;
+	std::string m_error ;
+	std::string m_address ;
+	unsigned int m_ttl {0U} ;
+
+private:
+	void onDone( const std::string & , const GNet::DnsResolver::AddressList & , unsigned int ) ;
+
+private:
+	GNet::DnsResolver m_resolver ;
+} ;
+
+DnsTest::DnsTest( GNet::EventState es , const GNet::DnsResolver::Config & config , unsigned int dns_port ,
+	const GNet::DnsSearch & search , const std::string & host ) :
+		m_resolver(es,config,{GNet::Address::loopback(GNet::Address::Family::ipv4,dns_port)},search)
+{
+	m_resolver.doneSignal().connect( G::Slot::slot(*this,&DnsTest::onDone) ) ;
+	m_resolver.start( host , 25U , AF_INET ) ;
+	GNet::EventLoop::instance().run() ;
+	m_resolver.doneSignal().disconnect() ;
+}
+
+void DnsTest::onDone( const std::string & error , const GNet::DnsResolver::AddressList & list , unsigned int ttl )
+{
+	m_error = error ;
+	m_address = list.empty() ? std::string() : list.at(0U).hostPartString() ;
+	m_ttl = ttl ;
+	GNet::EventLoop::instance().quit( "done" ) ;
+}
+
+static void testDns( GNet::EventState es , unsigned int dns_port , const std::string & hosts_file )
+{
+	auto config = GNet::DnsResolver::Config().set_timeout(G::TimeInterval(1U)).set_attempts(1U).set_hosts_file(hosts_file) ;
+	GNet::DnsSearch search ;
+	search.domains = { "missing.test" , "two.test" } ;
+	search.ndots = 1U ;
+
+	// the first search domain gives nxdomain so the second is used
+	{
+		DnsTest test( es , config , dns_port , search , "host" ) ;
+		Test::check( test.m_error.empty() , "search: lookup failed: " + test.m_error ) ;
+		Test::check( test.m_address == "127.0.2.0" , "search: wrong address: " + test.m_address ) ;
+		Test::check( test.m_ttl == 300U , "search: wrong ttl: " + G::Str::fromUInt(test.m_ttl) ) ;
+		std::cout << "search: ok" << std::endl ;
+	}
+
+	// a name with 'ndots' dots is tried as-is before the search list
+	{
+		DnsTest test( es , config , dns_port , search , "host.one" ) ;
+		Test::check( test.m_error.empty() , "ndots: lookup failed: " + test.m_error ) ;
+		Test::check( test.m_address == "127.0.1.0" , "ndots: wrong address: " + test.m_address ) ;
+		std::cout << "ndots: ok" << std::endl ;
+	}
+
+	// a name with a trailing dot is not searched
+	{
+		DnsTest test( es , config , dns_port , search , "host." ) ;
+		Test::check( test.m_error.empty() , "absolute: lookup failed: " + test.m_error ) ;
+		Test::check( test.m_address == "127.0.0.0" , "absolute: wrong address: " + test.m_address ) ;
+		std::cout << "absolute: ok" << std::endl ;
+	}
+
+	// every candidate gives nxdomain
+	{
+		GNet::DnsSearch missing_search ;
+		missing_search.domains = { "missing.test" } ;
+		DnsTest test( es , config , dns_port , missing_search , "missing" ) ;
+		Test::check( test.m_error.find("no such host") != std::string::npos , "nxdomain: unexpected result: " + test.m_address + test.m_error ) ;
+		std::cout << "nxdomain: ok" << std::endl ;
+	}
+
+	// a name in the hosts file has no ttl
+	{
+		DnsTest test( es , config , dns_port , search , "hosted" ) ;
+		Test::check( test.m_error.empty() , "hosts: lookup failed: " + test.m_error ) ;
+		Test::check( test.m_address == "127.0.0.9" , "hosts: wrong address: " + test.m_address ) ;
+		Test::check( test.m_ttl == std::numeric_limits<unsigned int>::max() , "hosts: wrong ttl: " + G::Str::fromUInt(test.m_ttl) ) ;
+		std::cout << "hosts: ok" << std::endl ;
+	}
+}
+
+struct CacheStats
+{
+	unsigned long entries {0UL} ;
+	unsigned long hits {0UL} ;
+	unsigned long misses {0UL} ;
+} ;
+
+static CacheStats cacheStats()
+{
+	std::ostringstream ss ;
+	GNet::Resolver::report( ss ) ;
+	CacheStats stats ;
+	std::string line ;
+	std::istringstream in( ss.str() ) ;
+	while( std::getline( in , line ) )
+	{
+		std::string value = G::Str::tail( line , ": " ) ;
+		if( G::Str::headMatch( line , "DNS cache entries: " ) ) stats.entries = G::Str::toULong( value ) ;
+		if( G::Str::headMatch( line , "DNS cache hits: " ) ) stats.hits = G::Str::toULong( value ) ;
+		if( G::Str::headMatch( line , "DNS cache misses: " ) ) stats.misses = G::Str::toULong( value ) ;
+	}
+	return stats ;
+}
+
+static void resolve( const std::string & address , const GNet::Resolver::Config & config )
+{
+	GNet::Location location( address + ":25" ) ;
+	std::string error = GNet::Resolver::resolve( location , config ).first ;
+	Test::check( error.empty() , "resolve failed: " + address + ": " + error ) ;
+}
+
+static void testResolverCache()
+{
+	const auto limit = static_cast<unsigned long>( G::Limits<>::resolver_cache ) ;
+	auto cached = GNet::Resolver::Config().set_sync_cache() ;
+
+	// not cached by default
+	{
+		CacheStats before = cacheStats() ;
+		resolve( "127.0.0.1" , GNet::Resolver::Config() ) ;
+		resolve( "127.0.0.1" , GNet::Resolver::Config() ) ;
+		CacheStats after = cacheStats() ;
+		Test::check( after.entries == before.entries && after.hits == before.hits && after.misses == before.misses ,
+			"default: cache used" ) ;
+		std::cout << "default: ok" << std::endl ;
+	}
+
+	// cached when enabled
+	{
+		CacheStats before = cacheStats() ;
+		resolve( "127.0.0.2" , cached ) ;
+		resolve( "127.0.0.2" , cached ) ;
+		CacheStats after = cacheStats() ;
+		Test::check( after.entries == before.entries+1UL , "enabled: no new entry" ) ;
+		Test::check( after.misses == before.misses+1UL && after.hits == before.hits+1UL , "enabled: cache not used" ) ;
+		std::cout << "enabled: ok" << std::endl ;
+	}
+
+	// a full cache drops the entries that expire soonest
+	{
+		for( unsigned long i = 0UL ; i < limit+50UL ; i++ )
+			resolve( "127.1." + G::Str::fromULong(i/250UL) + "." + G::Str::fromULong(i%250UL+1UL) , cached ) ;
+		CacheStats full = cacheStats() ;
+		Test::check( full.entries <= limit , "full: too many entries: " + G::Str::fromULong(full.entries) ) ;
+		resolve( "127.0.0.2" , cached ) ;
+		CacheStats after = cacheStats() ;
+		Test::check( after.misses == full.misses+1UL , "full: oldest entry not dropped" ) ;
+		resolve( "127.1." + G::Str::fromULong((limit+49UL)/250UL) + "." + G::Str::fromULong((limit+49UL)%250UL+1UL) , cached ) ;
+		Test::check( cacheStats().hits == after.hits+1UL , "full: newest entry dropped" ) ;
+		std::cout << "full: ok (" << full.entries << " entries)" << std::endl ;
+	}
+
+	// expired entries are not used
+	{
+		auto short_lived = GNet::Resolver::Config(cached).set_cache_ttl(1U) ;
+		resolve( "127.0.0.3" , short_lived ) ;
+		std::this_thread::sleep_for( std::chrono::milliseconds(1100) ) ;
+		CacheStats before = cacheStats() ;
+		resolve( "127.0.0.3" , short_lived ) ;
+		Test::check( cacheStats().misses == before.misses+1UL , "expiry: expired entry used" ) ;
+		std::cout << "expiry: ok" << std::endl ;
+	}
+}
+
+int main( int argc , char * argv [] )
+{
+	try
+	{
+		G::Arg arg( argc , argv ) ;
+		G::Options options ;
+		using M = G::Option::Multiplicity ;
+		G::Options::add( options , 'h' , "help" , "show help" , "" , M::zero , "" , 1 , 0 ) ;
+		G::Options::add( options , 'd' , "debug" , "debug logging" , "" , M::zero , "" , 1 , 0 ) ;
+		G::Options::add( options , 't' , "test" , "run the named test (connect, send-queue, dns, resolver-cache)" , "" , M::one , "name" , 1 , 0 ) ;
+		G::Options::add( options , 'p' , "dns-port" , "test dns server port" , "" , M::one , "port" , 1 , 0 ) ;
+		G::Options::add( options , 'f' , "hosts-file" , "test hosts file" , "" , M::one , "path" , 1 , 0 ) ;
+		G::GetOpt opt( arg , options ) ;
+		if( opt.hasErrors() )
+		{
+			opt.showErrors(std::cerr) ;
+			return 2 ;
+		}
+		if( opt.contains("help") || !opt.contains("test") )
+		{
+			G::OptionsUsage(opt.options()).output( {} , std::cout , arg.prefix() ) ;
+			return opt.contains("help") ? 0 : 2 ;
+		}
+
+		G::LogOutput log_output( arg.prefix() ,
+			G::LogOutput::Config()
+				.set_output_enabled(opt.contains("debug"))
+				.set_summary_info(opt.contains("debug"))
+				.set_verbose_info(opt.contains("debug"))
+				.set_debug(opt.contains("debug")) ) ;
+
+		auto event_loop = GNet::EventLoop::create() ;
+		auto es = GNet::EventState::create() ;
+		GNet::TimerList timer_list ;
+
+		std::string name = opt.value( "test" ) ;
+		if( name == "connect" )
+			testConnect( es ) ;
+		else if( name == "send-queue" )
+			testSendQueue( es ) ;
+		else if( name == "resolver-cache" )
+			testResolverCache() ;
+		else if( name == "dns" )
+			testDns( es , G::Str::toUInt(opt.value("dns-port","10053")) , opt.value("hosts-file") ) ;
+		else
+			throw std::runtime_error( "invalid test name: [" + name + "]" ) ;
+		return 0 ;
+	}
+	catch( std::exception & e )
+	{
+		std::cerr << G::Arg::prefix(argv) << ": error: " << e.what() << std::endl ;
+	}
+	catch(...)
+	{
+		std::cerr << G::Arg::prefix(argv) << ": error\n" ;
+	}
+	return 1 ;
+}
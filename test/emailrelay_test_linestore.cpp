@@ -0,0 +1,252 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file emailrelay_test_linestore.cpp
+///
+// A benchmark for line scanning in GNet::LineStore and GNet::LineBuffer.
+//
+// usage: emailrelay_test_linestore [--size <mb>] [--repeat <count>]
+//
+// Builds a message body (16MB by default) made up of header lines,
+// base64 lines, quoted-printable text and a few bare carriage-returns,
+// and splits it across the two segments of a line store. Finds every
+// CR-LF and then the "<CR><LF>.<CR><LF>" terminator, once using the
+// old byte-at-a-time scan for reference and once using
+// GNet::LineStore::find(), checking that the results agree. Finally
+// feeds the body through a GNet::LineBuffer in 64KiB reads, as in
+// the DATA phase of an SMTP session.
+//
+
+#include "gdef.h"
+#include "glinestore.h"
+#include "glinebuffer.h"
+#include "gstr.h"
+#include "garg.h"
+#include "ggetopt.h"
+#include "goptionsusage.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+
+using Duration = std::chrono::steady_clock::duration ;
+
+class Stopwatch
+{
+public:
+	Stopwatch() :
+		m_start(std::chrono::steady_clock::now())
+	{
+	}
+	Duration elapsed() const
+	{
+		return std::chrono::steady_clock::now() - m_start ;
+	}
+	void report( const std::string & what , std::size_t bytes ) const
+	{
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed()).count() ;
+		std::cout
+			<< std::left << std::setw(20) << what << " "
+			<< std::right << std::setw(10) << us << "us "
+			<< std::setw(8) << (us?(static_cast<long long>(bytes)/us):0LL) << "MB/s" << std::endl ;
+	}
+private:
+	std::chrono::steady_clock::time_point m_start ;
+} ;
+
+static std::string makeBody( std::size_t size )
+{
+	static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/" ;
+	std::minstd_rand random( 1U ) ;
+	std::uniform_int_distribution<unsigned int> char_index( 0U , 63U ) ;
+	std::uniform_int_distribution<unsigned int> text_length( 0U , 76U ) ;
+	std::uniform_int_distribution<unsigned int> percent( 0U , 99U ) ;
+	std::string body ;
+	body.reserve( size + 100U ) ;
+	body.append( "From: alice@example.com\r\nTo: bob@example.com\r\nSubject: test\r\n"
+		"MIME-Version: 1.0\r\nContent-Type: multipart/mixed; boundary=\"xxx\"\r\n\r\n" ) ;
+	while( body.size() < size )
+	{
+		// text part
+		body.append( "--xxx\r\nContent-Type: text/plain\r\nContent-Transfer-Encoding: quoted-printable\r\n\r\n" ) ;
+		for( unsigned int i = 0U ; i < 200U ; i++ )
+		{
+			unsigned int n = text_length( random ) ;
+			for( unsigned int j = 0U ; j < n ; j++ )
+				body.append( 1U , j%7U == 6U ? ' ' : alphabet[char_index(random)%52U] ) ;
+			if( percent(random) == 0 )
+				body.append( 1U , '\r' ) ; // bare CR
+			body.append( n == 76U ? "=\r\n" : "\r\n" ) ;
+		}
+		// attachment
+		body.append( "--xxx\r\nContent-Type: application/octet-stream\r\nContent-Transfer-Encoding: base64\r\n\r\n" ) ;
+		for( unsigned int i = 0U ; i < 2000U ; i++ )
+		{
+			for( unsigned int j = 0U ; j < 76U ; j++ )
+				body.append( 1U , alphabet[char_index(random)] ) ;
+			body.append( "\r\n" ) ;
+		}
+	}
+	body.append( "--xxx--\r\n.\r\n" ) ;
+	return body ;
+}
+
+static std::size_t referenceFind( const GNet::LineStore & store , const std::string & s , std::size_t startpos )
+{
+	// the old scan, one character at a time via at(), as with
+	// std::search over a LineStoreIterator
+	const std::size_t size = store.size() ;
+	for( std::size_t pos = startpos ; (pos+s.size()) <= size ; pos++ )
+	{
+		std::size_t i = 0U ;
+		for( ; i < s.size() && store.at(pos+i) == s[i] ; i++ )
+			{;}
+		if( i == s.size() )
+			return pos ;
+	}
+	return std::string::npos ;
+}
+
+static std::size_t referenceFindCrLf( const GNet::LineStore & store , std::size_t startpos )
+{
+	// the old two-character scan, using find(char) and then checking
+	// the next character
+	const std::size_t npos = std::string::npos ;
+	const std::size_t end = store.size() ;
+	for( std::size_t pos = startpos ; pos != npos ; ++pos )
+	{
+		pos = store.find( '\r' , pos ) ;
+		if( pos == npos ) break ;
+		if( (pos+1U) != end && store.at(pos+1U) == '\n' )
+			return pos ;
+	}
+	return npos ;
+}
+
+template <typename Tfn>
+static std::size_t scan( Tfn fn )
+{
+	std::size_t n = 0U ;
+	for( std::size_t pos = fn(0U) ; pos != std::string::npos ; pos = fn(pos+2U) )
+		n++ ;
+	return n ;
+}
+
+static void run( std::size_t size , unsigned int repeat )
+{
+	const std::string body = makeBody( size ) ;
+	const std::string crlf( "\r\n" , 2U ) ;
+	const std::string eod( "\r\n.\r\n" , 5U ) ;
+	const std::size_t bytes = body.size() * repeat ;
+
+	// a store with the first half by value and the second half as the extension
+	GNet::LineStore store ;
+	store.append( body.data() , body.size()/2U ) ;
+	store.extend( body.data() + body.size()/2U , body.size() - body.size()/2U ) ;
+
+	std::cout << "body: " << body.size() << " bytes" << std::endl ;
+	std::size_t lines = 0U ;
+	{
+		Stopwatch sw ;
+		for( unsigned int i = 0U ; i < repeat ; i++ )
+			lines = scan( [&](std::size_t pos){ return referenceFindCrLf(store,pos) ; } ) ;
+		sw.report( "crlf (reference)" , bytes ) ;
+	}
+	{
+		std::size_t n = 0U ;
+		Stopwatch sw ;
+		for( unsigned int i = 0U ; i < repeat ; i++ )
+			n = scan( [&](std::size_t pos){ return store.find(crlf,pos) ; } ) ;
+		sw.report( "crlf (find)" , bytes ) ;
+		if( n != lines )
+			throw std::runtime_error( "line count mismatch" ) ;
+	}
+	std::size_t end_pos = 0U ;
+	{
+		Stopwatch sw ;
+		for( unsigned int i = 0U ; i < repeat ; i++ )
+			end_pos = referenceFind( store , eod , 0U ) ;
+		sw.report( "eod (reference)" , bytes ) ;
+	}
+	{
+		std::size_t pos = 0U ;
+		Stopwatch sw ;
+		for( unsigned int i = 0U ; i < repeat ; i++ )
+			pos = store.find( eod , 0U ) ;
+		sw.report( "eod (find)" , bytes ) ;
+		if( pos != end_pos || pos != (body.size()-eod.size()) )
+			throw std::runtime_error( "end-of-data mismatch" ) ;
+	}
+	{
+		std::size_t n = 0U ;
+		Stopwatch sw ;
+		for( unsigned int i = 0U ; i < repeat ; i++ )
+		{
+			GNet::LineBuffer line_buffer( GNet::LineBuffer::Config::crlf() ) ;
+			n = 0U ;
+			for( std::size_t pos = 0U ; pos < body.size() ; pos += 65536U )
+			{
+				line_buffer.apply( body.data()+pos , std::min(body.size()-pos,std::size_t(65536U)) ,
+					[&n](const char*,std::size_t,std::size_t,std::size_t,char){ n++ ; return true ; } ) ;
+			}
+		}
+		sw.report( "linebuffer" , bytes ) ;
+		if( n != lines )
+			throw std::runtime_error( "line buffer line count mismatch" ) ;
+	}
+	std::cout << "(" << lines << " lines)" << std::endl ;
+}
+
+int main( int argc , char * argv [] )
+{
+	try
+	{
+		G::Arg arg( argc , argv ) ;
+		G::Options options ;
+		using M = G::Option::Multiplicity ;
+		G::Options::add( options , 'h' , "help" , "show help" , "" , M::zero , "" , 1 , 0 ) ;
+		G::Options::add( options , 's' , "size" , "message body size in megabytes" , "" , M::one , "mb" , 1 , 0 ) ;
+		G::Options::add( options , 'r' , "repeat" , "number of passes" , "" , M::one , "count" , 1 , 0 ) ;
+		G::GetOpt opt( arg , options ) ;
+		if( opt.hasErrors() )
+		{
+			opt.showErrors(std::cerr) ;
+			return 2 ;
+		}
+		if( opt.contains("help") )
+		{
+			G::OptionsUsage(opt.options()).output( {} , std::cout , arg.prefix() ) ;
+			return 0 ;
+		}
+		std::size_t size = G::Str::toUInt( opt.value("size","16") ) * 1024U * 1024U ;
+		unsigned int repeat = std::max( 1U , G::Str::toUInt( opt.value("repeat","4") ) ) ;
+		run( size , repeat ) ;
+		return 0 ;
+	}
+	catch( std::exception & e )
+	{
+		std::cerr << G::Arg::prefix(argv) << ": error: " << e.what() << std::endl ;
+	}
+	catch(...)
+	{
+		std::cerr << G::Arg::prefix(argv) << ": error\n" ;
+	}
+	return 1 ;
+}
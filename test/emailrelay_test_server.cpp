@@ -142,7 +142,8 @@ std::unique_ptr<GNet::ServerPeer> Server::newPeer( GNet::EventStateUnbound esu ,
 {
 	try
 	{
-		G_LOG_S( "Server::newPeer: new connection from " << peer_info.m_address.displayString() ) ;
+		G_LOG_S( "Server::newPeer: new connection from " << peer_info.m_address.displayString()
+			<< " (" << (peers().size()+1U) << " connected)" ) ;
 		return std::unique_ptr<GNet::ServerPeer>( new Peer( esu , std::move(peer_info) , m_config ) ) ;
 	}
 	catch( std::exception & e )
@@ -0,0 +1,393 @@
+//
+// Copyright (C) 2001-2024 Graeme Walker <graeme_walker@users.sourceforge.net>
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file emailrelay_test_timers.cpp
+///
+// A benchmark and correctness test for GNet::TimerList.
+//
+// usage: emailrelay_test_timers [--count <count>] [--test]
+//
+// Creates a large number of timers (100000 by default) with long
+// timeouts, as for lots of idle connections, and reports the average
+// cost of starting, restarting and cancelling them, the cost of
+// asking for the next timeout interval, the cost of expiring
+// them in batches, and the cost of destroying them.
+//
+// With "--test" it instead checks that timers expire in the right
+// order and not too early, across the slots and levels of the
+// timing wheel and as the wheel wraps round, and that cancelled,
+// re-armed and destroyed timers behave correctly. The exit code
+// is non-zero on failure.
+//
+
+#include "gdef.h"
+#include "gtimer.h"
+#include "gtimerlist.h"
+#include "geventstate.h"
+#include "gstr.h"
+#include "garg.h"
+#include "ggetopt.h"
+#include "goptionsusage.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <stdexcept>
+
+struct Item
+{
+	explicit Item( GNet::EventState es ) :
+		m_timer(*this,&Item::onTimeout,es)
+	{
+	}
+	void onTimeout()
+	{
+		m_fired++ ;
+	}
+	GNet::Timer<Item> m_timer ;
+	static std::size_t m_fired ;
+} ;
+
+std::size_t Item::m_fired = 0U ;
+
+using Duration = std::chrono::steady_clock::duration ;
+
+class Stopwatch
+{
+public:
+	Stopwatch() :
+		m_start(std::chrono::steady_clock::now())
+	{
+	}
+	Duration elapsed() const
+	{
+		return std::chrono::steady_clock::now() - m_start ;
+	}
+	void report( const std::string & what , std::size_t n ) const
+	{
+		report( what , elapsed() , n ) ;
+	}
+	static void report( const std::string & what , Duration d , std::size_t n )
+	{
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() ;
+		std::cout
+			<< std::left << std::setw(12) << what << " "
+			<< std::right << std::setw(10) << (ns/1000) << "us total "
+			<< std::setw(8) << (n?(ns/static_cast<long long>(n)):0LL) << "ns/op" << std::endl ;
+	}
+private:
+	std::chrono::steady_clock::time_point m_start ;
+} ;
+
+static void run( std::size_t count )
+{
+	GNet::TimerList timer_list ;
+	auto es = GNet::EventState::create() ;
+	std::minstd_rand random( 1U ) ;
+	std::uniform_int_distribution<unsigned int> long_timeout( 60U , 600U ) ;
+	std::uniform_int_distribution<unsigned int> short_timeout( 1000U , 50000U ) ; // us
+	std::vector<std::unique_ptr<Item>> items ;
+	items.reserve( count ) ;
+
+	std::cout << "timers: " << count << std::endl ;
+	{
+		Stopwatch sw ;
+		for( std::size_t i = 0U ; i < count ; i++ )
+			items.push_back( std::make_unique<Item>(es) ) ;
+		sw.report( "create" , count ) ;
+	}
+	{
+		Stopwatch sw ;
+		for( auto & item : items )
+			item->m_timer.startTimer( long_timeout(random) , short_timeout(random) ) ;
+		sw.report( "start" , count ) ;
+	}
+	{
+		Stopwatch sw ;
+		for( auto & item : items )
+			item->m_timer.startTimer( long_timeout(random) ) ;
+		sw.report( "restart" , count ) ;
+	}
+	{
+		// restart the soonest timer each time, as with activity on
+		// the connection that is next to time out
+		std::size_t n = std::min( count , std::size_t(1000U) ) ;
+		for( std::size_t i = 0U ; i < count ; i++ )
+			items[i]->m_timer.startTimer( 60U , static_cast<unsigned int>(i%1000000U) ) ;
+		Stopwatch sw ;
+		for( std::size_t i = 0U ; i < n ; i++ )
+		{
+			items[i]->m_timer.startTimer( long_timeout(random) ) ;
+			if( timer_list.interval().second )
+				throw std::runtime_error( "no timers" ) ;
+		}
+		sw.report( "interval" , n ) ;
+	}
+	{
+		Stopwatch sw ;
+		for( std::size_t i = 0U ; i < count ; i += 2U )
+			items[i]->m_timer.cancelTimer() ;
+		sw.report( "cancel" , (count+1U)/2U ) ;
+	}
+	{
+		// half of the timers expire soon, the other half stay armed
+		for( std::size_t i = 0U ; i < count ; i += 2U )
+			items[i]->m_timer.startTimer( 0U , short_timeout(random) ) ;
+		Duration d {} ;
+		std::size_t loops = 0U ;
+		while( Item::m_fired < (count+1U)/2U )
+		{
+			Stopwatch sw ;
+			auto interval = timer_list.interval() ;
+			d += sw.elapsed() ;
+			if( interval.second )
+				throw std::runtime_error( "no timers" ) ;
+			if( interval.first.s() != 0 || interval.first.us() != 0U ) // millisecond resolution, as in the event loop
+				std::this_thread::sleep_for( std::max( std::chrono::milliseconds(1) ,
+					std::chrono::milliseconds(interval.first.s()*1000U+interval.first.us()/1000U) ) ) ;
+			Stopwatch sw2 ;
+			timer_list.doTimeouts() ;
+			d += sw2.elapsed() ;
+			loops++ ;
+		}
+		Stopwatch::report( "expire" , d , Item::m_fired ) ;
+		std::cout << "(" << Item::m_fired << " timeouts in " << loops << " batches)" << std::endl ;
+	}
+	{
+		Stopwatch sw ;
+		items.clear() ;
+		sw.report( "destroy" , count ) ;
+	}
+}
+
+namespace Test
+{
+	using Clock = std::chrono::steady_clock ;
+	struct Event
+	{
+		int id ;
+		long ms ; // elapsed since the start of the test
+	} ;
+	std::vector<Event> events ;
+	Clock::time_point start ;
+	long elapsed()
+	{
+		return static_cast<long>( std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now()-start).count() ) ;
+	}
+	void check( bool ok , const std::string & what )
+	{
+		if( !ok )
+			throw std::runtime_error( "test failed: " + what ) ;
+	}
+}
+
+struct TestItem
+{
+	TestItem( int id , GNet::EventState es ) :
+		m_id(id) ,
+		m_timer(*this,&TestItem::onTimeout,es)
+	{
+	}
+	void onTimeout()
+	{
+		Test::events.push_back( {m_id,Test::elapsed()} ) ;
+		if( m_cancel ) m_cancel->m_timer.cancelTimer() ;
+		if( m_rearm_ms )
+		{
+			start( m_rearm_ms ) ;
+			m_rearm_ms = 0U ;
+		}
+	}
+	void start( unsigned int ms )
+	{
+		m_timer.startTimer( ms/1000U , (ms%1000U)*1000U ) ;
+	}
+	int m_id ;
+	TestItem * m_cancel {nullptr} ; // cancelled from this timer's callback
+	unsigned int m_rearm_ms {0U} ; // restarted from this timer's callback
+	GNet::Timer<TestItem> m_timer ;
+} ;
+
+static void runLoop( GNet::TimerList & timer_list , long limit_ms )
+{
+	// a minimal event loop, with millisecond resolution
+	for(;;)
+	{
+		auto interval = timer_list.interval() ;
+		if( interval.second )
+			break ;
+		Test::check( Test::elapsed() < limit_ms , "timers still running" ) ;
+		if( interval.first.s() != 0 || interval.first.us() != 0U )
+			std::this_thread::sleep_for( std::chrono::microseconds(
+				interval.first.s()*1000000LL + interval.first.us() ) ) ;
+		timer_list.doTimeouts() ;
+	}
+}
+
+static void checkOrder( const std::vector<std::pair<int,unsigned int>> & expected , long base_ms , const std::string & what )
+{
+	// expected is (id,timeout) in expiry order
+	Test::check( Test::events.size() == expected.size() , what + ": wrong number of timeouts: " +
+		std::to_string(Test::events.size()) + " not " + std::to_string(expected.size()) ) ;
+	for( std::size_t i = 0U ; i < expected.size() ; i++ )
+	{
+		const auto & event = Test::events[i] ;
+		Test::check( event.id == expected[i].first , what + ": wrong order at position " + std::to_string(i) +
+			": id " + std::to_string(event.id) + " not " + std::to_string(expected[i].first) ) ;
+		long early = base_ms + static_cast<long>(expected[i].second) - event.ms ;
+		Test::check( early <= 0L , what + ": timer " + std::to_string(event.id) + " expired early" ) ;
+	}
+}
+
+static void test()
+{
+	GNet::TimerList timer_list ;
+	auto es = GNet::EventState::create() ;
+	Test::start = Test::Clock::now() ;
+
+	// expiry order across level-0 slots, level-0 wraparound, and the
+	// level-1 and level-2 boundaries at 64ms and 4096ms -- started in
+	// a shuffled order
+	{
+		std::vector<unsigned int> timeouts { 0U , 1U , 2U , 7U , 31U , 63U , 64U , 65U , 100U , 127U , 128U ,
+			129U , 700U , 1000U , 2047U , 4095U , 4097U , 4300U } ;
+		std::vector<std::unique_ptr<TestItem>> items ;
+		std::vector<std::pair<int,unsigned int>> expected ;
+		for( std::size_t i = 0U ; i < timeouts.size() ; i++ )
+		{
+			items.push_back( std::make_unique<TestItem>( static_cast<int>(i) , es ) ) ;
+			expected.emplace_back( static_cast<int>(i) , timeouts[i] ) ;
+		}
+		std::vector<std::size_t> order( items.size() ) ;
+		for( std::size_t i = 0U ; i < order.size() ; i++ ) order[i] = i ;
+		std::shuffle( order.begin() , order.end() , std::minstd_rand(3U) ) ;
+		Test::events.clear() ;
+		long base = Test::elapsed() ;
+		for( auto i : order )
+			items[i]->start( timeouts[i] ) ;
+		runLoop( timer_list , base + 10000L ) ;
+		checkOrder( expected , base , "order" ) ;
+		std::cout << "order: ok" << std::endl ;
+	}
+
+	// the wheel has now turned a long way, so start a sequence that
+	// crosses several level-0 wraps from an arbitrary position, and
+	// with timers started at different times for the same deadline
+	{
+		std::vector<std::unique_ptr<TestItem>> items ;
+		std::vector<std::pair<int,unsigned int>> expected ;
+		Test::events.clear() ;
+		std::this_thread::sleep_for( std::chrono::milliseconds(23) ) ;
+		long base = Test::elapsed() ;
+		for( int i = 0 ; i < 20 ; i++ )
+		{
+			unsigned int ms = static_cast<unsigned int>( 19 - i ) * 37U + 5U ;
+			items.push_back( std::make_unique<TestItem>( i , es ) ) ;
+			items.back()->start( ms ) ;
+		}
+		for( int i = 19 ; i >= 0 ; i-- )
+			expected.emplace_back( i , static_cast<unsigned int>(19-i)*37U + 5U ) ;
+		runLoop( timer_list , base + 5000L ) ;
+		checkOrder( expected , base , "wraparound" ) ;
+		std::cout << "wraparound: ok" << std::endl ;
+	}
+
+	// cancel, re-arm and destroy
+	{
+		std::vector<std::unique_ptr<TestItem>> items ;
+		for( int i = 0 ; i < 8 ; i++ )
+			items.push_back( std::make_unique<TestItem>( i , es ) ) ;
+		Test::events.clear() ;
+		long base = Test::elapsed() ;
+		items[0]->start( 50U ) ; items[0]->m_timer.cancelTimer() ; // cancelled
+		items[1]->start( 300U ) ; items[1]->start( 20U ) ; // re-armed sooner
+		items[2]->start( 20U ) ; items[2]->start( 200U ) ; // re-armed later
+		items[3]->start( 100U ) ;
+		items[4]->start( 30U ) ; items[4]->m_cancel = items[5].get() ; // cancels 5 before it expires
+		items[5]->start( 35U ) ;
+		items[6]->start( 40U ) ; items[6]->m_rearm_ms = 100U ; // periodic, fires at 40 and 140
+		items[7]->start( 60U ) ;
+		items[7].reset() ; // destroyed while armed
+		runLoop( timer_list , base + 5000L ) ;
+		checkOrder( { {1,20U} , {4,30U} , {6,40U} , {3,100U} , {6,140U} , {2,200U} } , base , "cancel" ) ;
+		Test::check( !items[0]->m_timer.active() && !items[5]->m_timer.active() , "cancel: timers active" ) ;
+		std::cout << "cancel: ok" << std::endl ;
+	}
+
+	// zero-length timers expire in start order
+	{
+		std::vector<std::unique_ptr<TestItem>> items ;
+		std::vector<std::pair<int,unsigned int>> expected ;
+		for( int i = 0 ; i < 10 ; i++ )
+			items.push_back( std::make_unique<TestItem>( i , es ) ) ;
+		Test::events.clear() ;
+		long base = Test::elapsed() ;
+		for( int i : { 3 , 1 , 4 , 0 , 5 , 9 , 2 , 6 , 8 , 7 } )
+		{
+			items[static_cast<std::size_t>(i)]->start( 0U ) ;
+			expected.emplace_back( i , 0U ) ;
+		}
+		runLoop( timer_list , base + 1000L ) ;
+		checkOrder( expected , base , "zero" ) ;
+		std::cout << "zero: ok" << std::endl ;
+	}
+}
+
+int main( int argc , char * argv [] )
+{
+	try
+	{
+		G::Arg arg( argc , argv ) ;
+		G::Options options ;
+		using M = G::Option::Multiplicity ;
+		G::Options::add( options , 'h' , "help" , "show help" , "" , M::zero , "" , 1 , 0 ) ;
+		G::Options::add( options , 'c' , "count" , "number of timers" , "" , M::one , "count" , 1 , 0 ) ;
+		G::Options::add( options , 't' , "test" , "run correctness tests" , "" , M::zero , "" , 1 , 0 ) ;
+		G::GetOpt opt( arg , options ) ;
+		if( opt.hasErrors() )
+		{
+			opt.showErrors(std::cerr) ;
+			return 2 ;
+		}
+		if( opt.contains("help") )
+		{
+			G::OptionsUsage(opt.options()).output( {} , std::cout , arg.prefix() ) ;
+			return 0 ;
+		}
+		if( opt.contains("test") )
+		{
+			test() ;
+			return 0 ;
+		}
+		std::size_t count = G::Str::toUInt( opt.value("count","100000") ) ;
+		run( count ) ;
+		return 0 ;
+	}
+	catch( std::exception & e )
+	{
+		std::cerr << G::Arg::prefix(argv) << ": error: " << e.what() << std::endl ;
+	}
+	catch(...)
+	{
+		std::cerr << G::Arg::prefix(argv) << ": error\n" ;
+	}
+	return 1 ;
+}